@@ -193,9 +193,7 @@ int main(int argc, char* argv[])
         if (!args.dsoPath.empty()) {
             context.setDsoPath(args.dsoPath);
         }
-        for (const auto& f : args.inFiles) {
-            rdl2::readSceneFromFile(f, context);
-        }
+        rdl2::readScenesFromFiles(args.inFiles, context);
         rdl2::writeSceneToFile(context, args.outFile,
                                true, // deltaEncoding
                                true, // skipDefaults
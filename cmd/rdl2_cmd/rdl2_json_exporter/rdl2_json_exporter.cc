@@ -538,6 +538,10 @@ int main(int argc, char* argv[])
     // Use proxy mode. We only need the attribute declarations, and the proxy
     // DSOs are much, much faster to open.
     context.setProxyModeEnabled(true);
+
+    // Cache the declarations of the DSOs we open, so the next run doesn't
+    // have to open them at all.
+    context.setDsoManifestPath(rdl2::DsoManifest::defaultFilePath());
     
     // Create the GeneratorData for class and groupings files
     GeneratorData jsonGeneratorData(BO_OUT_PATH_S, JSON_EXTENSION, writeJson);
@@ -551,6 +555,7 @@ int main(int argc, char* argv[])
             context.loadAllSceneClasses();
             createAllFiles(context, options, jsonGeneratorData);
         }
+        context.saveDsoManifest();
     } catch (std::exception& e) {
         std::cerr << "ERROR: " << e.what() << "\n";
         std::exit(EXIT_FAILURE);
@@ -274,6 +274,10 @@ int main(int argc, char* argv[])
     // DSOs are much, much faster to open.
     context.setProxyModeEnabled(true);
 
+    // Cache the declarations of the DSOs we open, so the next run doesn't
+    // have to open them at all.
+    context.setDsoManifestPath(rdl2::DsoManifest::defaultFilePath());
+
     // append any additional DSO paths
     if (!options.dsoPaths.empty()) {
         std::string newPath = context.getDsoPath();
@@ -292,14 +296,13 @@ int main(int argc, char* argv[])
                               options);
         } else {
             // Load the requested RDL2 files
-            for (const auto& f : options.rdl2Files) {
-                rdl2::readSceneFromFile(f, context);
-            }
+            rdl2::readScenesFromFiles(options.rdl2Files, context);
 
             // Print the SceneObjects
             printSceneObjects(context,
                               options);
         }
+        context.saveDsoManifest();
     } catch (std::exception& e) {
         std::cerr << "ERROR: " << e.what() << '\n';
         std::exit(EXIT_FAILURE);
@@ -14,6 +14,14 @@
 #include <immintrin.h>          // AVX
 #endif // end AVX2_TEST
 
+// AVX512 kernels are compiled by the function target attribute regardless of the compile options
+// and only used when the CPU supports them (See SnapshotUtil::isAVX512Available()).
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define AVX512_IMPL
+#include <immintrin.h>          // AVX512F, BMI2
+#define AVX512_TARGET __attribute__((target("avx512f,bmi2")))
+#endif // end x86_64
+
 //
 // We have 3 different types of implementations for C++ APIs. All the same results but different
 // performances. IMPL_FULLBITOP is the best result so far but we keep all code for future testing
@@ -55,6 +63,17 @@ namespace fb_util {
 
 #define SNAPSHOTTILE_UINT32_MASK_ISPC
 
+//
+// On top of the above, the following directive switches to the _AVX512 implementation at runtime
+// when the CPU supports AVX512. This covers snapshotTileColor*, snapshotTileHeatMapNumSample,
+// snapshotTileFloat{,2,3,4}{Weight,NumSample} and snapshotTileUInt32WithMask.
+// All 64 pixels of the tile are processed by 4 iterations of 16 pixels and each 16 bit part of the
+// 64bit pixel masks is used as an AVX512 mask register directly.
+//
+#ifdef AVX512_IMPL
+#define SNAPSHOTTILE_AVX512
+#endif // end AVX512_IMPL
+
 //------------------------------------------------------------------------------
 //
 // beauty buffer
@@ -75,6 +94,11 @@ SnapshotUtil::snapshotTileColorWeight(uint32_t* dstC,
 // srcW :      source tile start address of weight data : weight buffer (w)       =  4byte * 8 * 8
 //
 {
+#ifdef SNAPSHOTTILE_AVX512
+    if (isAVX512Available()) {
+        return snapshotTileFloat4Weight_AVX512(dstC, dstW, srcC, srcW);
+    }
+#endif // end SNAPSHOTTILE_AVX512
 #ifdef SNAPSHOTTILE_COL_WEIGHT_ISPC
     return ispc::snapshotTileFloat4Weight(reinterpret_cast<int*>(dstC),
                                           reinterpret_cast<int*>(dstW),
@@ -204,6 +228,11 @@ SnapshotUtil::snapshotTileColorNumSample(uint32_t* dstC,
                                          const uint32_t* srcN,
                                          const uint64_t srcTileMask)
 {
+#ifdef SNAPSHOTTILE_AVX512
+    if (isAVX512Available()) {
+        return snapshotTileFloat4NumSample_AVX512(dstC, dstN, dstTileMask, srcC, srcN, srcTileMask);
+    }
+#endif // end SNAPSHOTTILE_AVX512
 #ifdef SNAPSHOTTILE_COL_NUMSAMPLE_ISPC
     return ispc::snapshotTileFloat4NumSample(reinterpret_cast<int*>(dstC),
                                              reinterpret_cast<int*>(dstN),
@@ -317,6 +346,11 @@ SnapshotUtil::snapshotTileHeatMapNumSample(uint32_t* dstV,
                                            const uint32_t* srcN,
                                            const uint64_t srcTileMask)
 {
+#ifdef SNAPSHOTTILE_AVX512
+    if (isAVX512Available()) {
+        return snapshotTileFloatNumSample_AVX512(dstV, dstN, dstTileMask, srcV, srcN, srcTileMask);
+    }
+#endif // end SNAPSHOTTILE_AVX512
 #ifdef SNAPSHOTTILE_HEAT_NUMSAMPLE_ISPC
     return ispc::snapshotTileFloatNumSample(reinterpret_cast<int *>(dstV),
                                             reinterpret_cast<int *>(dstN),
@@ -407,6 +441,11 @@ SnapshotUtil::snapshotTileFloatWeight(uint32_t* dstV,
                                       const uint32_t* srcV,
                                       const uint32_t* srcW)
 {
+#ifdef SNAPSHOTTILE_AVX512
+    if (isAVX512Available()) {
+        return snapshotTileFloatWeight_AVX512(dstV, dstW, srcV, srcW);
+    }
+#endif // end SNAPSHOTTILE_AVX512
 #ifdef SNAPSHOTTILE_FLOAT_WEIGHT_ISPC
     return ispc::snapshotTileFloatWeight(reinterpret_cast<int*>(dstV),
                                          reinterpret_cast<int*>(dstW),
@@ -492,6 +531,11 @@ SnapshotUtil::snapshotTileFloatNumSample(uint32_t* dstV,
                                          const uint32_t* srcN,
                                          const uint64_t srcTileMask)
 {
+#ifdef SNAPSHOTTILE_AVX512
+    if (isAVX512Available()) {
+        return snapshotTileFloatNumSample_AVX512(dstV, dstN, dstTileMask, srcV, srcN, srcTileMask);
+    }
+#endif // end SNAPSHOTTILE_AVX512
 #ifdef SNAPSHOTTILE_FLOAT_NUMSAMPLE_ISPC
     return ispc::snapshotTileFloatNumSample(reinterpret_cast<int*>(dstV),
                                             reinterpret_cast<int*>(dstN),
@@ -603,6 +647,11 @@ SnapshotUtil::snapshotTileFloat2Weight(uint32_t* dstV,
                                        const uint32_t* srcV,
                                        const uint32_t* srcW)
 {
+#ifdef SNAPSHOTTILE_AVX512
+    if (isAVX512Available()) {
+        return snapshotTileFloat2Weight_AVX512(dstV, dstW, srcV, srcW);
+    }
+#endif // end SNAPSHOTTILE_AVX512
 #ifdef SNAPSHOTTILE_FLOAT2_WEIGHT_ISPC
     return ispc::snapshotTileFloat2Weight(reinterpret_cast<int*>(dstV),
                                           reinterpret_cast<int64_t*>(dstW),
@@ -691,6 +740,11 @@ SnapshotUtil::snapshotTileFloat2NumSample(uint32_t* dstV,
                                           const uint32_t* srcN,
                                           const uint64_t srcTileMask)
 {
+#ifdef SNAPSHOTTILE_AVX512
+    if (isAVX512Available()) {
+        return snapshotTileFloat2NumSample_AVX512(dstV, dstN, dstTileMask, srcV, srcN, srcTileMask);
+    }
+#endif // end SNAPSHOTTILE_AVX512
 #ifdef SNAPSHOTTILE_FLOAT2_NUMSAMPLE_ISPC
     return ispc::snapshotTileFloat2NumSample(reinterpret_cast<int*>(dstV),
                                              reinterpret_cast<int64_t*>(dstN),
@@ -805,6 +859,11 @@ SnapshotUtil::snapshotTileFloat3Weight(uint32_t* dstV,
                                        const uint32_t* srcV,
                                        const uint32_t* srcW)
 {
+#ifdef SNAPSHOTTILE_AVX512
+    if (isAVX512Available()) {
+        return snapshotTileFloat3Weight_AVX512(dstV, dstW, srcV, srcW);
+    }
+#endif // end SNAPSHOTTILE_AVX512
 #ifdef SNAPSHOTTILE_FLOAT3_WEIGHT_ISPC
     return ispc::snapshotTileFloat3Weight(reinterpret_cast<int*>(dstV),
                                           reinterpret_cast<int*>(dstW),
@@ -896,6 +955,11 @@ SnapshotUtil::snapshotTileFloat3NumSample(uint32_t* dstV,
                                           const uint32_t* srcN,
                                           const uint64_t srcTileMask)
 {
+#ifdef SNAPSHOTTILE_AVX512
+    if (isAVX512Available()) {
+        return snapshotTileFloat3NumSample_AVX512(dstV, dstN, dstTileMask, srcV, srcN, srcTileMask);
+    }
+#endif // end SNAPSHOTTILE_AVX512
 #ifdef SNAPSHOTTILE_FLOAT3_NUMSAMPLE_ISPC
     return ispc::snapshotTileFloat3NumSample(reinterpret_cast<int*>(dstV),
                                              reinterpret_cast<int*>(dstN),
@@ -1014,6 +1078,11 @@ SnapshotUtil::snapshotTileFloat4Weight(uint32_t* dstV,
                                        const uint32_t* srcV,
                                        const uint32_t* srcW)
 {
+#ifdef SNAPSHOTTILE_AVX512
+    if (isAVX512Available()) {
+        return snapshotTileFloat4Weight_AVX512(dstV, dstW, srcV, srcW);
+    }
+#endif // end SNAPSHOTTILE_AVX512
 #ifdef SNAPSHOTTILE_FLOAT4_WEIGHT_ISPC
     return ispc::snapshotTileFloat4Weight(reinterpret_cast<int*>(dstV),
                                           reinterpret_cast<int*>(dstW),
@@ -1123,6 +1192,11 @@ SnapshotUtil::snapshotTileFloat4NumSample(uint32_t* dstV,
                                           const uint32_t* srcN,
                                           const uint64_t srcTileMask)
 {
+#ifdef SNAPSHOTTILE_AVX512
+    if (isAVX512Available()) {
+        return snapshotTileFloat4NumSample_AVX512(dstV, dstN, dstTileMask, srcV, srcN, srcTileMask);
+    }
+#endif // end SNAPSHOTTILE_AVX512
 #ifdef SNAPSHOTTILE_FLOAT4_NUMSAMPLE_ISPC
     return ispc::snapshotTileFloat4NumSample(reinterpret_cast<int*>(dstV),
                                              reinterpret_cast<int*>(dstN),
@@ -1244,6 +1318,11 @@ SnapshotUtil::snapshotTileUInt32WithMask(uint32_t* dst,
                                          const uint32_t* src,
                                          const uint64_t srcTileMask)
 {
+#ifdef SNAPSHOTTILE_AVX512
+    if (isAVX512Available()) {
+        return snapshotTileUInt32WithMask_AVX512(dst, dstTileMask, src, srcTileMask);
+    }
+#endif // end SNAPSHOTTILE_AVX512
 #ifdef SNAPSHOTTILE_UINT32_MASK_ISPC
     return ispc::snapshotTileUInt32WithMask(reinterpret_cast<int *>(dst),
                                             dstTileMask,
@@ -1329,6 +1408,313 @@ SnapshotUtil::snapshotTileUInt32WithMask_SIMD(uint32_t* dst,
                                             srcTileMask);
 }
 
+//------------------------------------------------------------------------------
+//
+// AVX512
+//
+
+// static function
+bool
+SnapshotUtil::isAVX512Available()
+{
+#ifdef AVX512_IMPL
+    // __builtin_cpu_supports() checks CPUID and also the OS support of the AVX512 register state.
+    static const bool available = []() {
+        __builtin_cpu_init(); // might be called before the static constructors
+        return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("bmi2");
+    }();
+    return available;
+#else // else AVX512_IMPL
+    return false;
+#endif // end else AVX512_IMPL
+}
+
+#ifdef AVX512_IMPL
+
+namespace {
+
+constexpr unsigned PIX_BLOCK = 16; // pixels per iteration : 16 x 32bit = 1 ZMM register
+
+template <unsigned N>
+constexpr uint64_t
+pixLeadBits()
+//
+// The bit of the first channel of each pixel inside the N channel x 16 pixels bit mask
+//
+{
+    uint64_t bits = 0x0;
+    for (unsigned i = 0; i < PIX_BLOCK; ++i) bits |= static_cast<uint64_t>(0x1) << (i * N);
+    return bits;
+}
+
+template <unsigned N>
+AVX512_TARGET inline uint32_t
+snapshotPixBlock(uint32_t* dstV,
+                 uint32_t* dstW,
+                 const uint32_t* srcV,
+                 const uint32_t* srcW,
+                 const uint32_t srcMask,   // pixels to be tested
+                 const uint32_t freshMask) // pixels which are updated regardless of the difference
+//
+// Snapshot 16 pixels (= 2 scanlines) of N channel value + weight (or numSample) data and returns
+// the 16 bit active pixel mask. A pixel is active when it is inside srcMask, the source weight
+// is not 0 and (some bit pattern of value/weight changed or it is inside freshMask). This is the
+// same as IMPL_FULLBITOP of the _SISD version.
+// 16 pixels x N channels are N ZMM registers. Each compare gives a 16 bit mask and the N masks are
+// reduced to the pixel mask by BMI2 pext. The pixel mask is expanded back by pdep for the masked
+// store of the channel values.
+//
+{
+    constexpr uint64_t leadBits = pixLeadBits<N>();
+
+    __m512i sV[N];
+    uint64_t chanDiff = 0x0; // N bits for each pixel
+    for (unsigned i = 0; i < N; ++i) {
+        sV[i] = _mm512_loadu_si512(srcV + i * PIX_BLOCK);
+        const __m512i dV = _mm512_loadu_si512(dstV + i * PIX_BLOCK);
+        chanDiff |= static_cast<uint64_t>(_mm512_cmpneq_epi32_mask(sV[i], dV)) << (i * PIX_BLOCK);
+    }
+    uint32_t pixDiff;
+    if constexpr (N == 1) {
+        pixDiff = static_cast<uint32_t>(chanDiff);
+    } else {
+        uint64_t anyChanDiff = chanDiff;
+        for (unsigned i = 1; i < N; ++i) anyChanDiff |= chanDiff >> i;
+        pixDiff = static_cast<uint32_t>(_pext_u64(anyChanDiff, leadBits));
+    }
+
+    const __m512i sW = _mm512_loadu_si512(srcW);
+    const __m512i dW = _mm512_loadu_si512(dstW);
+    const __mmask16 active =
+        (pixDiff | _mm512_cmpneq_epi32_mask(sW, dW) | freshMask) & _mm512_test_epi32_mask(sW, sW) & srcMask;
+    if (!active) return 0x0;
+
+    uint64_t chanActive = active;
+    if constexpr (N > 1) {
+        chanActive = _pdep_u64(active, leadBits) * ((static_cast<uint64_t>(0x1) << N) - 1);
+    }
+    for (unsigned i = 0; i < N; ++i) {
+        _mm512_mask_storeu_epi32(dstV + i * PIX_BLOCK,
+                                 static_cast<__mmask16>(chanActive >> (i * PIX_BLOCK)), sV[i]);
+    }
+    _mm512_mask_storeu_epi32(dstW, active, sW);
+    return active;
+}
+
+template <unsigned N>
+AVX512_TARGET inline uint64_t
+snapshotTileFloatNWeightAVX512(uint32_t* dstV,
+                               uint32_t* dstW,
+                               const uint32_t* srcV,
+                               const uint32_t* srcW)
+{
+    uint64_t activePixelMask = static_cast<uint64_t>(0x0);
+    for (unsigned offset = 0; offset < 64; offset += PIX_BLOCK) {
+        const uint64_t mask = snapshotPixBlock<N>(dstV + offset * N, dstW + offset,
+                                                  srcV + offset * N, srcW + offset,
+                                                  0xffff,  // srcMask : all pixels
+                                                  0x0);    // freshMask
+        activePixelMask |= mask << offset;
+    }
+    return activePixelMask;
+}
+
+template <unsigned N>
+AVX512_TARGET inline uint64_t
+snapshotTileFloatNNumSampleAVX512(uint32_t* dstV,
+                                  uint32_t* dstN,
+                                  const uint64_t dstTileMask,
+                                  const uint32_t* srcV,
+                                  const uint32_t* srcN,
+                                  const uint64_t srcTileMask)
+{
+    uint64_t activePixelMask = static_cast<uint64_t>(0x0);
+    for (unsigned offset = 0; offset < 64; offset += PIX_BLOCK) {
+        const uint32_t srcMask = static_cast<uint32_t>(srcTileMask >> offset) & 0xffff;
+        if (!srcMask) continue; // skip empty 2 scanlines
+        const uint32_t freshMask = ~static_cast<uint32_t>(dstTileMask >> offset) & 0xffff;
+        const uint64_t mask = snapshotPixBlock<N>(dstV + offset * N, dstN + offset,
+                                                  srcV + offset * N, srcN + offset,
+                                                  srcMask, freshMask);
+        activePixelMask |= mask << offset;
+    }
+    return activePixelMask;
+}
+
+AVX512_TARGET inline uint64_t
+snapshotTileUInt32WithMaskAVX512(uint32_t* dst,
+                                 const uint64_t dstTileMask,
+                                 const uint32_t* src,
+                                 const uint64_t srcTileMask)
+//
+// Same as snapshotPixBlock() but a single uint32 value works as both of value and weight.
+//
+{
+    uint64_t activePixelMask = static_cast<uint64_t>(0x0);
+    for (unsigned offset = 0; offset < 64; offset += PIX_BLOCK) {
+        const uint32_t srcMask = static_cast<uint32_t>(srcTileMask >> offset) & 0xffff;
+        if (!srcMask) continue; // skip empty 2 scanlines
+        const uint32_t freshMask = ~static_cast<uint32_t>(dstTileMask >> offset) & 0xffff;
+
+        const __m512i s = _mm512_loadu_si512(src + offset);
+        const __m512i d = _mm512_loadu_si512(dst + offset);
+        const __mmask16 active =
+            (_mm512_cmpneq_epi32_mask(s, d) | freshMask) & _mm512_test_epi32_mask(s, s) & srcMask;
+        _mm512_mask_storeu_epi32(dst + offset, active, s);
+        activePixelMask |= static_cast<uint64_t>(active) << offset;
+    }
+    return activePixelMask;
+}
+
+} // namespace
+
+#endif // end AVX512_IMPL
+
+#ifndef AVX512_IMPL
+#define AVX512_TARGET
+#endif // end AVX512_IMPL
+
+//
+// All the following _AVX512 functions fall back to _SISD if AVX512 code is not compiled.
+// They are never called by the APIs without suffix in this case.
+//
+
+// static function
+AVX512_TARGET uint64_t
+SnapshotUtil::snapshotTileFloatWeight_AVX512(uint32_t* dstV,
+                                             uint32_t* dstW,
+                                             const uint32_t* srcV,
+                                             const uint32_t* srcW)
+{
+#ifdef AVX512_IMPL
+    return snapshotTileFloatNWeightAVX512<1>(dstV, dstW, srcV, srcW);
+#else // else AVX512_IMPL
+    return snapshotTileFloatWeight_SISD(dstV, dstW, srcV, srcW);
+#endif // end else AVX512_IMPL
+}
+
+// static function
+AVX512_TARGET uint64_t
+SnapshotUtil::snapshotTileFloatNumSample_AVX512(uint32_t* dstV,
+                                                uint32_t* dstN,
+                                                const uint64_t dstTileMask,
+                                                const uint32_t* srcV,
+                                                const uint32_t* srcN,
+                                                const uint64_t srcTileMask)
+{
+#ifdef AVX512_IMPL
+    return snapshotTileFloatNNumSampleAVX512<1>(dstV, dstN, dstTileMask, srcV, srcN, srcTileMask);
+#else // else AVX512_IMPL
+    return snapshotTileFloatNumSample_SISD(dstV, dstN, dstTileMask, srcV, srcN, srcTileMask);
+#endif // end else AVX512_IMPL
+}
+
+// static function
+AVX512_TARGET uint64_t
+SnapshotUtil::snapshotTileFloat2Weight_AVX512(uint32_t* dstV,
+                                              uint32_t* dstW,
+                                              const uint32_t* srcV,
+                                              const uint32_t* srcW)
+{
+#ifdef AVX512_IMPL
+    return snapshotTileFloatNWeightAVX512<2>(dstV, dstW, srcV, srcW);
+#else // else AVX512_IMPL
+    return snapshotTileFloat2Weight_SISD(dstV, dstW, srcV, srcW);
+#endif // end else AVX512_IMPL
+}
+
+// static function
+AVX512_TARGET uint64_t
+SnapshotUtil::snapshotTileFloat2NumSample_AVX512(uint32_t* dstV,
+                                                 uint32_t* dstN,
+                                                 const uint64_t dstTileMask,
+                                                 const uint32_t* srcV,
+                                                 const uint32_t* srcN,
+                                                 const uint64_t srcTileMask)
+{
+#ifdef AVX512_IMPL
+    return snapshotTileFloatNNumSampleAVX512<2>(dstV, dstN, dstTileMask, srcV, srcN, srcTileMask);
+#else // else AVX512_IMPL
+    return snapshotTileFloat2NumSample_SISD(dstV, dstN, dstTileMask, srcV, srcN, srcTileMask);
+#endif // end else AVX512_IMPL
+}
+
+// static function
+AVX512_TARGET uint64_t
+SnapshotUtil::snapshotTileFloat3Weight_AVX512(uint32_t* dstV,
+                                              uint32_t* dstW,
+                                              const uint32_t* srcV,
+                                              const uint32_t* srcW)
+{
+#ifdef AVX512_IMPL
+    return snapshotTileFloatNWeightAVX512<3>(dstV, dstW, srcV, srcW);
+#else // else AVX512_IMPL
+    return snapshotTileFloat3Weight_SISD(dstV, dstW, srcV, srcW);
+#endif // end else AVX512_IMPL
+}
+
+// static function
+AVX512_TARGET uint64_t
+SnapshotUtil::snapshotTileFloat3NumSample_AVX512(uint32_t* dstV,
+                                                 uint32_t* dstN,
+                                                 const uint64_t dstTileMask,
+                                                 const uint32_t* srcV,
+                                                 const uint32_t* srcN,
+                                                 const uint64_t srcTileMask)
+{
+#ifdef AVX512_IMPL
+    return snapshotTileFloatNNumSampleAVX512<3>(dstV, dstN, dstTileMask, srcV, srcN, srcTileMask);
+#else // else AVX512_IMPL
+    return snapshotTileFloat3NumSample_SISD(dstV, dstN, dstTileMask, srcV, srcN, srcTileMask);
+#endif // end else AVX512_IMPL
+}
+
+// static function
+AVX512_TARGET uint64_t
+SnapshotUtil::snapshotTileFloat4Weight_AVX512(uint32_t* dstV,
+                                              uint32_t* dstW,
+                                              const uint32_t* srcV,
+                                              const uint32_t* srcW)
+{
+#ifdef AVX512_IMPL
+    return snapshotTileFloatNWeightAVX512<4>(dstV, dstW, srcV, srcW);
+#else // else AVX512_IMPL
+    return snapshotTileFloat4Weight_SISD(dstV, dstW, srcV, srcW);
+#endif // end else AVX512_IMPL
+}
+
+// static function
+AVX512_TARGET uint64_t
+SnapshotUtil::snapshotTileFloat4NumSample_AVX512(uint32_t* dstV,
+                                                 uint32_t* dstN,
+                                                 const uint64_t dstTileMask,
+                                                 const uint32_t* srcV,
+                                                 const uint32_t* srcN,
+                                                 const uint64_t srcTileMask)
+{
+#ifdef AVX512_IMPL
+    return snapshotTileFloatNNumSampleAVX512<4>(dstV, dstN, dstTileMask, srcV, srcN, srcTileMask);
+#else // else AVX512_IMPL
+    return snapshotTileFloat4NumSample_SISD(dstV, dstN, dstTileMask, srcV, srcN, srcTileMask);
+#endif // end else AVX512_IMPL
+}
+
+// static function
+AVX512_TARGET uint64_t
+SnapshotUtil::snapshotTileUInt32WithMask_AVX512(uint32_t* dst,
+                                                const uint64_t dstTileMask,
+                                                const uint32_t* src,
+                                                const uint64_t srcTileMask)
+{
+#ifdef AVX512_IMPL
+    return snapshotTileUInt32WithMaskAVX512(dst, dstTileMask, src, srcTileMask);
+#else // else AVX512_IMPL
+    return snapshotTileUInt32WithMask_SISD(dst, dstTileMask, src, srcTileMask);
+#endif // end else AVX512_IMPL
+}
+
+//------------------------------------------------------------------------------
+
 // static function
 std::string
 SnapshotUtil::showMask(const uint64_t mask64)
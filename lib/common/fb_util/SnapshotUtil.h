@@ -10,6 +10,10 @@
 // Some of them has hand coded intrinsic version of SIMD code.
 // We should try to make ISPC version to speed up near future.
 //
+// Functions have up to 3 implementations. _SISD is C++, _SIMD is ISPC and _AVX512 is hand coded
+// AVX512 intrinsics code. The API without suffix picks _AVX512 if isAVX512Available() is true
+// at runtime, otherwise uses the compile time choice (See SnapshotUtil.cc).
+//
 
 #include <stdint.h>             // uint32_t
 #include <string>
@@ -20,6 +24,9 @@ namespace fb_util {
 class SnapshotUtil
 {
 public:
+    // true if the CPU (and OS) supports the AVX512F and BMI2 instructions which _AVX512 functions use.
+    // _AVX512 functions must not be called when this is false.
+    static bool isAVX512Available();
 
     //------------------------------
     //
@@ -125,6 +132,12 @@ public:
                                                   const uint64_t srcTileMask) { // src tileMask  (m) = 8byte (64bit)
         return snapshotTileUInt32WithMask_SIMD(dst, dstTileMask, src, srcTileMask);
     }
+    static uint64_t snapshotTileWeightBuffer_AVX512(uint32_t *dst,                // weight buffer (v) = 4byte * 8 * 8
+                                                    const uint64_t dstTileMask,   // dst tileMask  (m) = 8byte (64bit)
+                                                    const uint32_t *src,          // weight buff   (v) = 4byte * 8 * 8
+                                                    const uint64_t srcTileMask) { // src tileMask  (m) = 8byte (64bit)
+        return snapshotTileUInt32WithMask_AVX512(dst, dstTileMask, src, srcTileMask);
+    }
 
     //------------------------------
     //
@@ -144,6 +157,10 @@ public:
                                                  uint32_t *dstW,        // weight buffer (w) = 4byte * 8 * 8
                                                  const uint32_t *srcV,  // float  buffer (x) = 4byte * 8 * 8
                                                  const uint32_t *srcW); // weight buffer (w) = 4byte * 8 * 8
+    static uint64_t snapshotTileFloatWeight_AVX512(uint32_t *dstV,        // float  buffer (x) = 4byte * 8 * 8
+                                                   uint32_t *dstW,        // weight buffer (w) = 4byte * 8 * 8
+                                                   const uint32_t *srcV,  // float  buffer (x) = 4byte * 8 * 8
+                                                   const uint32_t *srcW); // weight buffer (w) = 4byte * 8 * 8
 
     // make snapshot for float + numSample 
     // update destination buffer and return active pixel mask for this tile
@@ -165,6 +182,12 @@ public:
                                                     const uint32_t *srcV,        // float  buffer (x) = 4byte * 8 * 8
                                                     const uint32_t *srcN,        // numSample     (n) = 4byte * 8 * 8
                                                     const uint64_t srcTileMask); // src tileMask  (m) = 8byte (64bit)
+    static uint64_t snapshotTileFloatNumSample_AVX512(uint32_t *dstV,              // float  buffer (x) = 4byte * 8 * 8
+                                                      uint32_t *dstN,              // numSample     (n) = 4byte * 8 * 8
+                                                      const uint64_t dstTileMask,  // dst tileMask  (m) = 8byte (64bit)
+                                                      const uint32_t *srcV,        // float  buffer (x) = 4byte * 8 * 8
+                                                      const uint32_t *srcN,        // numSample     (n) = 4byte * 8 * 8
+                                                      const uint64_t srcTileMask); // src tileMask  (m) = 8byte (64bit)
 
     //------------------------------
 
@@ -182,6 +205,10 @@ public:
                                                   uint32_t *dstW,        // weight buffer (w)   = 4byte * 8 * 8
                                                   const uint32_t *srcV,  // float2 buffer (x,y) = 8byte * 8 * 8
                                                   const uint32_t *srcW); // weight buffer (w)   = 4byte * 8 * 8
+    static uint64_t snapshotTileFloat2Weight_AVX512(uint32_t *dstV,        // float2 buffer (x,y) = 8byte * 8 * 8
+                                                    uint32_t *dstW,        // weight buffer (w)   = 4byte * 8 * 8
+                                                    const uint32_t *srcV,  // float2 buffer (x,y) = 8byte * 8 * 8
+                                                    const uint32_t *srcW); // weight buffer (w)   = 4byte * 8 * 8
 
     // make snapshot for float2 + numSample 
     // update destination buffer and return active pixel mask for this tile
@@ -203,6 +230,12 @@ public:
                                                      const uint32_t *srcV,        // float2 buffer (x,y) = 8byte * 8 * 8
                                                      const uint32_t *srcN,        // numSample     (n)   = 4byte * 8 * 8
                                                      const uint64_t srcTileMask); // src tileMask  (m)   = 8byte (64bit)
+    static uint64_t snapshotTileFloat2NumSample_AVX512(uint32_t *dstV,              // float2 buffer (x,y) = 8byte * 8 * 8
+                                                       uint32_t *dstN,              // numSample     (n)   = 4byte * 8 * 8
+                                                       const uint64_t dstTileMask,  // dst tileMask  (m)   = 8byte (64bit)
+                                                       const uint32_t *srcV,        // float2 buffer (x,y) = 8byte * 8 * 8
+                                                       const uint32_t *srcN,        // numSample     (n)   = 4byte * 8 * 8
+                                                       const uint64_t srcTileMask); // src tileMask  (m)   = 8byte (64bit)
 
     //------------------------------
 
@@ -220,6 +253,10 @@ public:
                                                   uint32_t *dstW,        // weight buffer (w)     =  4byte * 8 * 8
                                                   const uint32_t *srcV,  // float3 buffer (x,y,z) = 12byte * 8 * 8
                                                   const uint32_t *srcW); // weight buffer (w)     =  4byte * 8 * 8
+    static uint64_t snapshotTileFloat3Weight_AVX512(uint32_t *dstV,        // float3 buffer (x,y,z) = 12byte * 8 * 8
+                                                    uint32_t *dstW,        // weight buffer (w)     =  4byte * 8 * 8
+                                                    const uint32_t *srcV,  // float3 buffer (x,y,z) = 12byte * 8 * 8
+                                                    const uint32_t *srcW); // weight buffer (w)     =  4byte * 8 * 8
 
     // make snapshot for float3 + numSample 
     // update destination buffer and return active pixel mask for this tile
@@ -241,6 +278,12 @@ public:
                                                      const uint32_t *srcV,        // float3 buffer (x,y,z) = 12byte * 8 * 8
                                                      const uint32_t *srcN,        // numSample     (n)     =  4byte * 8 * 8
                                                      const uint64_t srcTileMask); // src tileMask  (m)     =  8byte (64bit)
+    static uint64_t snapshotTileFloat3NumSample_AVX512(uint32_t *dstV,              // float3 buffer (x,y,z) = 12byte * 8 * 8
+                                                       uint32_t *dstN,              // numSample     (n)     =  4byte * 8 * 8
+                                                       const uint64_t dstTileMask,  // dst tileMask  (m)     =  8byte (64bit)
+                                                       const uint32_t *srcV,        // float3 buffer (x,y,z) = 12byte * 8 * 8
+                                                       const uint32_t *srcN,        // numSample     (n)     =  4byte * 8 * 8
+                                                       const uint64_t srcTileMask); // src tileMask  (m)     =  8byte (64bit)
 
     //------------------------------
 
@@ -258,6 +301,10 @@ public:
                                                   uint32_t *dstW,        // weight buffer (w)       =  4byte * 8 * 8
                                                   const uint32_t *srcV,  // float4 buffer (x,y,z,a) = 16byte * 8 * 8
                                                   const uint32_t *srcW); // weight buffer (w)       =  4byte * 8 * 8
+    static uint64_t snapshotTileFloat4Weight_AVX512(uint32_t *dstV,        // float4 buffer (x,y,z,a) = 16byte * 8 * 8
+                                                    uint32_t *dstW,        // weight buffer (w)       =  4byte * 8 * 8
+                                                    const uint32_t *srcV,  // float4 buffer (x,y,z,a) = 16byte * 8 * 8
+                                                    const uint32_t *srcW); // weight buffer (w)       =  4byte * 8 * 8
 
     // make snapshot for float4 + numSample 
     // update destination buffer and return active pixel mask for this tile
@@ -279,6 +326,12 @@ public:
                                                      const uint32_t *srcV,        // float3 buffer (x,y,z,a) = 16byte * 8 * 8
                                                      const uint32_t *srcN,        // numSample     (n)       =  4byte * 8 * 8
                                                      const uint64_t srcTileMask); // src tileMask  (m)       =  8byte (64bit)
+    static uint64_t snapshotTileFloat4NumSample_AVX512(uint32_t *dstV,              // float4 buffer (x,y,z,a) = 16byte * 8 * 8
+                                                       uint32_t *dstN,              // numSample     (n)       =  4byte * 8 * 8
+                                                       const uint64_t dstTileMask,  // dst tileMask  (m)       =  8byte (64bit)
+                                                       const uint32_t *srcV,        // float3 buffer (x,y,z,a) = 16byte * 8 * 8
+                                                       const uint32_t *srcN,        // numSample     (n)       =  4byte * 8 * 8
+                                                       const uint64_t srcTileMask); // src tileMask  (m)       =  8byte (64bit)
 
 protected:
     static uint64_t snapshotTileUInt32WithMask(uint32_t *dst,               // uint32 buff  (v) = 4byte * 8 * 8
@@ -293,6 +346,10 @@ protected:
                                                     const uint64_t dstTileMask,  // dst tileMask (m) = 8byte (64bit)
                                                     const uint32_t *src,         // uint32 buff  (v) = 4byte * 8 * 8
                                                     const uint64_t srcTileMask); // src tileMask (m) = 8byte (64bit)
+    static uint64_t snapshotTileUInt32WithMask_AVX512(uint32_t *dst,               // uint32 buff  (v) = 4byte * 8 * 8
+                                                      const uint64_t dstTileMask,  // dst tileMask (m) = 8byte (64bit)
+                                                      const uint32_t *src,         // uint32 buff  (v) = 4byte * 8 * 8
+                                                      const uint64_t srcTileMask); // src tileMask (m) = 8byte (64bit)
 
     static std::string showMask(const uint64_t mask64);
 }; // SnapshotUtil
@@ -10,6 +10,7 @@
 
 #include <iomanip>
 #include <sstream>
+#include <vector>
 
 
 namespace scene_rdl2 {
@@ -93,17 +94,19 @@ ActiveBitTables::finalize()
 void
 ActiveBitTables::enqFullDump(VContainerEnq &vContainerEnq)
 {
+    std::vector<unsigned> tileIds;
     crawlActiveTblItem([&](unsigned tileId) {
-            vContainerEnq.enqVLUInt(tileId);
+            tileIds.push_back(tileId);
         });
+    vContainerEnq.enqVLUIntArray(tileIds.data(), tileIds.size());
 }
 
 void
 ActiveBitTables::deqFullDump(VContainerDeq &vContainerDeq, const unsigned activeTileTotal)
 {
-    for (unsigned i = 0; i < activeTileTotal; ++i) {
-        unsigned tileId;
-        vContainerDeq.deqVLUInt(tileId);
+    std::vector<unsigned> tileIds(activeTileTotal);
+    vContainerDeq.deqVLUIntArray(tileIds.data(), activeTileTotal);
+    for (unsigned tileId : tileIds) {
         setOn(tileId);
     }
 }
@@ -111,6 +114,7 @@ ActiveBitTables::deqFullDump(VContainerDeq &vContainerDeq, const unsigned active
 void
 ActiveBitTables::enqFullDeltaDump(VContainerEnq &vContainerEnq)
 {
+    std::vector<unsigned> deltaIds;
     unsigned prevItemId = std::numeric_limits<unsigned>::max();
     crawlActiveTblItem([&](unsigned tileId) {
             unsigned deltaId;
@@ -119,23 +123,25 @@ ActiveBitTables::enqFullDeltaDump(VContainerEnq &vContainerEnq)
             } else {
                 deltaId = tileId - prevItemId;
             }
-            vContainerEnq.enqVLUInt(deltaId);
+            deltaIds.push_back(deltaId);
             prevItemId = tileId;
         });
+    vContainerEnq.enqVLUIntArray(deltaIds.data(), deltaIds.size());
 }
 
 void
 ActiveBitTables::deqFullDeltaDump(VContainerDeq &vContainerDeq, const unsigned activeTileTotal)
 {
+    std::vector<unsigned> deltaIds(activeTileTotal);
+    vContainerDeq.deqVLUIntArray(deltaIds.data(), activeTileTotal);
+
     unsigned prevId = 0;
     for (unsigned i = 0; i < activeTileTotal; ++i) {
-        unsigned deltaId, tileId;
-        vContainerDeq.deqVLUInt(deltaId);
-
+        unsigned tileId;
         if (i == 0) {
-            tileId = deltaId;
+            tileId = deltaIds[i];
         } else {
-            tileId = prevId + deltaId;
+            tileId = prevId + deltaIds[i];
         }
         setOn(tileId);
 
@@ -0,0 +1,186 @@
+// Copyright 2023-2024 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+#include "Crc32cUtil.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+
+#if defined(__SSE4_2__)
+#include <nmmintrin.h>
+#elif defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#endif
+
+namespace scene_rdl2 {
+namespace grid_util {
+
+namespace {
+
+constexpr unsigned LANE_TOTAL = 4;
+
+#if defined(__SSE4_2__)
+
+inline uint32_t crc32cU64(const uint32_t crc, const uint64_t v) { return static_cast<uint32_t>(_mm_crc32_u64(crc, v)); }
+inline uint32_t crc32cU8(const uint32_t crc, const uint8_t v) { return _mm_crc32_u8(crc, v); }
+
+#elif defined(__ARM_FEATURE_CRC32)
+
+inline uint32_t crc32cU64(const uint32_t crc, const uint64_t v) { return __crc32cd(crc, v); }
+inline uint32_t crc32cU8(const uint32_t crc, const uint8_t v) { return __crc32cb(crc, v); }
+
+#else // software fallback
+
+struct Crc32cTable
+{
+    Crc32cTable()
+    {
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) {
+                c = (c & 1) ? ((c >> 1) ^ 0x82f63b78) : (c >> 1); // reflected Castagnoli polynomial
+            }
+            mTbl[i] = c;
+        }
+    }
+    uint32_t mTbl[256];
+};
+
+inline uint32_t
+crc32cU8(const uint32_t crc, const uint8_t v)
+{
+    static const Crc32cTable table;
+    return table.mTbl[(crc ^ v) & 0xff] ^ (crc >> 8);
+}
+
+inline uint32_t
+crc32cU64(uint32_t crc, uint64_t v)
+{
+    for (int i = 0; i < 8; ++i) {
+        crc = crc32cU8(crc, static_cast<uint8_t>(v));
+        v >>= 8;
+    }
+    return crc;
+}
+
+#endif
+
+inline uint64_t
+loadU64(const unsigned char *ptr)
+{
+    uint64_t v;
+    std::memcpy(&v, ptr, sizeof(v)); // might be unaligned
+    return v;
+}
+
+inline const unsigned char *
+crc32cBlocks(uint32_t lane[LANE_TOTAL], const unsigned char *ptr, const unsigned char *const end)
+//
+// Processes all the 32 byte blocks and returns the start of the rest (less than 32 bytes)
+//
+{
+    while (end - ptr >= static_cast<std::ptrdiff_t>(LANE_TOTAL * sizeof(uint64_t))) {
+        lane[0] = crc32cU64(lane[0], loadU64(ptr));
+        lane[1] = crc32cU64(lane[1], loadU64(ptr + 8));
+        lane[2] = crc32cU64(lane[2], loadU64(ptr + 16));
+        lane[3] = crc32cU64(lane[3], loadU64(ptr + 24));
+        ptr += LANE_TOTAL * sizeof(uint64_t);
+    }
+    return ptr;
+}
+
+inline Crc32cUtil::Hash
+crc32cFinalize(uint32_t lane[LANE_TOTAL],
+               const unsigned char *ptr, const unsigned char *const end, // tail : less than 32 bytes
+               const size_t totalSize)
+{
+    // The tail goes to lane0
+    for (; end - ptr >= static_cast<std::ptrdiff_t>(sizeof(uint64_t)); ptr += sizeof(uint64_t)) {
+        lane[0] = crc32cU64(lane[0], loadU64(ptr));
+    }
+    for (; ptr < end; ++ptr) {
+        lane[0] = crc32cU8(lane[0], *ptr);
+    }
+
+    // Mixing the size makes the lane split position part of the hash. Otherwise, data which only
+    // differ by trailing bytes sometimes produce the same value.
+    Crc32cUtil::Hash hash;
+    for (unsigned laneId = 0; laneId < LANE_TOTAL; ++laneId) {
+        const uint32_t v = ~crc32cU64(lane[laneId], static_cast<uint64_t>(totalSize) + laneId);
+        hash[laneId * 4    ] = static_cast<unsigned char>(v);
+        hash[laneId * 4 + 1] = static_cast<unsigned char>(v >> 8);
+        hash[laneId * 4 + 2] = static_cast<unsigned char>(v >> 16);
+        hash[laneId * 4 + 3] = static_cast<unsigned char>(v >> 24);
+    }
+    return hash;
+}
+
+} // namespace
+
+// static function
+Crc32cUtil::Hash
+Crc32cUtil::hash(const void *inAddr, const size_t inSize)
+{
+    const unsigned char *ptr = static_cast<const unsigned char *>(inAddr);
+    const unsigned char *const end = ptr + inSize;
+
+    uint32_t lane[LANE_TOTAL] = {~0u, ~0u, ~0u, ~0u};
+    ptr = crc32cBlocks(lane, ptr, end);
+    return crc32cFinalize(lane, ptr, end, inSize);
+}
+
+// static function
+std::string
+Crc32cUtil::show(const Hash hash)
+{
+    std::ostringstream ostr;
+    for (size_t i = 0; i < HASH_SIZE; ++i) {
+        if (i > 0 && (i % 4) == 0) ostr << '-';
+        ostr << std::setw(2) << std::hex << std::setfill('0') << (int)hash[i] << std::dec;
+    }
+    return ostr.str();
+}
+
+//------------------------------------------------------------------------------------------
+
+void
+Crc32cGen::init()
+{
+    for (unsigned laneId = 0; laneId < LANE_TOTAL; ++laneId) mLane[laneId] = ~0u;
+    mCarrySize = 0;
+    mTotalSize = 0;
+}
+
+void
+Crc32cGen::updateByteData(const void *data, const size_t dataSize)
+{
+    const unsigned char *ptr = static_cast<const unsigned char *>(data);
+    const unsigned char *const end = ptr + dataSize;
+    mTotalSize += dataSize;
+
+    if (mCarrySize) {
+        // complete the 32 byte block which is carried over from the previous update
+        const size_t size = std::min(BLOCK_SIZE - mCarrySize, dataSize);
+        std::memcpy(mCarry + mCarrySize, ptr, size);
+        mCarrySize += size;
+        ptr += size;
+        if (mCarrySize < BLOCK_SIZE) return;
+        crc32cBlocks(mLane, mCarry, mCarry + BLOCK_SIZE);
+        mCarrySize = 0;
+    }
+
+    ptr = crc32cBlocks(mLane, ptr, end);
+    mCarrySize = static_cast<size_t>(end - ptr);
+    std::memcpy(mCarry, ptr, mCarrySize);
+}
+
+Crc32cGen::Hash
+Crc32cGen::finalize()
+{
+    return crc32cFinalize(mLane, mCarry, mCarry + mCarrySize, mTotalSize);
+}
+
+} // namespace grid_util
+} // namespace scene_rdl2
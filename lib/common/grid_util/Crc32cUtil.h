@@ -0,0 +1,70 @@
+// Copyright 2023-2024 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace scene_rdl2 {
+namespace grid_util {
+
+class Crc32cUtil
+//
+// This class generates a 128bit hash of specifying data by 4 interleaved CRC32C (Castagnoli) lanes.
+// The data is split into 8byte words and each word goes to the lanes in round-robin order. The lanes
+// have no dependency on each other, so the CPU overlaps the latency of the crc32 instructions.
+// The result is the 4 lane values (little endian) after the total data size is mixed into each lane.
+//
+// This is designed for data corruption detection and is much faster than SHA1. It is not a
+// cryptographic hash. Uses SSE4.2 or ARMv8 CRC32 instructions if available, otherwise table lookup.
+//
+{
+public:
+    static constexpr unsigned HASH_SIZE = 16;
+    using Hash = std::array<unsigned char, HASH_SIZE>;
+
+    static Hash hash(const void *inAddr, const size_t inSize);
+    static Hash hash(const std::string &in) { return hash(in.data(), in.size()); }
+
+    static std::string show(const Hash hash);
+};
+
+class Crc32cGen
+//
+// Crc32cGen generates exactly the same hash as Crc32cUtil::hash() of the concatenated data by
+// incrementally updating information. This is used for data which is split into several memory
+// blocks. Only the last partial 32 byte block is copied internally.
+//
+// Usage example
+//
+//   Crc32cGen crc;
+//   crc.updateByteData(addrA, sizeA);
+//   crc.updateByteData(addrB, sizeB);
+//   Crc32cGen::Hash hash = crc.finalize(); // same as Crc32cUtil::hash() of A + B
+//   crc.init(); // start new hash computation
+//
+{
+public:
+    using Hash = Crc32cUtil::Hash;
+    static constexpr unsigned HASH_SIZE = Crc32cUtil::HASH_SIZE;
+
+    Crc32cGen() { init(); }
+
+    void init(); // start new hash computation
+    void updateByteData(const void *data, const size_t dataSize);
+    Hash finalize();
+
+private:
+    static constexpr unsigned LANE_TOTAL = 4;
+    static constexpr size_t BLOCK_SIZE = LANE_TOTAL * sizeof(uint64_t);
+
+    uint32_t mLane[LANE_TOTAL];
+    unsigned char mCarry[BLOCK_SIZE]; // partial block which is waiting for the following data
+    size_t mCarrySize;
+    size_t mTotalSize;
+};
+
+} // namespace grid_util
+} // namespace scene_rdl2
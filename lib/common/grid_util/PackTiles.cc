@@ -17,8 +17,18 @@
 #include <scene_rdl2/scene/rdl2/ValueContainerDeq.h>
 #include <scene_rdl2/scene/rdl2/ValueContainerEnq.h>
 
+#include "Crc32cUtil.h"
+#include "RansCodec.h"
+#include "Sha1Util.h"
+
+#include <scene_rdl2/scene/rdl2/ValueContainerUtil.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
 #include <iomanip>
 #include <openssl/sha.h>
+#include <tbb/parallel_for.h>
 
 //
 // DEBUG_MODE directive activates debug message.
@@ -61,6 +71,10 @@
 #endif // end !__INTEL_COMPILER
 #endif 
 
+#if defined(__SSE2__)
+#include <emmintrin.h>          // _mm_unpacklo_epi8 : VER3 byte plane transpose
+#endif
+
 //#define DEBUG_MSG_SIZEDUMP
 
 // Low precision encoding related directive. 
@@ -103,9 +117,10 @@ public:
     using VContainerDeq = rdl2::ValueContainerDeq;
     using VContainerEnq = rdl2::ValueContainerEnq;
 
-    static constexpr unsigned HASH_SIZE = 20; // SHA1 hash size : byte
+    static constexpr unsigned HASH_SIZE = 20; // hash region size : byte
 
     using EnqFormatVer = PackTiles::EnqFormatVer;
+    using HashType = PackTiles::HashType;
     using PrecisionMode = PackTiles::PrecisionMode;
     using DataType = PackTiles::DataType;
 
@@ -119,13 +134,15 @@ public:
     encode(const ActivePixels &activePixels,      // should be constructed by original w, h
            const RenderBuffer &renderBufferTiled, // tile aligned resolution : non normalized color
            const FloatBuffer &weightBufferTiled,  // tile aligned resolution
-           std::string &output,
+           PackTilesBuffer &output,
            const PrecisionMode precisionMode, // precision which is used in this encoding operation
            const CoarsePassPrecision coarsePassPrecision, // minimum coarse pass precision
            const FinePassPrecision finePassPrecision,     // minimum fine pass precision
            const bool noNumSampleMode,
-           const bool withSha1Hash = false,
-           const EnqFormatVer enqFormatVer = EnqFormatVer::VER2);
+           const bool withHash = false,
+           const EnqFormatVer enqFormatVer = EnqFormatVer::VER2,
+           const HashType hashType = HashType::CRC32C,
+           const unsigned bandTotal = 1);
 
     // for McrtMergeComputation
     // RGBA : float * 4
@@ -133,12 +150,14 @@ public:
     static size_t
     encode(const ActivePixels &activePixels,      // should be constructed by original w, h
            const RenderBuffer &renderBufferTiled, // tile aligned reso : normalized color
-           std::string &output,
+           PackTilesBuffer &output,
            const PrecisionMode precisionMode, // precision which is used in this encoding operation
            const CoarsePassPrecision coarsePassPrecision, // minimum coarse pass precision
            const FinePassPrecision finePassPrecision,     // minimum fine pass precision
-           const bool withSha1Hash = false,
-           const EnqFormatVer enqFormatVer = EnqFormatVer::VER2);
+           const bool withHash = false,
+           const EnqFormatVer enqFormatVer = EnqFormatVer::VER2,
+           const HashType hashType = HashType::CRC32C,
+           const unsigned bandTotal = 1);
 
     // for McrtMergeComputation : for feedback logic between merge and mcrt computation
     // RGBA + numSample : float * 4 + u_int
@@ -147,12 +166,14 @@ public:
     encode(const ActivePixels& activePixels,      // should be constructed by original w, h
            const RenderBuffer& renderBufferTiled, // tile aligned resolution : normalized color
            const NumSampleBuffer& numSampleBufferTiled, // numSample data for renderBuffer
-           std::string &output,
+           PackTilesBuffer &output,
            const PrecisionMode precisionMode, // precision which is used in this encoding operation
            const CoarsePassPrecision coarsePassPrecision, // minimum coarse pass precision
            const FinePassPrecision finePassPrecision,     // minimum fine pass precision
-           const bool withSha1Hash = false,
-           const EnqFormatVer enqFormatVer = EnqFormatVer::VER2);
+           const bool withHash = false,
+           const EnqFormatVer enqFormatVer = EnqFormatVer::VER2,
+           const HashType hashType = HashType::CRC32C,
+           const unsigned bandTotal = 1);
 
     // RGBA + numSample : float * 4 + u_int
     template <bool renderBufferOdd>
@@ -190,12 +211,14 @@ public:
     static size_t
     encodePixelInfo(const ActivePixels &activePixels,
                     const PixelInfoBuffer &pixelInfoBufferTiled,
-                    std::string &output,
+                    PackTilesBuffer &output,
                     const PrecisionMode precisionMode, // precision which is used in this encoding operation
                     const CoarsePassPrecision coarsePassPrecision, // minimum coarse pass precision
                     const FinePassPrecision finePassPrecision,     // minimum fine pass precision
-                    const bool withSha1Hash = false,
-                    const EnqFormatVer enqFormatVer = EnqFormatVer::VER2);
+                    const bool withHash = false,
+                    const EnqFormatVer enqFormatVer = EnqFormatVer::VER2,
+                    const HashType hashType = HashType::CRC32C,
+                    const unsigned bandTotal = 1);
 
     static bool
     decodePixelInfo(const void* addr,                         // in
@@ -219,19 +242,23 @@ public:
     encodeHeatMap(const ActivePixels &activePixels,
                   const FloatBuffer &heatMapSecBufferTiled, // non normalize sec
                   const FloatBuffer &heatMapWeightBufferTiled,
-                  std::string &output,
+                  PackTilesBuffer &output,
                   const bool noNumSampleMode,
-                  const bool withSha1Hash = false,
-                  const EnqFormatVer enqFormatVer = EnqFormatVer::VER2);
+                  const bool withHash = false,
+                  const EnqFormatVer enqFormatVer = EnqFormatVer::VER2,
+                  const HashType hashType = HashType::CRC32C,
+                  const unsigned bandTotal = 1);
 
     // Sec : float * 1
     // no precision related argument because heatMap always uses H16
     static size_t
     encodeHeatMap(const ActivePixels &activePixels,
                   const FloatBuffer &heatMapSecBufferTiled, // normalize sec
-                  std::string &output,
-                  const bool withSha1Hash = false,
-                  const EnqFormatVer enqFormatVer = EnqFormatVer::VER2);
+                  PackTilesBuffer &output,
+                  const bool withHash = false,
+                  const EnqFormatVer enqFormatVer = EnqFormatVer::VER2,
+                  const HashType hashType = HashType::CRC32C,
+                  const unsigned bandTotal = 1);
 
     // Sec + numSample : float * 1 + u_int
     // no precision related argument because heatMap always uses H16
@@ -265,12 +292,14 @@ public:
     static size_t
     encodeWeightBuffer(const ActivePixels &activePixels,
                        const FloatBuffer &weightBufferTiled,
-                       std::string &output,
+                       PackTilesBuffer &output,
                        const PrecisionMode precisionMode, // precision which is used in this encode operation
                        const CoarsePassPrecision coarsePassPrecision, // minimum coarse pass precision
                        const FinePassPrecision finePassPrecision,     // minimum fine pass precision
-                       const bool withSha1Hash = false,
-                       const EnqFormatVer enqFormatVer = EnqFormatVer::VER2);
+                       const bool withHash = false,
+                       const EnqFormatVer enqFormatVer = EnqFormatVer::VER2,
+                       const HashType hashType = HashType::CRC32C,
+                       const unsigned bandTotal = 1);
 
     static bool
     decodeWeightBuffer(const void* addr,               // in
@@ -297,7 +326,7 @@ public:
                        const VariablePixelBuffer &renderOutputBufferTiled, // non normalized value
                        const float renderOutputBufferDefaultValue,
                        const FloatBuffer &renderOutputWeightBufferTiled,
-                       std::string &output,
+                       PackTilesBuffer &output,
                        const PrecisionMode precisionMode, // precision which is used in this encode operation
                        const bool noNumSampleMode,
                        const bool doNormalizeMode,
@@ -305,21 +334,25 @@ public:
                        const unsigned closestFilterAovOriginalNumChan,
                        const CoarsePassPrecision coarsePassPrecision, // minimum coarse pass precision
                        const FinePassPrecision finePassPrecision,     // minimum fine pass precision
-                       const bool withSha1Hash = false,
-                       const EnqFormatVer enqFormatVer = EnqFormatVer::VER2);
+                       const bool withHash = false,
+                       const EnqFormatVer enqFormatVer = EnqFormatVer::VER2,
+                       const HashType hashType = HashType::CRC32C,
+                       const unsigned bandTotal = 1);
     // for mcrt_dataio::MergeFbSender (progmcrtmerge)
     // VariableValue(float1|float2|float3|float4)
     static size_t
     encodeRenderOutputMerge(const ActivePixels &activePixels,
                             const VariablePixelBuffer &renderOutputBufferTiled, // normalized value
                             const float renderOutputBufferDefaultValue,
-                            std::string &output,
+                            PackTilesBuffer &output,
                             const PrecisionMode precisionMode, // precision which is used in this encode func
                             const bool closestFilterStatus,
                             const CoarsePassPrecision coarsePassPrecision, // minimum coarse pass precision
                             const FinePassPrecision finePassPrecision,     // minimum fine pass precision
-                            const bool withSha1Hash = false,
-                            const EnqFormatVer enqFormatVer = EnqFormatVer::VER2);
+                            const bool withHash = false,
+                            const EnqFormatVer enqFormatVer = EnqFormatVer::VER2,
+                            const HashType hashType = HashType::CRC32C,
+                            const unsigned bandTotal = 1);
 
     // VariableValue(float1|float2|float3|float4) + numSample : float * (1|2|3) + u_int
     // or
@@ -340,9 +373,10 @@ public:
     //
     static size_t
     encodeRenderOutputReference(const FbReferenceType &referenceType,
-                                std::string &output,
-                                const bool withSha1Hash = false,
-                                const EnqFormatVer enqFormatVer = EnqFormatVer::VER2);
+                                PackTilesBuffer &output,
+                                const bool withHash = false,
+                                const EnqFormatVer enqFormatVer = EnqFormatVer::VER2,
+                                const HashType hashType = HashType::CRC32C);
     static bool
     decodeRenderOutputReference(const void *addr,      // in
                                 const size_t dataSize, // in
@@ -403,6 +437,8 @@ private:
 
     finline static void
     enqHeaderBlock(const EnqFormatVer enqFormatVer,
+                   const HashType hashType,
+                   const bool banded,
                    const DataType dataType,
                    const FbReferenceType referenceType,
                    const ActivePixels *activePixels,
@@ -417,6 +453,7 @@ private:
     finline static bool
     deqHeaderBlock(VContainerDeq &vContainerDeq,
                    unsigned &formatVersion,
+                   bool &banded, // out : pixel block is split into multiple bands
                    DataType &dataType,
                    FbReferenceType &referenceType,
                    unsigned &width,
@@ -438,6 +475,23 @@ private:
     finline static bool
     deqHeaderBlock(VContainerDeq &vContainerDeq,
                    DataType &dataType);
+
+    // The header stores hashType above the formatVersion bits. hashType is SHA1 (= 0) when there
+    // is no hash, so that data has exactly the same header as before hashType was added.
+    // BANDED_FLAG is only set when the pixel block is split into multiple bands (bandTotal > 1).
+    static constexpr unsigned HASH_TYPE_SHIFT = 8;
+    static constexpr unsigned BANDED_FLAG = 0x1 << 16;
+    finline static bool splitFormatVersion(const unsigned formatVersionAndHashType,
+                                           unsigned &formatVersion,
+                                           HashType &hashType,
+                                           bool &banded);
+    static void computeHash(const HashType hashType,
+                            const unsigned char *src,
+                            const size_t srcSize,
+                            unsigned char *dst); // HASH_SIZE byte
+    static void computeHash(const HashType hashType,
+                            const std::vector<std::pair<const void *, size_t>> &src, // concatenated
+                            unsigned char *dst); // HASH_SIZE byte
                                
     finline static bool
     enqTileMaskBlock(const EnqFormatVer enqFormatVer,
@@ -463,6 +517,80 @@ private:
     static bool deqTileMaskBlockVer2(VContainerDeq &vContainerDeq, const unsigned activeTileTotal,
                                      ActivePixels &activePixels);
 
+    // VER3 pixel block : VER2 pixel block compressed by per-tile delta prediction + RansCodec
+    static void enqTilePixelBlockVer3(const ActivePixels &activePixels,
+                                      const DataType dataType,
+                                      const PrecisionMode precisionMode,
+                                      const std::string &pixelBlock, // VER2 pixel block (VContainer)
+                                      VContainerEnq &vContainerEnq);
+    static bool deqTilePixelBlockVer3(VContainerDeq &vContainerDeq,
+                                      const ActivePixels &activePixels,
+                                      std::string &pixelBlock); // out : VER2 pixel block (VContainer)
+
+    // Banded pixel block : the tiles are split into bands (ranges of tileId) which have about the
+    // same number of active pixels. Each band is encoded and decoded independently.
+    static constexpr unsigned BAND_TOTAL_MAX = 1024;
+    static void splitTileBands(const ActivePixels &activePixels,
+                               const unsigned bandTotal,
+                               std::vector<unsigned> &bandEndTileId); // out : exclusive end tileId
+    static void setupBandActivePixels(const ActivePixels &activePixels,
+                                      const unsigned startTileId,
+                                      const unsigned endTileId,
+                                      ActivePixels &bandActivePixels);
+    static bool deqTileBandIndex(VContainerDeq &vContainerDeq,
+                                 const ActivePixels &activePixels,
+                                 std::vector<unsigned> &bandEndTileId,
+                                 std::vector<const void *> &bandAddr,
+                                 std::vector<size_t> &bandSize);
+    static bool findPixelRecordLayout(const unsigned char *raw,
+                                      const size_t rawSize,
+                                      const size_t recTotal,
+                                      const DataType dataType,
+                                      const PrecisionMode precisionMode,
+                                      bool &withNumSample,
+                                      unsigned &valueBytes,
+                                      unsigned &laneBytes,
+                                      std::vector<unsigned char> &values,
+                                      std::vector<unsigned> &numSamples);
+    static void tileRecordTotal(const ActivePixels &activePixels, std::vector<unsigned> &recTotalTbl);
+    static void planesToRecords(const unsigned char *planes, const size_t recTotal,
+                                const unsigned valueBytes, unsigned char *recs);
+
+    static constexpr unsigned VER3_MAX_VALUE_BYTES = 16; // RGBA float
+
+    // lane-wise wraparound integer difference (out = cur - prev) and its inverse (cur += prev)
+    template <typename T>
+    static void deltaLanes(const unsigned char *cur, const unsigned char *prev, unsigned char *out,
+                           const unsigned valueBytes) {
+        for (unsigned i = 0; i < valueBytes; i += sizeof(T)) {
+            T a, b;
+            std::memcpy(&a, cur + i, sizeof(T));
+            std::memcpy(&b, prev + i, sizeof(T));
+            const T d = static_cast<T>(a - b);
+            std::memcpy(out + i, &d, sizeof(T));
+        }
+    }
+    template <typename T>
+    static void accumulateTileRecords(const std::vector<unsigned> &recTotalTbl,
+                                      unsigned char *recs, const unsigned valueBytes) {
+        // Records depend on each other only inside the tile. Lanes of one record are independent
+        // and this inner loop is vectorized by the compiler.
+        for (unsigned tileRecTotal : recTotalTbl) {
+            for (unsigned r = 1; r < tileRecTotal; ++r) {
+                unsigned char *cur = recs + static_cast<size_t>(r) * valueBytes;
+                const unsigned char *prev = cur - valueBytes;
+                for (unsigned i = 0; i < valueBytes; i += sizeof(T)) {
+                    T a, b;
+                    std::memcpy(&a, cur + i, sizeof(T));
+                    std::memcpy(&b, prev + i, sizeof(T));
+                    a = static_cast<T>(a + b);
+                    std::memcpy(cur + i, &a, sizeof(T));
+                }
+            }
+            recs += static_cast<size_t>(tileRecTotal) * valueBytes;
+        }
+    }
+
     //------------------------------
 
     inline static void enqLowPrecisionFloat(VContainerEnq &vContainerEnq, const float &v)
@@ -715,29 +843,38 @@ private:
                              const CoarsePassPrecision coarsePassPrecision, // minimum coarse pass precision
                              const FinePassPrecision finePassPrecision, // minimum fine pass precision
                              const ActivePixels &activePixels,
-                             std::string &output,
-                             const bool withSha1Hash,
+                             PackTilesBuffer &output,
+                             const bool withHash,
+                             const HashType hashType,
+                             const unsigned bandTotal,
                              F enqTilePixelBlockFunc) {
         //------------------------------
         //
-        // dummy SHA1 hash data
+        // dummy hash data
         // hash located very beginning of packTile data. (before of formatVersion actually)
         // hash data is outside valueContainer region. This cause verify hash very easily for
         // packTile data. (See verifyDecodeHash()).
         //
-        size_t hashOffset = output.size();
+        std::string &main = output.getMain();
+        size_t hashOffset = main.size();
         for (size_t i = 0; i < HASH_SIZE; ++i) {
-            output.push_back(0x0);
+            main.push_back(0x0);
         }
-        size_t dataOffset = output.size(); // data start offset insize output string
+        size_t dataOffset = main.size(); // data start offset insize output string
 
         //------------------------------
         //
         // data encode
         //
-        VContainerEnq vContainerEnq(&output);
+        VContainerEnq vContainerEnq(&main);
 
-        enqHeaderBlock(enqFormatVer,
+        std::vector<unsigned> bandEndTileId;
+        if (bandTotal > 1 && enqFormatVer != EnqFormatVer::VER1) {
+            splitTileBands(activePixels, bandTotal, bandEndTileId);
+        }
+        const bool banded = bandEndTileId.size() > 1;
+
+        enqHeaderBlock(enqFormatVer, (withHash) ? hashType : HashType::SHA1, banded,
                        dataType, FbReferenceType::UNDEF, &activePixels, defaultValue, precisionMode,
                        closestFilterStatus, coarsePassPrecision, finePassPrecision,
                        vContainerEnq);
@@ -747,11 +884,36 @@ private:
         std::vector<int64_t> sizeInfo(2); // 0:tileMaskBlockVer2Size 1:tileMaskBlockVer1Delta
         sizeInfoPtr = sizeInfo.data();
 #       endif // end DEBUG_MSG_SIZEDUMP
+        size_t bandStartId = 0;
+        bool bandSegments = false; // band data is kept outside of the main data
         if (enqTileMaskBlock(enqFormatVer, activePixels, vContainerEnq, sizeInfoPtr)) {
-            enqTilePixelBlockFunc(vContainerEnq);
+            if (banded) {
+                bandStartId = enqTilePixelBands(enqFormatVer, dataType, precisionMode, activePixels,
+                                                bandEndTileId, enqTilePixelBlockFunc, output,
+                                                vContainerEnq);
+                bandSegments = !output.isFlat();
+            } else {
+                output.allocWork(1);
+                enqTilePixelBlock(enqFormatVer, dataType, precisionMode, activePixels,
+                                  enqTilePixelBlockFunc, output.getWork(0), vContainerEnq);
+            }
         }
     
         size_t dataSize = vContainerEnq.finalize(); // data size
+        if (bandSegments) {
+            // The band data follows the main data as separate segments. The size field at the
+            // beginning of the container has to include them.
+            for (size_t bandId = 0; bandId < bandEndTileId.size(); ++bandId) {
+                dataSize += output.getBand(bandStartId + bandId).size();
+            }
+            std::memcpy(&main[dataOffset], &dataSize, sizeof(size_t));
+        }
+        output.addMainSegment(hashOffset, main.size() - hashOffset);
+        if (bandSegments) {
+            for (size_t bandId = 0; bandId < bandEndTileId.size(); ++bandId) {
+                output.addBandSegment(bandStartId + bandId);
+            }
+        }
 
 #       ifdef DEBUG_MSG_SIZEDUMP
         {
@@ -777,16 +939,26 @@ private:
         //
         // revise and set proper hash value
         //
-        if (withSha1Hash) {
-            // When withSha1Hash = true, we compute hash and save to preallocated location.
+        if (withHash) {
+            // When withHash = true, we compute hash and save to preallocated location.
             const unsigned char *srcPtr =
-                reinterpret_cast<const unsigned char *>((uintptr_t)(output.data()) +
+                reinterpret_cast<const unsigned char *>((uintptr_t)(main.data()) +
                                                         static_cast<uintptr_t>(dataOffset));
-            size_t srcSize = dataSize;
+            size_t srcSize = main.size() - dataOffset;
             unsigned char *dstPtr =
-                reinterpret_cast<unsigned char *>((uintptr_t)(output.data()) +
+                reinterpret_cast<unsigned char *>((uintptr_t)(main.data()) +
                                                   static_cast<uintptr_t>(hashOffset));
-            SHA1(srcPtr, srcSize, dstPtr);
+            if (bandSegments) {
+                std::vector<std::pair<const void *, size_t>> src;
+                src.emplace_back(srcPtr, srcSize);
+                for (size_t bandId = 0; bandId < bandEndTileId.size(); ++bandId) {
+                    const std::string &band = output.getBand(bandStartId + bandId);
+                    src.emplace_back(band.data(), band.size());
+                }
+                computeHash(hashType, src, dstPtr);
+            } else {
+                computeHash(hashType, srcPtr, srcSize, dstPtr);
+            }
         }
 
         return dataSize + HASH_SIZE;
@@ -829,6 +1001,7 @@ private:
 #           endif // end DEBUG_FOOTMARK_DECODEMAIN
 
             unsigned formatVersion;
+            bool banded;
             unsigned activeTileTotal, activePixelTotal;
             DataType currDataType;
             FbReferenceType currReferenceType;
@@ -840,6 +1013,7 @@ private:
             FinePassPrecision finePassPrecision;
             if (!deqHeaderBlock(vContainerDeq,
                                 formatVersion,
+                                banded,
                                 currDataType, currReferenceType,
                                 width, height, activeTileTotal, activePixelTotal, defaultValue,
                                 precisionMode,
@@ -885,9 +1059,19 @@ private:
             debugFootmark([]() { return ">> PackTiles.cc decodeMain() before deqTilePixelBlockFunc()"; });
             debugFootmarkPush();
 #           endif // end DEBUG_FOOTMARK_DECODEMAIN
-            if (!deqTilePixelBlockFunc(currDataType, defaultValue, precisionMode, closestFilterStatus,
-                                       coarsePassPrecision, finePassPrecision,
-                                       vContainerDeq)) {
+            auto deqFunc = [&](const ActivePixels &currActivePixels,
+                               const bool setupOutput,
+                               VContainerDeq &pixelBlockDeq) -> bool {
+                return deqTilePixelBlockFunc(currActivePixels, setupOutput,
+                                             currDataType, defaultValue, precisionMode, closestFilterStatus,
+                                             coarsePassPrecision, finePassPrecision,
+                                             pixelBlockDeq);
+            };
+            const bool pixelBlockResult =
+                ((banded) ?
+                 deqTilePixelBands(vContainerDeq, formatVersion, activePixels, deqFunc) :
+                 deqTilePixelBlock(vContainerDeq, formatVersion, activePixels, true, deqFunc));
+            if (!pixelBlockResult) {
                 activeDecodeAction = false;
 #               ifdef DEBUG_FOOTMARK_DECODEMAIN
                 debugFootmarkPop();
@@ -908,6 +1092,122 @@ private:
         return true;
     }
 
+    template <typename F>
+    static void enqTilePixelBlock(const EnqFormatVer enqFormatVer,
+                                  const DataType dataType,
+                                  const PrecisionMode precisionMode,
+                                  const ActivePixels &activePixels,
+                                  F &enqTilePixelBlockFunc,
+                                  std::string &pixelBlock, // work memory for VER3
+                                  VContainerEnq &vContainerEnq) {
+        if (enqFormatVer == EnqFormatVer::VER3) {
+            // VER3 compresses the VER2 pixel block as a whole. This keeps all the
+            // enqTilePixelBlockFunc as is.
+            VContainerEnq pixelBlockEnq(&pixelBlock);
+            enqTilePixelBlockFunc(activePixels, pixelBlockEnq);
+            pixelBlockEnq.finalize();
+            enqTilePixelBlockVer3(activePixels, dataType, precisionMode, pixelBlock, vContainerEnq);
+        } else {
+            enqTilePixelBlockFunc(activePixels, vContainerEnq);
+        }
+    }
+
+    template <typename F>
+    static size_t enqTilePixelBands(const EnqFormatVer enqFormatVer,
+                                    const DataType dataType,
+                                    const PrecisionMode precisionMode,
+                                    const ActivePixels &activePixels,
+                                    const std::vector<unsigned> &bandEndTileId,
+                                    F &enqTilePixelBlockFunc,
+                                    PackTilesBuffer &output,
+                                    VContainerEnq &vContainerEnq) {
+        //
+        // Each band is an independent VContainer which only includes the pixels of the band's tiles.
+        // They are encoded in parallel and then stored after the band index (endTileId and size of
+        // each band). enqTilePixelBlockFunc only reads the source buffers, so it is safe to run
+        // for different bands at the same time.
+        // Band data is encoded into the pooled band memory of output. Only flat mode copies them
+        // into the main data, otherwise they become independent segments (See encodeMain()).
+        // Returns the first band id of output.
+        //
+        const size_t bandTotal = bandEndTileId.size();
+        const size_t bandStartId = output.allocBand(bandTotal);
+        output.allocWork(bandTotal);
+        tbb::parallel_for(static_cast<size_t>(0), bandTotal, [&](const size_t bandId) {
+                ActivePixels bandActivePixels;
+                setupBandActivePixels(activePixels,
+                                      (bandId == 0) ? 0 : bandEndTileId[bandId - 1],
+                                      bandEndTileId[bandId],
+                                      bandActivePixels);
+                VContainerEnq bandEnq(&output.getBand(bandStartId + bandId));
+                enqTilePixelBlock(enqFormatVer, dataType, precisionMode, bandActivePixels,
+                                  enqTilePixelBlockFunc, output.getWork(bandId), bandEnq);
+                bandEnq.finalize();
+            });
+
+        vContainerEnq.enqVLUInt(static_cast<unsigned>(bandTotal));
+        for (size_t bandId = 0; bandId < bandTotal; ++bandId) {
+            vContainerEnq.enqVLUInt(bandEndTileId[bandId]);
+            vContainerEnq.enqVLSizeT(output.getBand(bandStartId + bandId).size());
+        }
+        if (output.isFlat()) {
+            for (size_t bandId = 0; bandId < bandTotal; ++bandId) {
+                const std::string &data = output.getBand(bandStartId + bandId);
+                vContainerEnq.enqByteData(static_cast<const void *>(data.data()), data.size());
+            }
+        }
+        return bandStartId;
+    }
+
+    template <typename F>
+    static bool deqTilePixelBlock(VContainerDeq &vContainerDeq,
+                                  const unsigned formatVersion,
+                                  const ActivePixels &activePixels,
+                                  const bool setupOutput,
+                                  F &deqFunc) {
+        if (formatVersion == static_cast<unsigned>(EnqFormatVer::VER3)) {
+            // restore the VER2 pixel block and decode it by the same deqTilePixelBlockFunc
+            std::string pixelBlock;
+            if (!deqTilePixelBlockVer3(vContainerDeq, activePixels, pixelBlock)) return false;
+            VContainerDeq pixelBlockDeq(static_cast<const void *>(pixelBlock.data()), pixelBlock.size());
+            return deqFunc(activePixels, setupOutput, pixelBlockDeq);
+        }
+        return deqFunc(activePixels, setupOutput, vContainerDeq);
+    }
+
+    template <typename F>
+    static bool deqTilePixelBands(VContainerDeq &vContainerDeq,
+                                  const unsigned formatVersion,
+                                  const ActivePixels &activePixels,
+                                  F &deqFunc) {
+        std::vector<unsigned> bandEndTileId;
+        std::vector<const void *> bandAddr;
+        std::vector<size_t> bandSize;
+        if (!deqTileBandIndex(vContainerDeq, activePixels, bandEndTileId, bandAddr, bandSize)) {
+            return false;
+        }
+
+        auto deqBand = [&](const size_t bandId, const bool setupOutput) -> bool {
+            ActivePixels bandActivePixels;
+            setupBandActivePixels(activePixels,
+                                  (bandId == 0) ? 0 : bandEndTileId[bandId - 1],
+                                  bandEndTileId[bandId],
+                                  bandActivePixels);
+            VContainerDeq bandDeq(bandAddr[bandId], bandSize[bandId]);
+            return deqTilePixelBlock(bandDeq, formatVersion, bandActivePixels, setupOutput, deqFunc);
+        };
+
+        // The first band is decoded alone with setupOutput = true. This sets up the output
+        // (precision info, resolution of the destination buffers, etc.) and after that, the remaining
+        // bands only update the pixels of their own tiles. So they are decoded in parallel.
+        if (!deqBand(0, true)) return false;
+        std::atomic<bool> result(true);
+        tbb::parallel_for(static_cast<size_t>(1), bandEndTileId.size(), [&](const size_t bandId) {
+                if (!deqBand(bandId, false)) result = false;
+            });
+        return result;
+    }
+
     // This API is used under McrtFbSender context.
     // Output value is normalized using weight when doNormalizedMode = true.
     // Output with numSample.
@@ -1611,13 +1911,15 @@ size_t
 PackTilesImpl::encode(const ActivePixels &activePixels,
                       const RenderBuffer &renderBufferTiled, // non-normalized color
                       const FloatBuffer &weightBufferTiled,
-                      std::string &output,
+                      PackTilesBuffer &output,
                       const PrecisionMode precisionMode,
                       const CoarsePassPrecision coarsePassPrecision,
                       const FinePassPrecision finePassPrecision,
                       const bool noNumSampleMode,
-                      const bool withSha1Hash,
-                      const EnqFormatVer enqFormatVer)
+                      const bool withHash,
+                      const EnqFormatVer enqFormatVer,
+                      const HashType hashType,
+                      const unsigned bandTotal)
 //
 // for McrtComputation : RenderBuffer (beauty/alpha), RenderBufferOdd (beautyAux/alphaAux)
 //
@@ -1641,12 +1943,12 @@ PackTilesImpl::encode(const ActivePixels &activePixels,
 //
 {
     DataType dataType = DataType::UNDEF;
-    std::function<void (VContainerEnq &)> enqTilePixelBlockFunc;
+    std::function<void (const ActivePixels &, VContainerEnq &)> enqTilePixelBlockFunc;
     if (noNumSampleMode) {
         dataType = ((renderBufferOdd) ?
                     DataType::BEAUTYODD :
                     DataType::BEAUTY);
-        enqTilePixelBlockFunc = [&](VContainerEnq &vContainerEnq) {
+        enqTilePixelBlockFunc = [&](const ActivePixels &activePixels, VContainerEnq &vContainerEnq) {
             enqTilePixelBlockVal
             (vContainerEnq,
              precisionMode,
@@ -1668,7 +1970,7 @@ PackTilesImpl::encode(const ActivePixels &activePixels,
         dataType = ((renderBufferOdd) ?
                     DataType::BEAUTYODD_WITH_NUMSAMPLE :
                     DataType::BEAUTY_WITH_NUMSAMPLE);
-        enqTilePixelBlockFunc = [&](VContainerEnq &vContainerEnq) {
+        enqTilePixelBlockFunc = [&](const ActivePixels &activePixels, VContainerEnq &vContainerEnq) {
             enqTilePixelBlockValSample
             (vContainerEnq,
              precisionMode,
@@ -1700,7 +2002,9 @@ PackTilesImpl::encode(const ActivePixels &activePixels,
                       finePassPrecision,
                       activePixels,
                       output,
-                      withSha1Hash,
+                      withHash,
+                      hashType,
+                      bandTotal,
                       enqTilePixelBlockFunc);
 }
 
@@ -1709,12 +2013,14 @@ template <bool renderBufferOdd>
 size_t
 PackTilesImpl::encode(const ActivePixels &activePixels,
                       const RenderBuffer &renderBufferTiled, // normalized color
-                      std::string &output,
+                      PackTilesBuffer &output,
                       const PrecisionMode precisionMode,
                       const CoarsePassPrecision coarsePassPrecision,
                       const FinePassPrecision finePassPrecision,
-                      const bool withSha1Hash,
-                      const EnqFormatVer enqFormatVer)
+                      const bool withHash,
+                      const EnqFormatVer enqFormatVer,
+                      const HashType hashType,
+                      const unsigned bandTotal)
 //
 // for McrtMergeComputation : RenderBuffer (beauty/alpha), RenderBufferOdd (beautyAux/alphaAux)
 //
@@ -1735,8 +2041,10 @@ PackTilesImpl::encode(const ActivePixels &activePixels,
                       finePassPrecision,
                       activePixels,
                       output,
-                      withSha1Hash,
-                      [&](VContainerEnq &vContainerEnq) { // enqTilePixelBlockFunc
+                      withHash,
+                      hashType,
+                      bandTotal,
+                      [&](const ActivePixels &activePixels, VContainerEnq &vContainerEnq) { // enqTilePixelBlockFunc
                           enqTilePixelBlockValNormalizedSrc
                           (vContainerEnq,
                            precisionMode,
@@ -1760,12 +2068,14 @@ size_t
 PackTilesImpl::encode(const ActivePixels& activePixels,
                       const RenderBuffer& renderBufferTiled, // normalized color
                       const NumSampleBuffer& numSampleBufferTiled, // numSample data for renderBuffer
-                      std::string &output,
+                      PackTilesBuffer &output,
                       const PrecisionMode precisionMode, // precision which is used in this encoding operation
                       const CoarsePassPrecision coarsePassPrecision, // minimum coarse pass precision
                       const FinePassPrecision finePassPrecision, // minimum fine pass precision
-                      const bool withSha1Hash,
-                      const EnqFormatVer enqFormatVer)
+                      const bool withHash,
+                      const EnqFormatVer enqFormatVer,
+                      const HashType hashType,
+                      const unsigned bandTotal)
 //
 // for McrtMergeComputation : RenderBuffer (beauty/alpha), RenderBufferOdd (beautyAux/alphaAux)
 //
@@ -1788,8 +2098,10 @@ PackTilesImpl::encode(const ActivePixels& activePixels,
                       finePassPrecision,
                       activePixels,
                       output,
-                      withSha1Hash,
-                      [&](VContainerEnq &vContainerEnq) { // enqTilePixelBlockFunc
+                      withHash,
+                      hashType,
+                      bandTotal,
+                      [&](const ActivePixels &activePixels, VContainerEnq &vContainerEnq) { // enqTilePixelBlockFunc
                           enqTilePixelBlockValSampleNormalizedSrc
                           (vContainerEnq,
                            precisionMode,
@@ -1855,7 +2167,8 @@ PackTilesImpl::decode(const void* addr,
                    dataSize,
                    activePixels,
                    sha1HashDigest,
-                   [&](DataType dataType, float /*defaultValue*/, const PrecisionMode precisionMode,
+                   [&](const ActivePixels& activePixels, const bool setupOutput,
+                       DataType dataType, float /*defaultValue*/, const PrecisionMode precisionMode,
                        bool /*closestFilterStatus*/,
                        CoarsePassPrecision currCoarsePassPrecision,
                        FinePassPrecision currFinePassPrecision,
@@ -1868,8 +2181,10 @@ PackTilesImpl::decode(const void* addr,
                        debugFootmarkPush();
 #                      endif // end DEBUG_FOOTMARK_DECODE_A
                        {
-                           coarsePassPrecision = currCoarsePassPrecision;
-                           finePassPrecision = currFinePassPrecision;
+                           if (setupOutput) {
+                               coarsePassPrecision = currCoarsePassPrecision;
+                               finePassPrecision = currFinePassPrecision;
+                           }
 
                            if (renderBufferOdd) {
                                if (dataType != DataType::BEAUTYODD_WITH_NUMSAMPLE) return false;
@@ -1985,7 +2300,8 @@ PackTilesImpl::decode(const void* addr,
                    dataSize,
                    activePixels,
                    sha1HashDigest,
-                   [&](DataType dataType, float /*defaultValue*/, const PrecisionMode precisionMode,
+                   [&](const ActivePixels& activePixels, const bool setupOutput,
+                       DataType dataType, float /*defaultValue*/, const PrecisionMode precisionMode,
                        bool /*closestFilterStatus*/,
                        CoarsePassPrecision currCoarsePassPrecision,
                        FinePassPrecision currFinePassPrecision,
@@ -1998,8 +2314,10 @@ PackTilesImpl::decode(const void* addr,
                        debugFootmarkPush();
 #                      endif // end DEBUG_FOOTMARK_DECODE_B
                        {
-                           coarsePassPrecision = currCoarsePassPrecision;
-                           finePassPrecision = currFinePassPrecision;
+                           if (setupOutput) {
+                               coarsePassPrecision = currCoarsePassPrecision;
+                               finePassPrecision = currFinePassPrecision;
+                           }
 
                            if (renderBufferOdd) {
                                if (dataType != DataType::BEAUTYODD) return false;
@@ -2060,6 +2378,8 @@ PackTilesImpl::decode(const void* addr,
 // static function
 finline void
 PackTilesImpl::enqHeaderBlock(const EnqFormatVer enqFormatVer,
+                              const HashType hashType,
+                              const bool banded,
                               const DataType dataType,
                               const FbReferenceType referenceType,
                               const ActivePixels *activePixels,
@@ -2082,7 +2402,9 @@ PackTilesImpl::enqHeaderBlock(const EnqFormatVer enqFormatVer,
         activePixelTotal = activePixels->getActivePixelTotal();
     }
 
-    vContainerEnq.enqVLUInt(static_cast<unsigned int>(enqFormatVer));
+    vContainerEnq.enqVLUInt(static_cast<unsigned int>(enqFormatVer) |
+                            (static_cast<unsigned int>(hashType) << HASH_TYPE_SHIFT) |
+                            ((banded) ? BANDED_FLAG : 0x0));
     vContainerEnq.enqVLUInt(static_cast<unsigned int>(dataType));
     vContainerEnq.enqVLUInt(static_cast<unsigned int>(referenceType));
     vContainerEnq.enqVLUInt(width); // non tile aligned size (original size)
@@ -2100,6 +2422,7 @@ PackTilesImpl::enqHeaderBlock(const EnqFormatVer enqFormatVer,
 finline bool
 PackTilesImpl::deqHeaderBlock(VContainerDeq &vContainerDeq,
                               unsigned &formatVersion,
+                              bool &banded,
                               DataType &dataType,
                               FbReferenceType &referenceType,
                               unsigned &width,
@@ -2112,12 +2435,12 @@ PackTilesImpl::deqHeaderBlock(VContainerDeq &vContainerDeq,
                               CoarsePassPrecision &coarsePassPrecision, // minimum coarse pass precision
                               FinePassPrecision &finePassPrecision) // minimum fine pass precision
 {
-    formatVersion = vContainerDeq.deqVLUInt();
-    if (formatVersion > static_cast<unsigned>(EnqFormatVer::VER2)) {
-        return false; // This code only understand up to VER2.
+    HashType hashType;
+    if (!splitFormatVersion(vContainerDeq.deqVLUInt(), formatVersion, hashType, banded)) {
+        return false; // This code only understand up to VER3.
     }
 
-    // formatVersion : VER1, VER2
+    // formatVersion : VER1, VER2, VER3
 
     dataType = static_cast<DataType>(vContainerDeq.deqVLUInt());
     referenceType = static_cast<FbReferenceType>(vContainerDeq.deqVLUInt());
@@ -2142,13 +2465,15 @@ PackTilesImpl::deqHeaderBlock(VContainerDeq &vContainerDeq,
                               FbReferenceType &referenceType)
 {
     unsigned int formatVersion, ui;
+    HashType hashType;
+    bool banded;
 
-    vContainerDeq.deqVLUInt(formatVersion);
-    if (formatVersion > static_cast<unsigned>(EnqFormatVer::VER2)) {
-        return false; // This code only understand up to VER2.
+    vContainerDeq.deqVLUInt(ui);
+    if (!splitFormatVersion(ui, formatVersion, hashType, banded)) {
+        return false; // This code only understand up to VER3.
     }
 
-    // formatVersion : VER1, VER2
+    // formatVersion : VER1, VER2, VER3
     
     vContainerDeq.deqVLUInt(ui);
     dataType = static_cast<DataType>(ui);
@@ -2168,13 +2493,15 @@ PackTilesImpl::deqHeaderBlock(VContainerDeq &vContainerDeq,
 //
 {
     unsigned int formatVersion, ui;
+    HashType hashType;
+    bool banded;
 
-    vContainerDeq.deqVLUInt(formatVersion);
-    if (formatVersion > static_cast<unsigned>(EnqFormatVer::VER2)) {
-        return false; // This code only understand up to VER2.
+    vContainerDeq.deqVLUInt(ui);
+    if (!splitFormatVersion(ui, formatVersion, hashType, banded)) {
+        return false; // This code only understand up to VER3.
     }
 
-    // formatVersion : VER1, VER2
+    // formatVersion : VER1, VER2, VER3
 
     vContainerDeq.deqVLUInt(ui);
     dataType = static_cast<DataType>(ui);
@@ -2182,6 +2509,86 @@ PackTilesImpl::deqHeaderBlock(VContainerDeq &vContainerDeq,
     return true;
 }
 
+// static function
+finline bool
+PackTilesImpl::splitFormatVersion(const unsigned formatVersionAndHashType,
+                                  unsigned &formatVersion,
+                                  HashType &hashType,
+                                  bool &banded)
+{
+    formatVersion = formatVersionAndHashType & ((1 << HASH_TYPE_SHIFT) - 1);
+    const unsigned hashTypeId = (formatVersionAndHashType >> HASH_TYPE_SHIFT) & 0xff;
+    if (formatVersion > static_cast<unsigned>(EnqFormatVer::VER3) ||
+        hashTypeId > static_cast<unsigned>(HashType::CRC32C) ||
+        (formatVersionAndHashType & ~(BANDED_FLAG | 0xffff))) {
+        return false;
+    }
+    hashType = static_cast<HashType>(hashTypeId);
+    banded = (formatVersionAndHashType & BANDED_FLAG) != 0;
+    if (banded && formatVersion < static_cast<unsigned>(EnqFormatVer::VER2)) {
+        return false; // bands are only supported by VER2 and later
+    }
+    return true;
+}
+
+// static function
+void
+PackTilesImpl::computeHash(const HashType hashType,
+                           const unsigned char *src,
+                           const size_t srcSize,
+                           unsigned char *dst)
+{
+    switch (hashType) {
+    case HashType::SHA1 :
+        SHA1(src, srcSize, dst);
+        break;
+    case HashType::CRC32C : {
+        static_assert(Crc32cUtil::HASH_SIZE <= HASH_SIZE, "Crc32cUtil hash does not fit in HASH_SIZE");
+        const Crc32cUtil::Hash hash = Crc32cUtil::hash(src, srcSize);
+        std::memcpy(dst, hash.data(), Crc32cUtil::HASH_SIZE);
+        std::memset(dst + Crc32cUtil::HASH_SIZE, 0x0, HASH_SIZE - Crc32cUtil::HASH_SIZE);
+    } break;
+    }
+}
+
+// static function
+void
+PackTilesImpl::computeHash(const HashType hashType,
+                           const std::vector<std::pair<const void *, size_t>> &src,
+                           unsigned char *dst)
+{
+    switch (hashType) {
+    case HashType::SHA1 : {
+        bool result = false;
+        try {
+            Sha1Gen sha1;
+            result = sha1.init();
+            for (size_t i = 0; result && i < src.size(); ++i) {
+                result = sha1.updateByteData(src[i].first, src[i].second);
+            }
+            if (result) {
+                const Sha1Gen::Hash hash = sha1.finalize();
+                std::memcpy(dst, hash.data(), HASH_SIZE);
+            }
+        }
+        catch (const std::string &err) {
+            std::cerr << ">> PackTiles.cc computeHash() SHA1 failed. err:" << err << '\n';
+            result = false;
+        }
+        if (!result) std::memset(dst, 0x0, HASH_SIZE); // verifyDecodeHash() fails
+    } break;
+    case HashType::CRC32C : {
+        Crc32cGen crc;
+        for (const auto &itr : src) {
+            crc.updateByteData(itr.first, itr.second);
+        }
+        const Crc32cGen::Hash hash = crc.finalize();
+        std::memcpy(dst, hash.data(), Crc32cGen::HASH_SIZE);
+        std::memset(dst + Crc32cGen::HASH_SIZE, 0x0, HASH_SIZE - Crc32cGen::HASH_SIZE);
+    } break;
+    }
+}
+
 // static function
 finline bool
 PackTilesImpl::enqTileMaskBlock(const EnqFormatVer enqFormatVer,
@@ -2193,7 +2600,7 @@ PackTilesImpl::enqTileMaskBlock(const EnqFormatVer enqFormatVer,
     if (enqFormatVer == EnqFormatVer::VER1) {
         enqTileMaskBlockVer1(activePixels, vContainerEnq);
     } else {
-        // This code only understand up to VER2.
+        // VER2 and VER3 share the same tileMask block.
         result = enqTileMaskBlockVer2(activePixels, vContainerEnq, sizeInfo);
     }
     return result;
@@ -2209,7 +2616,7 @@ PackTilesImpl::deqTileMaskBlock(VContainerDeq &vContainerDeq,
     if (formatVersion == static_cast<unsigned>(EnqFormatVer::VER1)) {
         deqTileMaskBlockVer1(vContainerDeq, activeTileTotal, activePixels);
     } else {
-        // This code only understand up to VER2.
+        // VER2 and VER3 share the same tileMask block.
         result = deqTileMaskBlockVer2(vContainerDeq, activeTileTotal, activePixels);
     }
     return result;
@@ -2225,12 +2632,14 @@ PackTilesImpl::deqTileMaskBlock(VContainerDeq &vContainerDeq,
 size_t
 PackTilesImpl::encodePixelInfo(const ActivePixels &activePixels,
                                const PixelInfoBuffer &pixelInfoBufferTiled,
-                               std::string &output,
+                               PackTilesBuffer &output,
                                const PrecisionMode precisionMode,
                                const CoarsePassPrecision coarsePassPrecision,
                                const FinePassPrecision finePassPrecision,
-                               const bool withSha1Hash,
-                               const EnqFormatVer enqFormatVer)
+                               const bool withHash,
+                               const EnqFormatVer enqFormatVer,
+                               const HashType hashType,
+                               const unsigned bandTotal)
 //
 // Creates PixelInfo (Depth) : float * 1
 //
@@ -2255,8 +2664,10 @@ PackTilesImpl::encodePixelInfo(const ActivePixels &activePixels,
                       finePassPrecision,
                       activePixels,
                       output,
-                      withSha1Hash,
-                      [&](VContainerEnq &vContainerEnq) { // enqTilePixelBlockFunc
+                      withHash,
+                      hashType,
+                      bandTotal,
+                      [&](const ActivePixels &activePixels, VContainerEnq &vContainerEnq) { // enqTilePixelBlockFunc
                           activeTileCrawler(activePixels,
                                             [&](uint64_t mask, unsigned pixelOffset) { // func
                                                 const auto *__restrict src =
@@ -2303,7 +2714,8 @@ PackTilesImpl::decodePixelInfo(const void* addr,
                    dataSize,
                    activePixels,
                    sha1HashDigest,
-                   [&](DataType dataType, float /*defaultValue*/,
+                   [&](const ActivePixels& activePixels, const bool setupOutput,
+                       DataType dataType, float /*defaultValue*/,
                        const PrecisionMode /*precisionMode*/,
                        bool /*closestFilterStatus*/,
                        CoarsePassPrecision currCoarsePassPrecision,
@@ -2317,8 +2729,10 @@ PackTilesImpl::decodePixelInfo(const void* addr,
                        debugFootmarkPush();
 #                      endif // end DEBUG_FOOTMARK_DECODE_PIXELINFO
                        {                          
-                           coarsePassPrecision = currCoarsePassPrecision;
-                           finePassPrecision = currFinePassPrecision;
+                           if (setupOutput) {
+                               coarsePassPrecision = currCoarsePassPrecision;
+                               finePassPrecision = currFinePassPrecision;
+                           }
 
                            if (dataType != DataType::PIXELINFO) return false;
                            // pixelInfoBufferTiled is resized and clear if size changed by message itself.
@@ -2378,10 +2792,12 @@ size_t
 PackTilesImpl::encodeHeatMap(const ActivePixels &activePixels,
                              const FloatBuffer &heatMapSecBufferTiled, // non-normalized sec
                              const FloatBuffer &heatMapWeightBufferTiled,
-                             std::string &output,
+                             PackTilesBuffer &output,
                              const bool noNumSampleMode,
-                             const bool withSha1Hash,
-                             const EnqFormatVer enqFormatVer)
+                             const bool withHash,
+                             const EnqFormatVer enqFormatVer,
+                             const HashType hashType,
+                             const unsigned bandTotal)
 //
 // Creates Sec(normalized) + numSample : float * 1 + unsigned int : when noNumSampleMode = false
 // Creates Sec(normalized)             : float * 1                : when noNumSampleMode = true
@@ -2414,8 +2830,10 @@ PackTilesImpl::encodeHeatMap(const ActivePixels &activePixels,
                        FinePassPrecision::H16,        // always half precision
                        activePixels,
                        output,
-                       withSha1Hash,
-                       [&](VContainerEnq &vContainerEnq) { // enqTilePixelBlockFunc
+                       withHash,
+                       hashType,
+                       bandTotal,
+                       [&](const ActivePixels &activePixels, VContainerEnq &vContainerEnq) { // enqTilePixelBlockFunc
                            activeTileCrawler
                            (activePixels,
                             [&](uint64_t mask, unsigned pixelOffset) { // func
@@ -2442,8 +2860,10 @@ PackTilesImpl::encodeHeatMap(const ActivePixels &activePixels,
                        FinePassPrecision::H16,        // always half precision
                        activePixels,
                        output,
-                       withSha1Hash,
-                       [&](VContainerEnq &vContainerEnq) { // enqTilePixelBlockFunc
+                       withHash,
+                       hashType,
+                       bandTotal,
+                       [&](const ActivePixels &activePixels, VContainerEnq &vContainerEnq) { // enqTilePixelBlockFunc
                            activeTileCrawler
                            (activePixels,
                             [&](uint64_t mask, unsigned pixelOffset) { // func
@@ -2468,9 +2888,11 @@ PackTilesImpl::encodeHeatMap(const ActivePixels &activePixels,
 size_t
 PackTilesImpl::encodeHeatMap(const ActivePixels &activePixels,
                              const FloatBuffer &heatMapSecBufferTiled, // normalized sec
-                             std::string &output,
-                             const bool withSha1Hash,
-                             const EnqFormatVer enqFormatVer)
+                             PackTilesBuffer &output,
+                             const bool withHash,
+                             const EnqFormatVer enqFormatVer,
+                             const HashType hashType,
+                             const unsigned bandTotal)
 //
 // Creates Sec : float * 1
 //
@@ -2489,8 +2911,10 @@ PackTilesImpl::encodeHeatMap(const ActivePixels &activePixels,
                       FinePassPrecision::H16,        // always half precision
                       activePixels,
                       output,
-                      withSha1Hash,
-                      [&](VContainerEnq &vContainerEnq) { // enqTilePixelBlockFunc
+                      withHash,
+                      hashType,
+                      bandTotal,
+                      [&](const ActivePixels &activePixels, VContainerEnq &vContainerEnq) { // enqTilePixelBlockFunc
                           activeTileCrawler
                               (activePixels,
                                [&](uint64_t mask, unsigned pixelOffset) { // func
@@ -2542,7 +2966,8 @@ PackTilesImpl::decodeHeatMap(const void* addr,
                    dataSize,
                    activePixels,
                    sha1HashDigest,
-                   [&](DataType dataType, float /*defaultValue*/,
+                   [&](const ActivePixels& activePixels, const bool /*setupOutput*/,
+                       DataType dataType, float /*defaultValue*/,
                        const PrecisionMode /*precisionMode*/,
                        bool /*closestFilterStatus*/,
                        CoarsePassPrecision /*currCoarsePassPrecision*/,
@@ -2650,7 +3075,8 @@ PackTilesImpl::decodeHeatMap(const void* addr,
                    dataSize,
                    activePixels,
                    sha1HashDigest,
-                   [&](DataType dataType, float /*defaultValue*/,
+                   [&](const ActivePixels& activePixels, const bool /*setupOutput*/,
+                       DataType dataType, float /*defaultValue*/,
                        const PrecisionMode /*precisionMode*/,
                        bool /*closestFilterStatus*/,
                        CoarsePassPrecision /*currCoarsePassPrecision*/,
@@ -2722,12 +3148,14 @@ PackTilesImpl::decodeHeatMap(const void* addr,
 size_t
 PackTilesImpl::encodeWeightBuffer(const ActivePixels &activePixels,
                                   const FloatBuffer &weightBufferTiled,
-                                  std::string &output,
+                                  PackTilesBuffer &output,
                                   const PrecisionMode precisionMode,
                                   const CoarsePassPrecision coarsePassPrecision,
                                   const FinePassPrecision finePassPrecision,
-                                  const bool withSha1Hash,
-                                  const EnqFormatVer enqFormatVer)
+                                  const bool withHash,
+                                  const EnqFormatVer enqFormatVer,
+                                  const HashType hashType,
+                                  const unsigned bandTotal)
 //
 // Creates Weight : float * 1
 //
@@ -2752,8 +3180,10 @@ PackTilesImpl::encodeWeightBuffer(const ActivePixels &activePixels,
                       finePassPrecision,
                       activePixels,
                       output,
-                      withSha1Hash,
-                      [&](VContainerEnq &vContainerEnq) { // enqTilePixelBlockFunc
+                      withHash,
+                      hashType,
+                      bandTotal,
+                      [&](const ActivePixels &activePixels, VContainerEnq &vContainerEnq) { // enqTilePixelBlockFunc
                           enqTilePixelBlockValNormalizedSrc
                               (vContainerEnq,
                                precisionMode,
@@ -2803,7 +3233,8 @@ PackTilesImpl::decodeWeightBuffer(const void* addr,
                    dataSize,
                    activePixels,
                    sha1HashDigest,
-                   [&](DataType dataType, float /*defaultValue*/,
+                   [&](const ActivePixels& activePixels, const bool setupOutput,
+                       DataType dataType, float /*defaultValue*/,
                        const PrecisionMode precisionMode,
                        bool /*closestFilterStatus*/,
                        CoarsePassPrecision currCoarsePassPrecision,
@@ -2817,8 +3248,10 @@ PackTilesImpl::decodeWeightBuffer(const void* addr,
                        debugFootmarkPush();
 #                      endif // end DEBUG_FOOTMARK_DECODE_WEIGHT
                        {
-                           coarsePassPrecision = currCoarsePassPrecision;
-                           finePassPrecision = currFinePassPrecision;
+                           if (setupOutput) {
+                               coarsePassPrecision = currCoarsePassPrecision;
+                               finePassPrecision = currFinePassPrecision;
+                           }
 
                            if (dataType != DataType::WEIGHT) return false;
                            // weightBufferTiled is resized and clear if size changed by message itself.
@@ -2881,7 +3314,7 @@ PackTilesImpl::encodeRenderOutput(const ActivePixels &activePixels,
                                   const VariablePixelBuffer &renderOutputBufferTiled, // non-normalized
                                   const float renderOutputBufferDefaultValue,
                                   const FloatBuffer &renderOutputWeightBufferTiled,
-                                  std::string &output,
+                                  PackTilesBuffer &output,
                                   const PrecisionMode precisionMode,
                                   const bool noNumSampleMode,
                                   const bool doNormalizeMode, // do normalize or not
@@ -2889,8 +3322,10 @@ PackTilesImpl::encodeRenderOutput(const ActivePixels &activePixels,
                                   const unsigned closestFilterAovOriginalNumChan,
                                   const CoarsePassPrecision coarsePassPrecision,
                                   const FinePassPrecision finePassPrecision,
-                                  const bool withSha1Hash,
-                                  const EnqFormatVer enqFormatVer)
+                                  const bool withHash,
+                                  const EnqFormatVer enqFormatVer,
+                                  const HashType hashType,
+                                  const unsigned bandTotal)
 //
 // for moonray::engine_tool::McrtFbSender (moonray)
 //
@@ -2965,8 +3400,10 @@ PackTilesImpl::encodeRenderOutput(const ActivePixels &activePixels,
                        finePassPrecision,
                        activePixels,
                        output,
-                       withSha1Hash,
-                       [&](VContainerEnq &vContainerEnq) { // enqTilePixelBlockFunc
+                       withHash,
+                       hashType,
+                       bandTotal,
+                       [&](const ActivePixels &activePixels, VContainerEnq &vContainerEnq) { // enqTilePixelBlockFunc
                            switch (renderOutputBufferTiled.getFormat()) {
                            case fb_util::VariablePixelBuffer::FLOAT : {
                                enqTilePixelBlockVal
@@ -3135,8 +3572,10 @@ PackTilesImpl::encodeRenderOutput(const ActivePixels &activePixels,
                        finePassPrecision,
                        activePixels,
                        output,
-                       withSha1Hash,
-                       [&](VContainerEnq &vContainerEnq) { // enqTilePixelBlockFunc
+                       withHash,
+                       hashType,
+                       bandTotal,
+                       [&](const ActivePixels &activePixels, VContainerEnq &vContainerEnq) { // enqTilePixelBlockFunc
                            switch (renderOutputBufferTiled.getFormat()) {
                            case fb_util::VariablePixelBuffer::FLOAT : {
                                enqTilePixelBlockValSample
@@ -3303,13 +3742,15 @@ size_t
 PackTilesImpl::encodeRenderOutputMerge(const ActivePixels &activePixels,
                                        const VariablePixelBuffer &renderOutputBufferTiled, // normalized
                                        const float renderOutputBufferDefaultValue,
-                                       std::string &output,
+                                       PackTilesBuffer &output,
                                        const PrecisionMode precisionMode,
                                        const bool closestFilterStatus,
                                        const CoarsePassPrecision coarsePassPrecision,
                                        const FinePassPrecision finePassPrecision,
-                                       const bool withSha1Hash,
-                                       const EnqFormatVer enqFormatVer)
+                                       const bool withHash,
+                                       const EnqFormatVer enqFormatVer,
+                                       const HashType hashType,
+                                       const unsigned bandTotal)
 //
 // Creates VariableValue(float1|float2|float3|float4) : float * (1|2|3|4)
 //    
@@ -3345,8 +3786,10 @@ PackTilesImpl::encodeRenderOutputMerge(const ActivePixels &activePixels,
                       finePassPrecision,                      
                       activePixels,
                       output,
-                      withSha1Hash,
-                      [&](VContainerEnq &vContainerEnq) { // enqTilePixelBlockFunc
+                      withHash,
+                      hashType,
+                      bandTotal,
+                      [&](const ActivePixels &activePixels, VContainerEnq &vContainerEnq) { // enqTilePixelBlockFunc
                           switch (renderOutputBufferTiled.getFormat()) {
                           case fb_util::VariablePixelBuffer::FLOAT :
                               enqTilePixelBlockValNormalizedSrc
@@ -3474,7 +3917,8 @@ PackTilesImpl::decodeRenderOutput(const void* addr,
                    dataSize,
                    activePixels,
                    sha1HashDigest,
-                   [&](DataType dataType, float defaultValue,
+                   [&](const ActivePixels& activePixels, const bool setupOutput,
+                       DataType dataType, float defaultValue,
                        const PrecisionMode precisionMode,
                        bool closestFilterStatus,
                        CoarsePassPrecision currCoarsePassPrecision,
@@ -3488,8 +3932,10 @@ PackTilesImpl::decodeRenderOutput(const void* addr,
                        debugFootmarkPush();
 #                      endif // end DEBUG_FOOTMARK_DECODE_RENDEROUTPUT
                        {
-                           fbAov->setCoarsePassPrecision(currCoarsePassPrecision);
-                           fbAov->setFinePassPrecision(currFinePassPrecision);
+                           if (setupOutput) {
+                               fbAov->setCoarsePassPrecision(currCoarsePassPrecision);
+                               fbAov->setFinePassPrecision(currFinePassPrecision);
+                           }
 
 #                          ifdef DEBUG_FOOTMARK_DECODE_RENDEROUTPUT
                            debugFootmarkAdd([]() {
@@ -3535,11 +3981,13 @@ PackTilesImpl::decodeRenderOutput(const void* addr,
                            default :
                                return false;
                            }
-                           // need to set default value before call setup()
-                           fbAov->setDefaultValue(defaultValue);
+                           if (setupOutput) {
+                               // need to set default value before call setup()
+                               fbAov->setDefaultValue(defaultValue);
 
-                           // setup closestFilter related information
-                           fbAov->setClosestFilterStatus(closestFilterStatus);
+                               // setup closestFilter related information
+                               fbAov->setClosestFilterStatus(closestFilterStatus);
+                           }
 
 #                          ifdef DEBUG_FOOTMARK_DECODE_RENDEROUTPUT
                            debugFootmarkAdd([&]() {
@@ -3562,8 +4010,12 @@ PackTilesImpl::decodeRenderOutput(const void* addr,
                            // If no change reso and no change for fmt,
                            // we just skip both of re-allocation and clear for fbAov and try to
                            // overwrite decoded data onto previous result.
-                           fbAov->setup(nullptr, fmt, activePixels.getWidth(), activePixels.getHeight(),
-                                        storeNumSampleData);
+                           // Banded data only does this for the first band, other bands are decoded
+                           // in parallel into the same fbAov.
+                           if (setupOutput) {
+                               fbAov->setup(nullptr, fmt, activePixels.getWidth(), activePixels.getHeight(),
+                                            storeNumSampleData);
+                           }
 
 #                          ifdef DEBUG_FOOTMARK_DECODE_RENDEROUTPUT
                            debugFootmarkAdd([]() {
@@ -3878,30 +4330,33 @@ PackTilesImpl::decodeRenderOutput(const void* addr,
 // stataic function
 size_t
 PackTilesImpl::encodeRenderOutputReference(const FbReferenceType &referenceType,
-                                           std::string &output,
-                                           const bool withSha1Hash,
-                                           const EnqFormatVer enqFormatVer)
+                                           PackTilesBuffer &output,
+                                           const bool withHash,
+                                           const EnqFormatVer enqFormatVer,
+                                           const HashType hashType)
 {
     //------------------------------
     //
-    // dummy SHA1 hash data
+    // dummy hash data
     // hash located very beginning of packTile data. (before of formatVersion actually)
     // hash data is outside valueContainer region. This cause verify hash very easily for packTile data.
     // (See verifyDecodeHash()).
     //
-    size_t hashOffset = output.size();
+    std::string &main = output.getMain();
+    size_t hashOffset = main.size();
     for (size_t i = 0; i < HASH_SIZE; ++i) {
-        output.push_back(0x0);
+        main.push_back(0x0);
     }
-    size_t dataOffset = output.size(); // data start offset insize output string
+    size_t dataOffset = main.size(); // data start offset insize output string
 
     //------------------------------
     //
     // data encode
     //
-    VContainerEnq vContainerEnq(&output);
+    VContainerEnq vContainerEnq(&main);
 
-    enqHeaderBlock(enqFormatVer,
+    enqHeaderBlock(enqFormatVer, (withHash) ? hashType : HashType::SHA1,
+                   false, // banded
                    DataType::REFERENCE, referenceType,
                    nullptr,                  // const ActivePixels *
                    0.0f,                     // defaultValue
@@ -3912,20 +4367,21 @@ PackTilesImpl::encodeRenderOutputReference(const FbReferenceType &referenceType,
                    vContainerEnq);
 
     size_t dataSize = vContainerEnq.finalize(); // data size
+    output.addMainSegment(hashOffset, main.size() - hashOffset);
 
     //------------------------------
     //
     // revise and set proper hash value
     //
-    if (withSha1Hash) {
-        // When withSha1Hash = true, we compute hash and save to preallocated location.
+    if (withHash) {
+        // When withHash = true, we compute hash and save to preallocated location.
         const unsigned char *srcPtr =
-            reinterpret_cast<const unsigned char *>((uintptr_t)(output.data()) +
+            reinterpret_cast<const unsigned char *>((uintptr_t)(main.data()) +
                                                     static_cast<uintptr_t>(dataOffset));
         unsigned srcSize = dataSize;
-        unsigned char *dstPtr = reinterpret_cast<unsigned char *>((uintptr_t)(output.data()) +
+        unsigned char *dstPtr = reinterpret_cast<unsigned char *>((uintptr_t)(main.data()) +
                                                                   static_cast<uintptr_t>(hashOffset));
-        SHA1(srcPtr, srcSize, dstPtr);
+        computeHash(hashType, srcPtr, srcSize, dstPtr);
     }
 
     return dataSize + HASH_SIZE;
@@ -4032,6 +4488,7 @@ PackTilesImpl::show(const std::string &hd, const void *addr, const size_t dataSi
     VContainerDeq vContainerDeq(static_cast<const void *>(currAddr), dataSize - HASH_SIZE);
 
     unsigned formatVersion;
+    bool banded;
     DataType dataType;
     FbReferenceType referenceType;
     unsigned width, height;
@@ -4042,6 +4499,7 @@ PackTilesImpl::show(const std::string &hd, const void *addr, const size_t dataSi
     FinePassPrecision finePassPrecision;
     if (!deqHeaderBlock(vContainerDeq,
                         formatVersion,
+                        banded,
                         dataType, referenceType,
                         width, height, activeTileTotal, activePixelTotal, defaultValue,
                         precisionMode,
@@ -4071,24 +4529,35 @@ PackTilesImpl::show(const std::string &hd, const void *addr, const size_t dataSi
         numSampleBufferTiled.clear();
     }
 
-    deqTilePixelBlockValSample(vContainerDeq,
-                               precisionMode,
-                               activePixels,
-                               normalizedRenderBufferTiled,
-                               numSampleBufferTiled,
-                               true, // storeNumSampleData
-                               [&](RenderColor &v, unsigned int &numSample) { // lowPrecision
-                                   v = deqLowPrecisionVec4f(vContainerDeq);
-                                   vContainerDeq.deqVLUInt(numSample);
-                               },
-                               [&](RenderColor &v, unsigned int &numSample) { // halfPrecision
-                                   v = deqHalfPrecisionVec4f(vContainerDeq);
-                                   vContainerDeq.deqVLUInt(numSample);
-                               },
-                               [&](RenderColor &v, unsigned int &numSample) { // fullPrecision
-                                   v = vContainerDeq.deqVec4f();
-                                   numSample = vContainerDeq.deqVLUInt();
-                               });
+    auto deqPixelBlock = [&](const ActivePixels &currActivePixels,
+                             const bool /*setupOutput*/,
+                             VContainerDeq &pixelBlockDeq) -> bool {
+        deqTilePixelBlockValSample(pixelBlockDeq,
+                                   precisionMode,
+                                   currActivePixels,
+                                   normalizedRenderBufferTiled,
+                                   numSampleBufferTiled,
+                                   true, // storeNumSampleData
+                                   [&](RenderColor &v, unsigned int &numSample) { // lowPrecision
+                                       v = deqLowPrecisionVec4f(pixelBlockDeq);
+                                       pixelBlockDeq.deqVLUInt(numSample);
+                                   },
+                                   [&](RenderColor &v, unsigned int &numSample) { // halfPrecision
+                                       v = deqHalfPrecisionVec4f(pixelBlockDeq);
+                                       pixelBlockDeq.deqVLUInt(numSample);
+                                   },
+                                   [&](RenderColor &v, unsigned int &numSample) { // fullPrecision
+                                       v = pixelBlockDeq.deqVec4f();
+                                       numSample = pixelBlockDeq.deqVLUInt();
+                                   });
+        return true;
+    };
+    if (!((banded) ?
+          deqTilePixelBands(vContainerDeq, formatVersion, activePixels, deqPixelBlock) :
+          deqTilePixelBlock(vContainerDeq, formatVersion, activePixels, true, deqPixelBlock))) {
+        ostr << hd << "PackTiles::show() : decode pixel block failed";
+        return ostr.str();
+    }
 
     //------------------------------
     //
@@ -4097,6 +4566,7 @@ PackTilesImpl::show(const std::string &hd, const void *addr, const size_t dataSi
     ostr << hd << "PackTiles::show {\n";
     ostr << showHash(hd + "  ", sha1HashDigest) << '\n';    
     ostr << hd << "  formatVersion:" << formatVersion << '\n';
+    ostr << hd << "  banded:" << ((banded) ? "true" : "false") << '\n';
     ostr << hd << "  dataType:" << showDataType(dataType) << '\n';
     ostr << hd << "  referenceType:" << showFbReferenceType(referenceType) << '\n';
     ostr << hd << "  defaultValue:" << defaultValue << '\n';
@@ -4338,8 +4808,17 @@ PackTilesImpl::verifyDecodeHash(const void *addr, const size_t dataSize)
                                                 static_cast<uintptr_t>(HASH_SIZE));
     unsigned srcSize = static_cast<unsigned>(dataSize) - HASH_SIZE;
 
+    // The hash algorithm is recorded by the first item (formatVersion) of the header block which
+    // follows the size_t data size of the VContainer.
+    if (srcSize < sizeof(size_t) + rdl2::ValueContainerUtil::variableLengthIntMaxSize) return false;
+    unsigned formatVersionAndHashType, formatVersion;
+    HashType hashType;
+    bool banded;
+    rdl2::ValueContainerUtil::variableLengthDecoding(srcPtr + sizeof(size_t), formatVersionAndHashType);
+    if (!splitFormatVersion(formatVersionAndHashType, formatVersion, hashType, banded)) return false;
+
     unsigned char reCompHash[HASH_SIZE];
-    SHA1(srcPtr, srcSize, reCompHash);
+    computeHash(hashType, srcPtr, srcSize, reCompHash);
 
     for (unsigned i = 0; i < HASH_SIZE; ++i) {
         if (dataHash[i] != reCompHash[i]) return false;
@@ -4597,6 +5076,498 @@ PackTilesImpl::deqTileMaskBlockVer2(VContainerDeq &vContainerDeq,
     return PackActiveTiles::deqTileMaskBlock(vContainerDeq, activeTileTotal, activePixels);
 }
 
+// static function
+void
+PackTilesImpl::enqTilePixelBlockVer3(const ActivePixels &activePixels,
+                                     const DataType dataType,
+                                     const PrecisionMode precisionMode,
+                                     const std::string &pixelBlock,
+                                     VContainerEnq &vContainerEnq)
+//
+// VER3 pixel block encoding. Input is the VER2 pixel block (VContainer formatted) and all of its
+// bytes are kept losslessly.
+//   1) Split the pixel block into per-pixel records of value (valueBytes) and numSample.
+//   2) Replace each record by the difference from the previous record inside the same tile.
+//      Differences are computed as integers of laneBytes width, so they are exact regardless of
+//      the precisionMode. The first record of each tile is stored as is.
+//   3) Transpose differences into valueBytes byte planes and encode each plane by RansCodec.
+//      numSample is encoded as zigzag variable length differences by RansCodec as well.
+// Smooth gradients turn into small differences and most of the higher order byte planes become
+// nearly constant. If the pixel block does not split into records, it is encoded as a single
+// plane without prediction.
+//
+{
+    const unsigned char *raw =
+        reinterpret_cast<const unsigned char *>(pixelBlock.data()) + sizeof(size_t);
+    const size_t rawSize = pixelBlock.size() - sizeof(size_t);
+
+    std::vector<unsigned> recTotalTbl;
+    tileRecordTotal(activePixels, recTotalTbl);
+    size_t recTotal = 0;
+    for (unsigned tileRecTotal : recTotalTbl) recTotal += tileRecTotal;
+
+    bool withNumSample = false;
+    unsigned valueBytes = 0;
+    unsigned laneBytes = 1;
+    std::vector<unsigned char> values;
+    std::vector<unsigned> numSamples;
+    if (!findPixelRecordLayout(raw, rawSize, recTotal, dataType, precisionMode,
+                               withNumSample, valueBytes, laneBytes, values, numSamples)) {
+        withNumSample = false;
+        valueBytes = 0;
+        laneBytes = 1;
+    }
+
+    vContainerEnq.enqVLSizeT(rawSize);
+    vContainerEnq.enqVLUInt(valueBytes);
+    vContainerEnq.enqVLUInt(laneBytes);
+    vContainerEnq.enqBool(withNumSample);
+
+    std::string coded;
+    if (!valueBytes) {
+        RansCodec::encode(raw, rawSize, coded);
+    } else {
+        const unsigned char *valuePtr = (withNumSample) ? values.data() : raw;
+
+        std::vector<unsigned char> planes(recTotal * valueBytes);
+        std::vector<unsigned> numSampleDelta((withNumSample) ? recTotal : 0);
+        unsigned char delta[VER3_MAX_VALUE_BYTES];
+        size_t recId = 0;
+        for (unsigned tileRecTotal : recTotalTbl) {
+            for (unsigned r = 0; r < tileRecTotal; ++r, ++recId) {
+                const unsigned char *cur = valuePtr + recId * valueBytes;
+                if (r == 0) {
+                    std::memcpy(delta, cur, valueBytes);
+                } else {
+                    switch (laneBytes) {
+                    case 4 : deltaLanes<uint32_t>(cur, cur - valueBytes, delta, valueBytes); break;
+                    case 2 : deltaLanes<uint16_t>(cur, cur - valueBytes, delta, valueBytes); break;
+                    default : deltaLanes<uint8_t>(cur, cur - valueBytes, delta, valueBytes); break;
+                    }
+                }
+                for (unsigned b = 0; b < valueBytes; ++b) {
+                    planes[b * recTotal + recId] = delta[b];
+                }
+
+                if (withNumSample) {
+                    const unsigned prev = (r == 0) ? 0 : numSamples[recId - 1];
+                    const int d = static_cast<int>(numSamples[recId] - prev);
+                    numSampleDelta[recId] = // zigzag
+                        (static_cast<unsigned>(d) << 1) ^ static_cast<unsigned>(d >> 31);
+                }
+            }
+        }
+
+        for (unsigned b = 0; b < valueBytes; ++b) {
+            RansCodec::encode(&planes[b * recTotal], recTotal, coded);
+        }
+        if (withNumSample) {
+            constexpr size_t vlMax = rdl2::ValueContainerUtil::variableLengthIntMaxSize;
+            std::vector<unsigned char> vl(recTotal * vlMax + 32); // + padding for SIMD store
+            const size_t vlSize =
+                rdl2::ValueContainerUtil::variableLengthEncodingArray(numSampleDelta.data(),
+                                                                      recTotal, vl.data());
+            vContainerEnq.enqVLSizeT(vlSize);
+            RansCodec::encode(vl.data(), vlSize, coded);
+        }
+    }
+
+    vContainerEnq.enqVLSizeT(coded.size());
+    vContainerEnq.enqByteData(coded.data(), coded.size());
+}
+
+// static function
+bool
+PackTilesImpl::deqTilePixelBlockVer3(VContainerDeq &vContainerDeq,
+                                     const ActivePixels &activePixels,
+                                     std::string &pixelBlock)
+//
+// Restores the VER2 pixel block from VER3 data. activePixels should already be decoded from the
+// tileMask block. Returns false if the data is corrupted.
+//
+{
+    const size_t rawSize = vContainerDeq.deqVLSizeT();
+    const unsigned valueBytes = vContainerDeq.deqVLUInt();
+    const unsigned laneBytes = vContainerDeq.deqVLUInt();
+    const bool withNumSample = vContainerDeq.deqBool();
+    const size_t numSampleStreamSize = (withNumSample) ? vContainerDeq.deqVLSizeT() : 0;
+    const size_t codedSize = vContainerDeq.deqVLSizeT();
+    if (codedSize > vContainerDeq.getRestSize()) return false;
+    const unsigned char *coded =
+        static_cast<const unsigned char *>(vContainerDeq.skipByteData(codedSize));
+
+    std::vector<unsigned> recTotalTbl;
+    tileRecordTotal(activePixels, recTotalTbl);
+    size_t recTotal = 0;
+    for (unsigned tileRecTotal : recTotalTbl) recTotal += tileRecTotal;
+
+    // Reject sizes which could not come from any pixel block before allocating memory.
+    constexpr size_t vlMax = rdl2::ValueContainerUtil::variableLengthIntMaxSize;
+    if (!valueBytes) {
+        if (rawSize > recTotal * 256) return false;
+    } else {
+        if (valueBytes > VER3_MAX_VALUE_BYTES ||
+            (laneBytes != 1 && laneBytes != 2 && laneBytes != 4) ||
+            (valueBytes % laneBytes) != 0) {
+            return false;
+        }
+        if (withNumSample) {
+            if (rawSize < recTotal * (valueBytes + 1) || rawSize > recTotal * (valueBytes + vlMax) ||
+                numSampleStreamSize < recTotal || numSampleStreamSize > recTotal * vlMax) {
+                return false;
+            }
+        } else {
+            if (rawSize != recTotal * valueBytes) return false;
+        }
+    }
+
+    VContainerEnq vContainerEnq(&pixelBlock);
+    unsigned char *raw = static_cast<unsigned char *>(vContainerEnq.enqReserveMem(rawSize));
+
+    if (!valueBytes) {
+        if (RansCodec::decode(coded, codedSize, raw, rawSize) != codedSize) return false;
+        vContainerEnq.finalize();
+        return true;
+    }
+
+    //------------------------------
+    //
+    // entropy decode byte planes and numSample stream
+    //
+    std::vector<unsigned char> planes(recTotal * valueBytes);
+    size_t codedPos = 0;
+    for (unsigned b = 0; b < valueBytes; ++b) {
+        const size_t size = RansCodec::decode(coded + codedPos, codedSize - codedPos,
+                                              &planes[b * recTotal], recTotal);
+        if (!size) return false;
+        codedPos += size;
+    }
+    // + padding for the 16 byte loads of variableLengthDecodingArray()
+    std::vector<unsigned char> vl((withNumSample) ? numSampleStreamSize + 32 : 0, 0x0);
+    if (withNumSample) {
+        const size_t size = RansCodec::decode(coded + codedPos, codedSize - codedPos,
+                                              vl.data(), numSampleStreamSize);
+        if (!size) return false;
+        codedPos += size;
+
+        // The numSample stream has to hold exactly recTotal values and end with the last one.
+        // Otherwise a broken stream would let variableLengthDecodingArray() run past its end.
+        const size_t stopTotal =
+            std::count_if(vl.data(), vl.data() + numSampleStreamSize,
+                          [](const unsigned char c) { return !(c & 0x80); });
+        if (stopTotal != recTotal ||
+            (numSampleStreamSize && (vl[numSampleStreamSize - 1] & 0x80))) {
+            return false;
+        }
+    }
+    if (codedPos != codedSize) return false;
+
+    //------------------------------
+    //
+    // byte planes -> records -> undo per-tile delta prediction
+    //
+    std::vector<unsigned char> recBuff((withNumSample) ? recTotal * valueBytes : 0);
+    unsigned char *recs = (withNumSample) ? recBuff.data() : raw;
+    planesToRecords(planes.data(), recTotal, valueBytes, recs);
+    switch (laneBytes) {
+    case 4 : accumulateTileRecords<uint32_t>(recTotalTbl, recs, valueBytes); break;
+    case 2 : accumulateTileRecords<uint16_t>(recTotalTbl, recs, valueBytes); break;
+    default : accumulateTileRecords<uint8_t>(recTotalTbl, recs, valueBytes); break;
+    }
+
+    if (withNumSample) {
+        std::vector<unsigned> numSampleDelta(recTotal);
+        if (rdl2::ValueContainerUtil::variableLengthDecodingArray(vl.data(), recTotal,
+                                                                  numSampleDelta.data()) !=
+            numSampleStreamSize) {
+            return false;
+        }
+
+        // interleave value and numSample back into the VER2 record format
+        size_t rawPos = 0;
+        size_t recId = 0;
+        for (unsigned tileRecTotal : recTotalTbl) {
+            unsigned numSample = 0;
+            for (unsigned r = 0; r < tileRecTotal; ++r, ++recId) {
+                const unsigned zz = numSampleDelta[recId];
+                numSample += (zz >> 1) ^ (0U - (zz & 0x1)); // unzigzag
+
+                const size_t size = rdl2::ValueContainerUtil::variableLengthEncodingSize(numSample);
+                if (rawPos + valueBytes + size > rawSize) return false;
+                std::memcpy(raw + rawPos, recs + recId * valueBytes, valueBytes);
+                rawPos += valueBytes;
+                rawPos += rdl2::ValueContainerUtil::variableLengthEncoding(numSample, raw + rawPos);
+            }
+        }
+        if (rawPos != rawSize) return false;
+    }
+
+    vContainerEnq.finalize();
+    return true;
+}
+
+// static function
+void
+PackTilesImpl::splitTileBands(const ActivePixels &activePixels,
+                              const unsigned bandTotal,
+                              std::vector<unsigned> &bandEndTileId)
+//
+// Splits the tiles into at most bandTotal bands which have about the same number of active pixels.
+// Every band includes at least one active tile. bandEndTileId is the exclusive end tileId of each
+// band and the last one is always numTiles. The result might have fewer bands than bandTotal when
+// there are not enough active tiles.
+//
+{
+    bandEndTileId.clear();
+
+    const unsigned numTiles = activePixels.getNumTiles();
+    size_t pixTotal = 0;
+    for (unsigned tileId = 0; tileId < numTiles; ++tileId) {
+        pixTotal += __builtin_popcountll(activePixels.getTileMask(tileId));
+    }
+    const size_t maxBandTotal =
+        std::min(static_cast<size_t>(std::min(bandTotal, BAND_TOTAL_MAX)),
+                 static_cast<size_t>(activePixels.getActiveTileTotal()));
+    if (maxBandTotal < 2) return; // no need to split
+
+    size_t bandId = 0;
+    size_t pixCount = 0;
+    for (unsigned tileId = 0; tileId < numTiles; ++tileId) {
+        const uint64_t mask = activePixels.getTileMask(tileId);
+        if (!mask) continue;
+        pixCount += __builtin_popcountll(mask);
+        if (pixCount * maxBandTotal >= pixTotal * (bandId + 1)) {
+            bandEndTileId.push_back(tileId + 1);
+            // a big tile might cover more than one band
+            while (bandId < maxBandTotal && pixCount * maxBandTotal >= pixTotal * (bandId + 1)) {
+                ++bandId;
+            }
+        }
+    }
+    // The last band always closes at numTiles. The last active tile closes the last band, so only
+    // the trailing empty tiles are appended.
+    bandEndTileId.back() = numTiles;
+}
+
+// static function
+void
+PackTilesImpl::setupBandActivePixels(const ActivePixels &activePixels,
+                                     const unsigned startTileId,
+                                     const unsigned endTileId,
+                                     ActivePixels &bandActivePixels)
+{
+    bandActivePixels.init(activePixels.getWidth(), activePixels.getHeight());
+    bandActivePixels.reset();
+    for (unsigned tileId = startTileId; tileId < endTileId; ++tileId) {
+        bandActivePixels.setTileMask(tileId, activePixels.getTileMask(tileId));
+    }
+}
+
+// static function
+bool
+PackTilesImpl::deqTileBandIndex(VContainerDeq &vContainerDeq,
+                                const ActivePixels &activePixels,
+                                std::vector<unsigned> &bandEndTileId,
+                                std::vector<const void *> &bandAddr,
+                                std::vector<size_t> &bandSize)
+//
+// Reads the band index and returns the address and size of each band. activePixels should already
+// be decoded from the tileMask block. Returns false if the data is corrupted.
+//
+{
+    const unsigned numTiles = activePixels.getNumTiles();
+    const unsigned bandTotal = vContainerDeq.deqVLUInt();
+    if (bandTotal < 1 || bandTotal > BAND_TOTAL_MAX || bandTotal > numTiles) return false;
+
+    bandEndTileId.resize(bandTotal);
+    bandAddr.resize(bandTotal);
+    bandSize.resize(bandTotal);
+
+    unsigned prevEndTileId = 0;
+    size_t totalSize = 0;
+    for (unsigned bandId = 0; bandId < bandTotal; ++bandId) {
+        bandEndTileId[bandId] = vContainerDeq.deqVLUInt();
+        bandSize[bandId] = vContainerDeq.deqVLSizeT();
+        if (bandEndTileId[bandId] < prevEndTileId || bandEndTileId[bandId] > numTiles ||
+            bandSize[bandId] < sizeof(size_t) || bandSize[bandId] > vContainerDeq.getRestSize()) {
+            return false;
+        }
+        prevEndTileId = bandEndTileId[bandId];
+        totalSize += bandSize[bandId];
+    }
+    if (prevEndTileId != numTiles || totalSize > vContainerDeq.getRestSize()) return false;
+
+    for (unsigned bandId = 0; bandId < bandTotal; ++bandId) {
+        bandAddr[bandId] = vContainerDeq.skipByteData(bandSize[bandId]);
+    }
+    return true;
+}
+
+// static function
+bool
+PackTilesImpl::findPixelRecordLayout(const unsigned char *raw,
+                                     const size_t rawSize,
+                                     const size_t recTotal,
+                                     const DataType dataType,
+                                     const PrecisionMode precisionMode,
+                                     bool &withNumSample,
+                                     unsigned &valueBytes,
+                                     unsigned &laneBytes,
+                                     std::vector<unsigned char> &values,
+                                     std::vector<unsigned> &numSamples)
+//
+// Figures out the per-pixel record layout of the VER2 pixel block. The record layout depends on
+// dataType, precisionMode and the encode function (some of them always use float), so the layout
+// expected from dataType and precisionMode is tried first and then other channel/lane combinations.
+// A layout is only accepted when the whole pixel block parses with it. For numSample data, values
+// and numSamples return the split records.
+//
+{
+    if (!recTotal) return false;
+
+    unsigned channelTotal = 1;
+    switch (dataType) {
+    case DataType::BEAUTY_WITH_NUMSAMPLE :
+    case DataType::BEAUTYODD_WITH_NUMSAMPLE :
+    case DataType::FLOAT4_WITH_NUMSAMPLE :
+        withNumSample = true; channelTotal = 4; break;
+    case DataType::BEAUTY :
+    case DataType::BEAUTYODD :
+    case DataType::FLOAT4 :
+        withNumSample = false; channelTotal = 4; break;
+    case DataType::FLOAT3_WITH_NUMSAMPLE : withNumSample = true; channelTotal = 3; break;
+    case DataType::FLOAT3 : withNumSample = false; channelTotal = 3; break;
+    case DataType::FLOAT2_WITH_NUMSAMPLE : withNumSample = true; channelTotal = 2; break;
+    case DataType::FLOAT2 : withNumSample = false; channelTotal = 2; break;
+    case DataType::HEATMAP_WITH_NUMSAMPLE :
+    case DataType::FLOAT1_WITH_NUMSAMPLE :
+        withNumSample = true; channelTotal = 1; break;
+    case DataType::PIXELINFO :
+    case DataType::HEATMAP :
+    case DataType::FLOAT1 :
+    case DataType::WEIGHT :
+        withNumSample = false; channelTotal = 1; break;
+    default :
+        return false;
+    }
+
+    unsigned precisionLane = 4;
+    switch (precisionMode) {
+    case PackTiles::PrecisionMode::UC8 : precisionLane = 1; break;
+    case PackTiles::PrecisionMode::H16 : precisionLane = 2; break;
+    default : break;
+    }
+    const unsigned laneTbl[] = {precisionLane, 4, 2, 1};
+
+    std::vector<std::pair<unsigned, unsigned>> candidates; // (valueBytes, laneBytes)
+    auto addCandidate = [&](unsigned currValueBytes, unsigned currLaneBytes) {
+        for (const auto &itr : candidates) {
+            if (itr.first == currValueBytes) return;
+        }
+        candidates.emplace_back(currValueBytes, currLaneBytes);
+    };
+    for (unsigned lane : laneTbl) addCandidate(channelTotal * lane, lane);
+    for (unsigned lane : laneTbl) {
+        for (unsigned c = 4; c > 0; --c) addCandidate(c * lane, lane);
+    }
+
+    for (const auto &itr : candidates) {
+        const unsigned currValueBytes = itr.first;
+        if (!withNumSample) {
+            if (rawSize != recTotal * currValueBytes) continue;
+            valueBytes = currValueBytes;
+            laneBytes = itr.second;
+            return true;
+        }
+
+        if (rawSize < recTotal * (currValueBytes + 1)) continue;
+        values.resize(recTotal * currValueBytes);
+        numSamples.resize(recTotal);
+        size_t pos = 0;
+        size_t recId = 0;
+        for (; recId < recTotal; ++recId) {
+            if (pos + currValueBytes >= rawSize) break;
+            std::memcpy(&values[recId * currValueBytes], raw + pos, currValueBytes);
+            pos += currValueBytes;
+
+            // numSample : only accept canonical encoding, so re-encoding reproduces the same bytes
+            const size_t start = pos;
+            unsigned v = 0;
+            bool done = false;
+            for (unsigned shift = 0; shift < 32 && pos < rawSize; shift += 7) {
+                const unsigned char c = raw[pos++];
+                if (shift == 28 && (c & 0x70)) break; // overflow
+                v |= static_cast<unsigned>(c & 0x7f) << shift;
+                if (!(c & 0x80)) { done = true; break; }
+            }
+            if (!done || rdl2::ValueContainerUtil::variableLengthEncodingSize(v) != pos - start) break;
+            numSamples[recId] = v;
+        }
+        if (recId == recTotal && pos == rawSize) {
+            valueBytes = currValueBytes;
+            laneBytes = itr.second;
+            return true;
+        }
+    }
+    return false;
+}
+
+// static function
+void
+PackTilesImpl::tileRecordTotal(const ActivePixels &activePixels, std::vector<unsigned> &recTotalTbl)
+//
+// number of active pixels (= pixel records) of each active tile in activeTileCrawler order
+//
+{
+    recTotalTbl.clear();
+    recTotalTbl.reserve(activePixels.getActiveTileTotal());
+    activeTileCrawler(activePixels,
+                      [&](uint64_t mask, unsigned /*pixelOffset*/) {
+                          recTotalTbl.push_back(static_cast<unsigned>(_mm_popcnt_u64(mask)));
+                      });
+}
+
+// static function
+void
+PackTilesImpl::planesToRecords(const unsigned char *planes,
+                               const size_t recTotal,
+                               const unsigned valueBytes,
+                               unsigned char *recs)
+//
+// Transposes valueBytes byte planes of recTotal bytes each into recTotal records.
+//
+{
+    size_t recId = 0;
+#if defined(__SSE2__)
+    if (valueBytes == 16) {
+        // 16x16 byte transpose for 16 records at a time (RGBA float). Each round interleaves
+        // row i and row i+8, and 4 rounds complete the transpose.
+        for (; recId + 16 <= recTotal; recId += 16) {
+            __m128i x[16], y[16];
+            for (unsigned b = 0; b < 16; ++b) {
+                x[b] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(planes + b * recTotal + recId));
+            }
+            for (unsigned round = 0; round < 4; ++round) {
+                for (unsigned i = 0; i < 8; ++i) {
+                    y[i * 2] = _mm_unpacklo_epi8(x[i], x[i + 8]);
+                    y[i * 2 + 1] = _mm_unpackhi_epi8(x[i], x[i + 8]);
+                }
+                for (unsigned i = 0; i < 16; ++i) x[i] = y[i];
+            }
+            for (unsigned i = 0; i < 16; ++i) {
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(recs + (recId + i) * 16), x[i]);
+            }
+        }
+    }
+#endif // end __SSE2__
+    for (; recId < recTotal; ++recId) {
+        unsigned char *rec = recs + recId * valueBytes;
+        for (unsigned b = 0; b < valueBytes; ++b) {
+            rec[b] = planes[b * recTotal + recId];
+        }
+    }
+}
+
 // static function
 std::string
 PackTilesImpl::showRenderBufferDetail(const std::string &hd,
@@ -4959,6 +5930,8 @@ PackTilesImpl::calcBeautyDataSizeForTest(const ActivePixels &activePixels,
     std::string data;
     VContainerEnq vContainerEnq(&data);
     enqHeaderBlock(enqFormatVer,
+                   HashType::SHA1, // no hash
+                   false,          // banded
                    dataType,
                    FbReferenceType::UNDEF,
                    &activePixels,
@@ -5031,28 +6004,52 @@ PackTiles::encode(const bool renderBufferOdd,
                   const ActivePixels &activePixels,      // constructed by original w, h
                   const RenderBuffer &renderBufferTiled, // tile aligned reso : non normalized color
                   const FloatBuffer &weightBufferTiled,  // tile aligned resolution
-                  std::string &output,
+                  PackTilesBuffer &output,
                   const PrecisionMode precisionMode,
                   const CoarsePassPrecision coarsePassPrecision,
                   const FinePassPrecision finePassPrecision,
                   const bool noNumSampleMode,
-                  const bool withSha1Hash,
-                  const EnqFormatVer enqFormatVer)
+                  const bool withHash,
+                  const EnqFormatVer enqFormatVer,
+                  const HashType hashType,
+                  const unsigned bandTotal)
 {
     if (renderBufferOdd) {
         return PackTilesImpl::encode<true>(activePixels, renderBufferTiled, weightBufferTiled,
                                            output,
                                            precisionMode, coarsePassPrecision, finePassPrecision,
-                                           noNumSampleMode, withSha1Hash,
-                                           enqFormatVer);
+                                           noNumSampleMode, withHash,
+                                           enqFormatVer, hashType, bandTotal);
     } else {
         return PackTilesImpl::encode<false>(activePixels, renderBufferTiled, weightBufferTiled,
                                             output,
                                             precisionMode, coarsePassPrecision, finePassPrecision,
-                                            noNumSampleMode, withSha1Hash,
-                                            enqFormatVer);
+                                            noNumSampleMode, withHash,
+                                            enqFormatVer, hashType, bandTotal);
     }
 }
+
+// static function
+size_t
+PackTiles::encode(const bool renderBufferOdd,
+                  const ActivePixels &activePixels,      // constructed by original w, h
+                  const RenderBuffer &renderBufferTiled, // tile aligned reso : non normalized color
+                  const FloatBuffer &weightBufferTiled,  // tile aligned resolution
+                  std::string &output,
+                  const PrecisionMode precisionMode,
+                  const CoarsePassPrecision coarsePassPrecision,
+                  const FinePassPrecision finePassPrecision,
+                  const bool noNumSampleMode,
+                  const bool withHash,
+                  const EnqFormatVer enqFormatVer,
+                  const HashType hashType,
+                  const unsigned bandTotal)
+{
+    PackTilesBuffer buffer(output); // flat mode : same data as std::string output
+    return encode(renderBufferOdd, activePixels, renderBufferTiled, weightBufferTiled, buffer,
+                  precisionMode, coarsePassPrecision, finePassPrecision, noNumSampleMode, withHash,
+                  enqFormatVer, hashType, bandTotal);
+}
                   
 // for McrtMergeComputation
 // RGBA : float * 4
@@ -5061,23 +6058,45 @@ size_t
 PackTiles::encode(const bool renderBufferOdd,
                   const ActivePixels &activePixels,      // constructed by original w, h
                   const RenderBuffer &renderBufferTiled, // tile aligned reso : normalized color
-                  std::string &output,
+                  PackTilesBuffer &output,
                   const PrecisionMode precisionMode,
                   const CoarsePassPrecision coarsePassPrecision,
                   const FinePassPrecision finePassPrecision,
-                  const bool withSha1Hash,
-                  const EnqFormatVer enqFormatVer)
+                  const bool withHash,
+                  const EnqFormatVer enqFormatVer,
+                  const HashType hashType,
+                  const unsigned bandTotal)
 {
     if (renderBufferOdd) {
         return PackTilesImpl::encode<true>(activePixels, renderBufferTiled, output,
                                            precisionMode, coarsePassPrecision, finePassPrecision,
-                                           withSha1Hash, enqFormatVer);
+                                           withHash, enqFormatVer, hashType, bandTotal);
     } else {
         return PackTilesImpl::encode<false>(activePixels, renderBufferTiled, output,
                                             precisionMode, coarsePassPrecision, finePassPrecision,
-                                            withSha1Hash, enqFormatVer);
+                                            withHash, enqFormatVer, hashType, bandTotal);
     }
 }
+
+// static function
+size_t
+PackTiles::encode(const bool renderBufferOdd,
+                  const ActivePixels &activePixels,      // constructed by original w, h
+                  const RenderBuffer &renderBufferTiled, // tile aligned reso : normalized color
+                  std::string &output,
+                  const PrecisionMode precisionMode,
+                  const CoarsePassPrecision coarsePassPrecision,
+                  const FinePassPrecision finePassPrecision,
+                  const bool withHash,
+                  const EnqFormatVer enqFormatVer,
+                  const HashType hashType,
+                  const unsigned bandTotal)
+{
+    PackTilesBuffer buffer(output); // flat mode : same data as std::string output
+    return encode(renderBufferOdd, activePixels, renderBufferTiled, buffer, precisionMode,
+                  coarsePassPrecision, finePassPrecision, withHash, enqFormatVer, hashType,
+                  bandTotal);
+}
                   
 // for McrtMergeComputation : for feedabck logic between merge and mcrt computation
 // RGBA + numSample : float * 4 + u_int
@@ -5087,26 +6106,49 @@ PackTiles::encode(const bool renderBufferOdd,
                   const ActivePixels& activePixels,      // constructed by original w, h
                   const RenderBuffer& renderBufferTiled, // tile aligned reso : normalized color
                   const NumSampleBuffer& numSampleBufferTiled, // numSample data for renderBuffer
-                  std::string &output,
+                  PackTilesBuffer &output,
                   const PrecisionMode precisionMode, // current precision mode
                   const CoarsePassPrecision coarsePassPrecision, // minimum coarse pass precision
                   const FinePassPrecision finePassPrecision, // minimum fine pass precision
-                  const bool withSha1Hash,
-                  const EnqFormatVer enqFormatVer)
+                  const bool withHash,
+                  const EnqFormatVer enqFormatVer,
+                  const HashType hashType,
+                  const unsigned bandTotal)
 {
     if (renderBufferOdd) {
         return PackTilesImpl::encode<true>(activePixels, renderBufferTiled, numSampleBufferTiled,
                                            output,
                                            precisionMode, coarsePassPrecision, finePassPrecision,
-                                           withSha1Hash, enqFormatVer);
+                                           withHash, enqFormatVer, hashType, bandTotal);
     } else {
         return PackTilesImpl::encode<false>(activePixels, renderBufferTiled, numSampleBufferTiled,
                                             output,
                                             precisionMode, coarsePassPrecision, finePassPrecision,
-                                            withSha1Hash, enqFormatVer);
+                                            withHash, enqFormatVer, hashType, bandTotal);
     }
 }
 
+// static function
+size_t
+PackTiles::encode(const bool renderBufferOdd,
+                  const ActivePixels& activePixels,      // constructed by original w, h
+                  const RenderBuffer& renderBufferTiled, // tile aligned reso : normalized color
+                  const NumSampleBuffer& numSampleBufferTiled, // numSample data for renderBuffer
+                  std::string &output,
+                  const PrecisionMode precisionMode, // current precision mode
+                  const CoarsePassPrecision coarsePassPrecision, // minimum coarse pass precision
+                  const FinePassPrecision finePassPrecision, // minimum fine pass precision
+                  const bool withHash,
+                  const EnqFormatVer enqFormatVer,
+                  const HashType hashType,
+                  const unsigned bandTotal)
+{
+    PackTilesBuffer buffer(output); // flat mode : same data as std::string output
+    return encode(renderBufferOdd, activePixels, renderBufferTiled, numSampleBufferTiled, buffer,
+                  precisionMode, coarsePassPrecision, finePassPrecision, withHash, enqFormatVer,
+                  hashType, bandTotal);
+}
+
 // RGBA + numSample : float * 4 + u_int
 // static function
 bool
@@ -5186,19 +6228,40 @@ PackTiles::decode(const bool renderBufferOdd,                // in
 size_t
 PackTiles::encodePixelInfo(const ActivePixels &activePixels,
                            const PixelInfoBuffer &pixelInfoBufferTiled,
-                           std::string &output,
+                           PackTilesBuffer &output,
                            const PrecisionMode precisionMode,
                            const CoarsePassPrecision coarsePassPrecision,
                            const FinePassPrecision finePassPrecision,
-                           const bool withSha1Hash,
-                           const EnqFormatVer enqFormatVer)
+                           const bool withHash,
+                           const EnqFormatVer enqFormatVer,
+                           const HashType hashType,
+                           const unsigned bandTotal)
 {
     return PackTilesImpl::encodePixelInfo(activePixels, pixelInfoBufferTiled,
                                           output,
                                           precisionMode,
                                           coarsePassPrecision,
                                           finePassPrecision,
-                                          withSha1Hash, enqFormatVer);
+                                          withHash, enqFormatVer, hashType, bandTotal);
+}
+
+// static function
+size_t
+PackTiles::encodePixelInfo(const ActivePixels &activePixels,
+                           const PixelInfoBuffer &pixelInfoBufferTiled,
+                           std::string &output,
+                           const PrecisionMode precisionMode,
+                           const CoarsePassPrecision coarsePassPrecision,
+                           const FinePassPrecision finePassPrecision,
+                           const bool withHash,
+                           const EnqFormatVer enqFormatVer,
+                           const HashType hashType,
+                           const unsigned bandTotal)
+{
+    PackTilesBuffer buffer(output); // flat mode : same data as std::string output
+    return encodePixelInfo(activePixels, pixelInfoBufferTiled, buffer, precisionMode,
+                           coarsePassPrecision, finePassPrecision, withHash, enqFormatVer, hashType,
+                           bandTotal);
 }
 
 // static function
@@ -5232,14 +6295,33 @@ size_t
 PackTiles::encodeHeatMap(const ActivePixels &activePixels,
                          const FloatBuffer &heatMapSecBufferTiled, // non normalize sec
                          const FloatBuffer &heatMapWeightBufferTiled,
-                         std::string &output,
+                         PackTilesBuffer &output,
                          const bool noNumSampleMode,
-                         const bool withSha1Hash,
-                         const EnqFormatVer enqFormatVer)
+                         const bool withHash,
+                         const EnqFormatVer enqFormatVer,
+                         const HashType hashType,
+                         const unsigned bandTotal)
 {
     return PackTilesImpl::encodeHeatMap(activePixels, heatMapSecBufferTiled, heatMapWeightBufferTiled,
                                         output,
-                                        noNumSampleMode, withSha1Hash, enqFormatVer);
+                                        noNumSampleMode, withHash, enqFormatVer, hashType, bandTotal);
+}
+
+// static function
+size_t
+PackTiles::encodeHeatMap(const ActivePixels &activePixels,
+                         const FloatBuffer &heatMapSecBufferTiled, // non normalize sec
+                         const FloatBuffer &heatMapWeightBufferTiled,
+                         std::string &output,
+                         const bool noNumSampleMode,
+                         const bool withHash,
+                         const EnqFormatVer enqFormatVer,
+                         const HashType hashType,
+                         const unsigned bandTotal)
+{
+    PackTilesBuffer buffer(output); // flat mode : same data as std::string output
+    return encodeHeatMap(activePixels, heatMapSecBufferTiled, heatMapWeightBufferTiled, buffer,
+                         noNumSampleMode, withHash, enqFormatVer, hashType, bandTotal);
 }
 
 // Sec : float * 1
@@ -5247,13 +6329,30 @@ PackTiles::encodeHeatMap(const ActivePixels &activePixels,
 size_t
 PackTiles::encodeHeatMap(const ActivePixels &activePixels,
                          const FloatBuffer &heatMapSecBufferTiled, // normalize sec
-                         std::string &output,
-                         const bool withSha1Hash,
-                         const EnqFormatVer enqFormatVer)
+                         PackTilesBuffer &output,
+                         const bool withHash,
+                         const EnqFormatVer enqFormatVer,
+                         const HashType hashType,
+                         const unsigned bandTotal)
 {
     return PackTilesImpl::encodeHeatMap(activePixels, heatMapSecBufferTiled,
                                         output,
-                                        withSha1Hash, enqFormatVer);
+                                        withHash, enqFormatVer, hashType, bandTotal);
+}
+
+// static function
+size_t
+PackTiles::encodeHeatMap(const ActivePixels &activePixels,
+                         const FloatBuffer &heatMapSecBufferTiled, // normalize sec
+                         std::string &output,
+                         const bool withHash,
+                         const EnqFormatVer enqFormatVer,
+                         const HashType hashType,
+                         const unsigned bandTotal)
+{
+    PackTilesBuffer buffer(output); // flat mode : same data as std::string output
+    return encodeHeatMap(activePixels, heatMapSecBufferTiled, buffer, withHash, enqFormatVer,
+                         hashType, bandTotal);
 }
 
 // Sec + numSample : float * 1 + u_int
@@ -5302,12 +6401,14 @@ PackTiles::decodeHeatMap(const void* addr,                      // in
 size_t
 PackTiles::encodeWeightBuffer(const ActivePixels &activePixels,
                               const FloatBuffer &weightBufferTiled,
-                              std::string &output,
+                              PackTilesBuffer &output,
                               const PrecisionMode precisionMode,
                               const CoarsePassPrecision coarsePassPrecision,
                               const FinePassPrecision finePassPrecision,
-                              const bool withSha1Hash,
-                              const EnqFormatVer enqFormatVer)
+                              const bool withHash,
+                              const EnqFormatVer enqFormatVer,
+                              const HashType hashType,
+                              const unsigned bandTotal)
 {
     return PackTilesImpl::encodeWeightBuffer(activePixels,
                                              weightBufferTiled,
@@ -5315,8 +6416,27 @@ PackTiles::encodeWeightBuffer(const ActivePixels &activePixels,
                                              precisionMode,
                                              coarsePassPrecision,
                                              finePassPrecision,
-                                             withSha1Hash,
-                                             enqFormatVer);
+                                             withHash,
+                                             enqFormatVer, hashType, bandTotal);
+}
+
+// static function
+size_t
+PackTiles::encodeWeightBuffer(const ActivePixels &activePixels,
+                              const FloatBuffer &weightBufferTiled,
+                              std::string &output,
+                              const PrecisionMode precisionMode,
+                              const CoarsePassPrecision coarsePassPrecision,
+                              const FinePassPrecision finePassPrecision,
+                              const bool withHash,
+                              const EnqFormatVer enqFormatVer,
+                              const HashType hashType,
+                              const unsigned bandTotal)
+{
+    PackTilesBuffer buffer(output); // flat mode : same data as std::string output
+    return encodeWeightBuffer(activePixels, weightBufferTiled, buffer, precisionMode,
+                              coarsePassPrecision, finePassPrecision, withHash, enqFormatVer,
+                              hashType, bandTotal);
 }
 
 // static function
@@ -5353,7 +6473,7 @@ PackTiles::encodeRenderOutput(const ActivePixels &activePixels,
                               const VariablePixelBuffer &renderOutputBufferTiled, // non normalized value
                               const float renderOutputBufferDefaultValue,
                               const FloatBuffer &renderOutputWeightBufferTiled,
-                              std::string &output,
+                              PackTilesBuffer &output,
                               const PrecisionMode precisionMode,
                               const bool noNumSampleMode,
                               const bool doNormalizeMode,
@@ -5361,8 +6481,10 @@ PackTiles::encodeRenderOutput(const ActivePixels &activePixels,
                               const unsigned closestFilterAovOriginalNumChan,
                               const CoarsePassPrecision coarsePassPrecision,
                               const FinePassPrecision finePassPrecision,
-                              const bool withSha1Hash,
-                              const EnqFormatVer enqFormatVer)
+                              const bool withHash,
+                              const EnqFormatVer enqFormatVer,
+                              const HashType hashType,
+                              const unsigned bandTotal)
 // closestFilterAovOriginalNumChan is only used when closestFilterStatus is true
 {
     return PackTilesImpl::encodeRenderOutput(activePixels,
@@ -5377,8 +6499,35 @@ PackTiles::encodeRenderOutput(const ActivePixels &activePixels,
                                              closestFilterAovOriginalNumChan,
                                              coarsePassPrecision,
                                              finePassPrecision,
-                                             withSha1Hash,
-                                             enqFormatVer);
+                                             withHash,
+                                             enqFormatVer, hashType, bandTotal);
+}
+
+// static function
+size_t
+PackTiles::encodeRenderOutput(const ActivePixels &activePixels,
+                              const VariablePixelBuffer &renderOutputBufferTiled, // non normalized value
+                              const float renderOutputBufferDefaultValue,
+                              const FloatBuffer &renderOutputWeightBufferTiled,
+                              std::string &output,
+                              const PrecisionMode precisionMode,
+                              const bool noNumSampleMode,
+                              const bool doNormalizeMode,
+                              const bool closestFilterStatus,
+                              const unsigned closestFilterAovOriginalNumChan,
+                              const CoarsePassPrecision coarsePassPrecision,
+                              const FinePassPrecision finePassPrecision,
+                              const bool withHash,
+                              const EnqFormatVer enqFormatVer,
+                              const HashType hashType,
+                              const unsigned bandTotal)
+{
+    PackTilesBuffer buffer(output); // flat mode : same data as std::string output
+    return encodeRenderOutput(activePixels, renderOutputBufferTiled, renderOutputBufferDefaultValue,
+                              renderOutputWeightBufferTiled, buffer, precisionMode, noNumSampleMode,
+                              doNormalizeMode, closestFilterStatus, closestFilterAovOriginalNumChan,
+                              coarsePassPrecision, finePassPrecision, withHash, enqFormatVer,
+                              hashType, bandTotal);
 }
     
 // for mcrt_dataio::MergeFbSender (progmcrtmerge)
@@ -5388,13 +6537,15 @@ size_t
 PackTiles::encodeRenderOutputMerge(const ActivePixels &activePixels,
                                    const VariablePixelBuffer &renderOutputBufferTiled, // normalized
                                    const float renderOutputBufferDefaultValue,
-                                   std::string &output,
+                                   PackTilesBuffer &output,
                                    const PrecisionMode precisionMode,
                                    const bool closestFilterStatus,
                                    const CoarsePassPrecision coarsePassPrecision,
                                    const FinePassPrecision finePassPrecision,
-                                   const bool withSha1Hash,
-                                   const EnqFormatVer enqFormatVer)
+                                   const bool withHash,
+                                   const EnqFormatVer enqFormatVer,
+                                   const HashType hashType,
+                                   const unsigned bandTotal)
 {
     return PackTilesImpl::encodeRenderOutputMerge(activePixels,
                                                   renderOutputBufferTiled,
@@ -5404,8 +6555,30 @@ PackTiles::encodeRenderOutputMerge(const ActivePixels &activePixels,
                                                   closestFilterStatus,
                                                   coarsePassPrecision,
                                                   finePassPrecision,
-                                                  withSha1Hash,
-                                                  enqFormatVer);
+                                                  withHash,
+                                                  enqFormatVer, hashType, bandTotal);
+}
+
+// static function
+size_t
+PackTiles::encodeRenderOutputMerge(const ActivePixels &activePixels,
+                                   const VariablePixelBuffer &renderOutputBufferTiled, // normalized
+                                   const float renderOutputBufferDefaultValue,
+                                   std::string &output,
+                                   const PrecisionMode precisionMode,
+                                   const bool closestFilterStatus,
+                                   const CoarsePassPrecision coarsePassPrecision,
+                                   const FinePassPrecision finePassPrecision,
+                                   const bool withHash,
+                                   const EnqFormatVer enqFormatVer,
+                                   const HashType hashType,
+                                   const unsigned bandTotal)
+{
+    PackTilesBuffer buffer(output); // flat mode : same data as std::string output
+    return encodeRenderOutputMerge(activePixels, renderOutputBufferTiled,
+                                   renderOutputBufferDefaultValue, buffer, precisionMode,
+                                   closestFilterStatus, coarsePassPrecision, finePassPrecision,
+                                   withHash, enqFormatVer, hashType, bandTotal);
 }
 
 // VariableValue(float1|float2|float3|float4) + numSample : float * (1|2|3|4) + u_int
@@ -5435,14 +6608,27 @@ PackTiles::decodeRenderOutput(const void* addr,           // in
 //
 // RenderOutput reference buffer
 //
+// static function
+size_t
+PackTiles::encodeRenderOutputReference(const FbReferenceType &referenceType,
+                                       PackTilesBuffer &output,
+                                       const bool withHash,
+                                       const EnqFormatVer enqFormatVer,
+                                       const HashType hashType)
+{
+    return PackTilesImpl::encodeRenderOutputReference(referenceType, output, withHash, enqFormatVer, hashType);
+}
+
 // static function
 size_t
 PackTiles::encodeRenderOutputReference(const FbReferenceType &referenceType,
                                        std::string &output,
-                                       const bool withSha1Hash,
-                                       const EnqFormatVer enqFormatVer)
+                                       const bool withHash,
+                                       const EnqFormatVer enqFormatVer,
+                                       const HashType hashType)
 {
-    return PackTilesImpl::encodeRenderOutputReference(referenceType, output, withSha1Hash, enqFormatVer);
+    PackTilesBuffer buffer(output); // flat mode : same data as std::string output
+    return encodeRenderOutputReference(referenceType, buffer, withHash, enqFormatVer, hashType);
 }
     
 // static function
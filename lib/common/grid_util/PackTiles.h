@@ -26,6 +26,7 @@
 
 #include "Fb.h"
 #include "FbReferenceType.h"
+#include "PackTilesBuffer.h"
 #include "PackTilesPassPrecision.h"
 
 #include <scene_rdl2/common/fb_util/FbTypes.h>
@@ -59,16 +60,38 @@ public:
     using VContainerDeq = rdl2::ValueContainerDeq;
     using VContainerEnq = rdl2::ValueContainerEnq;
 
-    static constexpr unsigned HASH_SIZE = 20; // SHA1 hash size : byte
+    static constexpr unsigned HASH_SIZE = 20; // hash region size at the top of the data : byte
 
     // PackTile format version for encoding(i.e. enqueue) operation.
-    // We can encode (i.e. enqueue) both of VER1 and VER2 based on argument of enqFormatVer of
-    // encode*() Current default is VER2.
+    // We can encode (i.e. enqueue) VER1, VER2 and VER3 based on argument of enqFormatVer of
+    // encode*() Current default is VER2. Decode functions understand all of them.
     enum class EnqFormatVer : unsigned int {
         VER1 = 1, // original naive tileId/pixelMask output version
-        VER2 = 2  // optimized tileId/pixelMask output by PackActiveTiles
+        VER2 = 2, // optimized tileId/pixelMask output by PackActiveTiles
+        VER3 = 3  // VER2 + pixel values are compressed by per-tile delta prediction and rANS
+                  // entropy coding. Lossless against VER2 at the same precisionMode.
     };
 
+    // Hash algorithm for the hash region at the top of the encoded data (withHash = true).
+    // The hashType is recorded in the header block, so verifyDecodeHash() picks the same algorithm.
+    // CRC32C is a 128bit hash by 4 interleaved CRC32C lanes (See Crc32cUtil). It is an order of
+    // magnitude faster than SHA1 and is enough to detect data corruption. SHA1 data has exactly the
+    // same format as before hashType was added, so use SHA1 if old decoders need to read the data.
+    enum class HashType : unsigned int {
+        SHA1 = 0,  // 20 bytes
+        CRC32C = 1 // 16 bytes + zero padding
+    };
+
+    // bandTotal of encode*() : the pixel block is split into up to bandTotal bands (ranges of
+    // tiles with about the same number of active pixels). Bands are encoded and decoded in parallel
+    // by TBB. Decode functions detect banded data automatically. bandTotal = 1 (default) outputs
+    // exactly the same format as before bandTotal was added. Banded data needs VER2 or later.
+
+    // output of encode*() : every encode API has a std::string version and a PackTilesBuffer
+    // version. Both append the encoded data and output exactly the same bytes. The PackTilesBuffer
+    // version keeps banded pixel blocks as separate segments instead of copying them into one
+    // string (See PackTilesBuffer::getIovec()) and reuses its memory across frames.
+
     enum class PrecisionMode : char {
         F32, // using full 32bit float
         H16, // using half 16bit float
@@ -121,8 +144,24 @@ public:
            const CoarsePassPrecision coarsePassPrecision, // minimum coarse pass precision
            const FinePassPrecision finePassPrecision,     // minimum fine pass precision
            const bool noNumSampleMode,
-           const bool withSha1Hash = false,
-           const EnqFormatVer enqFormatVer = EnqFormatVer::VER2);
+           const bool withHash = false,
+           const EnqFormatVer enqFormatVer = EnqFormatVer::VER2,
+           const HashType hashType = HashType::CRC32C,
+           const unsigned bandTotal = 1);
+    static size_t
+    encode(const bool renderBufferOdd,
+           const ActivePixels &activePixels,      // constructed by original w, h
+           const RenderBuffer &renderBufferTiled, // tile aligned reso : non normalized color
+           const FloatBuffer &weightBufferTiled,  // tile aligned resolution
+           PackTilesBuffer &output,
+           const PrecisionMode precisionMode,             // current precision mode
+           const CoarsePassPrecision coarsePassPrecision, // minimum coarse pass precision
+           const FinePassPrecision finePassPrecision,     // minimum fine pass precision
+           const bool noNumSampleMode,
+           const bool withHash = false,
+           const EnqFormatVer enqFormatVer = EnqFormatVer::VER2,
+           const HashType hashType = HashType::CRC32C,
+           const unsigned bandTotal = 1);
 
     // for McrtMergeComputation
     // RGBA : float * 4
@@ -134,8 +173,22 @@ public:
            const PrecisionMode precisionMode,             // current precision mode
            const CoarsePassPrecision coarsePassPrecision, // minimum coarse pass precision
            const FinePassPrecision finePassPrecision,     // minimum fine pass precision
-           const bool withSha1Hash = false,
-           const EnqFormatVer enqFormatVer = EnqFormatVer::VER2);
+           const bool withHash = false,
+           const EnqFormatVer enqFormatVer = EnqFormatVer::VER2,
+           const HashType hashType = HashType::CRC32C,
+           const unsigned bandTotal = 1);
+    static size_t
+    encode(const bool renderBufferOdd,
+           const ActivePixels &activePixels,      // constructed by original w, h
+           const RenderBuffer &renderBufferTiled, // tile aligned reso : normalized color
+           PackTilesBuffer &output,
+           const PrecisionMode precisionMode,             // current precision mode
+           const CoarsePassPrecision coarsePassPrecision, // minimum coarse pass precision
+           const FinePassPrecision finePassPrecision,     // minimum fine pass precision
+           const bool withHash = false,
+           const EnqFormatVer enqFormatVer = EnqFormatVer::VER2,
+           const HashType hashType = HashType::CRC32C,
+           const unsigned bandTotal = 1);
 
     // for McrtMergeComputation : for feedback logic between merge and mcrt computation
     // RGBA + numSample : float * 4 + u_int
@@ -148,8 +201,23 @@ public:
            const PrecisionMode precisionMode, // current precision mode
            const CoarsePassPrecision coarsePassPrecision, // minimum coarse pass precision
            const FinePassPrecision finePassPrecision,     // minimum fine pass precision
-           const bool withSha1Hash = false,
-           const EnqFormatVer enqFormatVer = EnqFormatVer::VER2);
+           const bool withHash = false,
+           const EnqFormatVer enqFormatVer = EnqFormatVer::VER2,
+           const HashType hashType = HashType::CRC32C,
+           const unsigned bandTotal = 1);
+    static size_t
+    encode(const bool renderBufferOdd,
+           const ActivePixels& activePixels, // constructed by original w, h
+           const RenderBuffer& renderBufferTiled, // tile aligned reso : normalized color
+           const NumSampleBuffer& numSampleBufferTiled, // numSample data for renderbuffer
+           PackTilesBuffer &output,
+           const PrecisionMode precisionMode, // current precision mode
+           const CoarsePassPrecision coarsePassPrecision, // minimum coarse pass precision
+           const FinePassPrecision finePassPrecision,     // minimum fine pass precision
+           const bool withHash = false,
+           const EnqFormatVer enqFormatVer = EnqFormatVer::VER2,
+           const HashType hashType = HashType::CRC32C,
+           const unsigned bandTotal = 1);
 
     // RGBA + numSample : float * 4 + u_int
     static bool
@@ -191,8 +259,21 @@ public:
                     const PrecisionMode precisionMode,             // current precision mode
                     const CoarsePassPrecision coarsePassPrecision, // minimum coarse pass precision
                     const FinePassPrecision finePassPrecision,     // minimum fine pass precision
-                    const bool withSha1Hash = false,
-                    const EnqFormatVer enqFormatVer = EnqFormatVer::VER2);
+                    const bool withHash = false,
+                    const EnqFormatVer enqFormatVer = EnqFormatVer::VER2,
+                    const HashType hashType = HashType::CRC32C,
+                    const unsigned bandTotal = 1);
+    static size_t
+    encodePixelInfo(const ActivePixels &activePixels,
+                    const PixelInfoBuffer &pixelInfoBufferTiled,
+                    PackTilesBuffer &output,
+                    const PrecisionMode precisionMode,             // current precision mode
+                    const CoarsePassPrecision coarsePassPrecision, // minimum coarse pass precision
+                    const FinePassPrecision finePassPrecision,     // minimum fine pass precision
+                    const bool withHash = false,
+                    const EnqFormatVer enqFormatVer = EnqFormatVer::VER2,
+                    const HashType hashType = HashType::CRC32C,
+                    const unsigned bandTotal = 1);
 
     static bool
     decodePixelInfo(const void* addr,                         // in
@@ -218,8 +299,20 @@ public:
                   const FloatBuffer &heatMapWeightBufferTiled,
                   std::string &output,
                   const bool noNumSampleMode,
-                  const bool withSha1Hash = false,
-                  const EnqFormatVer enqFormatVer = EnqFormatVer::VER2);
+                  const bool withHash = false,
+                  const EnqFormatVer enqFormatVer = EnqFormatVer::VER2,
+                  const HashType hashType = HashType::CRC32C,
+                  const unsigned bandTotal = 1);
+    static size_t
+    encodeHeatMap(const ActivePixels &activePixels,
+                  const FloatBuffer &heatMapSecBufferTiled, // non normalize sec
+                  const FloatBuffer &heatMapWeightBufferTiled,
+                  PackTilesBuffer &output,
+                  const bool noNumSampleMode,
+                  const bool withHash = false,
+                  const EnqFormatVer enqFormatVer = EnqFormatVer::VER2,
+                  const HashType hashType = HashType::CRC32C,
+                  const unsigned bandTotal = 1);
 
     // Sec : float * 1
     // no precision related argument because heatMap always uses H16
@@ -227,8 +320,18 @@ public:
     encodeHeatMap(const ActivePixels &activePixels,
                   const FloatBuffer &heatMapSecBufferTiled, // normalize sec
                   std::string &output,
-                  const bool withSha1Hash = false,
-                  const EnqFormatVer enqFormatVer = EnqFormatVer::VER2);
+                  const bool withHash = false,
+                  const EnqFormatVer enqFormatVer = EnqFormatVer::VER2,
+                  const HashType hashType = HashType::CRC32C,
+                  const unsigned bandTotal = 1);
+    static size_t
+    encodeHeatMap(const ActivePixels &activePixels,
+                  const FloatBuffer &heatMapSecBufferTiled, // normalize sec
+                  PackTilesBuffer &output,
+                  const bool withHash = false,
+                  const EnqFormatVer enqFormatVer = EnqFormatVer::VER2,
+                  const HashType hashType = HashType::CRC32C,
+                  const unsigned bandTotal = 1);
 
     // Sec + numSample : float * 1 + u_int
     // no precision related argument because heatMap always uses H16
@@ -266,8 +369,21 @@ public:
                        const PrecisionMode precisionMode,             // current precision mode
                        const CoarsePassPrecision coarsePassPrecision, // minimum coarse pass precision
                        const FinePassPrecision finePassPrecision,     // minimum fine pass precision
-                       const bool withSha1Hash = false,
-                       const EnqFormatVer enqFormatVer = EnqFormatVer::VER2);
+                       const bool withHash = false,
+                       const EnqFormatVer enqFormatVer = EnqFormatVer::VER2,
+                       const HashType hashType = HashType::CRC32C,
+                       const unsigned bandTotal = 1);
+    static size_t
+    encodeWeightBuffer(const ActivePixels &activePixels,
+                       const FloatBuffer &weightBufferTiled,
+                       PackTilesBuffer &output,
+                       const PrecisionMode precisionMode,             // current precision mode
+                       const CoarsePassPrecision coarsePassPrecision, // minimum coarse pass precision
+                       const FinePassPrecision finePassPrecision,     // minimum fine pass precision
+                       const bool withHash = false,
+                       const EnqFormatVer enqFormatVer = EnqFormatVer::VER2,
+                       const HashType hashType = HashType::CRC32C,
+                       const unsigned bandTotal = 1);
 
     static bool
     decodeWeightBuffer(const void* addr,               // in
@@ -302,8 +418,27 @@ public:
                        const unsigned closestFilterAovOriginalNumChan, // only use closestFilter on
                        const CoarsePassPrecision coarsePassPrecision,  // minimum coarse pass precision
                        const FinePassPrecision finePassPrecision,      // minimum fine pass precision
-                       const bool withSha1Hash = false,
-                       const EnqFormatVer enqFormatVer = EnqFormatVer::VER2);
+                       const bool withHash = false,
+                       const EnqFormatVer enqFormatVer = EnqFormatVer::VER2,
+                       const HashType hashType = HashType::CRC32C,
+                       const unsigned bandTotal = 1);
+    static size_t
+    encodeRenderOutput(const ActivePixels &activePixels,
+                       const VariablePixelBuffer &renderOutputBufferTiled, // non normalized value
+                       const float renderOutputBufferDefaultValue,
+                       const FloatBuffer &renderOutputWeightBufferTiled,
+                       PackTilesBuffer &output,
+                       const PrecisionMode precisionMode, // current precision mode
+                       const bool noNumSampleMode,
+                       const bool doNormalizeMode,
+                       const bool closestFilterStatus,
+                       const unsigned closestFilterAovOriginalNumChan, // only use closestFilter on
+                       const CoarsePassPrecision coarsePassPrecision,  // minimum coarse pass precision
+                       const FinePassPrecision finePassPrecision,      // minimum fine pass precision
+                       const bool withHash = false,
+                       const EnqFormatVer enqFormatVer = EnqFormatVer::VER2,
+                       const HashType hashType = HashType::CRC32C,
+                       const unsigned bandTotal = 1);
     // for mcrt_dataio::MergeFbSender (progmcrtmerge)
     // VariableValue(float1|float2|float3|float4)
     static size_t
@@ -315,8 +450,23 @@ public:
                             const bool closestFilterStatus,
                             const CoarsePassPrecision coarsePassPrecision, // minimum coarse pass precision
                             const FinePassPrecision finePassPrecision,     // minimum fine pass precision
-                            const bool withSha1Hash = false,
-                            const EnqFormatVer enqFormatVer = EnqFormatVer::VER2);
+                            const bool withHash = false,
+                            const EnqFormatVer enqFormatVer = EnqFormatVer::VER2,
+                            const HashType hashType = HashType::CRC32C,
+                            const unsigned bandTotal = 1);
+    static size_t
+    encodeRenderOutputMerge(const ActivePixels &activePixels,
+                            const VariablePixelBuffer &renderOutputBufferTiled, // normalized value
+                            const float renderOutputBufferDefaultValue,
+                            PackTilesBuffer &output,
+                            const PrecisionMode precisionMode, // current precision mode
+                            const bool closestFilterStatus,
+                            const CoarsePassPrecision coarsePassPrecision, // minimum coarse pass precision
+                            const FinePassPrecision finePassPrecision,     // minimum fine pass precision
+                            const bool withHash = false,
+                            const EnqFormatVer enqFormatVer = EnqFormatVer::VER2,
+                            const HashType hashType = HashType::CRC32C,
+                            const unsigned bandTotal = 1);
 
     // VariableValue(float1|float2|float3|float4) + numSample : float * (1|2|3|4) + u_int
     // or
@@ -338,8 +488,15 @@ public:
     static size_t
     encodeRenderOutputReference(const FbReferenceType &referenceType,
                                 std::string &output,
-                                const bool withSha1Hash = false,
-                                const EnqFormatVer enqFormatVer = EnqFormatVer::VER2);
+                                const bool withHash = false,
+                                const EnqFormatVer enqFormatVer = EnqFormatVer::VER2,
+                                const HashType hashType = HashType::CRC32C);
+    static size_t
+    encodeRenderOutputReference(const FbReferenceType &referenceType,
+                                PackTilesBuffer &output,
+                                const bool withHash = false,
+                                const EnqFormatVer enqFormatVer = EnqFormatVer::VER2,
+                                const HashType hashType = HashType::CRC32C);
     static bool
     decodeRenderOutputReference(const void *addr, const size_t dataSize, // input
                                 FbAovShPtr &fbAov, // output
@@ -0,0 +1,142 @@
+// Copyright 2023-2024 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+#include "PackTilesBuffer.h"
+
+#include <sstream>
+
+namespace scene_rdl2 {
+namespace grid_util {
+
+void
+PackTilesBuffer::clear()
+{
+    mMain->clear(); // std::string::clear() keeps the capacity
+    mBandUsed = 0;
+    mSegments.clear();
+}
+
+size_t
+PackTilesBuffer::getDataSize() const
+{
+    if (mFlat) return mMain->size();
+
+    size_t total = 0;
+    for (const Segment &segment : mSegments) total += segment.mSize;
+    return total;
+}
+
+size_t
+PackTilesBuffer::getSegmentTotal() const
+{
+    if (mFlat) return (mMain->empty()) ? 0 : 1;
+    return mSegments.size();
+}
+
+size_t
+PackTilesBuffer::getCapacity() const
+{
+    size_t total = mMain->capacity();
+    for (const std::string &band : mBand) total += band.capacity();
+    for (const std::string &work : mWork) total += work.capacity();
+    return total;
+}
+
+void
+PackTilesBuffer::getIovec(std::vector<struct iovec> &iov) const
+{
+    iov.clear();
+    if (mFlat) {
+        if (!mMain->empty()) {
+            iov.push_back({const_cast<char *>(mMain->data()), mMain->size()});
+        }
+        return;
+    }
+
+    iov.reserve(mSegments.size());
+    for (const Segment &segment : mSegments) {
+        iov.push_back({const_cast<void *>(getSegmentAddr(segment)), segment.mSize});
+    }
+}
+
+void
+PackTilesBuffer::flatten(std::string &output) const
+{
+    if (mFlat) {
+        output.append(*mMain);
+        return;
+    }
+
+    output.reserve(output.size() + getDataSize());
+    for (const Segment &segment : mSegments) {
+        output.append(static_cast<const char *>(getSegmentAddr(segment)), segment.mSize);
+    }
+}
+
+std::string
+PackTilesBuffer::show() const
+{
+    std::ostringstream ostr;
+    ostr << "PackTilesBuffer {\n"
+         << "  mFlat:" << ((mFlat) ? "true" : "false") << '\n'
+         << "  dataSize:" << getDataSize() << '\n'
+         << "  segmentTotal:" << getSegmentTotal() << '\n'
+         << "  capacity:" << getCapacity() << '\n'
+         << "  mBandUsed:" << mBandUsed << " (pool:" << mBand.size() << ")\n"
+         << "}";
+    return ostr.str();
+}
+
+size_t
+PackTilesBuffer::allocBand(const size_t bandTotal)
+{
+    const size_t startId = mBandUsed;
+    mBandUsed += bandTotal;
+    if (mBand.size() < mBandUsed) mBand.resize(mBandUsed);
+    for (size_t bandId = startId; bandId < mBandUsed; ++bandId) {
+        mBand[bandId].clear();
+    }
+    return startId;
+}
+
+void
+PackTilesBuffer::allocWork(const size_t workTotal)
+{
+    if (mWork.size() < workTotal) mWork.resize(workTotal);
+    for (size_t workId = 0; workId < workTotal; ++workId) {
+        mWork[workId].clear();
+    }
+}
+
+void
+PackTilesBuffer::addMainSegment(const size_t offset, const size_t size)
+{
+    if (mFlat || !size) return;
+
+    if (!mSegments.empty()) {
+        Segment &last = mSegments.back();
+        if (last.mBandId < 0 && last.mOffset + last.mSize == offset) {
+            last.mSize += size; // continuous main data
+            return;
+        }
+    }
+    mSegments.push_back({-1, offset, size});
+}
+
+void
+PackTilesBuffer::addBandSegment(const size_t bandId)
+{
+    if (mFlat) return;
+    mSegments.push_back({static_cast<int>(bandId), 0, mBand[bandId].size()});
+}
+
+const void *
+PackTilesBuffer::getSegmentAddr(const Segment &segment) const
+{
+    if (segment.mBandId < 0) {
+        return static_cast<const void *>(mMain->data() + segment.mOffset);
+    }
+    return static_cast<const void *>(mBand[segment.mBandId].data());
+}
+
+} // namespace grid_util
+} // namespace scene_rdl2
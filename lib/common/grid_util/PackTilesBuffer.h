@@ -0,0 +1,95 @@
+// Copyright 2023-2024 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <sys/uio.h> // struct iovec
+
+namespace scene_rdl2 {
+namespace grid_util {
+
+class PackTilesBuffer
+//
+// Reusable output buffer for the PackTiles encode APIs.
+//
+// The encoded data is kept as an ordered list of segments instead of one contiguous string.
+// Banded pixel blocks (See bandTotal of PackTiles) stay in the pooled per-band memory which they
+// are encoded into, and are not copied into the main data. getIovec() returns all the segments in
+// order, so the data can be handed to writev()/sendmsg() as is. The concatenation of all the
+// segments is exactly the same data as the std::string version of the encode APIs outputs.
+//
+// clear() keeps all the allocated memory. Encoding the next frame into the same PackTilesBuffer
+// does not reallocate once the capacity reaches the frame size. Several encode calls can be stored
+// into the same PackTilesBuffer, each of them is appended to the end.
+//
+// PackTilesBuffer(std::string &output) wraps the caller's string instead (flat mode). All the data
+// including bands is appended into that string as one contiguous data. The std::string version of
+// the encode APIs uses this mode internally.
+//
+{
+public:
+    PackTilesBuffer() : mMain(&mMainOwn) {}
+    explicit PackTilesBuffer(std::string &output) : mMain(&output), mFlat(true) {}
+
+    // This class is Non-copyable
+    PackTilesBuffer &operator = (const PackTilesBuffer &) = delete;
+    PackTilesBuffer(const PackTilesBuffer &) = delete;
+
+    void clear(); // start a new frame : keeps all the allocated memory
+
+    bool isFlat() const { return mFlat; }
+    bool isEmpty() const { return getDataSize() == 0; }
+
+    size_t getDataSize() const; // total size of all the segments : byte
+    size_t getSegmentTotal() const;
+    size_t getCapacity() const; // total allocated memory : byte
+
+    // Returns all the segments in order. Each iovec points to the internal memory of this object
+    // and is valid until the next encode or clear().
+    void getIovec(std::vector<struct iovec> &iov) const;
+
+    void flatten(std::string &output) const; // append all the segments to output
+
+    std::string show() const;
+
+private:
+    friend class PackTilesImpl;
+
+    struct Segment {
+        int mBandId;    // -1 : main data, otherwise pooled band id
+        size_t mOffset; // offset of the main data (only used when mBandId = -1)
+        size_t mSize;
+    };
+
+    std::string &getMain() { return *mMain; }
+
+    // returns the first id of bandTotal empty band buffers
+    size_t allocBand(const size_t bandTotal);
+    std::string &getBand(const size_t bandId) { return mBand[bandId]; }
+
+    // empty work buffers : only used inside a single encode call
+    void allocWork(const size_t workTotal);
+    std::string &getWork(const size_t workId) { return mWork[workId]; }
+
+    void addMainSegment(const size_t offset, const size_t size);
+    void addBandSegment(const size_t bandId);
+
+    const void *getSegmentAddr(const Segment &segment) const;
+
+    //------------------------------
+
+    std::string mMainOwn;
+    std::string *mMain {nullptr};
+    bool mFlat {false};
+
+    size_t mBandUsed {0};
+    std::vector<std::string> mBand; // pooled memory for band data
+    std::vector<std::string> mWork; // pooled memory for VER3 uncompressed pixel block
+
+    std::vector<Segment> mSegments;
+};
+
+} // namespace grid_util
+} // namespace scene_rdl2
@@ -11,8 +11,11 @@
 #include "PackActiveTiles.h"
 
 #include <scene_rdl2/common/fb_util/ActivePixels.h>
+#include <scene_rdl2/common/rec_time/RecTime.h>
 
+#include <cstring>
 #include <fstream>
+#include <iomanip>
 
 namespace scene_rdl2 {
 namespace grid_util {
@@ -53,6 +56,36 @@ readActivePixelsArray(const std::string &filename,
     return true;
 }
 
+static void
+setupGradientBuffer(const fb_util::ActivePixels &activePixels,
+                    fb_util::RenderBuffer &renderBufferTiled,
+                    fb_util::FloatBuffer &weightBufferTiled)
+//
+// smooth gradient with per pixel sample count variation
+//
+{
+    const unsigned width = activePixels.getWidth();
+    const unsigned height = activePixels.getHeight();
+    const unsigned alignedWidth = activePixels.getAlignedWidth();
+    const unsigned alignedHeight = activePixels.getAlignedHeight();
+    renderBufferTiled.init(alignedWidth, alignedHeight);
+    weightBufferTiled.init(alignedWidth, alignedHeight);
+    const unsigned numTilesX = alignedWidth / 8;
+    for (unsigned tileId = 0; tileId < activePixels.getNumTiles(); ++tileId) {
+        for (unsigned pixId = 0; pixId < 64; ++pixId) {
+            const float x = static_cast<float>((tileId % numTilesX) * 8 + pixId % 8) / (float)width;
+            const float y = static_cast<float>((tileId / numTilesX) * 8 + pixId / 8) / (float)height;
+            const float weight = static_cast<float>(1 + (tileId + pixId) % 4);
+            renderBufferTiled.getData()[tileId * 64 + pixId] =
+                fb_util::RenderColor(weight * (0.2f + 0.6f * x),
+                                     weight * (0.1f + 0.5f * y),
+                                     weight * 0.4f * (x + y),
+                                     weight);
+            weightBufferTiled.getData()[tileId * 64 + pixId] = weight;
+        }
+    }
+}
+
 //---------------------------------------------------------------------------------------------------------------
 
 // static function
@@ -123,6 +156,320 @@ PackTilesTest::timingTestEnqTileMaskBlock(const unsigned width,
     PackTiles::timingTestEnqTileMaskBlock(width, height, totalActivePixels);
 }
 
+// static function
+void
+PackTilesTest::timingAndSizeTest(const unsigned width,
+                                 const unsigned height,
+                                 const unsigned totalActivePixels)
+//
+// Pixel data size and encode/decode throughput compare test between ver2 and ver3 for all
+// precision modes. ActivePixels and a smooth gradient beauty buffer (RGBA + numSample) are
+// procedurally generated.
+//   ver2 : pixel values are stored as is
+//   ver3 : per-tile delta prediction + rANS entropy coding of pixel values
+// Intentionally using std::cerr for debug purpose.
+//
+{
+    constexpr int loopMax = 10;
+
+    fb_util::ActivePixels activePixels;
+    activePixels.init(width, height);
+    PackActiveTiles::randomActivePixels(activePixels, totalActivePixels);
+
+    const unsigned alignedWidth = activePixels.getAlignedWidth();
+    const unsigned alignedHeight = activePixels.getAlignedHeight();
+    fb_util::RenderBuffer renderBufferTiled;
+    fb_util::FloatBuffer weightBufferTiled;
+    setupGradientBuffer(activePixels, renderBufferTiled, weightBufferTiled);
+
+    std::cerr << "#>> PackTilesTest.cc timingAndSizeTest()"
+              << " w:" << width << " h:" << height
+              << " totalActivePixels:" << activePixels.getActivePixelTotal() << std::endl;
+    std::cerr << "# 1         2        3        4     5              6              7"
+              << "              8" << std::endl;
+    std::cerr << "# precision ver2Size ver3Size %     ver2Enc(MB/s)  ver3Enc(MB/s)  ver2Dec(MB/s)"
+              << "  ver3Dec(MB/s)" << std::endl;
+
+    const PackTiles::PrecisionMode precisionModeTbl[] = {PackTiles::PrecisionMode::F32,
+                                                         PackTiles::PrecisionMode::H16,
+                                                         PackTiles::PrecisionMode::UC8};
+    const PackTiles::EnqFormatVer verTbl[] = {PackTiles::EnqFormatVer::VER2,
+                                              PackTiles::EnqFormatVer::VER3};
+    for (const PackTiles::PrecisionMode precisionMode : precisionModeTbl) {
+        size_t dataSize[2] = {0, 0};
+        float encodeTime[2] = {0.0f, 0.0f};
+        float decodeTime[2] = {0.0f, 0.0f};
+        fb_util::RenderBuffer decodedRenderBufferTiled[2];
+        PackTiles::NumSampleBuffer decodedNumSampleBufferTiled[2];
+        bool verify = true;
+
+        rec_time::RecTime recTime;
+        for (int verId = 0; verId < 2; ++verId) {
+            for (int loopId = 0; loopId < loopMax; ++loopId) {
+                std::string data;
+                recTime.start();
+                dataSize[verId] = PackTiles::encode(false, // renderBufferOdd
+                                                    activePixels,
+                                                    renderBufferTiled,
+                                                    weightBufferTiled,
+                                                    data,
+                                                    precisionMode,
+                                                    CoarsePassPrecision::F32,
+                                                    FinePassPrecision::F32,
+                                                    false, // noNumSampleMode
+                                                    false, // withHash
+                                                    verTbl[verId]);
+                encodeTime[verId] += recTime.end();
+
+                fb_util::ActivePixels decodedActivePixels;
+                CoarsePassPrecision coarsePassPrecision;
+                FinePassPrecision finePassPrecision;
+                bool activeDecodeAction;
+                recTime.start();
+                if (!PackTiles::decode(false, // renderBufferOdd
+                                       data.data(), data.size(),
+                                       true, // storeNumSampleData
+                                       decodedActivePixels,
+                                       decodedRenderBufferTiled[verId],
+                                       decodedNumSampleBufferTiled[verId],
+                                       coarsePassPrecision,
+                                       finePassPrecision,
+                                       activeDecodeAction)) {
+                    verify = false;
+                }
+                decodeTime[verId] += recTime.end();
+            }
+        }
+
+        // ver3 should decode exactly the same result as ver2
+        const size_t pixTotal = static_cast<size_t>(alignedWidth) * alignedHeight;
+        if (std::memcmp(decodedRenderBufferTiled[0].getData(), decodedRenderBufferTiled[1].getData(),
+                        pixTotal * sizeof(fb_util::RenderColor)) ||
+            std::memcmp(decodedNumSampleBufferTiled[0].getData(), decodedNumSampleBufferTiled[1].getData(),
+                        pixTotal * sizeof(unsigned int))) {
+            verify = false;
+        }
+
+        // throughput is measured by the decoded pixel data (RGBA float + numSample) size
+        const float pixDataMB =
+            static_cast<float>(activePixels.getActivePixelTotal() *
+                               (sizeof(fb_util::RenderColor) + sizeof(unsigned int))) / (1024.0f * 1024.0f);
+        auto throughput = [&](float totalSec) {
+            return (totalSec > 0.0f) ? pixDataMB * (float)loopMax / totalSec : 0.0f;
+        };
+
+        std::cerr << PackTiles::showPrecisionMode(precisionMode)
+                  << ' ' << dataSize[0]
+                  << ' ' << dataSize[1]
+                  << ' ' << std::setw(5) << std::fixed << std::setprecision(3)
+                  << (float)dataSize[1] / (float)dataSize[0]
+                  << ' ' << std::setw(10) << std::setprecision(2) << throughput(encodeTime[0])
+                  << ' ' << std::setw(10) << throughput(encodeTime[1])
+                  << ' ' << std::setw(10) << throughput(decodeTime[0])
+                  << ' ' << std::setw(10) << throughput(decodeTime[1])
+                  << ((verify) ? "" : " verify-NG")
+                  << std::endl;
+    }
+}
+
+// static function
+void
+PackTilesTest::hashTimingTest(const unsigned width,
+                              const unsigned height,
+                              const unsigned totalActivePixels)
+//
+// Encode and verifyDecodeHash throughput compare test between hash types. Uses F32 VER2 beauty
+// (RGBA + numSample) data of the procedurally generated ActivePixels and gradient buffer.
+//   none   : withHash = false
+//   SHA1   : 20byte SHA1 (OpenSSL)
+//   CRC32C : 4 interleaved CRC32C lanes
+// Intentionally using std::cerr for debug purpose.
+//
+{
+    constexpr int loopMax = 20;
+
+    fb_util::ActivePixels activePixels;
+    activePixels.init(width, height);
+    PackActiveTiles::randomActivePixels(activePixels, totalActivePixels);
+
+    fb_util::RenderBuffer renderBufferTiled;
+    fb_util::FloatBuffer weightBufferTiled;
+    setupGradientBuffer(activePixels, renderBufferTiled, weightBufferTiled);
+
+    std::cerr << "#>> PackTilesTest.cc hashTimingTest()"
+              << " w:" << width << " h:" << height
+              << " totalActivePixels:" << activePixels.getActivePixelTotal() << std::endl;
+    std::cerr << "# 1      2        3            4" << std::endl;
+    std::cerr << "# hash   dataSize encode(MB/s) verifyHash(MB/s)" << std::endl;
+
+    struct Item {
+        const char *mName;
+        bool mWithHash;
+        PackTiles::HashType mHashType;
+    };
+    const Item itemTbl[] = {{"none  ", false, PackTiles::HashType::SHA1},
+                            {"SHA1  ", true, PackTiles::HashType::SHA1},
+                            {"CRC32C", true, PackTiles::HashType::CRC32C}};
+    for (const Item &item : itemTbl) {
+        size_t dataSize = 0;
+        float encodeTime = 0.0f;
+        float verifyTime = 0.0f;
+        bool verify = true;
+
+        rec_time::RecTime recTime;
+        for (int loopId = 0; loopId < loopMax; ++loopId) {
+            std::string data;
+            recTime.start();
+            dataSize = PackTiles::encode(false, // renderBufferOdd
+                                         activePixels,
+                                         renderBufferTiled,
+                                         weightBufferTiled,
+                                         data,
+                                         PackTiles::PrecisionMode::F32,
+                                         CoarsePassPrecision::F32,
+                                         FinePassPrecision::F32,
+                                         false, // noNumSampleMode
+                                         item.mWithHash,
+                                         PackTiles::EnqFormatVer::VER2,
+                                         item.mHashType);
+            encodeTime += recTime.end();
+
+            if (item.mWithHash) {
+                recTime.start();
+                if (!PackTiles::verifyDecodeHash(data.data(), data.size())) verify = false;
+                verifyTime += recTime.end();
+
+                // A single flipped bit should be detected.
+                data[data.size() / 2] ^= 0x1;
+                if (PackTiles::verifyDecodeHash(data.data(), data.size())) verify = false;
+            }
+        }
+
+        const float dataMB = static_cast<float>(dataSize) / (1024.0f * 1024.0f);
+        auto throughput = [&](float totalSec) {
+            return (totalSec > 0.0f) ? dataMB * (float)loopMax / totalSec : 0.0f;
+        };
+
+        std::cerr << item.mName
+                  << ' ' << dataSize
+                  << ' ' << std::setw(10) << std::fixed << std::setprecision(2) << throughput(encodeTime)
+                  << ' ' << std::setw(10) << throughput(verifyTime)
+                  << ((verify) ? "" : " verify-NG")
+                  << std::endl;
+    }
+}
+
+// static function
+void
+PackTilesTest::bandTimingTest(const unsigned width,
+                              const unsigned height,
+                              const unsigned totalActivePixels,
+                              const unsigned bandTotal)
+//
+// Encode/decode throughput compare test between non-banded (bandTotal = 1) and banded pixel
+// block. Uses F32 beauty (RGBA + numSample) data of the procedurally generated ActivePixels and
+// gradient buffer. Banded data should decode exactly the same result as non-banded data.
+// Intentionally using std::cerr for debug purpose.
+//
+{
+    constexpr int loopMax = 10;
+
+    fb_util::ActivePixels activePixels;
+    activePixels.init(width, height);
+    PackActiveTiles::randomActivePixels(activePixels, totalActivePixels);
+
+    const unsigned alignedWidth = activePixels.getAlignedWidth();
+    const unsigned alignedHeight = activePixels.getAlignedHeight();
+    fb_util::RenderBuffer renderBufferTiled;
+    fb_util::FloatBuffer weightBufferTiled;
+    setupGradientBuffer(activePixels, renderBufferTiled, weightBufferTiled);
+
+    std::cerr << "#>> PackTilesTest.cc bandTimingTest()"
+              << " w:" << width << " h:" << height
+              << " totalActivePixels:" << activePixels.getActivePixelTotal()
+              << " bandTotal:" << bandTotal << std::endl;
+    std::cerr << "# 1   2         3          4           5         6          7" << std::endl;
+    std::cerr << "# ver size(1)   size(band) enc(1)(MB/s) enc(band) dec(1)(MB/s) dec(band)" << std::endl;
+
+    const PackTiles::EnqFormatVer verTbl[] = {PackTiles::EnqFormatVer::VER2,
+                                              PackTiles::EnqFormatVer::VER3};
+    for (const PackTiles::EnqFormatVer ver : verTbl) {
+        const unsigned bandTotalTbl[2] = {1, bandTotal};
+        size_t dataSize[2] = {0, 0};
+        float encodeTime[2] = {0.0f, 0.0f};
+        float decodeTime[2] = {0.0f, 0.0f};
+        fb_util::RenderBuffer decodedRenderBufferTiled[2];
+        PackTiles::NumSampleBuffer decodedNumSampleBufferTiled[2];
+        bool verify = true;
+
+        rec_time::RecTime recTime;
+        for (int bandId = 0; bandId < 2; ++bandId) {
+            for (int loopId = 0; loopId < loopMax; ++loopId) {
+                std::string data;
+                recTime.start();
+                dataSize[bandId] = PackTiles::encode(false, // renderBufferOdd
+                                                     activePixels,
+                                                     renderBufferTiled,
+                                                     weightBufferTiled,
+                                                     data,
+                                                     PackTiles::PrecisionMode::F32,
+                                                     CoarsePassPrecision::F32,
+                                                     FinePassPrecision::F32,
+                                                     false, // noNumSampleMode
+                                                     false, // withHash
+                                                     ver,
+                                                     PackTiles::HashType::CRC32C,
+                                                     bandTotalTbl[bandId]);
+                encodeTime[bandId] += recTime.end();
+
+                fb_util::ActivePixels decodedActivePixels;
+                CoarsePassPrecision coarsePassPrecision;
+                FinePassPrecision finePassPrecision;
+                bool activeDecodeAction;
+                recTime.start();
+                if (!PackTiles::decode(false, // renderBufferOdd
+                                       data.data(), data.size(),
+                                       true, // storeNumSampleData
+                                       decodedActivePixels,
+                                       decodedRenderBufferTiled[bandId],
+                                       decodedNumSampleBufferTiled[bandId],
+                                       coarsePassPrecision,
+                                       finePassPrecision,
+                                       activeDecodeAction)) {
+                    verify = false;
+                }
+                decodeTime[bandId] += recTime.end();
+            }
+        }
+
+        const size_t pixTotal = static_cast<size_t>(alignedWidth) * alignedHeight;
+        if (std::memcmp(decodedRenderBufferTiled[0].getData(), decodedRenderBufferTiled[1].getData(),
+                        pixTotal * sizeof(fb_util::RenderColor)) ||
+            std::memcmp(decodedNumSampleBufferTiled[0].getData(), decodedNumSampleBufferTiled[1].getData(),
+                        pixTotal * sizeof(unsigned int))) {
+            verify = false;
+        }
+
+        // throughput is measured by the decoded pixel data (RGBA float + numSample) size
+        const float pixDataMB =
+            static_cast<float>(activePixels.getActivePixelTotal() *
+                               (sizeof(fb_util::RenderColor) + sizeof(unsigned int))) / (1024.0f * 1024.0f);
+        auto throughput = [&](float totalSec) {
+            return (totalSec > 0.0f) ? pixDataMB * (float)loopMax / totalSec : 0.0f;
+        };
+
+        std::cerr << ((ver == PackTiles::EnqFormatVer::VER2) ? "ver2" : "ver3")
+                  << ' ' << dataSize[0]
+                  << ' ' << dataSize[1]
+                  << ' ' << std::setw(10) << std::fixed << std::setprecision(2) << throughput(encodeTime[0])
+                  << ' ' << std::setw(10) << throughput(encodeTime[1])
+                  << ' ' << std::setw(10) << throughput(decodeTime[0])
+                  << ' ' << std::setw(10) << throughput(decodeTime[1])
+                  << ((verify) ? "" : " verify-NG")
+                  << std::endl;
+    }
+}
+
 // static function
 void
 PackTilesTest::replaySnapshotDelta(const std::string &filename)
@@ -44,6 +44,29 @@ public:
                                            const unsigned height,
                                            const unsigned totalActivePixels);
 
+    // Pixel data size and encode/decode throughput compare test between ver2 and ver3 for all
+    // precision modes. ActivePixels and a smooth gradient beauty buffer (RGBA + numSample) are
+    // procedurally generated.
+    //   ver2 : pixel values are stored as is
+    //   ver3 : per-tile delta prediction + rANS entropy coding of pixel values
+    static void timingAndSizeTest(const unsigned width,
+                                  const unsigned height,
+                                  const unsigned totalActivePixels);
+
+    // Encode and verifyDecodeHash throughput compare test between hash types (none, SHA1 and
+    // CRC32C). ActivePixels and a smooth gradient beauty buffer are procedurally generated.
+    static void hashTimingTest(const unsigned width,
+                               const unsigned height,
+                               const unsigned totalActivePixels);
+
+    // Encode/decode throughput compare test between non-banded (bandTotal = 1) and banded
+    // (parallel) pixel block for ver2 and ver3. ActivePixels and a smooth gradient beauty buffer are
+    // procedurally generated.
+    static void bandTimingTest(const unsigned width,
+                               const unsigned height,
+                               const unsigned totalActivePixels,
+                               const unsigned bandTotal);
+
     // EnqTimeMaskBlock ver1+ver2 timing test using already dumped ActivePixelsArray data
     //   ver1 : original naive activeTileId + activePixelMask
     //   ver2 : PackActiveTiles encoding method
@@ -0,0 +1,298 @@
+// Copyright 2023-2024 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+//
+//
+#include "RansCodec.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace scene_rdl2 {
+namespace grid_util {
+
+namespace {
+
+enum class Mode : unsigned char {
+    RAW = 0,
+    CONST = 1,
+    RANS = 2
+};
+
+constexpr unsigned PROB_BITS = 12;
+constexpr uint32_t PROB_SCALE = 1 << PROB_BITS;
+constexpr uint32_t RANS_L = 1 << 23; // lower bound of the normalized state interval
+constexpr unsigned STATE_TOTAL = 4;  // interleaved states
+
+struct DecSym {
+    uint16_t mFreq;
+    uint16_t mBias; // slot - cumulative frequency
+    uint8_t mSym;
+};
+
+inline void
+enqVarLen(uint32_t v, std::string &dst)
+{
+    while (v >= 0x80) {
+        dst.push_back(static_cast<char>((v & 0x7f) | 0x80));
+        v >>= 7;
+    }
+    dst.push_back(static_cast<char>(v));
+}
+
+inline bool
+deqVarLen(const unsigned char *&ip, const unsigned char *end, uint32_t &v)
+{
+    v = 0;
+    for (unsigned shift = 0; shift < 35; shift += 7) {
+        if (ip == end) return false;
+        const unsigned char c = *ip++;
+        v |= static_cast<uint32_t>(c & 0x7f) << shift;
+        if (!(c & 0x80)) return true;
+    }
+    return false;
+}
+
+void
+normalizeFreq(const uint32_t count[256], const size_t total, uint32_t freq[256])
+//
+// Scales the symbol counts so they sum up to PROB_SCALE. Every symbol which shows up in the data
+// keeps a frequency of at least 1.
+//
+{
+    uint32_t sum = 0;
+    unsigned maxSym = 0;
+    for (unsigned s = 0; s < 256; ++s) {
+        freq[s] = 0;
+        if (count[s]) {
+            uint64_t f = static_cast<uint64_t>(count[s]) * PROB_SCALE / total;
+            freq[s] = (f) ? static_cast<uint32_t>(f) : 1;
+            sum += freq[s];
+            if (count[s] > count[maxSym]) maxSym = s;
+        }
+    }
+
+    // Rounding error goes to the most frequent symbols. The loop always terminates because at most
+    // 256 symbols need the minimum frequency of 1.
+    while (sum > PROB_SCALE) {
+        unsigned big = maxSym;
+        for (unsigned s = 0; s < 256; ++s) {
+            if (freq[s] > freq[big]) big = s;
+        }
+        const uint32_t delta = std::min(freq[big] - 1, sum - PROB_SCALE);
+        freq[big] -= delta;
+        sum -= delta;
+    }
+    freq[maxSym] += PROB_SCALE - sum;
+}
+
+} // namespace
+
+// static function
+void
+RansCodec::encode(const void *src, const size_t size, std::string &dst)
+{
+    const unsigned char *in = static_cast<const unsigned char *>(src);
+
+    uint32_t count[256] = {0};
+    for (size_t i = 0; i < size; ++i) {
+        count[in[i]]++;
+    }
+
+    unsigned symTotal = 0;
+    for (unsigned s = 0; s < 256; ++s) {
+        if (count[s]) symTotal++;
+    }
+    if (symTotal == 1) {
+        dst.push_back(static_cast<char>(Mode::CONST));
+        dst.push_back(static_cast<char>(in[0]));
+        return;
+    }
+    const size_t rawOffset = dst.size();
+    if (symTotal == 0 || size < 64) { // too small to amortize the frequency table
+        dst.push_back(static_cast<char>(Mode::RAW));
+        dst.append(static_cast<const char *>(src), size);
+        return;
+    }
+
+    uint32_t freq[256];
+    uint32_t cum[257];
+    normalizeFreq(count, size, freq);
+    cum[0] = 0;
+    for (unsigned s = 0; s < 256; ++s) {
+        cum[s + 1] = cum[s] + freq[s];
+    }
+
+    // Each symbol emits at most 2 bytes with 12bit probabilities, plus the final states.
+    std::vector<unsigned char> buff(size * 2 + STATE_TOTAL * sizeof(uint32_t));
+    unsigned char *const buffEnd = buff.data() + buff.size();
+    unsigned char *ptr = buffEnd;
+
+    // Symbols are encoded in reverse, so the decoder can read them forward.
+    uint32_t state[STATE_TOTAL] = {RANS_L, RANS_L, RANS_L, RANS_L};
+    for (size_t i = size; i-- > 0;) {
+        uint32_t &x = state[i & (STATE_TOTAL - 1)];
+        const unsigned char s = in[i];
+        const uint32_t f = freq[s];
+        const uint32_t xMax = ((RANS_L >> PROB_BITS) << 8) * f;
+        while (x >= xMax) {
+            *--ptr = static_cast<unsigned char>(x & 0xff);
+            x >>= 8;
+        }
+        x = ((x / f) << PROB_BITS) + (x % f) + cum[s];
+    }
+    for (int stateId = STATE_TOTAL - 1; stateId >= 0; --stateId) {
+        ptr -= sizeof(uint32_t);
+        const uint32_t x = state[stateId];
+        ptr[0] = static_cast<unsigned char>(x);
+        ptr[1] = static_cast<unsigned char>(x >> 8);
+        ptr[2] = static_cast<unsigned char>(x >> 16);
+        ptr[3] = static_cast<unsigned char>(x >> 24);
+    }
+    const size_t payloadSize = static_cast<size_t>(buffEnd - ptr);
+
+    dst.push_back(static_cast<char>(Mode::RANS));
+    unsigned char bitmap[32] = {0};
+    for (unsigned s = 0; s < 256; ++s) {
+        if (freq[s]) bitmap[s >> 3] |= static_cast<unsigned char>(1 << (s & 7));
+    }
+    dst.append(reinterpret_cast<const char *>(bitmap), sizeof(bitmap));
+    for (unsigned s = 0; s < 256; ++s) {
+        if (freq[s]) enqVarLen(freq[s], dst);
+    }
+    enqVarLen(static_cast<uint32_t>(payloadSize), dst);
+    dst.append(reinterpret_cast<const char *>(ptr), payloadSize);
+
+    if (dst.size() - rawOffset >= size + 1) {
+        // entropy coding did not pay off, store as is
+        dst.resize(rawOffset);
+        dst.push_back(static_cast<char>(Mode::RAW));
+        dst.append(static_cast<const char *>(src), size);
+    }
+}
+
+// static function
+size_t
+RansCodec::decode(const void *src, const size_t srcSize, void *dst, const size_t rawSize)
+{
+    const unsigned char *const start = static_cast<const unsigned char *>(src);
+    const unsigned char *const end = start + srcSize;
+    const unsigned char *ip = start;
+    unsigned char *out = static_cast<unsigned char *>(dst);
+
+    if (ip == end) return 0;
+    const Mode mode = static_cast<Mode>(*ip++);
+    switch (mode) {
+    case Mode::RAW :
+        if (static_cast<size_t>(end - ip) < rawSize) return 0;
+        std::memcpy(out, ip, rawSize);
+        return 1 + rawSize;
+    case Mode::CONST :
+        if (ip == end) return 0;
+        std::memset(out, *ip, rawSize);
+        return 2;
+    case Mode::RANS :
+        break;
+    default :
+        return 0;
+    }
+
+    //------------------------------
+    //
+    // frequency table
+    //
+    if (end - ip < 32) return 0;
+    const unsigned char *bitmap = ip;
+    ip += 32;
+
+    std::vector<DecSym> table(PROB_SCALE);
+    uint32_t cum = 0;
+    for (unsigned s = 0; s < 256; ++s) {
+        if (!(bitmap[s >> 3] & (1 << (s & 7)))) continue;
+        uint32_t f;
+        if (!deqVarLen(ip, end, f) || f == 0 || cum + f > PROB_SCALE) return 0;
+        for (uint32_t slot = cum; slot < cum + f; ++slot) {
+            table[slot] = DecSym {static_cast<uint16_t>(f),
+                                  static_cast<uint16_t>(slot - cum),
+                                  static_cast<uint8_t>(s)};
+        }
+        cum += f;
+    }
+    if (cum != PROB_SCALE) return 0;
+
+    uint32_t payloadSize;
+    if (!deqVarLen(ip, end, payloadSize) ||
+        payloadSize < STATE_TOTAL * sizeof(uint32_t) ||
+        static_cast<size_t>(end - ip) < payloadSize) {
+        return 0;
+    }
+    const unsigned char *const payloadEnd = ip + payloadSize;
+
+    //------------------------------
+    //
+    // symbols
+    //
+    uint32_t state[STATE_TOTAL];
+    for (unsigned stateId = 0; stateId < STATE_TOTAL; ++stateId) {
+        state[stateId] = (static_cast<uint32_t>(ip[0]) |
+                          static_cast<uint32_t>(ip[1]) << 8 |
+                          static_cast<uint32_t>(ip[2]) << 16 |
+                          static_cast<uint32_t>(ip[3]) << 24);
+        ip += sizeof(uint32_t);
+    }
+
+    const DecSym *__restrict tbl = table.data();
+    auto decodeSym = [&](uint32_t &x, unsigned char &sym) -> bool {
+        const DecSym &e = tbl[x & (PROB_SCALE - 1)];
+        sym = e.mSym;
+        x = e.mFreq * (x >> PROB_BITS) + e.mBias;
+        while (x < RANS_L) {
+            if (ip == payloadEnd) return false;
+            x = (x << 8) | *ip++;
+        }
+        return true;
+    };
+
+    // Main loop : the 4 states are independent, which lets the CPU overlap their table lookups.
+    // A single symbol reads at most 2 bytes, so no bounds check is needed while 8 bytes remain.
+    uint32_t x0 = state[0], x1 = state[1], x2 = state[2], x3 = state[3];
+    auto step = [&](uint32_t &x, unsigned char &sym) {
+        const DecSym e = tbl[x & (PROB_SCALE - 1)];
+        sym = e.mSym;
+        x = e.mFreq * (x >> PROB_BITS) + e.mBias;
+        // branchless renormalization : data with a skewed distribution makes the branches
+        // unpredictable
+        const uint32_t n0 = (x < RANS_L);
+        x = (n0) ? ((x << 8) | ip[0]) : x;
+        ip += n0;
+        const uint32_t n1 = (x < RANS_L);
+        x = (n1) ? ((x << 8) | ip[0]) : x;
+        ip += n1;
+    };
+    size_t i = 0;
+    while (i + STATE_TOTAL <= rawSize && payloadEnd - ip >= 8) {
+        step(x0, out[i    ]);
+        step(x1, out[i + 1]);
+        step(x2, out[i + 2]);
+        step(x3, out[i + 3]);
+        i += STATE_TOTAL;
+    }
+    state[0] = x0; state[1] = x1; state[2] = x2; state[3] = x3;
+
+    // tail : checked one symbol at a time
+    for (; i < rawSize; ++i) {
+        if (!decodeSym(state[i & (STATE_TOTAL - 1)], out[i])) return 0;
+    }
+
+    // A consistent stream ends with all states back at their initial value.
+    if (ip != payloadEnd) return 0;
+    for (unsigned stateId = 0; stateId < STATE_TOTAL; ++stateId) {
+        if (state[stateId] != RANS_L) return 0;
+    }
+    return static_cast<size_t>(payloadEnd - start);
+}
+
+} // namespace grid_util
+} // namespace scene_rdl2
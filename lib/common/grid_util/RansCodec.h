@@ -0,0 +1,43 @@
+// Copyright 2023-2024 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+//
+//
+#pragma once
+
+//
+// -- RansCodec : order-0 byte entropy coder for pack-tile codec version3 --
+//
+// RansCodec is used by pack-tile codec version3 to compress the prediction residual planes of
+// the pixel values. It is a range asymmetric numeral system (rANS) coder with 12bit symbol
+// probabilities and 4 interleaved 32bit states. The interleaving breaks the dependency chain
+// between consecutive symbols, so decoding runs about 4 symbols in parallel on one core.
+//
+// Each encoded block starts with a mode byte.
+//   RAW   : the bytes are stored as is. Used when entropy coding does not make data smaller.
+//   CONST : every byte has the same value, stored as a single byte.
+//   RANS  : 32byte symbol presence bitmap | frequency (variable length) of each present symbol |
+//           payload size (variable length) | payload
+//
+// The decoder has to know the original data size in advance. Callers store it next to the block.
+//
+
+#include <cstddef>
+#include <string>
+
+namespace scene_rdl2 {
+namespace grid_util {
+
+class RansCodec
+{
+public:
+    // Appends the encoded form of size bytes at src to dst.
+    static void encode(const void *src, const size_t size, std::string &dst);
+
+    // Decodes the block at src into exactly rawSize bytes at dst.
+    // Returns the number of bytes consumed from src, or 0 if the block is corrupted.
+    static size_t decode(const void *src, const size_t srcSize, void *dst, const size_t rawSize);
+};
+
+} // namespace grid_util
+} // namespace scene_rdl2
@@ -11,6 +11,8 @@
 #include "Col4.h"
 #include "Math.h"
 
+#include <type_traits>
+
 
 // Forward declaration of the ISPC types
 namespace ispc {
@@ -48,8 +50,8 @@ namespace math {
     __forceinline explicit Color4 ( const Col4c& other ) { r = other.r*sOneOver255; g = other.g*sOneOver255; b = other.b*sOneOver255; a = other.a*sOneOver255; }
     __forceinline explicit Color4 ( const Col4f& other ) { r = other.r; g = other.g; b = other.b; a = other.a; }
     
-    __forceinline Color4           ( const Color4& other ) { r = other.r; g = other.g; b = other.b; a = other.a; }
-    __forceinline Color4& operator=( const Color4& other ) { r = other.r; g = other.g; b = other.b; a = other.a; return *this; }
+    __forceinline Color4           ( const Color4& other ) = default;
+    __forceinline Color4& operator=( const Color4& other ) = default;
 
     ////////////////////////////////////////////////////////////////////////////////
     /// Set
@@ -128,8 +130,8 @@ namespace math {
     __forceinline explicit Color (const float& v) : r(v), g(v), b(v) {}
     __forceinline          Color (const float& rParam, const float& gParam, const float& bParam) : r(rParam), g(gParam), b(bParam) {}
 
-    __forceinline Color           ( const Color& other ) { r = other.r; g = other.g; b = other.b; }
-    __forceinline Color& operator=( const Color& other ) { r = other.r; g = other.g; b = other.b; return *this; }
+    __forceinline Color           ( const Color& other ) = default;
+    __forceinline Color& operator=( const Color& other ) = default;
 
     __forceinline Color           ( const Color4& other ) { r = other.r; g = other.g; b = other.b; }
     __forceinline Color& operator=( const Color4& other ) { r = other.r; g = other.g; b = other.b; return *this; }
@@ -275,6 +277,9 @@ namespace math {
     return cout << '(' << a.r << ", " << a.g << ", " << a.b << ", " << a.a << ')';
   }
 
+  MNRY_STATIC_ASSERT(std::is_trivially_copyable<Color>::value);
+  MNRY_STATIC_ASSERT(std::is_trivially_copyable<Color4>::value);
+
 
   ////////////////////////////////////////////////////////////////////////////////
   /// asIspc() and asCpp() C++ <--> ISPC Type-casting functions
@@ -13,6 +13,8 @@
 #include "Mat3.h"
 #include "Xform.h"
 
+#include <type_traits>
+
 // Forward declaration of the ISPC types
 namespace ispc {
     struct Mat4f;
@@ -59,8 +61,8 @@ namespace math {
 
     /*! default matrix constructor */
     __forceinline Mat4           ( ) {}
-    __forceinline Mat4           ( const Mat4& other ) { vx = other.vx; vy = other.vy; vz = other.vz; vw = other.vw;}
-    __forceinline Mat4& operator=( const Mat4& other ) { vx = other.vx; vy = other.vy; vz = other.vz; vw = other.vw; return *this; }
+    __forceinline Mat4           ( const Mat4& other ) = default;
+    __forceinline Mat4& operator=( const Mat4& other ) = default;
 
     template<typename L1> __forceinline explicit Mat4( const Mat4<L1>& s ) : vx(s.vx), vy(s.vy), vz(s.vz), vw(s.vw) {}
 
@@ -463,6 +465,9 @@ namespace math {
   typedef Mat4<Vec4f> Mat4f;
   typedef Mat4<Vec4d> Mat4d;
 
+  MNRY_STATIC_ASSERT(std::is_trivially_copyable<Mat4f>::value);
+  MNRY_STATIC_ASSERT(std::is_trivially_copyable<Mat4d>::value);
+
   ////////////////////////////////////////////////////////////////////////////////
   /// asIspc() and asCpp() C++ <--> ISPC Type-casting functions
   ////////////////////////////////////////////////////////////////////////////////
@@ -5,6 +5,7 @@
 #include "ValueContainerUtils.h"
 
 #include <cstring> // std::memcpy
+#include <type_traits>
 
 // This is a directive for debug message dump. Use this directive, all dequeue operations
 // are displayed to std::cout
@@ -66,12 +67,7 @@ public:
     template <typename T> void
     deq(T& t)
     {
-        // Unfortunately following statis_assert return error from
-        // rdl2::Rgb, rdl2::Rgba, rdl2::Mat4f and rdl2::Mat4d
-        // I commented out at this moment. Toshi (Apr/27/2020)
-        /*
         static_assert(std::is_trivially_copyable<T>::value, "Calling memcpy");
-        */
         const void *ptr = getDeqDataAddrUpdate(sizeof(T));
         std::memcpy(static_cast<void*>(&t), ptr, sizeof(T));
         VALUE_CONTAINER_DEQ_DEBUG_MSG("deq(" << demangle(typeid(T).name()) << "):>" << t << "<\n");
@@ -129,27 +125,23 @@ public:
     template <typename T> void 
     deqVector(T &vec)
     {
+        // Items are stored contiguously, copy them in one go.
+        using ValueT = typename T::value_type;
+        static_assert(std::is_trivially_copyable<ValueT>::value, "Calling memcpy");
+
         unsigned long size;
         updateCurrPtr(ValueContainerUtil::variableLengthDecoding(mCurrPtr, size));
         VALUE_CONTAINER_DEQ_DEBUG_MSG("deqVector("
                                       << demangle(typeid(T).name()) << ").size():>" << size << "<\n");
         vec.resize(size);
-        const void* ptr = getDeqDataAddrUpdate(sizeof(vec[0]) * size);
+        const void* ptr = getDeqDataAddrUpdate(sizeof(ValueT) * size);
+        if (size) std::memcpy(static_cast<void*>(vec.data()), ptr, sizeof(ValueT) * size);
+#ifdef VALUE_CONTAINER_DEQ_DEBUG_MSG_ON
         for (size_t i = 0; i < size; ++i) {
-            // Unfortunately following statis_assert return error from
-            // rdl2::IntVector, ValueCacheDeq::UIntVector, rdl2::LongVector, rdl2::FloatVector,
-            // rdl2::DoubleVector, rdl2::RgbVector, rdl2::RgbaVector,
-            // rdl2::Vec2fVector, rdl2::Vec2dVector, rdl2::Vec3fVector, rdl2::Vec3dVector,
-            // rdl2::Vec4fVector, rdl2::Vec4dVector, rdl2::Mat4fVector, rdl2::Mat4dVector
-            // I commented out at this moment. Toshi (Apr/27/2020)
-            /*
-            static_assert(std::is_trivially_copyable<T>::value, "Calling memcpy");
-            */
-            std::memcpy(static_cast<void*>(&vec[i]), ptr, sizeof(vec[i]));
-            ptr = (const void*)((uintptr_t)ptr + (uintptr_t)sizeof(vec[i]));
             VALUE_CONTAINER_DEQ_DEBUG_MSG("  deqVector(" << demangle(typeid(T).name()) << ") " <<
                                           "vec[" << i << "]:>" << vec[i] << "<\n");
         }
+#endif // end VALUE_CONTAINER_DEQ_DEBUG_MSG_ON
     }
 
     inline void deqBoolVector(BoolVector& vec);
@@ -5,6 +5,7 @@
 #include "ValueContainerUtils.h"
 
 #include <cstring> // std::memcpy
+#include <type_traits>
 
 // This is a directive for debug message dump. Use this directive, all enqueue operations
 // are displayed to std::cout
@@ -102,6 +103,7 @@ public:
     template <typename T> void
     enqVector(const T& vec)
     {
+        static_assert(std::is_trivially_copyable<typename T::value_type>::value, "Calling memcpy");
         const size_t len = ValueContainerUtil::variableLengthLongMaxSize + sizeof(vec[0]) * vec.size();
         void* ptr = getEnqDataAddr(len);
         const size_t len2 = ValueContainerUtil::variableLengthEncoding(static_cast<unsigned long>(vec.size()), ptr);
@@ -109,7 +111,7 @@ public:
         VALUE_CONTAINER_ENQ_DEBUG_MSG("enqVector(" << demangle(typeid(T).name()) << ").size():>"
                                        << vec.size() << "<\n");
         // all vec items are stored in contiguous address
-        memoryCopy(ptr, &vec[0], sizeof(vec[0]) * vec.size());
+        memoryCopy(ptr, vec.data(), sizeof(vec[0]) * vec.size());
         ptr = (void *)((uintptr_t)ptr + sizeof(vec[0]) * vec.size());
         updateId(ptr);
         VALUE_CONTAINER_ENQ_COUNTER(vec);
@@ -0,0 +1,1643 @@
+// Copyright 2023-2024 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+#include "AsciiNativeReader.h"
+
+#include "Attribute.h"
+#include "Displacement.h"
+#include "Geometry.h"
+#include "GeometrySet.h"
+#include "Layer.h"
+#include "Light.h"
+#include "LightFilter.h"
+#include "LightFilterSet.h"
+#include "LightSet.h"
+#include "Material.h"
+#include "Metadata.h"
+#include "SceneClass.h"
+#include "SceneContext.h"
+#include "SceneObject.h"
+#include "SceneVariables.h"
+#include "ShadowReceiverSet.h"
+#include "ShadowSet.h"
+#include "TraceSet.h"
+#include "VolumeShader.h"
+
+#include <scene_rdl2/common/except/exceptions.h>
+#include <scene_rdl2/render/logging/logging.h>
+#include <scene_rdl2/render/util/BitUtils.h>
+#include <scene_rdl2/render/util/Strings.h>
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <string_view>
+
+namespace scene_rdl2 {
+namespace rdl2 {
+
+using logging::Logger;
+
+namespace {
+
+// The globals the subset knows about, other than SceneClass constructors.
+enum Global : uint8_t
+{
+    GLOBAL_NONE,
+    GLOBAL_TRUE,
+    GLOBAL_FALSE,
+    GLOBAL_RGB,
+    GLOBAL_RGBA,
+    GLOBAL_VEC2,
+    GLOBAL_VEC3,
+    GLOBAL_VEC4,
+    GLOBAL_MAT4,
+    GLOBAL_BIND,
+    GLOBAL_BLUR,
+    GLOBAL_UNDEF,
+    GLOBAL_GEOMETRY_SET,
+    GLOBAL_LIGHT_SET,
+    GLOBAL_LIGHT_FILTER_SET,
+    GLOBAL_SHADOW_SET,
+    GLOBAL_SHADOW_RECEIVER_SET,
+    GLOBAL_TRACE_SET,
+    GLOBAL_LAYER,
+    GLOBAL_METADATA,
+    GLOBAL_SCENE_VARIABLES,
+    GLOBAL_RESERVED,
+    GLOBAL_KEYWORD
+};
+
+Global
+findGlobal(const std::string& name)
+{
+    static const std::unordered_map<std::string, Global> globals = {
+        { "true", GLOBAL_TRUE },
+        { "false", GLOBAL_FALSE },
+        { "Rgb", GLOBAL_RGB },
+        { "Rgba", GLOBAL_RGBA },
+        { "Vec2", GLOBAL_VEC2 },
+        { "Vec3", GLOBAL_VEC3 },
+        { "Vec4", GLOBAL_VEC4 },
+        { "Mat4", GLOBAL_MAT4 },
+        { "bind", GLOBAL_BIND },
+        { "blur", GLOBAL_BLUR },
+        { "undef", GLOBAL_UNDEF },
+        { "GeometrySet", GLOBAL_GEOMETRY_SET },
+        { "LightSet", GLOBAL_LIGHT_SET },
+        { "LightFilterSet", GLOBAL_LIGHT_FILTER_SET },
+        { "ShadowSet", GLOBAL_SHADOW_SET },
+        { "ShadowReceiverSet", GLOBAL_SHADOW_RECEIVER_SET },
+        { "TraceSet", GLOBAL_TRACE_SET },
+        { "Layer", GLOBAL_LAYER },
+        { "Metadata", GLOBAL_METADATA },
+        { "SceneVariables", GLOBAL_SCENE_VARIABLES },
+        { "SceneClass", GLOBAL_RESERVED },
+        { "SceneObject", GLOBAL_RESERVED },
+        { "and", GLOBAL_KEYWORD }, { "break", GLOBAL_KEYWORD },
+        { "do", GLOBAL_KEYWORD }, { "else", GLOBAL_KEYWORD },
+        { "elseif", GLOBAL_KEYWORD }, { "end", GLOBAL_KEYWORD },
+        { "for", GLOBAL_KEYWORD }, { "function", GLOBAL_KEYWORD },
+        { "goto", GLOBAL_KEYWORD }, { "if", GLOBAL_KEYWORD },
+        { "in", GLOBAL_KEYWORD }, { "local", GLOBAL_KEYWORD },
+        { "nil", GLOBAL_KEYWORD }, { "not", GLOBAL_KEYWORD },
+        { "or", GLOBAL_KEYWORD }, { "repeat", GLOBAL_KEYWORD },
+        { "return", GLOBAL_KEYWORD }, { "then", GLOBAL_KEYWORD },
+        { "until", GLOBAL_KEYWORD }, { "while", GLOBAL_KEYWORD }
+    };
+    auto iter = globals.find(name);
+    return iter == globals.end() ? GLOBAL_NONE : iter->second;
+}
+
+// The same aliases the RDLA support library applies to constructor names.
+const std::string&
+aliasClassName(const std::string& name)
+{
+    static const std::string perspectiveCamera("PerspectiveCamera");
+    return name == "Camera" ? perspectiveCamera : name;
+}
+
+// Number of arguments of the value constructors, or -1 if it varies.
+int
+callArgCount(Global global)
+{
+    switch (global) {
+    case GLOBAL_RGB:   return 3;
+    case GLOBAL_RGBA:  return 4;
+    case GLOBAL_VEC2:  return 2;
+    case GLOBAL_VEC3:  return 3;
+    case GLOBAL_VEC4:  return 4;
+    case GLOBAL_MAT4:  return 16;
+    case GLOBAL_BLUR:  return 2;
+    case GLOBAL_UNDEF: return 0;
+    default:           return -1;
+    }
+}
+
+inline bool
+isNameStart(char c)
+{
+    return std::isalpha(static_cast<unsigned char>(c)) || c == '_';
+}
+
+inline bool
+isNameChar(char c)
+{
+    return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+}
+
+// Mirrors luaO_chunkid(), so messages name the chunk the way Lua does.
+std::string
+chunkId(const std::string& chunkName)
+{
+    if (!chunkName.empty() && (chunkName[0] == '@' || chunkName[0] == '=')) {
+        return chunkName.substr(1);
+    }
+    return util::buildString("[string \"", chunkName, "\"]");
+}
+
+} // namespace
+
+AsciiNativeReader::AsciiNativeReader(SceneContext& context) :
+    mContext(context),
+    mPos(nullptr),
+    mEnd(nullptr),
+    mLine(1),
+    mToken(Token::END),
+    mPunct(0),
+    mNumber(0.0)
+{
+}
+
+// static function
+Float
+AsciiNativeReader::toFloat(double number)
+{
+    if (number >= 0x1.0p-126 || number <= -0x1.0p-126 || number == 0.0) {
+        // Normal float
+        return static_cast<float>(number);
+    }
+
+    // Denormal float - create bit pattern for mantissa.
+    // A denormal float works very much like an integer in its representation - it has a fixed exponent encoded as all
+    // zeros, its mantissa ranges from 0x00000001 to 0x007FFFFF, and every 1ulp step in this value represents the same
+    // distance in float space. So you just need to scale the double up by a suitably large power of 2 such that the
+    // integer part becomes the desired bit pattern, and convert to int. The necessary exponent is 126+23: 126 to undo
+    // the float exponent bias, plus 23 since 0x007FFFFF is 2^23-1. The only thing needed beyond this is special
+    // treatment of the sign bit, because the denormal bit pattern doesn't behave like a two's complement number.
+    int bits = static_cast<int>(std::round(number * 0x1.0p149));
+    if (number < 0.0) {
+        // Mantissa needs to be a positive number. So if the value was negative,
+        // negate the mantissa and set the sign bit
+        bits = -bits | 0x80000000;
+    }
+    return util::bitCast<float>(bits);
+}
+
+// ---------------------------------------------------------------------------
+//      LEXER
+// ---------------------------------------------------------------------------
+
+bool
+AsciiNativeReader::skipSpaceAndComments()
+{
+    while (mPos < mEnd) {
+        const char c = *mPos;
+        if (c == '\n') {
+            ++mLine;
+            ++mPos;
+        } else if (c == ' ' || c == '\t' || c == '\r' || c == '\f' || c == '\v') {
+            ++mPos;
+        } else if (c == '-' && mPos + 1 < mEnd && mPos[1] == '-') {
+            mPos += 2;
+
+            // A long comment opens with a long bracket: [[ or [==[.
+            int level = -1;
+            if (mPos < mEnd && *mPos == '[') {
+                const char* p = mPos + 1;
+                while (p < mEnd && *p == '=') ++p;
+                if (p < mEnd && *p == '[') level = static_cast<int>(p - mPos - 1);
+            }
+
+            if (level < 0) {
+                while (mPos < mEnd && *mPos != '\n') ++mPos;
+                continue;
+            }
+
+            // Find the matching closing bracket.
+            mPos += level + 2;
+            for (;;) {
+                if (mPos >= mEnd) return false; // Unfinished long comment.
+                if (*mPos == '\n') {
+                    ++mLine;
+                } else if (*mPos == ']') {
+                    const char* p = mPos + 1;
+                    while (p < mEnd && *p == '=') ++p;
+                    if (p < mEnd && *p == ']' && p - mPos - 1 == level) {
+                        mPos = p + 1;
+                        break;
+                    }
+                }
+                ++mPos;
+            }
+        } else {
+            break;
+        }
+    }
+    return true;
+}
+
+bool
+AsciiNativeReader::readString(char quote)
+{
+    // Handles the escapes AsciiWriter output can contain. The rarer ones
+    // (\z, \u{XXX}) fall back to Lua.
+    mText.clear();
+    ++mPos;
+    while (mPos < mEnd) {
+        const char c = *mPos++;
+        if (c == quote) {
+            return true;
+        } else if (c == '\n' || c == '\r') {
+            return false; // Unfinished string.
+        } else if (c != '\\') {
+            mText.push_back(c);
+            continue;
+        }
+
+        if (mPos >= mEnd) return false;
+        const char e = *mPos++;
+        switch (e) {
+        case 'a':  mText.push_back('\a'); break;
+        case 'b':  mText.push_back('\b'); break;
+        case 'f':  mText.push_back('\f'); break;
+        case 'n':  mText.push_back('\n'); break;
+        case 'r':  mText.push_back('\r'); break;
+        case 't':  mText.push_back('\t'); break;
+        case 'v':  mText.push_back('\v'); break;
+        case '\\': mText.push_back('\\'); break;
+        case '"':  mText.push_back('"');  break;
+        case '\'': mText.push_back('\''); break;
+        case '\n':
+        case '\r':
+            // An escaped line break is a line break, \r\n and \n\r count once.
+            if (mPos < mEnd && (*mPos == '\n' || *mPos == '\r') && *mPos != e) ++mPos;
+            mText.push_back('\n');
+            ++mLine;
+            break;
+        case 'x':
+            {
+                int value = 0;
+                for (int i = 0; i < 2; ++i) {
+                    if (mPos >= mEnd || !std::isxdigit(static_cast<unsigned char>(*mPos))) {
+                        return false;
+                    }
+                    const char h = *mPos++;
+                    value = value * 16 + (std::isdigit(static_cast<unsigned char>(h)) ?
+                            h - '0' : (std::tolower(static_cast<unsigned char>(h)) - 'a' + 10));
+                }
+                mText.push_back(static_cast<char>(value));
+            }
+            break;
+        default:
+            if (!std::isdigit(static_cast<unsigned char>(e))) return false;
+            {
+                int value = e - '0';
+                for (int i = 0; i < 2 && mPos < mEnd &&
+                        std::isdigit(static_cast<unsigned char>(*mPos)); ++i) {
+                    value = value * 10 + (*mPos++ - '0');
+                }
+                if (value > 255) return false;
+                mText.push_back(static_cast<char>(value));
+            }
+            break;
+        }
+    }
+    return false; // Unfinished string.
+}
+
+bool
+AsciiNativeReader::readNumber()
+{
+    // Consume the numeral the way Lua's lexer does, then insist that strtod()
+    // (which is also what Lua converts decimal numerals with) consumes all
+    // of it. Hexadecimal numerals have different integer semantics in Lua, so
+    // they fall back.
+    const char* start = mPos;
+    if (mPos + 1 < mEnd && mPos[0] == '0' && (mPos[1] == 'x' || mPos[1] == 'X')) {
+        return false;
+    }
+    while (mPos < mEnd) {
+        const char c = *mPos;
+        if ((c == 'e' || c == 'E') && mPos + 1 < mEnd && (mPos[1] == '+' || mPos[1] == '-')) {
+            mPos += 2;
+        } else if (std::isxdigit(static_cast<unsigned char>(c)) || c == '.') {
+            ++mPos;
+        } else {
+            break;
+        }
+    }
+    if (mPos < mEnd && isNameChar(*mPos)) return false;
+
+    char buffer[64];
+    const std::size_t length = mPos - start;
+    if (length >= sizeof(buffer)) return false;
+    std::memcpy(buffer, start, length);
+    buffer[length] = '\0';
+
+    char* end = nullptr;
+    mNumber = std::strtod(buffer, &end);
+    return end == buffer + length;
+}
+
+AsciiNativeReader::Token
+AsciiNativeReader::next()
+{
+    if (!skipSpaceAndComments()) {
+        return mToken = Token::INVALID;
+    }
+    if (mPos >= mEnd) {
+        return mToken = Token::END;
+    }
+
+    const char c = *mPos;
+    if (isNameStart(c)) {
+        const char* start = mPos;
+        while (mPos < mEnd && isNameChar(*mPos)) ++mPos;
+        mText.assign(start, mPos);
+        return mToken = Token::NAME;
+    }
+    if (std::isdigit(static_cast<unsigned char>(c)) ||
+            (c == '.' && mPos + 1 < mEnd && std::isdigit(static_cast<unsigned char>(mPos[1])))) {
+        return mToken = (readNumber() ? Token::NUMBER : Token::INVALID);
+    }
+    if (c == '"' || c == '\'') {
+        return mToken = (readString(c) ? Token::STRING : Token::INVALID);
+    }
+
+    switch (c) {
+    case '[':
+        // [[ and [= open long strings.
+        if (mPos + 1 < mEnd && (mPos[1] == '[' || mPos[1] == '=')) {
+            return mToken = Token::INVALID;
+        }
+        break;
+    case '=':
+        // == is an operator.
+        if (mPos + 1 < mEnd && mPos[1] == '=') {
+            return mToken = Token::INVALID;
+        }
+        break;
+    case '(': case ')': case '{': case '}': case ']': case ',': case ';': case '-':
+        break;
+    default:
+        return mToken = Token::INVALID;
+    }
+    mPunct = c;
+    ++mPos;
+    return mToken = Token::PUNCT;
+}
+
+bool
+AsciiNativeReader::accept(char punct)
+{
+    if (mToken == Token::PUNCT && mPunct == punct) {
+        next();
+        return true;
+    }
+    return false;
+}
+
+// ---------------------------------------------------------------------------
+//      PARSER
+// ---------------------------------------------------------------------------
+
+uint32_t
+AsciiNativeReader::addNode(Kind kind, uint32_t first, uint32_t count, double number)
+{
+    mNodes.push_back(Node{ kind, first, count, number });
+    return static_cast<uint32_t>(mNodes.size() - 1);
+}
+
+uint32_t
+AsciiNativeReader::addString(const std::string& str)
+{
+    mStrings.push_back(str);
+    return static_cast<uint32_t>(mStrings.size() - 1);
+}
+
+uint32_t
+AsciiNativeReader::internString(const std::string& str)
+{
+    auto result = mInterned.emplace(str, static_cast<uint32_t>(mStrings.size()));
+    if (result.second) {
+        mStrings.push_back(str);
+    }
+    return result.first->second;
+}
+
+void
+AsciiNativeReader::addGlobalName(const std::string& name)
+{
+    if (mGlobalSet.insert(name).second) {
+        mGlobalNames.push_back(name);
+    }
+}
+
+void
+AsciiNativeReader::beginChildren(uint32_t& base) const
+{
+    base = static_cast<uint32_t>(mScratchNodes.size());
+}
+
+void
+AsciiNativeReader::endChildren(uint32_t base, uint32_t& first, uint32_t& count)
+{
+    first = static_cast<uint32_t>(mChildren.size());
+    count = static_cast<uint32_t>(mScratchNodes.size() - base);
+    mChildren.insert(mChildren.end(), mScratchNodes.begin() + base, mScratchNodes.end());
+    mKeys.insert(mKeys.end(), mScratchKeys.begin() + base, mScratchKeys.end());
+    mScratchNodes.resize(base);
+    mScratchKeys.resize(base);
+}
+
+bool
+AsciiNativeReader::parse(const std::string& code)
+{
+    mNodes.clear();
+    mChildren.clear();
+    mKeys.clear();
+    mStrings.clear();
+    mInterned.clear();
+    mRefs.clear();
+    mBlocks.clear();
+    mGlobalNames.clear();
+    mGlobalSet.clear();
+    mClassNames.clear();
+    mAttributes.clear();
+    mScratchNodes.clear();
+    mScratchKeys.clear();
+
+    mPos = code.data();
+    mEnd = mPos + code.size();
+    mLine = 1;
+    next();
+    while (mToken != Token::END) {
+        if (accept(';')) continue;
+        if (!parseBlock()) return false;
+    }
+    return true;
+}
+
+bool
+AsciiNativeReader::parseBlock()
+{
+    if (mToken != Token::NAME) return false;
+    const std::string name = mText;
+    const int line = mLine;
+    next();
+
+    Block block;
+    block.mLine = line;
+    block.mTable = NONE;
+
+    const Global global = findGlobal(name);
+    if (global == GLOBAL_SCENE_VARIABLES) {
+        // SceneVariables is an object rather than a constructor.
+        if (mToken != Token::PUNCT || mPunct != '{') return false;
+        addGlobalName(name);
+        mRefs.push_back(Ref{ Ctor::SCENE_VARIABLES, internString("SceneVariables"),
+                             addString("__SceneVariables__"), 0, nullptr, INTERFACE_GENERIC });
+        block.mObject = addNode(Kind::OBJECT, static_cast<uint32_t>(mRefs.size() - 1));
+    } else {
+        if (!parseNamed(name, block.mObject) || mNodes[block.mObject].mKind != Kind::OBJECT) {
+            return false;
+        }
+    }
+
+    if (mToken == Token::PUNCT && mPunct == '{') {
+        if (!parseTable(block.mTable)) return false;
+    } else if (global == GLOBAL_SCENE_VARIABLES) {
+        return false;
+    }
+
+    mBlocks.push_back(block);
+    return true;
+}
+
+bool
+AsciiNativeReader::parseValue(uint32_t& node)
+{
+    switch (mToken) {
+    case Token::NUMBER:
+        node = addNode(Kind::NUMBER, 0, 0, mNumber);
+        next();
+        return true;
+
+    case Token::STRING:
+        node = addNode(Kind::STRING, addString(mText));
+        next();
+        return true;
+
+    case Token::NAME:
+        {
+            const std::string name = mText;
+            next();
+            return parseNamed(name, node);
+        }
+
+    case Token::PUNCT:
+        if (mPunct == '{') {
+            return parseTable(node);
+        } else if (mPunct == '-') {
+            // Only negative numbers, not general unary minus.
+            next();
+            if (mToken != Token::NUMBER) return false;
+            node = addNode(Kind::NUMBER, 0, 0, -mNumber);
+            next();
+            return true;
+        }
+        return false;
+
+    default:
+        return false;
+    }
+}
+
+bool
+AsciiNativeReader::parseNamed(const std::string& name, uint32_t& node)
+{
+    const Global global = findGlobal(name);
+    switch (global) {
+    case GLOBAL_TRUE:
+    case GLOBAL_FALSE:
+        node = addNode(Kind::BOOL, 0, 0, global == GLOBAL_TRUE ? 1.0 : 0.0);
+        return true;
+
+    case GLOBAL_RGB:
+    case GLOBAL_RGBA:
+    case GLOBAL_VEC2:
+    case GLOBAL_VEC3:
+    case GLOBAL_VEC4:
+    case GLOBAL_MAT4:
+    case GLOBAL_BIND:
+    case GLOBAL_BLUR:
+    case GLOBAL_UNDEF:
+        return parseCall(name, global, node);
+
+    case GLOBAL_GEOMETRY_SET:       return parseReference(Ctor::GEOMETRY_SET, name, node);
+    case GLOBAL_LIGHT_SET:          return parseReference(Ctor::LIGHT_SET, name, node);
+    case GLOBAL_LIGHT_FILTER_SET:   return parseReference(Ctor::LIGHT_FILTER_SET, name, node);
+    case GLOBAL_SHADOW_SET:         return parseReference(Ctor::SHADOW_SET, name, node);
+    case GLOBAL_SHADOW_RECEIVER_SET:return parseReference(Ctor::SHADOW_RECEIVER_SET, name, node);
+    case GLOBAL_TRACE_SET:          return parseReference(Ctor::TRACE_SET, name, node);
+    case GLOBAL_LAYER:              return parseReference(Ctor::LAYER, name, node);
+    case GLOBAL_METADATA:           return parseReference(Ctor::METADATA, name, node);
+    case GLOBAL_NONE:               return parseReference(Ctor::SCENE_OBJECT, name, node);
+
+    default:
+        // Keywords, the generic SceneClass() and SceneObject() functions,
+        // and SceneVariables used as a value.
+        return false;
+    }
+}
+
+bool
+AsciiNativeReader::parseCall(const std::string& name, int global, uint32_t& node)
+{
+    if (!accept('(')) return false;
+
+    uint32_t base;
+    beginChildren(base);
+    if (!accept(')')) {
+        for (;;) {
+            uint32_t arg;
+            if (!parseValue(arg)) return false;
+            mScratchNodes.push_back(arg);
+            mScratchKeys.push_back(NONE);
+            if (accept(')')) break;
+            if (!accept(',')) return false;
+        }
+    }
+
+    const std::size_t argCount = mScratchNodes.size() - base;
+    const int expected = callArgCount(static_cast<Global>(global));
+    if (expected >= 0 && argCount != static_cast<std::size_t>(expected)) return false;
+
+    Kind kind;
+    switch (global) {
+    case GLOBAL_RGB:   kind = Kind::RGB;   break;
+    case GLOBAL_RGBA:  kind = Kind::RGBA;  break;
+    case GLOBAL_VEC2:  kind = Kind::VEC2;  break;
+    case GLOBAL_VEC3:  kind = Kind::VEC3;  break;
+    case GLOBAL_VEC4:  kind = Kind::VEC4;  break;
+    case GLOBAL_MAT4:  kind = Kind::MAT4;  break;
+    case GLOBAL_BIND:  kind = Kind::BIND;  break;
+    case GLOBAL_BLUR:  kind = Kind::BLUR;  break;
+    default:           kind = Kind::UNDEF; break;
+    }
+
+    if (kind == Kind::BIND) {
+        if (argCount != 1 && argCount != 2) return false;
+    } else if (kind == Kind::BLUR) {
+        // blur() insists on two values of the same Lua type and metatable,
+        // and doesn't nest with bind() or blur(). Tables have no metatable.
+        const Node& a = mNodes[mScratchNodes[base]];
+        const Node& b = mNodes[mScratchNodes[base + 1]];
+        if (a.mKind != b.mKind || a.mKind == Kind::TABLE ||
+                a.mKind == Kind::BIND || a.mKind == Kind::BLUR) {
+            return false;
+        }
+        if (a.mKind == Kind::OBJECT && mRefs[a.mFirst].mCtor != mRefs[b.mFirst].mCtor) {
+            return false;
+        }
+    } else if (kind != Kind::UNDEF) {
+        // The math types only take numbers.
+        for (std::size_t i = base; i < mScratchNodes.size(); ++i) {
+            if (mNodes[mScratchNodes[i]].mKind != Kind::NUMBER) return false;
+        }
+    }
+
+    addGlobalName(name);
+    uint32_t first, count;
+    endChildren(base, first, count);
+    node = addNode(kind, first, count);
+    return true;
+}
+
+bool
+AsciiNativeReader::parseReference(Ctor ctor, const std::string& name, uint32_t& node)
+{
+    // Name("object") or Name "object".
+    const bool parens = accept('(');
+    if (mToken != Token::STRING) return false;
+    const uint32_t objectName = addString(mText);
+    next();
+    if (parens && !accept(')')) return false;
+
+    addGlobalName(name);
+    uint32_t className;
+    if (ctor == Ctor::SCENE_OBJECT) {
+        // Constructors are resolved through the SceneClass() and
+        // SceneObject() globals.
+        addGlobalName("SceneClass");
+        addGlobalName("SceneObject");
+        const std::string& alias = aliasClassName(name);
+        const std::size_t numStrings = mStrings.size();
+        className = internString(alias);
+        if (mStrings.size() != numStrings) {
+            mClassNames.push_back(alias);
+        }
+    } else {
+        className = internString(name);
+    }
+
+    mRefs.push_back(Ref{ ctor, className, objectName, 0, nullptr, INTERFACE_GENERIC });
+    node = addNode(Kind::OBJECT, static_cast<uint32_t>(mRefs.size() - 1));
+    return true;
+}
+
+bool
+AsciiNativeReader::parseTable(uint32_t& node)
+{
+    if (!accept('{')) return false;
+
+    uint32_t base;
+    beginChildren(base);
+    while (!accept('}')) {
+        uint32_t key = NONE;
+        uint32_t value;
+        if (accept('[')) {
+            // ["key"] = value
+            if (mToken != Token::STRING) return false;
+            key = internString(mText);
+            next();
+            if (!accept(']') || !accept('=')) return false;
+            if (!parseValue(value)) return false;
+        } else if (mToken == Token::NAME) {
+            // key = value, or a value which starts with a name.
+            const std::string name = mText;
+            next();
+            if (accept('=')) {
+                if (findGlobal(name) == GLOBAL_KEYWORD ||
+                        name == "true" || name == "false") {
+                    return false;
+                }
+                key = internString(name);
+                if (!parseValue(value)) return false;
+            } else if (!parseNamed(name, value)) {
+                return false;
+            }
+        } else if (!parseValue(value)) {
+            return false;
+        }
+        mScratchNodes.push_back(value);
+        mScratchKeys.push_back(key);
+
+        if (!accept(',') && !accept(';')) {
+            if (!accept('}')) return false;
+            break;
+        }
+    }
+
+    uint32_t first, count;
+    endChildren(base, first, count);
+    node = addNode(Kind::TABLE, first, count);
+    return true;
+}
+
+const AsciiNativeReader::Node&
+AsciiNativeReader::child(uint32_t node, uint32_t i) const
+{
+    return mNodes[mChildren[mNodes[node].mFirst + i]];
+}
+
+uint32_t
+AsciiNativeReader::childKey(uint32_t node, uint32_t i) const
+{
+    return mKeys[mNodes[node].mFirst + i];
+}
+
+// ---------------------------------------------------------------------------
+//      VALIDATION
+// ---------------------------------------------------------------------------
+
+bool
+AsciiNativeReader::validate()
+{
+    // Resolve every reference to a SceneClass and to an existing or planned
+    // SceneObject, the same way createSceneObject() would.
+    std::unordered_map<uint32_t, SceneClass*> classes;
+    std::unordered_map<std::string_view, uint32_t> planned;
+    for (uint32_t i = 0; i < mRefs.size(); ++i) {
+        Ref& ref = mRefs[i];
+        ref.mFirst = i;
+
+        if (ref.mCtor == Ctor::SCENE_VARIABLES) {
+            ref.mExisting = &mContext.getSceneVariables();
+            ref.mInterface = ref.mExisting->getType();
+            continue;
+        }
+
+        const std::string& objectName = mStrings[ref.mObjectName];
+        if (objectName.empty()) return false;
+
+        auto plannedIter = planned.find(objectName);
+        if (plannedIter != planned.end()) {
+            const Ref& first = mRefs[plannedIter->second];
+            if (first.mClassName != ref.mClassName) return false;
+            ref.mFirst = first.mFirst;
+            ref.mExisting = first.mExisting;
+            ref.mInterface = first.mInterface;
+            continue;
+        }
+        planned.emplace(objectName, i);
+
+        if (mContext.sceneObjectExists(objectName)) {
+            SceneObject* existing = mContext.getSceneObject(objectName);
+            if (existing->getSceneClass().getName() != mStrings[ref.mClassName]) return false;
+            ref.mExisting = existing;
+            ref.mInterface = existing->getType();
+            continue;
+        }
+
+        auto classIter = classes.find(ref.mClassName);
+        if (classIter == classes.end()) {
+            // Lua reports classes which can't be created, with its own
+            // messages.
+            SceneClass* sc = nullptr;
+            try {
+                sc = mContext.createSceneClass(mStrings[ref.mClassName]);
+            } catch (const std::exception&) {
+                return false;
+            }
+            classIter = classes.emplace(ref.mClassName, sc).first;
+        }
+        ref.mInterface = classIter->second->getDeclaredInterface();
+    }
+
+    mAttributes.assign(mChildren.size(), nullptr);
+    for (const Block& block : mBlocks) {
+        if (block.mTable == NONE) continue;
+
+        const Ref& ref = mRefs[mNodes[block.mObject].mFirst];
+        bool valid = false;
+        switch (ref.mCtor) {
+        case Ctor::SCENE_OBJECT:
+        case Ctor::SCENE_VARIABLES:
+        case Ctor::SHADOW_RECEIVER_SET:
+            valid = validateMassSet(block, ref);
+            break;
+        case Ctor::GEOMETRY_SET:
+            valid = validateSet(block, interfaceType<Geometry>());
+            break;
+        case Ctor::LIGHT_SET:
+        case Ctor::SHADOW_SET:
+            valid = validateSet(block, interfaceType<Light>());
+            break;
+        case Ctor::LIGHT_FILTER_SET:
+            valid = validateSet(block, interfaceType<LightFilter>());
+            break;
+        case Ctor::TRACE_SET:
+            valid = validateTraceSet(block);
+            break;
+        case Ctor::LAYER:
+            valid = validateLayer(block);
+            break;
+        case Ctor::METADATA:
+            valid = validateMetadata(block);
+            break;
+        }
+        if (!valid) return false;
+    }
+    return true;
+}
+
+const SceneClass*
+AsciiNativeReader::refSceneClass(const Ref& ref)
+{
+    if (ref.mExisting) {
+        return &ref.mExisting->getSceneClass();
+    }
+    return mContext.getSceneClass(mStrings[ref.mClassName]);
+}
+
+const Attribute*
+AsciiNativeReader::findAttribute(const SceneClass* sc, uint32_t key)
+{
+    // Blocks of the same class name the same attributes over and over, so
+    // cache the lookups per class and key.
+    std::vector<const Attribute*>& cache = mAttributeCache[sc];
+    if (cache.size() <= key) {
+        cache.resize(mStrings.size(), nullptr);
+    }
+    const Attribute*& attr = cache[key];
+    if (!attr) {
+        try {
+            attr = sc->getAttribute(mStrings[key]);
+        } catch (const except::KeyError&) {
+            return nullptr;
+        }
+    }
+    return attr;
+}
+
+bool
+AsciiNativeReader::validateMassSet(const Block& block, const Ref& ref)
+{
+    const SceneClass* sc = refSceneClass(ref);
+    const Node& table = mNodes[block.mTable];
+    for (uint32_t i = 0; i < table.mCount; ++i) {
+        // Positional values would be looked up as attributes "1", "2"...
+        const uint32_t key = childKey(block.mTable, i);
+        if (key == NONE) return false;
+
+        const Attribute* attr = findAttribute(sc, key);
+        if (!attr || !validateAttribute(attr, mChildren[table.mFirst + i])) {
+            return false;
+        }
+        mAttributes[table.mFirst + i] = attr;
+    }
+    return true;
+}
+
+bool
+AsciiNativeReader::validateAttribute(const Attribute* attr, uint32_t node)
+{
+    if (mNodes[node].mKind == Kind::BIND) {
+        if (!attr->isBindable()) return false;
+
+        const uint32_t binding = mChildren[mNodes[node].mFirst];
+        if (!validateObjectValue(attr, binding)) return false;
+
+        if (mNodes[node].mCount == 1) return true;
+        node = mChildren[mNodes[node].mFirst + 1];
+    }
+
+    if (mNodes[node].mKind == Kind::BLUR) {
+        return validateValue(attr, attr->getType(), mChildren[mNodes[node].mFirst], false) &&
+               validateValue(attr, attr->getType(), mChildren[mNodes[node].mFirst + 1], false);
+    }
+    return validateValue(attr, attr->getType(), node, false);
+}
+
+bool
+AsciiNativeReader::validateObjectValue(const Attribute* attr, uint32_t node)
+{
+    const Node& value = mNodes[node];
+    if (value.mKind == Kind::UNDEF) return true;
+    if (value.mKind != Kind::OBJECT) return false;
+
+    // ShadowReceiverSets aren't accepted as values by the Lua callbacks.
+    const Ref& ref = mRefs[value.mFirst];
+    if (ref.mCtor == Ctor::SHADOW_RECEIVER_SET) return false;
+    return (ref.mInterface & attr->getObjectType()) != 0;
+}
+
+bool
+AsciiNativeReader::validateValue(const Attribute* attr, AttributeType type,
+                                 uint32_t node, bool inVector)
+{
+    const Node& value = mNodes[node];
+    switch (type) {
+    case TYPE_BOOL:
+        return value.mKind == Kind::BOOL;
+
+    case TYPE_INT:
+        if (value.mKind == Kind::STRING && !inVector && attr->isEnumerable()) {
+            const std::string& str = mStrings[value.mFirst];
+            for (auto it = attr->beginEnumValues(); it != attr->endEnumValues(); ++it) {
+                if (it->second == str) return true;
+            }
+            return false;
+        }
+        return value.mKind == Kind::NUMBER;
+
+    case TYPE_LONG:
+    case TYPE_FLOAT:
+    case TYPE_DOUBLE:
+        return value.mKind == Kind::NUMBER;
+
+    case TYPE_STRING:
+        return value.mKind == Kind::STRING;
+
+    case TYPE_RGB:
+        return value.mKind == Kind::RGB;
+
+    case TYPE_RGBA:
+        return value.mKind == Kind::RGBA;
+
+    case TYPE_VEC2F:
+    case TYPE_VEC2D:
+        return value.mKind == Kind::VEC2;
+
+    case TYPE_VEC3F:
+    case TYPE_VEC3D:
+        return value.mKind == Kind::VEC3;
+
+    case TYPE_VEC4F:
+    case TYPE_VEC4D:
+        return value.mKind == Kind::VEC4;
+
+    case TYPE_MAT4F:
+    case TYPE_MAT4D:
+        return value.mKind == Kind::MAT4;
+
+    case TYPE_SCENE_OBJECT:
+        return validateObjectValue(attr, node);
+
+    default:
+        break;
+    }
+
+    AttributeType elemType;
+    switch (type) {
+    case TYPE_BOOL_VECTOR:          elemType = TYPE_BOOL;         break;
+    case TYPE_INT_VECTOR:           elemType = TYPE_INT;          break;
+    case TYPE_LONG_VECTOR:          elemType = TYPE_LONG;         break;
+    case TYPE_FLOAT_VECTOR:         elemType = TYPE_FLOAT;        break;
+    case TYPE_DOUBLE_VECTOR:        elemType = TYPE_DOUBLE;       break;
+    case TYPE_STRING_VECTOR:        elemType = TYPE_STRING;       break;
+    case TYPE_RGB_VECTOR:           elemType = TYPE_RGB;          break;
+    case TYPE_RGBA_VECTOR:          elemType = TYPE_RGBA;         break;
+    case TYPE_VEC2F_VECTOR:         elemType = TYPE_VEC2F;        break;
+    case TYPE_VEC2D_VECTOR:         elemType = TYPE_VEC2D;        break;
+    case TYPE_VEC3F_VECTOR:         elemType = TYPE_VEC3F;        break;
+    case TYPE_VEC3D_VECTOR:         elemType = TYPE_VEC3D;        break;
+    case TYPE_VEC4F_VECTOR:         elemType = TYPE_VEC4F;        break;
+    case TYPE_VEC4D_VECTOR:         elemType = TYPE_VEC4D;        break;
+    case TYPE_MAT4F_VECTOR:         elemType = TYPE_MAT4F;        break;
+    case TYPE_MAT4D_VECTOR:         elemType = TYPE_MAT4D;        break;
+    case TYPE_SCENE_OBJECT_VECTOR:
+    case TYPE_SCENE_OBJECT_INDEXABLE:
+                                    elemType = TYPE_SCENE_OBJECT; break;
+    default:
+        return false;
+    }
+
+    // Vectors are tables with only an array part.
+    if (value.mKind != Kind::TABLE) return false;
+    for (uint32_t i = 0; i < value.mCount; ++i) {
+        if (mKeys[value.mFirst + i] != NONE ||
+                !validateValue(attr, elemType, mChildren[value.mFirst + i], true)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool
+AsciiNativeReader::validateSet(const Block& block, SceneObjectInterface elemType)
+{
+    const Node& table = mNodes[block.mTable];
+    for (uint32_t i = 0; i < table.mCount; ++i) {
+        const Node& elem = child(block.mTable, i);
+        if (childKey(block.mTable, i) != NONE || elem.mKind != Kind::OBJECT) return false;
+
+        const Ref& ref = mRefs[elem.mFirst];
+        if (ref.mCtor != Ctor::SCENE_OBJECT || !(ref.mInterface & elemType)) return false;
+    }
+    return true;
+}
+
+bool
+AsciiNativeReader::validateGeometryAndParts(uint32_t node)
+{
+    // { Geometry, "part" or { "part", ... }, ... }
+    const Node& entry = mNodes[node];
+    if (entry.mKind != Kind::TABLE || entry.mCount < 2) return false;
+    for (uint32_t i = 0; i < entry.mCount; ++i) {
+        if (childKey(node, i) != NONE) return false;
+    }
+
+    const Node& geom = child(node, 0);
+    if (geom.mKind != Kind::OBJECT) return false;
+    const Ref& ref = mRefs[geom.mFirst];
+    if (ref.mCtor != Ctor::SCENE_OBJECT || !(ref.mInterface & interfaceType<Geometry>())) {
+        return false;
+    }
+
+    const uint32_t partsNode = mChildren[entry.mFirst + 1];
+    const Node& parts = mNodes[partsNode];
+    if (parts.mKind == Kind::STRING) return true;
+    if (parts.mKind != Kind::TABLE) return false;
+    for (uint32_t i = 0; i < parts.mCount; ++i) {
+        if (childKey(partsNode, i) != NONE || child(partsNode, i).mKind != Kind::STRING) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool
+AsciiNativeReader::validateTraceSet(const Block& block)
+{
+    const Node& table = mNodes[block.mTable];
+    for (uint32_t i = 0; i < table.mCount; ++i) {
+        const uint32_t entry = mChildren[table.mFirst + i];
+        if (childKey(block.mTable, i) != NONE || !validateGeometryAndParts(entry) ||
+                mNodes[entry].mCount != 2) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool
+AsciiNativeReader::validateLayer(const Block& block)
+{
+    const Node& table = mNodes[block.mTable];
+    for (uint32_t i = 0; i < table.mCount; ++i) {
+        const uint32_t entry = mChildren[table.mFirst + i];
+        if (childKey(block.mTable, i) != NONE || !validateGeometryAndParts(entry)) {
+            return false;
+        }
+
+        // Each kind of assignment may appear once. Values which aren't
+        // assignments are ignored, as in Lua.
+        SceneObjectInterface seen = SceneObjectInterface(0);
+        for (uint32_t j = 2; j < mNodes[entry].mCount; ++j) {
+            const Node& value = child(entry, j);
+            if (value.mKind != Kind::OBJECT) continue;
+
+            const Ref& ref = mRefs[value.mFirst];
+            SceneObjectInterface kind;
+            switch (ref.mCtor) {
+            case Ctor::LIGHT_SET:           kind = interfaceType<LightSet>();          break;
+            case Ctor::LIGHT_FILTER_SET:    kind = interfaceType<LightFilterSet>();    break;
+            case Ctor::SHADOW_SET:          kind = interfaceType<ShadowSet>();         break;
+            case Ctor::SHADOW_RECEIVER_SET: kind = interfaceType<ShadowReceiverSet>(); break;
+            case Ctor::SCENE_OBJECT:
+                if (ref.mInterface & interfaceType<Material>()) {
+                    kind = interfaceType<Material>();
+                } else if (ref.mInterface & interfaceType<Displacement>()) {
+                    kind = interfaceType<Displacement>();
+                } else if (ref.mInterface & interfaceType<VolumeShader>()) {
+                    kind = interfaceType<VolumeShader>();
+                } else {
+                    return false;
+                }
+                break;
+            default:
+                continue;
+            }
+            if (!(ref.mInterface & kind) || (seen & kind)) return false;
+            seen = SceneObjectInterface(seen | kind);
+        }
+    }
+    return true;
+}
+
+bool
+AsciiNativeReader::validateMetadata(const Block& block)
+{
+    const Node& table = mNodes[block.mTable];
+    for (uint32_t i = 0; i < table.mCount; ++i) {
+        const uint32_t entry = mChildren[table.mFirst + i];
+        if (childKey(block.mTable, i) != NONE || mNodes[entry].mKind != Kind::TABLE ||
+                mNodes[entry].mCount != 3) {
+            return false;
+        }
+        for (uint32_t j = 0; j < 3; ++j) {
+            if (childKey(entry, j) != NONE || child(entry, j).mKind != Kind::STRING) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+//      APPLICATION
+// ---------------------------------------------------------------------------
+
+void
+AsciiNativeReader::apply(const std::string& chunkName, bool warningsAsErrors)
+{
+    // Create the new objects, a class at a time.
+    std::vector<uint32_t> classOrder;
+    std::unordered_map<uint32_t, std::vector<uint32_t>> newRefs;
+    for (uint32_t i = 0; i < mRefs.size(); ++i) {
+        Ref& ref = mRefs[i];
+        if (ref.mExisting || ref.mFirst != i) continue;
+        auto result = newRefs.emplace(ref.mClassName, std::vector<uint32_t>());
+        if (result.second) {
+            classOrder.push_back(ref.mClassName);
+        }
+        result.first->second.push_back(i);
+    }
+    for (uint32_t className : classOrder) {
+        const std::vector<uint32_t>& refs = newRefs[className];
+        std::vector<std::string> objectNames;
+        objectNames.reserve(refs.size());
+        for (uint32_t i : refs) {
+            objectNames.push_back(mStrings[mRefs[i].mObjectName]);
+        }
+        std::vector<SceneObject*> objects =
+            mContext.createSceneObjects(mStrings[className], objectNames);
+        for (std::size_t i = 0; i < refs.size(); ++i) {
+            mRefs[refs[i]].mExisting = objects[i];
+        }
+    }
+    for (Ref& ref : mRefs) {
+        ref.mExisting = mRefs[ref.mFirst].mExisting;
+    }
+
+    // Then fill them in, in order.
+    for (const Block& block : mBlocks) {
+        if (block.mTable == NONE) continue;
+
+        switch (mRefs[mNodes[block.mObject].mFirst].mCtor) {
+        case Ctor::SCENE_OBJECT:
+        case Ctor::SCENE_VARIABLES:
+        case Ctor::SHADOW_RECEIVER_SET:
+            applyMassSet(block, chunkName, warningsAsErrors);
+            break;
+        case Ctor::GEOMETRY_SET:
+            applySet<GeometrySet, Geometry>(block);
+            break;
+        case Ctor::LIGHT_SET:
+            applySet<LightSet, Light>(block);
+            break;
+        case Ctor::SHADOW_SET:
+            applySet<ShadowSet, Light>(block);
+            break;
+        case Ctor::LIGHT_FILTER_SET:
+            applySet<LightFilterSet, LightFilter>(block);
+            break;
+        case Ctor::TRACE_SET:
+            applyTraceSet(block);
+            break;
+        case Ctor::LAYER:
+            applyLayer(block);
+            break;
+        case Ctor::METADATA:
+            applyMetadata(block);
+            break;
+        }
+    }
+}
+
+SceneObject*
+AsciiNativeReader::object(uint32_t node) const
+{
+    const Node& value = mNodes[node];
+    return value.mKind == Kind::OBJECT ? mRefs[value.mFirst].mExisting : nullptr;
+}
+
+void
+AsciiNativeReader::applyMassSet(const Block& block, const std::string& chunkName,
+                                bool warningsAsErrors)
+{
+    SceneObject* so = object(block.mObject);
+    const Node& table = mNodes[block.mTable];
+
+    SceneObject::UpdateGuard guard(so);
+    for (uint32_t i = 0; i < table.mCount; ++i) {
+        const Attribute* attr = mAttributes[table.mFirst + i];
+        try {
+            setAttribute(so, attr, mChildren[table.mFirst + i]);
+        } catch (const except::TypeError& e) {
+            // validate() rules these out, but handle them as the Lua
+            // callbacks would if they happen anyway.
+            const std::string where = util::buildString(chunkId(chunkName), ":", block.mLine, ":");
+            if (warningsAsErrors) {
+                throw except::RuntimeError(util::buildString("RDLA Error: ", where, " ",
+                        so->getName(), ": ", e.what()));
+            }
+            Logger::warn(util::buildString(where, so->getName(), ": ", e.what()));
+        } catch (const except::ValueError& e) {
+            const std::string where = util::buildString(chunkId(chunkName), ":", block.mLine, ":");
+            if (warningsAsErrors) {
+                throw except::RuntimeError(util::buildString("RDLA Error: ", where, " ",
+                        so->getName(), ": ", e.what()));
+            }
+            Logger::warn(util::buildString(where, so->getName(), ": ", e.what()));
+        }
+    }
+}
+
+template <typename SetT, typename ElemT>
+void
+AsciiNativeReader::applySet(const Block& block)
+{
+    SetT* set = object(block.mObject)->asA<SetT>();
+    const Node& table = mNodes[block.mTable];
+
+    SceneObject::UpdateGuard guard(set);
+    for (uint32_t i = 0; i < table.mCount; ++i) {
+        set->add(object(mChildren[table.mFirst + i])->asA<ElemT>());
+    }
+}
+
+std::vector<String>
+AsciiNativeReader::partList(uint32_t node) const
+{
+    const uint32_t partsNode = mChildren[mNodes[node].mFirst + 1];
+    const Node& parts = mNodes[partsNode];
+    if (parts.mKind == Kind::STRING) {
+        return { mStrings[parts.mFirst] };
+    }
+
+    std::vector<String> partList;
+    partList.reserve(parts.mCount);
+    for (uint32_t i = 0; i < parts.mCount; ++i) {
+        partList.push_back(mStrings[child(partsNode, i).mFirst]);
+    }
+    return partList;
+}
+
+void
+AsciiNativeReader::applyTraceSet(const Block& block)
+{
+    TraceSet* traceSet = object(block.mObject)->asA<TraceSet>();
+    const Node& table = mNodes[block.mTable];
+
+    SceneObject::UpdateGuard guard(traceSet);
+    for (uint32_t i = 0; i < table.mCount; ++i) {
+        const uint32_t entry = mChildren[table.mFirst + i];
+        Geometry* geom = object(mChildren[mNodes[entry].mFirst])->asA<Geometry>();
+        for (const String& part : partList(entry)) {
+            traceSet->assign(geom, part);
+        }
+    }
+}
+
+void
+AsciiNativeReader::applyLayer(const Block& block)
+{
+    Layer* layer = object(block.mObject)->asA<Layer>();
+    const Node& table = mNodes[block.mTable];
+
+    SceneObject::UpdateGuard guard(layer);
+    for (uint32_t i = 0; i < table.mCount; ++i) {
+        const uint32_t entry = mChildren[table.mFirst + i];
+        Geometry* geom = object(mChildren[mNodes[entry].mFirst])->asA<Geometry>();
+
+        LayerAssignment layerAssignment;
+        for (uint32_t j = 2; j < mNodes[entry].mCount; ++j) {
+            const Node& value = child(entry, j);
+            if (value.mKind != Kind::OBJECT) continue;
+
+            SceneObject* so = mRefs[value.mFirst].mExisting;
+            switch (mRefs[value.mFirst].mCtor) {
+            case Ctor::LIGHT_SET:
+                layerAssignment.mLightSet = so->asA<LightSet>();
+                break;
+            case Ctor::LIGHT_FILTER_SET:
+                layerAssignment.mLightFilterSet = so->asA<LightFilterSet>();
+                break;
+            case Ctor::SHADOW_SET:
+                layerAssignment.mShadowSet = so->asA<ShadowSet>();
+                break;
+            case Ctor::SHADOW_RECEIVER_SET:
+                layerAssignment.mShadowReceiverSet = so->asA<ShadowReceiverSet>();
+                break;
+            case Ctor::SCENE_OBJECT:
+                if (so->isA<Material>()) {
+                    layerAssignment.mMaterial = so->asA<Material>();
+                } else if (so->isA<Displacement>()) {
+                    layerAssignment.mDisplacement = so->asA<Displacement>();
+                } else if (so->isA<VolumeShader>()) {
+                    layerAssignment.mVolumeShader = so->asA<VolumeShader>();
+                }
+                break;
+            default:
+                break;
+            }
+        }
+
+        for (const String& part : partList(entry)) {
+            layer->assign(geom, part, layerAssignment);
+        }
+    }
+}
+
+void
+AsciiNativeReader::applyMetadata(const Block& block)
+{
+    Metadata* metadata = object(block.mObject)->asA<Metadata>();
+    const Node& table = mNodes[block.mTable];
+
+    StringVector names;
+    StringVector types;
+    StringVector values;
+    for (uint32_t i = 0; i < table.mCount; ++i) {
+        const uint32_t entry = mChildren[table.mFirst + i];
+        names.push_back(mStrings[child(entry, 0).mFirst]);
+        types.push_back(mStrings[child(entry, 1).mFirst]);
+        values.push_back(mStrings[child(entry, 2).mFirst]);
+    }
+
+    SceneObject::UpdateGuard guard(metadata);
+    metadata->setAttributes(names, types, values);
+}
+
+void
+AsciiNativeReader::setAttribute(SceneObject* so, const Attribute* attr, uint32_t node)
+{
+    if (mNodes[node].mKind == Kind::BIND) {
+        so->setBinding(*attr, object(mChildren[mNodes[node].mFirst]));
+        if (mNodes[node].mCount == 1) return; // No base value, we're done.
+        node = mChildren[mNodes[node].mFirst + 1];
+    } else if (attr->isBindable()) {
+        // Setting a plain value removes any binding.
+        so->setBinding(*attr, nullptr);
+    }
+
+    if (mNodes[node].mKind == Kind::BLUR) {
+        setValue(so, attr, mChildren[mNodes[node].mFirst], true, TIMESTEP_BEGIN);
+        setValue(so, attr, mChildren[mNodes[node].mFirst + 1], true, TIMESTEP_END);
+    } else {
+        setValue(so, attr, node, false, TIMESTEP_BEGIN);
+    }
+}
+
+template <typename T, typename F>
+void
+AsciiNativeReader::setSingle(SceneObject* so, const Attribute* attr, uint32_t node,
+                             bool blurred, AttributeTimestep timestep, F extractor)
+{
+    if (blurred) {
+        so->set(AttributeKey<T>(*attr), extractor(mNodes[node]), timestep);
+    } else {
+        so->set(AttributeKey<T>(*attr), extractor(mNodes[node]));
+    }
+}
+
+template <typename VecT, typename F>
+void
+AsciiNativeReader::setVector(SceneObject* so, const Attribute* attr, uint32_t node,
+                             bool blurred, AttributeTimestep timestep, F extractor)
+{
+    const Node& table = mNodes[node];
+    VecT vec;
+    for (uint32_t i = 0; i < table.mCount; ++i) {
+        vec.push_back(extractor(child(node, i)));
+    }
+
+    if (blurred) {
+        so->set(AttributeKey<VecT>(*attr), vec, timestep);
+    } else {
+        so->set(AttributeKey<VecT>(*attr), vec);
+    }
+}
+
+void
+AsciiNativeReader::setValue(SceneObject* so, const Attribute* attr, uint32_t node,
+                            bool blurred, AttributeTimestep timestep)
+{
+    // The conversions match the Lua callbacks: Rgb and Rgba components are
+    // plain float casts, vectors and matrices are read as doubles.
+    auto toBool = [](const Node& n) { return n.mNumber != 0.0; };
+    auto toInt = [](const Node& n) { return static_cast<Int>(n.mNumber); };
+    auto toLong = [](const Node& n) { return static_cast<Long>(n.mNumber); };
+    auto toFloatValue = [](const Node& n) { return toFloat(n.mNumber); };
+    auto toDouble = [](const Node& n) { return n.mNumber; };
+    auto toString = [this](const Node& n) { return mStrings[n.mFirst]; };
+    auto component = [this](const Node& n, uint32_t i) {
+        return mNodes[mChildren[n.mFirst + i]].mNumber;
+    };
+    auto toRgb = [&component](const Node& n) {
+        return Rgb(float(component(n, 0)), float(component(n, 1)), float(component(n, 2)));
+    };
+    auto toRgba = [&component](const Node& n) {
+        return Rgba(float(component(n, 0)), float(component(n, 1)), float(component(n, 2)),
+                    float(component(n, 3)));
+    };
+    auto toVec2 = [&component](const Node& n) {
+        return Vec2d(component(n, 0), component(n, 1));
+    };
+    auto toVec3 = [&component](const Node& n) {
+        return Vec3d(component(n, 0), component(n, 1), component(n, 2));
+    };
+    auto toVec4 = [&component](const Node& n) {
+        return Vec4d(component(n, 0), component(n, 1), component(n, 2), component(n, 3));
+    };
+    auto toMat4 = [&component](const Node& n) {
+        return Mat4d(component(n, 0), component(n, 1), component(n, 2), component(n, 3),
+                     component(n, 4), component(n, 5), component(n, 6), component(n, 7),
+                     component(n, 8), component(n, 9), component(n, 10), component(n, 11),
+                     component(n, 12), component(n, 13), component(n, 14), component(n, 15));
+    };
+    auto toObject = [this](const Node& n) {
+        return n.mKind == Kind::OBJECT ? mRefs[n.mFirst].mExisting : nullptr;
+    };
+
+    switch (attr->getType()) {
+    case TYPE_BOOL:
+        setSingle<Bool>(so, attr, node, blurred, timestep, toBool);
+        break;
+
+    case TYPE_INT:
+        setSingle<Int>(so, attr, node, blurred, timestep, [this, attr, &toInt](const Node& n) {
+            if (n.mKind == Kind::STRING) {
+                // Enums may be given by their description.
+                const std::string& str = mStrings[n.mFirst];
+                for (auto it = attr->beginEnumValues(); it != attr->endEnumValues(); ++it) {
+                    if (it->second == str) return Int(it->first);
+                }
+                throw except::TypeError(util::buildString(
+                        "invalid enumeration value encountered: ", str));
+            }
+            return toInt(n);
+        });
+        break;
+
+    case TYPE_LONG:
+        setSingle<Long>(so, attr, node, blurred, timestep, toLong);
+        break;
+
+    case TYPE_FLOAT:
+        setSingle<Float>(so, attr, node, blurred, timestep, toFloatValue);
+        break;
+
+    case TYPE_DOUBLE:
+        setSingle<Double>(so, attr, node, blurred, timestep, toDouble);
+        break;
+
+    case TYPE_STRING:
+        setSingle<String>(so, attr, node, blurred, timestep, toString);
+        break;
+
+    case TYPE_RGB:
+        setSingle<Rgb>(so, attr, node, blurred, timestep, toRgb);
+        break;
+
+    case TYPE_RGBA:
+        setSingle<Rgba>(so, attr, node, blurred, timestep, toRgba);
+        break;
+
+    case TYPE_VEC2F:
+        setSingle<Vec2f>(so, attr, node, blurred, timestep, [&toVec2](const Node& n) {
+            return Vec2f(toVec2(n));
+        });
+        break;
+
+    case TYPE_VEC2D:
+        setSingle<Vec2d>(so, attr, node, blurred, timestep, toVec2);
+        break;
+
+    case TYPE_VEC3F:
+        setSingle<Vec3f>(so, attr, node, blurred, timestep, [&toVec3](const Node& n) {
+            return Vec3f(toVec3(n));
+        });
+        break;
+
+    case TYPE_VEC3D:
+        setSingle<Vec3d>(so, attr, node, blurred, timestep, toVec3);
+        break;
+
+    case TYPE_VEC4F:
+        setSingle<Vec4f>(so, attr, node, blurred, timestep, [&toVec4](const Node& n) {
+            return Vec4f(toVec4(n));
+        });
+        break;
+
+    case TYPE_VEC4D:
+        setSingle<Vec4d>(so, attr, node, blurred, timestep, toVec4);
+        break;
+
+    case TYPE_MAT4F:
+        setSingle<Mat4f>(so, attr, node, blurred, timestep, [&toMat4](const Node& n) {
+            return Mat4f(toMat4(n));
+        });
+        break;
+
+    case TYPE_MAT4D:
+        setSingle<Mat4d>(so, attr, node, blurred, timestep, toMat4);
+        break;
+
+    case TYPE_SCENE_OBJECT:
+        setSingle<SceneObject*>(so, attr, node, blurred, timestep, toObject);
+        break;
+
+    case TYPE_BOOL_VECTOR:
+        setVector<BoolVector>(so, attr, node, blurred, timestep, toBool);
+        break;
+
+    case TYPE_INT_VECTOR:
+        setVector<IntVector>(so, attr, node, blurred, timestep, toInt);
+        break;
+
+    case TYPE_LONG_VECTOR:
+        setVector<LongVector>(so, attr, node, blurred, timestep, toLong);
+        break;
+
+    case TYPE_FLOAT_VECTOR:
+        setVector<FloatVector>(so, attr, node, blurred, timestep, toFloatValue);
+        break;
+
+    case TYPE_DOUBLE_VECTOR:
+        setVector<DoubleVector>(so, attr, node, blurred, timestep, toDouble);
+        break;
+
+    case TYPE_STRING_VECTOR:
+        setVector<StringVector>(so, attr, node, blurred, timestep, toString);
+        break;
+
+    case TYPE_RGB_VECTOR:
+        setVector<RgbVector>(so, attr, node, blurred, timestep, toRgb);
+        break;
+
+    case TYPE_RGBA_VECTOR:
+        setVector<RgbaVector>(so, attr, node, blurred, timestep, toRgba);
+        break;
+
+    case TYPE_VEC2F_VECTOR:
+        setVector<Vec2fVector>(so, attr, node, blurred, timestep, [&toVec2](const Node& n) {
+            return Vec2f(toVec2(n));
+        });
+        break;
+
+    case TYPE_VEC2D_VECTOR:
+        setVector<Vec2dVector>(so, attr, node, blurred, timestep, toVec2);
+        break;
+
+    case TYPE_VEC3F_VECTOR:
+        setVector<Vec3fVector>(so, attr, node, blurred, timestep, [&toVec3](const Node& n) {
+            return Vec3f(toVec3(n));
+        });
+        break;
+
+    case TYPE_VEC3D_VECTOR:
+        setVector<Vec3dVector>(so, attr, node, blurred, timestep, toVec3);
+        break;
+
+    case TYPE_VEC4F_VECTOR:
+        setVector<Vec4fVector>(so, attr, node, blurred, timestep, [&toVec4](const Node& n) {
+            return Vec4f(toVec4(n));
+        });
+        break;
+
+    case TYPE_VEC4D_VECTOR:
+        setVector<Vec4dVector>(so, attr, node, blurred, timestep, toVec4);
+        break;
+
+    case TYPE_MAT4F_VECTOR:
+        setVector<Mat4fVector>(so, attr, node, blurred, timestep, [&toMat4](const Node& n) {
+            return Mat4f(toMat4(n));
+        });
+        break;
+
+    case TYPE_MAT4D_VECTOR:
+        setVector<Mat4dVector>(so, attr, node, blurred, timestep, toMat4);
+        break;
+
+    case TYPE_SCENE_OBJECT_VECTOR:
+        setVector<SceneObjectVector>(so, attr, node, blurred, timestep, toObject);
+        break;
+
+    case TYPE_SCENE_OBJECT_INDEXABLE:
+        setVector<SceneObjectIndexable>(so, attr, node, blurred, timestep, toObject);
+        break;
+
+    default:
+        throw except::TypeError(util::buildString(
+                "attribute '", attr->getName(), "' has unknown type."));
+    }
+}
+
+} // namespace rdl2
+} // namespace scene_rdl2
+
@@ -0,0 +1,290 @@
+// Copyright 2023-2024 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+// Include this before any other includes!
+#include <scene_rdl2/common/platform/Platform.h>
+
+#include "Types.h"
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace scene_rdl2 {
+namespace rdl2 {
+
+/**
+ * AsciiNativeReader reads the declarative subset of RDL text which
+ * AsciiWriter produces, without running it through the Lua interpreter.
+ * That subset is a sequence of blocks like
+ *
+ *      SceneVariables {
+ *          ["attribute"] = value,
+ *      }
+ *      ClassName("object name") {
+ *          ["attribute"] = value,
+ *      }
+ *
+ * including the set, TraceSet, Layer and Metadata forms of the block, where
+ * each value is a boolean, number or string literal, a SceneObject
+ * reference, an Rgb(), Rgba(), Vec2(), Vec3(), Vec4(), Mat4(), bind(),
+ * blur() or undef() call, or a table of those. Comments are allowed.
+ *
+ * Reading happens in three steps, and only the last one modifies the
+ * SceneContext:
+ *  - parse() turns the text into an in-memory list of blocks. It fails on
+ *    anything outside the subset, such as variables, expressions, function
+ *    definitions or control flow.
+ *  - validate() resolves the SceneClasses and attributes and type checks
+ *    every value the same way AsciiReader's Lua callbacks do. It fails on
+ *    anything the Lua code path would warn about, raise an error for, or
+ *    implicitly convert.
+ *  - apply() creates the SceneObjects and sets their attributes.
+ *
+ * When parse() or validate() fail, the caller should run the text through
+ * Lua instead, which then produces the usual results and error messages.
+ *
+ * Only the names listed by getGlobalNames() are looked up as globals, and
+ * they are assumed to have their default meaning. It is up to the caller to
+ * verify that, because an earlier Lua chunk may have reassigned them.
+ */
+class AsciiNativeReader
+{
+public:
+    /**
+     * Constructs an AsciiNativeReader which will apply RDL text to the given
+     * SceneContext.
+     *
+     * @param   context     The SceneContext where updates will be made.
+     */
+    explicit AsciiNativeReader(SceneContext& context);
+
+    /**
+     * Parses RDL text. Nothing is modified.
+     *
+     * @param   code    String of text containing RDL data.
+     * @return  True if the text is entirely in the declarative subset.
+     */
+    bool parse(const std::string& code);
+
+    /// The global names (constructors and SceneVariables) the parsed text uses.
+    finline const std::vector<std::string>& getGlobalNames() const;
+
+    /// The SceneClasses the parsed text constructs objects of.
+    finline const std::vector<std::string>& getClassNames() const;
+
+    /**
+     * Resolves and type checks the parsed text against the SceneContext. It
+     * may create SceneClasses, but no SceneObjects are created or modified.
+     *
+     * @return  True if apply() will do exactly what the Lua code would.
+     */
+    bool validate();
+
+    /**
+     * Creates the SceneObjects and sets the attributes of the parsed and
+     * validated text. Errors are unexpected at this point, but are handled
+     * like the Lua callbacks handle them: attribute errors are logged as
+     * warnings, or raised if warningsAsErrors is set.
+     *
+     * @param   chunkName           The name of the source of the RDL data,
+     *                              as used in error messages.
+     * @param   warningsAsErrors    Raise attribute errors instead of logging
+     *                              warnings.
+     * @throw   except::RuntimeError    If an error is raised.
+     */
+    void apply(const std::string& chunkName, bool warningsAsErrors);
+
+    /**
+     * Converts a number to a Float the way RDL text does: denormals are
+     * rounded to the nearest denormal float rather than flushed to zero.
+     *
+     * @param   number  The number as read from the text.
+     * @return  The nearest Float.
+     */
+    static Float toFloat(double number);
+
+private:
+    // What a parsed value is.
+    enum class Kind : uint8_t
+    {
+        BOOL,
+        NUMBER,
+        STRING,
+        OBJECT,
+        UNDEF,
+        RGB,
+        RGBA,
+        VEC2,
+        VEC3,
+        VEC4,
+        MAT4,
+        BIND,
+        BLUR,
+        TABLE
+    };
+
+    // Which constructor a SceneObject reference was made with. It decides
+    // how the object would have been boxed in Lua, and so where it may be
+    // used.
+    enum class Ctor : uint8_t
+    {
+        SCENE_OBJECT,
+        GEOMETRY_SET,
+        LIGHT_SET,
+        LIGHT_FILTER_SET,
+        SHADOW_SET,
+        SHADOW_RECEIVER_SET,
+        TRACE_SET,
+        LAYER,
+        METADATA,
+        SCENE_VARIABLES
+    };
+
+    struct Node
+    {
+        Kind mKind;
+        uint32_t mFirst;    // STRING: string, OBJECT: ref, others: first child
+        uint32_t mCount;    // Number of children
+        double mNumber;     // NUMBER value, BOOL value
+    };
+
+    struct Ref
+    {
+        Ctor mCtor;
+        uint32_t mClassName;            // Index into mStrings
+        uint32_t mObjectName;           // Index into mStrings
+        uint32_t mFirst;                // First ref to the same object
+        SceneObject* mExisting;         // Set by validate() or apply()
+        SceneObjectInterface mInterface;// Set by validate()
+    };
+
+    struct Block
+    {
+        uint32_t mObject;   // OBJECT node
+        uint32_t mTable;    // TABLE node, or NONE for a bare reference
+        int mLine;
+    };
+
+    static constexpr uint32_t NONE = 0xffffffff;
+
+    // Lexer.
+    enum class Token : uint8_t
+    {
+        END,
+        NAME,
+        STRING,
+        NUMBER,
+        PUNCT,
+        INVALID
+    };
+
+    Token next();
+    finline bool accept(char punct);
+    bool skipSpaceAndComments();
+    bool readString(char quote);
+    bool readNumber();
+
+    // Parser. Each returns false if the text leaves the subset.
+    bool parseBlock();
+    bool parseValue(uint32_t& node);
+    bool parseNamed(const std::string& name, uint32_t& node);
+    bool parseTable(uint32_t& node);
+    bool parseCall(const std::string& name, int global, uint32_t& node);
+    bool parseReference(Ctor ctor, const std::string& name, uint32_t& node);
+
+    uint32_t addNode(Kind kind, uint32_t first = 0, uint32_t count = 0, double number = 0.0);
+    uint32_t addString(const std::string& str);
+    uint32_t internString(const std::string& str);
+    void addGlobalName(const std::string& name);
+    void beginChildren(uint32_t& base) const;
+    void endChildren(uint32_t base, uint32_t& first, uint32_t& count);
+
+    // Validation.
+    const SceneClass* refSceneClass(const Ref& ref);
+    const Attribute* findAttribute(const SceneClass* sc, uint32_t key);
+    bool validateMassSet(const Block& block, const Ref& ref);
+    bool validateAttribute(const Attribute* attr, uint32_t node);
+    bool validateValue(const Attribute* attr, AttributeType type, uint32_t node, bool inVector);
+    bool validateObjectValue(const Attribute* attr, uint32_t node);
+    bool validateSet(const Block& block, SceneObjectInterface elemType);
+    bool validateTraceSet(const Block& block);
+    bool validateLayer(const Block& block);
+    bool validateMetadata(const Block& block);
+    bool validateGeometryAndParts(uint32_t node);
+
+    // Application.
+    SceneObject* object(uint32_t node) const;
+    void applyMassSet(const Block& block, const std::string& chunkName, bool warningsAsErrors);
+    template <typename SetT, typename ElemT>
+    void applySet(const Block& block);
+    void applyTraceSet(const Block& block);
+    void applyLayer(const Block& block);
+    void applyMetadata(const Block& block);
+    std::vector<String> partList(uint32_t node) const;
+    void setAttribute(SceneObject* so, const Attribute* attr, uint32_t node);
+    void setValue(SceneObject* so, const Attribute* attr, uint32_t node,
+                  bool blurred, AttributeTimestep timestep);
+
+    template <typename T, typename F>
+    void setSingle(SceneObject* so, const Attribute* attr, uint32_t node,
+                   bool blurred, AttributeTimestep timestep, F extractor);
+    template <typename VecT, typename F>
+    void setVector(SceneObject* so, const Attribute* attr, uint32_t node,
+                   bool blurred, AttributeTimestep timestep, F extractor);
+
+    finline const Node& child(uint32_t node, uint32_t i) const;
+    finline uint32_t childKey(uint32_t node, uint32_t i) const;
+
+    SceneContext& mContext;
+
+    // Lexer state.
+    const char* mPos;
+    const char* mEnd;
+    int mLine;
+    Token mToken;
+    char mPunct;
+    std::string mText;      // NAME or STRING contents
+    double mNumber;
+
+    // Parsed text.
+    std::vector<Node> mNodes;
+    std::vector<uint32_t> mChildren;    // Child nodes of tables and calls
+    std::vector<uint32_t> mKeys;        // Key of each child, or NONE
+    std::vector<std::string> mStrings;
+    std::unordered_map<std::string, uint32_t> mInterned;
+    std::vector<Ref> mRefs;
+    std::vector<Block> mBlocks;
+    std::vector<std::string> mGlobalNames;
+    std::unordered_set<std::string> mGlobalSet;
+    std::vector<std::string> mClassNames;
+
+    // Children of the tables and calls being parsed. They are moved to
+    // mChildren and mKeys when complete, so siblings stay contiguous.
+    std::vector<uint32_t> mScratchNodes;
+    std::vector<uint32_t> mScratchKeys;
+
+    // Attribute of each keyed child of a mass set block, set by validate().
+    std::vector<const Attribute*> mAttributes;
+    std::unordered_map<const SceneClass*, std::vector<const Attribute*>> mAttributeCache;
+};
+
+const std::vector<std::string>&
+AsciiNativeReader::getGlobalNames() const
+{
+    return mGlobalNames;
+}
+
+const std::vector<std::string>&
+AsciiNativeReader::getClassNames() const
+{
+    return mClassNames;
+}
+
+} // namespace rdl2
+} // namespace scene_rdl2
+
@@ -4,6 +4,7 @@
 
 #include "AsciiReader.h"
 
+#include "AsciiNativeReader.h"
 #include "Attribute.h"
 #include "Displacement.h"
 #include "Geometry.h"
@@ -27,18 +28,19 @@
 #include <scene_rdl2/common/platform/Platform.h>
 #include <scene_rdl2/common/except/exceptions.h>
 #include <scene_rdl2/render/util/Alloc.h>
-#include <scene_rdl2/render/util/BitUtils.h>
 #include <scene_rdl2/render/util/Strings.h>
 #include <scene_rdl2/render/logging/logging.h>
 
 #include <lua.hpp>
 
+#include <cctype>
 #include <cstring>
 #include <fstream>
 #include <istream>
 #include <ostream>
 #include <iterator>
 #include <string>
+#include <unordered_set>
 #include <utility>
 
 /**
@@ -162,6 +164,7 @@ static Undef undef;
 } // namespace
 
 const char AsciiReader::LUA_REGISTRY_KEY = 'k';
+const char AsciiReader::SYMBOL_CACHE_KEY = 's';
 
 const char* AsciiReader::SCENE_OBJECT_METATABLE = "rdl2_SceneObject";
 const char* AsciiReader::GEOMETRY_SET_METATABLE = "rdl2_GeometrySet";
@@ -185,7 +188,12 @@ const char* AsciiReader::UNDEF_VALUE_METATABLE = "rdl2_Undef";
 AsciiReader::AsciiReader(SceneContext& context) :
     mContext(context),
     mLua(luaL_newstate()),
-    mWarningsAsErrors(false)
+    mWarningsAsErrors(false),
+    mPrefetchSceneClasses(false),
+    mNativeParsing(true),
+    mUsedNativeParser(false),
+    mGlobalIndexRef(LUA_NOREF),
+    mConstructorsRef(LUA_NOREF)
 {
     if (!mLua) {
         throw except::RuntimeError("Could not initialize Lua interpreter.");
@@ -195,6 +203,9 @@ AsciiReader::AsciiReader(SceneContext& context) :
     // object instance to forward callbacks to.
     storeInstancePtr();
 
+    // Create the table which caches the Symbol of each attribute name string.
+    createSymbolCache();
+
     // Open Lua libraries. Perhaps constrain this in the future. Do we really
     // need/want all the standard libs?
     luaL_openlibs(mLua);
@@ -238,6 +249,18 @@ AsciiReader::AsciiReader(SceneContext& context) :
         std::cerr << "luaL_pcall failed" << std::endl;
         throw except::RuntimeError("Could not load RDLA support library.");
     }
+
+    // Hold on to the support library's global lookup hooks, so
+    // globalsArePristine() can tell whether they've been replaced.
+    lua_pushglobaltable(mLua);
+    if (lua_getmetatable(mLua, -1)) {
+        lua_getfield(mLua, -1, "__index");
+        mGlobalIndexRef = luaL_ref(mLua, LUA_REGISTRYINDEX);
+        lua_getfield(mLua, -1, "__constructors");
+        mConstructorsRef = luaL_ref(mLua, LUA_REGISTRYINDEX);
+        lua_pop(mLua, 1);
+    }
+    lua_pop(mLua, 1);
 }
 
 AsciiReader::~AsciiReader()
@@ -273,6 +296,80 @@ AsciiReader::fromStream(std::istream& input, const std::string& chunkName)
 void
 AsciiReader::fromString(const std::string& code, const std::string& chunkName)
 {
+    mUsedNativeParser = false;
+
+    // Try the native parser first. It only handles text which is plain data,
+    // and only while the globals it refers to mean what they did originally.
+    if (mNativeParsing) {
+        AsciiNativeReader native(mContext);
+        if (native.parse(code)) {
+            fromParsedString(code, &native, chunkName);
+            return;
+        }
+    }
+    fromParsedString(code, nullptr, chunkName);
+}
+
+void
+AsciiReader::fromParsedString(const std::string& code, AsciiNativeReader* parsed,
+                              const std::string& chunkName)
+{
+    mUsedNativeParser = false;
+
+    // Nothing may be left loading once we return, the caller is free to
+    // change the DSO settings of the context.
+    try {
+        if (!mNativeParsing || !parsed || !applyNative(*parsed, chunkName)) {
+            runLua(code, chunkName);
+        }
+    } catch (...) {
+        if (mPrefetchSceneClasses) {
+            mContext.waitForSceneClassPrefetch();
+        }
+        throw;
+    }
+    if (mPrefetchSceneClasses) {
+        mContext.waitForSceneClassPrefetch();
+    }
+}
+
+bool
+AsciiReader::applyNative(AsciiNativeReader& native, const std::string& chunkName)
+{
+    if (!globalsArePristine(native.getGlobalNames())) {
+        return false;
+    }
+    if (mPrefetchSceneClasses) {
+        mContext.prefetchSceneClasses(native.getClassNames());
+    }
+    if (!native.validate()) {
+        return false;
+    }
+    native.apply(chunkName, mWarningsAsErrors);
+    mUsedNativeParser = true;
+    return true;
+}
+
+void
+AsciiReader::runLua(const std::string& code, const std::string& chunkName)
+{
+    // Get the DSOs of the classes the code constructs loading while Lua
+    // runs. Names which are already globals aren't constructors.
+    if (mPrefetchSceneClasses) {
+        std::vector<std::string> classNames;
+        lua_pushglobaltable(mLua);
+        for (std::string& className : findSceneClassNames(code)) {
+            lua_pushlstring(mLua, className.data(), className.size());
+            lua_rawget(mLua, -2);
+            if (lua_isnil(mLua, -1)) {
+                classNames.push_back(std::move(className));
+            }
+            lua_pop(mLua, 1);
+        }
+        lua_pop(mLua, 1);
+        mContext.prefetchSceneClasses(classNames);
+    }
+
     // Evaluate the Lua code. At this point we'll get callbacks from Lua for
     // anything interesting. (This just does what luaL_dostring() does, we've
     // just expanded it here because we'd like to control the "name" of the
@@ -285,6 +382,272 @@ AsciiReader::fromString(const std::string& code, const std::string& chunkName)
     }
 }
 
+bool
+AsciiReader::globalsArePristine(const std::vector<std::string>& names)
+{
+    static const std::unordered_map<std::string, lua_CFunction> builtins = {
+        { "SceneClass", RDL2_LUA_FUNCPTR(sceneClassCreate) },
+        { "SceneObject", RDL2_LUA_FUNCPTR(sceneObjectCreate) },
+        { "GeometrySet", RDL2_LUA_FUNCPTR(geometrySetCreate) },
+        { "LightSet", RDL2_LUA_FUNCPTR(lightSetCreate) },
+        { "LightFilterSet", RDL2_LUA_FUNCPTR(lightFilterSetCreate) },
+        { "ShadowSet", RDL2_LUA_FUNCPTR(shadowSetCreate) },
+        { "ShadowReceiverSet", RDL2_LUA_FUNCPTR(shadowReceiverSetCreate) },
+        { "TraceSet", RDL2_LUA_FUNCPTR(traceSetCreate) },
+        { "Layer", RDL2_LUA_FUNCPTR(layerCreate) },
+        { "Metadata", RDL2_LUA_FUNCPTR(metadataCreate) },
+        { "Rgb", RDL2_LUA_FUNCPTR(rgbCreate) },
+        { "Rgba", RDL2_LUA_FUNCPTR(rgbaCreate) },
+        { "Vec2", RDL2_LUA_FUNCPTR(vec2Create) },
+        { "Vec3", RDL2_LUA_FUNCPTR(vec3Create) },
+        { "Vec4", RDL2_LUA_FUNCPTR(vec4Create) },
+        { "Mat4", RDL2_LUA_FUNCPTR(mat4Create) },
+        { "bind", RDL2_LUA_FUNCPTR(boundValueCreate) },
+        { "blur", RDL2_LUA_FUNCPTR(blurredValueCreate) },
+        { "undef", RDL2_LUA_FUNCPTR(undefValueCreate) }
+    };
+
+    if (mGlobalIndexRef == LUA_NOREF || mConstructorsRef == LUA_NOREF) {
+        return false;
+    }
+
+    // The globals table must still use the support library's __index.
+    lua_pushglobaltable(mLua);                                  // G
+    if (!lua_getmetatable(mLua, -1)) {
+        lua_pop(mLua, 1);
+        return false;
+    }                                                           // G mt
+    lua_getfield(mLua, -1, "__index");                          // G mt index
+    lua_rawgeti(mLua, LUA_REGISTRYINDEX, mGlobalIndexRef);      // G mt index index
+    bool pristine = lua_rawequal(mLua, -1, -2);
+    lua_pop(mLua, 2);                                           // G mt
+    lua_getfield(mLua, -1, "__declared");                       // G mt declared
+    lua_rawgeti(mLua, LUA_REGISTRYINDEX, mConstructorsRef);     // G mt declared ctors
+    pristine = pristine && lua_istable(mLua, -2) && lua_istable(mLua, -1);
+
+    for (std::size_t i = 0; pristine && i < names.size(); ++i) {
+        const std::string& name = names[i];
+        lua_pushlstring(mLua, name.data(), name.size());
+        lua_rawget(mLua, -5);                                   // ... value
+
+        auto builtin = builtins.find(name);
+        if (builtin != builtins.end()) {
+            pristine = lua_iscfunction(mLua, -1) &&
+                       lua_tocfunction(mLua, -1) == builtin->second;
+        } else if (name == "SceneVariables") {
+            pristine = luaL_testudata(mLua, -1, SCENE_OBJECT_METATABLE) &&
+                       unboxPtr<SceneObject>(lua_touserdata(mLua, -1)) ==
+                       &mContext.getSceneVariables();
+        } else if (lua_isnil(mLua, -1)) {
+            // Undeclared, so __index will create the constructor.
+            lua_pushlstring(mLua, name.data(), name.size());
+            lua_rawget(mLua, -4);
+            pristine = !lua_toboolean(mLua, -1);
+            lua_pop(mLua, 1);
+        } else {
+            // Must be the constructor __index created.
+            lua_pushlstring(mLua, name.data(), name.size());
+            lua_rawget(mLua, -3);
+            pristine = lua_rawequal(mLua, -1, -2);
+            lua_pop(mLua, 1);
+        }
+        lua_pop(mLua, 1);
+    }
+
+    lua_pop(mLua, 4);
+    return pristine;
+}
+
+namespace {
+
+bool
+isIdentifierStart(char c)
+{
+    return std::isalpha(static_cast<unsigned char>(c)) || c == '_';
+}
+
+bool
+isIdentifierChar(char c)
+{
+    return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+}
+
+bool
+isLuaKeyword(const std::string& word)
+{
+    static const std::unordered_set<std::string> keywords = {
+        "and", "break", "do", "else", "elseif", "end", "false", "for",
+        "function", "goto", "if", "in", "local", "nil", "not", "or",
+        "repeat", "return", "then", "true", "until", "while"
+    };
+    return keywords.count(word) != 0;
+}
+
+// Returns the level of the Lua long bracket ("[[", "[=[", ...) starting at p,
+// or -1 if there isn't one.
+int
+longBracketLevel(const char* p, const char* end)
+{
+    if (p == end || *p != '[') {
+        return -1;
+    }
+    int level = 0;
+    for (++p; p != end && *p == '='; ++p) {
+        ++level;
+    }
+    return (p != end && *p == '[') ? level : -1;
+}
+
+// Skips the long bracket string or comment of the given level starting at p.
+const char*
+skipLongBracket(const char* p, const char* end, int level)
+{
+    for (p += level + 2; p != end; ++p) {
+        if (*p == ']') {
+            const char* q = p + 1;
+            int closeLevel = 0;
+            for (; q != end && *q == '='; ++q) {
+                ++closeLevel;
+            }
+            if (closeLevel == level && q != end && *q == ']') {
+                return q + 1;
+            }
+        }
+    }
+    return end;
+}
+
+// Skips the quoted string starting at p.
+const char*
+skipQuoted(const char* p, const char* end)
+{
+    const char quote = *p++;
+    for (; p != end && *p != quote && *p != '\n'; ++p) {
+        if (*p == '\\' && p + 1 != end) {
+            ++p;
+        }
+    }
+    return (p != end) ? p + 1 : end;
+}
+
+const char*
+skipSpace(const char* p, const char* end)
+{
+    while (p != end && std::isspace(static_cast<unsigned char>(*p))) {
+        ++p;
+    }
+    return p;
+}
+
+} // namespace
+
+// static function
+std::vector<std::string>
+AsciiReader::findSceneClassNames(const std::string& code)
+{
+    std::vector<std::string> classNames;
+    std::unordered_set<std::string> found;
+
+    const char* p = code.data();
+    const char* const end = p + code.size();
+    bool afterIndexOperator = false; // the last token was "." or ":"
+    while (p != end) {
+        const char c = *p;
+
+        if (c == '-' && p + 1 != end && p[1] == '-') {
+            // Comment, either a long bracket or to the end of the line.
+            p += 2;
+            const int level = longBracketLevel(p, end);
+            if (level >= 0) {
+                p = skipLongBracket(p, end, level);
+            } else {
+                while (p != end && *p != '\n') {
+                    ++p;
+                }
+            }
+            continue;
+        }
+
+        if (c == '"' || c == '\'') {
+            p = skipQuoted(p, end);
+            afterIndexOperator = false;
+            continue;
+        }
+
+        if (c == '[') {
+            const int level = longBracketLevel(p, end);
+            if (level >= 0) {
+                p = skipLongBracket(p, end, level);
+                afterIndexOperator = false;
+                continue;
+            }
+        }
+
+        if (c == '.' || c == ':') {
+            // ".." and "..." are operators, "." and ":" index, "::" is a label.
+            const char* q = p;
+            while (q != end && *q == c) {
+                ++q;
+            }
+            afterIndexOperator = (q - p == 1);
+            p = q;
+            continue;
+        }
+
+        if (isIdentifierStart(c)) {
+            const char* start = p;
+            while (p != end && isIdentifierChar(*p)) {
+                ++p;
+            }
+            if (afterIndexOperator) {
+                // A field or method, such as string.format("...").
+                afterIndexOperator = false;
+                continue;
+            }
+
+            // Constructors are called with a single string argument, with or
+            // without parentheses.
+            const char* q = skipSpace(p, end);
+            if (q != end && *q == '(') {
+                q = skipSpace(q + 1, end);
+            }
+            if (q == end || (*q != '"' && *q != '\'' && longBracketLevel(q, end) < 0)) {
+                continue;
+            }
+
+            std::string name(start, p);
+            if (isLuaKeyword(name)) {
+                continue;
+            }
+            if (name == "Camera") {
+                // Aliased by the RDLA support library.
+                name = "PerspectiveCamera";
+            }
+            if (found.insert(name).second) {
+                classNames.push_back(std::move(name));
+            }
+            continue;
+        }
+
+        if (std::isdigit(static_cast<unsigned char>(c))) {
+            // Skip numbers whole, so exponents and hex digits aren't
+            // mistaken for identifiers.
+            while (p != end && (isIdentifierChar(*p) || *p == '.')) {
+                ++p;
+            }
+            afterIndexOperator = false;
+            continue;
+        }
+
+        if (!std::isspace(static_cast<unsigned char>(c))) {
+            afterIndexOperator = false;
+        }
+        ++p;
+    }
+
+    return classNames;
+}
+
 void
 AsciiReader::storeInstancePtr()
 {
@@ -297,6 +660,71 @@ AsciiReader::storeInstancePtr()
     lua_settable(mLua, LUA_REGISTRYINDEX);
 }
 
+void
+AsciiReader::createSymbolCache()
+{
+    lua_pushlightuserdata(mLua,
+        static_cast<void*>(const_cast<char*>(&SYMBOL_CACHE_KEY)));
+    lua_newtable(mLua);
+    lua_rawset(mLua, LUA_REGISTRYINDEX);
+}
+
+Symbol
+AsciiReader::toSymbol(int index)
+{
+    // Lua strings are interned and carry their hash, so looking a string up
+    // in a Lua table is cheaper than hashing it into the symbol table again.
+    // Numeric keys are left alone, converting them in place would confuse
+    // lua_next().
+    index = lua_absindex(mLua, index);
+    if (lua_type(mLua, index) != LUA_TSTRING) {
+        return Symbol();
+    }
+
+    lua_pushlightuserdata(mLua,
+        static_cast<void*>(const_cast<char*>(&SYMBOL_CACHE_KEY)));
+    lua_rawget(mLua, LUA_REGISTRYINDEX);
+    LuaPopGuard popGuard(mLua, 1);
+
+    lua_pushvalue(mLua, index);
+    lua_rawget(mLua, -2);
+    const bool cached = lua_isnumber(mLua, -1);
+    const uint32_t id = static_cast<uint32_t>(lua_tointeger(mLua, -1));
+    lua_pop(mLua, 1);
+    if (cached) {
+        return Symbol::fromId(id);
+    }
+
+    // Never intern here. Every attribute name was interned when its
+    // attribute was declared, so a string that isn't in the symbol table
+    // can't name one, and interning it would keep it alive for the rest of
+    // the process. Misses aren't cached either, the name may get interned by
+    // a SceneClass created later.
+    std::size_t len = 0;
+    const char* str = lua_tolstring(mLua, index, &len);
+    const Symbol symbol = Symbol::find(std::string(str, len));
+    if (!symbol.isValid()) {
+        return symbol;
+    }
+    lua_pushvalue(mLua, index);
+    lua_pushinteger(mLua, static_cast<lua_Integer>(symbol.id()));
+    lua_rawset(mLua, -3);
+    return symbol;
+}
+
+const Attribute*
+AsciiReader::lookupAttribute(const SceneClass& sceneClass, int index)
+{
+    const Symbol name = toSymbol(index);
+    if (name.isValid()) {
+        return sceneClass.getAttribute(name);
+    }
+
+    // Not an attribute name. The string lookup throws the same KeyError
+    // with the name in it.
+    return sceneClass.getAttribute(std::string(lua_tostring(mLua, index)));
+}
+
 AsciiReader*
 AsciiReader::loadInstancePtr(lua_State* state)
 {
@@ -1013,26 +1441,7 @@ AsciiReader::extractNumeric(int index)
                 "number expected, got ", luaL_typename(mLua, index)));
     }
 
-    lua_Number num = lua_tonumber(mLua, index);
-    if (num >= 0x1.0p-126 || num <= -0x1.0p-126 || num == 0.0) {
-        // Normal float
-        return static_cast<float>(num);
-    }
-
-    // Denormal float - create bit pattern for mantissa.
-    // A denormal float works very much like an integer in its representation - it has a fixed exponent encoded as all
-    // zeros, its mantissa ranges from 0x00000001 to 0x007FFFFF, and every 1ulp step in this value represents the same
-    // distance in float space. So you just need to scale the double up by a suitably large power of 2 such that the
-    // integer part becomes the desired bit pattern, and convert to int. The necessary exponent is 126+23: 126 to undo
-    // the float exponent bias, plus 23 since 0x007FFFFF is 2^23-1. The only thing needed beyond this is special
-    // treatment of the sign bit, because the denormal bit pattern doesn't behave like a two's complement number.
-    int bits = static_cast<int>(std::round(num * 0x1.0p149));
-    if (num < 0.0) {
-        // Mantissa needs to be a positive number. So if the value was negative,
-        // negate the mantissa and set the sign bit
-        bits = -bits | 0x80000000;
-    }
-    return util::bitCast<float>(bits);
+    return AsciiNativeReader::toFloat(lua_tonumber(mLua, index));
 }
 
 String
@@ -2064,10 +2473,9 @@ RDL2_LUA_DEFINE(sceneObjectIndex)
         return luaL_argerror(mLua, 1,
                 "Cannot retrieve attribute from a null SceneObject.");
     }
-    std::string attrName(luaL_checkstring(mLua, 2));
-
+    luaL_checkstring(mLua, 2);
     try {
-        const Attribute* attr = so->getSceneClass().getAttribute(attrName);
+        const Attribute* attr = lookupAttribute(so->getSceneClass(), 2);
 
         // Handle blurrable attributes which may have multiple values.
         if (attr->isBlurrable()) {
@@ -2113,14 +2521,13 @@ RDL2_LUA_DEFINE(sceneObjectNewIndex)
         return luaL_argerror(mLua, 1,
                 "Cannot set attribute on a null SceneObject.");
     }
-    std::string attrName(luaL_checkstring(mLua, 2));
-
+    luaL_checkstring(mLua, 2);
     // Begin the attribute update.
     SceneObject::UpdateGuard guard(so);
 
     try {
         // Fetch the attribute and set the value.
-        const Attribute* attr = so->getSceneClass().getAttribute(attrName);
+        const Attribute* attr = lookupAttribute(so->getSceneClass(), 2);
         setAttribute(so, attr, 3);
     } catch (except::KeyError& e) {
         // No attribute with that name.
@@ -2203,11 +2610,13 @@ RDL2_LUA_DEFINE(sceneObjectCall)
     // lua_pushlstring() on non-strings may confuse lua_next(), and we don't
     // want to risk it.
     std::vector<std::string> attrNames;
+    std::vector<Symbol> attrSymbols;
     lua_pushnil(mLua); // Seeds the table traversal.
     while (lua_next(mLua, 2) != 0) {
         LuaPopGuard popGuard(mLua, 1);
         if (lua_isstring(mLua, -2)) {
             attrNames.push_back(lua_tostring(mLua, -2));
+            attrSymbols.push_back(toSymbol(-2));
         }
     }
 
@@ -2215,8 +2624,8 @@ RDL2_LUA_DEFINE(sceneObjectCall)
     SceneObject::UpdateGuard guard(so);
 
     // Grab the value for each attribute and set it.
-    for (auto& attrName : attrNames) {
-        //const std::string& attrName = *iter;
+    for (std::size_t i = 0; i < attrNames.size(); ++i) {
+        const std::string& attrName = attrNames[i];
 
         // Push the attribute's value onto the stack.
         lua_getfield(mLua, 2, attrName.c_str());
@@ -2224,7 +2633,9 @@ RDL2_LUA_DEFINE(sceneObjectCall)
 
         try {
             // Fetch the attribute and set the value.
-            const Attribute* attr = so->getSceneClass().getAttribute(attrName);
+            const SceneClass& sc = so->getSceneClass();
+            const Attribute* attr = attrSymbols[i].isValid() ?
+                sc.getAttribute(attrSymbols[i]) : sc.getAttribute(attrName);
             setAttribute(so, attr, -1);
         } catch (except::KeyError& e) {
             // No attribute with that name.
@@ -2546,10 +2957,9 @@ RDL2_LUA_DEFINE(shadowReceiverSetIndex)
         return luaL_argerror(mLua, 1,
                 "Cannot retrieve attribute from a null SceneObject.");
     }
-    std::string attrName(luaL_checkstring(mLua, 2));
-
+    luaL_checkstring(mLua, 2);
     try {
-        const Attribute* attr = so->getSceneClass().getAttribute(attrName);
+        const Attribute* attr = lookupAttribute(so->getSceneClass(), 2);
 
         // Handle blurrable attributes which may have multiple values.
         if (attr->isBlurrable()) {
@@ -2595,14 +3005,13 @@ RDL2_LUA_DEFINE(shadowReceiverSetNewIndex)
         return luaL_argerror(mLua, 1,
                 "Cannot set attribute on a null SceneObject.");
     }
-    std::string attrName(luaL_checkstring(mLua, 2));
-
+    luaL_checkstring(mLua, 2);
     // Begin the attribute update.
     SceneObject::UpdateGuard guard(so);
 
     try {
         // Fetch the attribute and set the value.
-        const Attribute* attr = so->getSceneClass().getAttribute(attrName);
+        const Attribute* attr = lookupAttribute(so->getSceneClass(), 2);
         setAttribute(so, attr, 3);
     } catch (except::KeyError& e) {
         // No attribute with that name.
@@ -2676,11 +3085,13 @@ RDL2_LUA_DEFINE(shadowReceiverSetCall)
     // lua_pushlstring() on non-strings may confuse lua_next(), and we don't
     // want to risk it.
     std::vector<std::string> attrNames;
+    std::vector<Symbol> attrSymbols;
     lua_pushnil(mLua); // Seeds the table traversal.
     while (lua_next(mLua, 2) != 0) {
         LuaPopGuard popGuard(mLua, 1);
         if (lua_isstring(mLua, -2)) {
             attrNames.push_back(lua_tostring(mLua, -2));
+            attrSymbols.push_back(toSymbol(-2));
         }
     }
 
@@ -2688,8 +3099,8 @@ RDL2_LUA_DEFINE(shadowReceiverSetCall)
     SceneObject::UpdateGuard guard(so);
 
     // Grab the value for each attribute and set it.
-    for (auto& attrName : attrNames) {
-        //const std::string& attrName = *iter;
+    for (std::size_t i = 0; i < attrNames.size(); ++i) {
+        const std::string& attrName = attrNames[i];
 
         // Push the attribute's value onto the stack.
         lua_getfield(mLua, 2, attrName.c_str());
@@ -2697,7 +3108,9 @@ RDL2_LUA_DEFINE(shadowReceiverSetCall)
 
         try {
             // Fetch the attribute and set the value.
-            const Attribute* attr = so->getSceneClass().getAttribute(attrName);
+            const SceneClass& sc = so->getSceneClass();
+            const Attribute* attr = attrSymbols[i].isValid() ?
+                sc.getAttribute(attrSymbols[i]) : sc.getAttribute(attrName);
             setAttribute(so, attr, -1);
         } catch (except::KeyError& e) {
             // No attribute with that name.
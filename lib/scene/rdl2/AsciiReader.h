@@ -7,6 +7,7 @@
 // Include this before any other includes!
 #include <scene_rdl2/common/platform/Platform.h>
 
+#include "Symbol.h"
 #include "Types.h"
 
 #include <lua.hpp>
@@ -92,6 +93,21 @@ public:
      */
     void fromString(const std::string& code, const std::string& chunkName = "@rdla");
 
+    /**
+     * Like fromString(), for RDL text which has already been given to
+     * AsciiNativeReader::parse(), so it isn't parsed again. Parsing needs no
+     * SceneContext access, which lets callers parse several texts
+     * concurrently and then read them in order.
+     *
+     * @param   code        String of text containing RDL data.
+     * @param   parsed      A reader for this AsciiReader's SceneContext whose
+     *                      parse(code) returned true, or nullptr if it
+     *                      returned false.
+     * @param   chunkName   The name of the source of this RDL data. (optional)
+     */
+    void fromParsedString(const std::string& code, AsciiNativeReader* parsed,
+                          const std::string& chunkName = "@rdla");
+
     /**
      * When enabled, questionable actions which may be mistakes (such as trying 
      * to set an attribute which doesn't exist) will cause an error rather than
@@ -102,7 +118,58 @@ public:
      */
     finline void setWarningsAsErrors(bool warningsAsErrors);
 
+    /**
+     * When enabled, fromString() scans the RDL text for the SceneClasses it
+     * constructs before running it, and has the SceneContext open the DSOs
+     * of those classes in the background (see
+     * SceneContext::prefetchSceneClasses()), so they load while the text is
+     * applied. Every read waits for the prefetch before it returns or
+     * throws. Disabled by default.
+     *
+     * @param   prefetch    Prefetch the SceneClasses named in the text.
+     */
+    finline void setPrefetchSceneClasses(bool prefetch);
+
+    /**
+     * When enabled, fromString() first tries to read the RDL text with
+     * AsciiNativeReader, which handles the declarative subset AsciiWriter
+     * produces without going through Lua. Text outside that subset, or which
+     * the Lua code would treat differently, is run through Lua as usual.
+     * Enabled by default.
+     *
+     * @param   nativeParsing   Try the native parser before Lua.
+     */
+    finline void setNativeParsing(bool nativeParsing);
+
+    /// True if the last fromString() call was handled by the native parser.
+    finline bool getUsedNativeParser() const;
+
+    /**
+     * Scans RDL text for the names which appear to be SceneClass constructor
+     * calls, such as the "FooMaterial" in FooMaterial("/name"). Comments and
+     * string contents are skipped. This is a heuristic: names which turn out
+     * not to be SceneClasses are possible.
+     *
+     * @param   code    String of text containing RDL data.
+     * @return  The candidate class names in order of first appearance.
+     */
+    static std::vector<std::string> findSceneClassNames(const std::string& code);
+
 private:
+    // True if each of the given global names still has the meaning
+    // AsciiNativeReader assumes: the built in functions and SceneVariables are
+    // the ones registered by the constructor, and any other name is either a
+    // SceneClass constructor created by the support library, or undeclared
+    // so that looking it up creates one.
+    bool globalsArePristine(const std::vector<std::string>& names);
+
+    // Validates and applies parsed text if the globals allow it. Returns
+    // false if the text must be run through Lua instead.
+    bool applyNative(AsciiNativeReader& native, const std::string& chunkName);
+
+    // Runs RDL text through the Lua interpreter.
+    void runLua(const std::string& code, const std::string& chunkName);
+
     // This squirrels away the "this" pointer of this AsciiReader instance
     // within the Lua interpreter registry. This is used for figuring out which
     // instance of AsciiReader to dispatch to when Lua callbacks are invoked
@@ -121,6 +188,22 @@ private:
     // Hacktastic!
     static const char LUA_REGISTRY_KEY;
 
+    // Registry key of the Lua table mapping attribute name strings to Symbol
+    // ids, so each distinct name is looked up once per reader.
+    static const char SYMBOL_CACHE_KEY;
+
+    // Creates the symbol cache table in the Lua registry.
+    void createSymbolCache();
+
+    // Returns the Symbol for the string at the given stack index, caching it
+    // on first use. Returns the invalid Symbol for strings that were never
+    // interned and for values that aren't strings, without interning them.
+    Symbol toSymbol(int index);
+
+    // Looks up the attribute named by the string at the given stack index,
+    // by Symbol when the name is interned and by string otherwise.
+    const Attribute* lookupAttribute(const SceneClass& sceneClass, int index);
+
     // Constants for the names of each metatable we export.
     static const char* SCENE_OBJECT_METATABLE;
     static const char* GEOMETRY_SET_METATABLE;
@@ -532,6 +615,14 @@ private:
 
     lua_State* mLua;
     bool mWarningsAsErrors;
+    bool mPrefetchSceneClasses;
+    bool mNativeParsing;
+    bool mUsedNativeParser;
+
+    // Registry references to the support library's global __index metamethod
+    // and to the table of constructors it has created.
+    int mGlobalIndexRef;
+    int mConstructorsRef;
 };
 
 void
@@ -540,6 +631,24 @@ AsciiReader::setWarningsAsErrors(bool warningsAsErrors)
     mWarningsAsErrors = warningsAsErrors;
 }
 
+void
+AsciiReader::setPrefetchSceneClasses(bool prefetch)
+{
+    mPrefetchSceneClasses = prefetch;
+}
+
+void
+AsciiReader::setNativeParsing(bool nativeParsing)
+{
+    mNativeParsing = nativeParsing;
+}
+
+bool
+AsciiReader::getUsedNativeParser() const
+{
+    return mUsedNativeParser;
+}
+
 } // namespace rdl2
 } // namespace scene_rdl2
 
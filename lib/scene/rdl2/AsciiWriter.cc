@@ -26,9 +26,13 @@
 #include <scene_rdl2/common/except/exceptions.h>
 #include <scene_rdl2/render/util/Strings.h>
 
+#include <tbb/parallel_for.h>
+#include <tbb/task_arena.h>
+
 #include <algorithm>
-#include <iomanip>
+#include <charconv>
 #include <fstream>
+#include <limits>
 #include <numeric>
 #include <ostream>
 #include <sstream>
@@ -39,115 +43,153 @@ namespace rdl2 {
 
 namespace {
 
-// use max_digits10 precision when printing float or double
-// to minimize ascii serialization error
-#define FLOAT_PREC  std::setprecision(std::numeric_limits<float>::max_digits10)
-#define DOUBLE_PREC std::setprecision(std::numeric_limits<double>::max_digits10)
+// Values are appended to the output with std::to_chars rather than formatted
+// through iostreams. Floats and doubles use max_digits10 precision to
+// minimize ascii serialization error, in the same "%g" style an ostream with
+// that precision would produce.
+void
+appendReal(std::string& out, Float f)
+{
+    char buf[32];
+    const auto result = std::to_chars(buf, buf + sizeof(buf), f, std::chars_format::general,
+                                      std::numeric_limits<Float>::max_digits10);
+    out.append(buf, result.ptr);
+}
 
-std::string
-boolToString(Bool b)
+void
+appendReal(std::string& out, Double d)
 {
-    std::ostringstream s;
-    s << std::boolalpha << b;
-    return s.str();
+    char buf[32];
+    const auto result = std::to_chars(buf, buf + sizeof(buf), d, std::chars_format::general,
+                                      std::numeric_limits<Double>::max_digits10);
+    out.append(buf, result.ptr);
 }
 
-std::string
-intToString(Int i)
+template <typename T>
+void
+appendInteger(std::string& out, T i)
 {
-    return util::buildString(i);
+    char buf[24];
+    const auto result = std::to_chars(buf, buf + sizeof(buf), i);
+    out.append(buf, result.ptr);
 }
 
-std::string
-longToString(Long l)
+// Appends "name(a, b, ...)".
+template <typename T, typename... Rest>
+void
+appendComponents(std::string& out, const char* name, T first, Rest... rest)
 {
-    return util::buildString(l);
+    out += name;
+    out += '(';
+    appendReal(out, first);
+    ((out += ", ", appendReal(out, rest)), ...);
+    out += ')';
 }
 
-std::string
-floatToString(Float f)
+void
+appendBool(std::string& out, Bool b)
 {
-    return util::buildString(FLOAT_PREC, f);
+    out += b ? "true" : "false";
 }
 
-std::string
-doubleToString(Double d)
+void
+appendInt(std::string& out, Int i)
 {
-    return util::buildString(DOUBLE_PREC, d);
+    appendInteger(out, i);
 }
 
-std::string
-stringToString(String s)
+void
+appendLong(std::string& out, Long l)
 {
-    return util::buildString('"', s, '"');
+    appendInteger(out, l);
 }
 
-std::string
-rgbToString(Rgb r)
+void
+appendFloat(std::string& out, Float f)
 {
-    return util::buildString(FLOAT_PREC, "Rgb(", r.r, ", ", r.g, ", ", r.b, ')');
+    appendReal(out, f);
 }
 
-std::string
-rgbaToString(Rgba r)
+void
+appendDouble(std::string& out, Double d)
 {
-    return util::buildString(FLOAT_PREC, "Rgba(", r.r, ", ", r.g, ", ", r.b, ", ", r.a, ')');
+    appendReal(out, d);
 }
 
-std::string
-vec2fToString(Vec2f v)
+void
+appendString(std::string& out, const String& s)
 {
-    return util::buildString(FLOAT_PREC, "Vec2(", v.x, ", ", v.y, ')');
+    out += '"';
+    out += s;
+    out += '"';
 }
 
-std::string
-vec2dToString(Vec2d v)
+void
+appendRgb(std::string& out, const Rgb& r)
 {
-    return util::buildString(DOUBLE_PREC, "Vec2(", v.x, ", ", v.y, ')');
+    appendComponents(out, "Rgb", r.r, r.g, r.b);
 }
 
-std::string
-vec3fToString(Vec3f v)
+void
+appendRgba(std::string& out, const Rgba& r)
 {
-    return util::buildString(FLOAT_PREC, "Vec3(", v.x, ", ", v.y, ", ", v.z, ')');
+    appendComponents(out, "Rgba", r.r, r.g, r.b, r.a);
 }
 
-std::string
-vec3dToString(Vec3d v)
+void
+appendVec2f(std::string& out, const Vec2f& v)
 {
-    return util::buildString(DOUBLE_PREC, "Vec3(", v.x, ", ", v.y, ", ", v.z, ')');
+    appendComponents(out, "Vec2", v.x, v.y);
 }
 
-std::string
-vec4fToString(Vec4f v)
+void
+appendVec2d(std::string& out, const Vec2d& v)
 {
-    return util::buildString(FLOAT_PREC, "Vec4(", v.x, ", ", v.y, ", ", v.z, ", ", v.w,')');
+    appendComponents(out, "Vec2", v.x, v.y);
 }
 
-std::string
-vec4dToString(Vec4d v)
+void
+appendVec3f(std::string& out, const Vec3f& v)
 {
-    return util::buildString(DOUBLE_PREC, "Vec4(", v.x, ", ", v.y, ", ", v.z, ", ", v.w,')');
+    appendComponents(out, "Vec3", v.x, v.y, v.z);
 }
 
-std::string
-mat4fToString(const Mat4f& m)
+void
+appendVec3d(std::string& out, const Vec3d& v)
 {
-    return util::buildString(FLOAT_PREC, "Mat4(",
-            m.vx.x, ", ", m.vx.y, ", ", m.vx.z, ", ", m.vx.w, ", ",
-            m.vy.x, ", ", m.vy.y, ", ", m.vy.z, ", ", m.vy.w, ", ",
-            m.vz.x, ", ", m.vz.y, ", ", m.vz.z, ", ", m.vz.w, ", ",
-            m.vw.x, ", ", m.vw.y, ", ", m.vw.z, ", ", m.vw.w, ')');
+    appendComponents(out, "Vec3", v.x, v.y, v.z);
 }
 
-std::string
-mat4dToString(const Mat4d& m)
+void
+appendVec4f(std::string& out, const Vec4f& v)
+{
+    appendComponents(out, "Vec4", v.x, v.y, v.z, v.w);
+}
+
+void
+appendVec4d(std::string& out, const Vec4d& v)
 {
-    return util::buildString(DOUBLE_PREC, "Mat4(",
-            m.vx.x, ", ", m.vx.y, ", ", m.vx.z, ", ", m.vx.w, ", ",
-            m.vy.x, ", ", m.vy.y, ", ", m.vy.z, ", ", m.vy.w, ", ",
-            m.vz.x, ", ", m.vz.y, ", ", m.vz.z, ", ", m.vz.w, ", ",
-            m.vw.x, ", ", m.vw.y, ", ", m.vw.z, ", ", m.vw.w, ')');
+    appendComponents(out, "Vec4", v.x, v.y, v.z, v.w);
+}
+
+void
+appendMat4f(std::string& out, const Mat4f& m)
+{
+    appendComponents(out, "Mat4",
+            m.vx.x, m.vx.y, m.vx.z, m.vx.w,
+            m.vy.x, m.vy.y, m.vy.z, m.vy.w,
+            m.vz.x, m.vz.y, m.vz.z, m.vz.w,
+            m.vw.x, m.vw.y, m.vw.z, m.vw.w);
+}
+
+void
+appendMat4d(std::string& out, const Mat4d& m)
+{
+    appendComponents(out, "Mat4",
+            m.vx.x, m.vx.y, m.vx.z, m.vx.w,
+            m.vy.x, m.vy.y, m.vy.z, m.vy.w,
+            m.vz.x, m.vz.y, m.vz.z, m.vz.w,
+            m.vw.x, m.vw.y, m.vw.z, m.vw.w);
 }
 
 const SceneObject*
@@ -304,41 +346,45 @@ sortGeometriesAndParts(const SceneObjectIndexable& geometries,
     return order;
 }
 
+
+// Objects formatted per parallel batch in writeObjectsParallel(), per thread.
+constexpr std::size_t OBJECTS_PER_THREAD_BATCH = 64;
+
 } // namespace
 
 template <typename T, typename F>
-std::string
-AsciiWriter::vectorToString(const SceneObject* so, const Attribute* attr,
-                            AttributeTimestep timestep, F predicate) const
+void
+AsciiWriter::writeVector(std::string& out, const SceneObject* so, const Attribute* attr,
+                         AttributeTimestep timestep, F append) const
 {
     const T& vec = so->get(AttributeKey<T>(*attr), timestep);
-    std::ostringstream s;
-    s << '{';
+    out += '{';
     bool first = true;
     size_t elemsThisLine = 0;
     for (auto iter = vec.begin(); iter != vec.end(); ++iter) {
         if (first) {
             first = false;
         } else {
-            s << ",";
+            out += ',';
         }
         if (mElemsPerLine > 0 && elemsThisLine == mElemsPerLine) {
-            s << "\n" << mIndent << "    ";
+            out += '\n';
+            out += mIndent;
+            out += "    ";
             elemsThisLine = 0;
         } else {
-            s << " ";
+            out += ' ';
         }
-        s << predicate(*iter);
+        append(out, *iter);
         ++elemsThisLine;
     }
-    s << '}';
-    return s.str();
+    out += '}';
 }
 
 bool
 AsciiWriter::skipSceneObject(const SceneObject* so) const
 {
-    return mDeltaEncoding && !so->mDirty;
+    return (mDeltaEncoding || mDirtyOnly) && !so->mDirty;
 }
 
 bool
@@ -361,16 +407,27 @@ AsciiWriter::generateWriteOrder() const
 {
     std::vector<const SceneObject*> order;
 
-    // Write all the other objects. Skip the SceneVariables, we already put
-    // them first.
-    for (auto iter = mContext.beginSceneObject();
-            iter != mContext.endSceneObject(); ++iter) {
-        if (skipSceneObject(iter->second)) continue;
-
-        // Skip the SceneVariables, they're handled separately.
-        if (iter->second->getName() == "__SceneVariables__") continue;
-
-        order.push_back(iter->second);
+    // Collect all the other objects. Skip the SceneVariables, they're handled
+    // separately.
+    auto collect = [this, &order](const SceneObject* so) {
+        if (skipSceneObject(so)) return;
+        if (so->getName() == "__SceneVariables__") return;
+        order.push_back(so);
+    };
+
+    // If only dirty objects are written, only visit the objects dirtied since
+    // the last commitAllChanges() instead of the whole context.
+    if (mDeltaEncoding || mDirtyOnly) {
+        const SceneContext::DirtyObjectJournal& journal = mContext.getDirtyObjectJournal();
+        order.reserve(journal.size());
+        for (const SceneObject* so : journal) {
+            collect(so);
+        }
+    } else {
+        for (auto iter = mContext.beginSceneObject();
+                iter != mContext.endSceneObject(); ++iter) {
+            collect(iter->second);
+        }
     }
 
     // For now, we order objects by a simple heuristic which tends to put
@@ -394,78 +451,80 @@ AsciiWriter::generateWriteOrder() const
     rest = partitionAndSortByName<Camera>(rest, order.end());
     rest = partitionAndSortByName<Metadata>(rest, order.end());
 
+    // Sort the remaining objects by name too, so the order doesn't depend on
+    // where the objects were collected from.
+    std::sort(rest, order.end(), [](const SceneObject* a, const SceneObject* b) {
+        return a->getName() < b->getName();
+    });
+
     return order;
 }
 
-std::string
-AsciiWriter::sceneObjectRef(const SceneObject* so) const
+void
+AsciiWriter::writeSceneObjectRef(std::string& out, const SceneObject* so) const
 {
     if (so == nullptr) {
-        return "undef()";
+        out += "undef()";
+        return;
     }
 
-    // TODO: cache these strings so we don't build them all the time? look
-    //       them up in an identifier table?
-    return util::buildString(so->getSceneClass().getName(), "(\"",
-            so->getName(), "\")");
+    out += so->getSceneClass().getName();
+    out += "(\"";
+    out += so->getName();
+    out += "\")";
 }
 
-std::string
-AsciiWriter::blurredValueToString(const SceneObject* so, const Attribute* attr) const
+void
+AsciiWriter::writeBlurredValue(std::string& out, const SceneObject* so, const Attribute* attr) const
 {
-    std::ostringstream s;
-
     // TODO: only output single value if begin and end are the same
     if (attr->isBlurrable()) {
-        s << "blur(" << valueToString(so, attr, TIMESTEP_BEGIN) << ", " <<
-                valueToString(so, attr, TIMESTEP_END) << ")";
+        out += "blur(";
+        writeValue(out, so, attr, TIMESTEP_BEGIN);
+        out += ", ";
+        writeValue(out, so, attr, TIMESTEP_END);
+        out += ')';
     } else {
-        s << valueToString(so, attr, TIMESTEP_BEGIN);
+        writeValue(out, so, attr, TIMESTEP_BEGIN);
     }
-
-    return s.str();
 }
 
-std::string
-AsciiWriter::boundValueToString(const SceneObject* so, const Attribute* attr) const
+void
+AsciiWriter::writeBoundValue(std::string& out, const SceneObject* so, const Attribute* attr) const
 {
-    std::ostringstream s;
-
-    bool isBinding = false;
-    const SceneObject* boundObject = nullptr;
-    try {
-        boundObject = fetchBinding(so, attr);
-        isBinding = true;
-    } catch (const except::TypeError&) {
-        isBinding = false;
-    }
+    const bool isBinding = attr->isBindable();
+    const SceneObject* boundObject = isBinding ? fetchBinding(so, attr) : nullptr;
+    const bool skipValue = skipAttributeValue(so, attr);
 
     if (isBinding) {
-        s << "bind(" << sceneObjectRef(boundObject);
-    }
-
-    if ((boundObject || isBinding) && !skipAttributeValue(so, attr)) {
-        s << ", ";
+        out += "bind(";
+        writeSceneObjectRef(out, boundObject);
+        if (!skipValue) {
+            out += ", ";
+        }
     }
 
-    if (!skipAttributeValue(so, attr)) {
-        s << blurredValueToString(so, attr);
+    if (!skipValue) {
+        writeBlurredValue(out, so, attr);
     }
 
     if (isBinding) {
-        s << ')';
+        out += ')';
     }
-
-    return s.str();
 }
 
-std::string
-AsciiWriter::valueToString(const SceneObject* so, const Attribute* attr,
-                           AttributeTimestep timestep) const
+void
+AsciiWriter::writeValue(std::string& out, const SceneObject* so, const Attribute* attr,
+                        AttributeTimestep timestep) const
 {
+    auto appendRef = [this](std::string& dst, const SceneObject* ref) {
+        writeSceneObjectRef(dst, ref);
+    };
+
     switch (attr->getType()) {
     case TYPE_BOOL:
-        return boolToString(so->get(AttributeKey<Bool>(*attr), timestep));
+        appendBool(out, so->get(AttributeKey<Bool>(*attr), timestep));
+        break;
 
     case TYPE_INT:
         {
@@ -473,7 +532,8 @@ AsciiWriter::valueToString(const SceneObject* so, const Attribute* attr,
             if (attr->isEnumerable()) {
 
                 try {
-                    return std::string("\"") + attr->getEnumDescription(i) + std::string("\"");
+                    appendString(out, attr->getEnumDescription(i));
+                    break;
                 }
 
                 // Catch and ignore any key errors since not all enums may have
@@ -483,111 +543,141 @@ AsciiWriter::valueToString(const SceneObject* so, const Attribute* attr,
             }
 
             // Fallback to outputting the raw integer.
-            return intToString(i);
+            appendInt(out, i);
         }
+        break;
 
     case TYPE_LONG:
-        return longToString(so->get(AttributeKey<int64_t>(*attr), timestep));
+        appendLong(out, so->get(AttributeKey<int64_t>(*attr), timestep));
+        break;
 
     case TYPE_FLOAT:
-        return floatToString(so->get(AttributeKey<Float>(*attr), timestep));
+        appendFloat(out, so->get(AttributeKey<Float>(*attr), timestep));
+        break;
 
     case TYPE_DOUBLE:
-        return doubleToString(so->get(AttributeKey<Double>(*attr), timestep));
+        appendDouble(out, so->get(AttributeKey<Double>(*attr), timestep));
+        break;
 
     case TYPE_STRING:
-        return stringToString(so->get(AttributeKey<String>(*attr), timestep));
+        appendString(out, so->get(AttributeKey<String>(*attr), timestep));
+        break;
 
     case TYPE_RGB:
-        return rgbToString(so->get(AttributeKey<Rgb>(*attr), timestep));
+        appendRgb(out, so->get(AttributeKey<Rgb>(*attr), timestep));
+        break;
 
     case TYPE_RGBA:
-        return rgbaToString(so->get(AttributeKey<Rgba>(*attr), timestep));
+        appendRgba(out, so->get(AttributeKey<Rgba>(*attr), timestep));
+        break;
 
     case TYPE_VEC2F:
-        return vec2fToString(so->get(AttributeKey<Vec2f>(*attr), timestep));
+        appendVec2f(out, so->get(AttributeKey<Vec2f>(*attr), timestep));
+        break;
 
     case TYPE_VEC2D:
-        return vec2dToString(so->get(AttributeKey<Vec2d>(*attr), timestep));
+        appendVec2d(out, so->get(AttributeKey<Vec2d>(*attr), timestep));
+        break;
 
     case TYPE_VEC3F:
-        return vec3fToString(so->get(AttributeKey<Vec3f>(*attr), timestep));
+        appendVec3f(out, so->get(AttributeKey<Vec3f>(*attr), timestep));
+        break;
 
     case TYPE_VEC3D:
-        return vec3dToString(so->get(AttributeKey<Vec3d>(*attr), timestep));
+        appendVec3d(out, so->get(AttributeKey<Vec3d>(*attr), timestep));
+        break;
 
     case TYPE_VEC4F:
-        return vec4fToString(so->get(AttributeKey<Vec4f>(*attr), timestep));
+        appendVec4f(out, so->get(AttributeKey<Vec4f>(*attr), timestep));
+        break;
 
     case TYPE_VEC4D:
-        return vec4dToString(so->get(AttributeKey<Vec4d>(*attr), timestep));
+        appendVec4d(out, so->get(AttributeKey<Vec4d>(*attr), timestep));
+        break;
 
     case TYPE_MAT4F:
-        return mat4fToString(so->get(AttributeKey<Mat4f>(*attr), timestep));
+        appendMat4f(out, so->get(AttributeKey<Mat4f>(*attr), timestep));
+        break;
 
     case TYPE_MAT4D:
-        return mat4dToString(so->get(AttributeKey<Mat4d>(*attr), timestep));
+        appendMat4d(out, so->get(AttributeKey<Mat4d>(*attr), timestep));
+        break;
 
     case TYPE_SCENE_OBJECT:
-        return sceneObjectRef(so->get(AttributeKey<SceneObject*>(*attr), timestep));
+        writeSceneObjectRef(out, so->get(AttributeKey<SceneObject*>(*attr), timestep));
+        break;
 
     case TYPE_BOOL_VECTOR:
-        return vectorToString<BoolVector>(so, attr, timestep, boolToString);
+        writeVector<BoolVector>(out, so, attr, timestep, appendBool);
+        break;
 
     case TYPE_INT_VECTOR:
-        return vectorToString<IntVector>(so, attr, timestep, intToString);
+        writeVector<IntVector>(out, so, attr, timestep, appendInt);
+        break;
 
     case TYPE_LONG_VECTOR:
-        return vectorToString<LongVector>(so, attr, timestep, longToString);
+        writeVector<LongVector>(out, so, attr, timestep, appendLong);
+        break;
 
     case TYPE_FLOAT_VECTOR:
-        return vectorToString<FloatVector>(so, attr, timestep, floatToString);
+        writeVector<FloatVector>(out, so, attr, timestep, appendFloat);
+        break;
 
     case TYPE_DOUBLE_VECTOR:
-        return vectorToString<DoubleVector>(so, attr, timestep, doubleToString);
+        writeVector<DoubleVector>(out, so, attr, timestep, appendDouble);
+        break;
 
     case TYPE_STRING_VECTOR:
-        return vectorToString<StringVector>(so, attr, timestep, stringToString);
+        writeVector<StringVector>(out, so, attr, timestep, appendString);
+        break;
 
     case TYPE_RGB_VECTOR:
-        return vectorToString<RgbVector>(so, attr, timestep, rgbToString);
+        writeVector<RgbVector>(out, so, attr, timestep, appendRgb);
+        break;
 
     case TYPE_RGBA_VECTOR:
-        return vectorToString<RgbaVector>(so, attr, timestep, rgbaToString);
+        writeVector<RgbaVector>(out, so, attr, timestep, appendRgba);
+        break;
 
     case TYPE_VEC2F_VECTOR:
-        return vectorToString<Vec2fVector>(so, attr, timestep, vec2fToString);
+        writeVector<Vec2fVector>(out, so, attr, timestep, appendVec2f);
+        break;
 
     case TYPE_VEC2D_VECTOR:
-        return vectorToString<Vec2dVector>(so, attr, timestep, vec2dToString);
+        writeVector<Vec2dVector>(out, so, attr, timestep, appendVec2d);
+        break;
 
     case TYPE_VEC3F_VECTOR:
-        return vectorToString<Vec3fVector>(so, attr, timestep, vec3fToString);
+        writeVector<Vec3fVector>(out, so, attr, timestep, appendVec3f);
+        break;
 
     case TYPE_VEC3D_VECTOR:
-        return vectorToString<Vec3dVector>(so, attr, timestep, vec3dToString);
+        writeVector<Vec3dVector>(out, so, attr, timestep, appendVec3d);
+        break;
 
     case TYPE_VEC4F_VECTOR:
-        return vectorToString<Vec4fVector>(so, attr, timestep, vec4fToString);
+        writeVector<Vec4fVector>(out, so, attr, timestep, appendVec4f);
+        break;
 
     case TYPE_VEC4D_VECTOR:
-        return vectorToString<Vec4dVector>(so, attr, timestep, vec4dToString);
+        writeVector<Vec4dVector>(out, so, attr, timestep, appendVec4d);
+        break;
 
     case TYPE_MAT4F_VECTOR:
-        return vectorToString<Mat4fVector>(so, attr, timestep, mat4fToString);
+        writeVector<Mat4fVector>(out, so, attr, timestep, appendMat4f);
+        break;
 
     case TYPE_MAT4D_VECTOR:
-        return vectorToString<Mat4dVector>(so, attr, timestep, mat4dToString);
+        writeVector<Mat4dVector>(out, so, attr, timestep, appendMat4d);
+        break;
 
     case TYPE_SCENE_OBJECT_VECTOR:
-        return vectorToString<SceneObjectVector>(so, attr, timestep, [this](const SceneObject* so) {
-            return sceneObjectRef(so);
-        });
+        writeVector<SceneObjectVector>(out, so, attr, timestep, appendRef);
+        break;
 
     case TYPE_SCENE_OBJECT_INDEXABLE:
-        return vectorToString<SceneObjectIndexable>(so, attr, timestep, [this](const SceneObject* so) {
-            return sceneObjectRef(so);
-        });
+        writeVector<SceneObjectIndexable>(out, so, attr, timestep, appendRef);
+        break;
 
     default:
         throw except::TypeError("Attempt to convert value of unknown type to string.");
@@ -595,30 +685,61 @@ AsciiWriter::valueToString(const SceneObject* so, const Attribute* attr,
 }
 
 void
-AsciiWriter::writeSceneObject(std::ostream& out, const SceneObject* so) const
+AsciiWriter::writeObjectBlock(std::string& out, const SceneObject* so) const
+{
+    // Write the object header.
+    writeSceneObjectRef(out, so);
+    out += " {\n";
+
+    // Write the attributes block, with special cases for sets and layers.
+    if (so->isA<GeometrySet>()) {
+        writeSet(out, so->asA<GeometrySet>()->getGeometries());
+    } else if (so->isA<LightFilterSet>()) {
+        writeSet(out, so->asA<LightFilterSet>()->getLightFilters());
+    } else if (so->isA<ShadowSet>()) {
+        writeSet(out, so->asA<ShadowSet>()->getLights());
+    } else if (so->isA<ShadowReceiverSet>()) {
+        writeSet(out, so->asA<ShadowReceiverSet>()->getGeometries());
+    } else if (so->isA<LightSet>()) {
+        writeSet(out, so->asA<LightSet>()->getLights());
+    } else if (so->isA<Layer>()) {
+        writeLayer(out, so->asA<Layer>());
+    } else if (so->isA<TraceSet>()) {
+        writeTraceSet(out, so->asA<TraceSet>());
+    } else if (so->isA<Metadata>()) {
+        writeMetadata(out, so->asA<Metadata>());
+    } else {
+        writeSceneObject(out, so);
+    }
+
+    // Write the object footer.
+    out += "}\n";
+}
+
+void
+AsciiWriter::writeSceneObject(std::string& out, const SceneObject* so) const
 {
     const SceneClass& sc = so->getSceneClass();
     for (auto iter = sc.beginAttributes(); iter != sc.endAttributes(); ++iter) {
         const Attribute* attr = *iter;
 
         // Only skip the attribute if it doesn't have a binding.
-        try {
-            if (!fetchBinding(so, attr) && skipAttributeValue(so, attr)) {
-                continue;
-            }
-        } catch (const except::TypeError&) {
-            if (skipAttributeValue(so, attr)) {
-                continue;
-            }
+        const SceneObject* binding = attr->isBindable() ? fetchBinding(so, attr) : nullptr;
+        if (!binding && skipAttributeValue(so, attr)) {
+            continue;
         }
 
-        out << mIndent << "[\"" << attr->getName() << "\"] = " <<
-                boundValueToString(so, attr) << ",\n";
+        out += mIndent;
+        out += "[\"";
+        out += attr->getName();
+        out += "\"] = ";
+        writeBoundValue(out, so, attr);
+        out += ",\n";
     }
 }
 
 void
-AsciiWriter::writeTraceSet(std::ostream& out, const TraceSet* traceSet) const
+AsciiWriter::writeTraceSet(std::string& out, const TraceSet* traceSet) const
 {
     const auto& geometries = traceSet->get(TraceSet::sGeometriesKey);
     const auto& parts = traceSet->get(TraceSet::sPartsKey);
@@ -629,13 +750,17 @@ AsciiWriter::writeTraceSet(std::ostream& out, const TraceSet* traceSet) const
     // Write out each assignment in the trace set.
     for (std::size_t i = 0; i < order.size(); ++i) {
         std::size_t index = order[i];
-        out << mIndent << '{' << sceneObjectRef(geometries[index]) << ", \"" <<
-                parts[index] << "\"},\n";
+        out += mIndent;
+        out += '{';
+        writeSceneObjectRef(out, geometries[index]);
+        out += ", ";
+        appendString(out, parts[index]);
+        out += "},\n";
     }
 }
 
 void
-AsciiWriter::writeLayer(std::ostream& out, const Layer* layer) const
+AsciiWriter::writeLayer(std::string& out, const Layer* layer) const
 {
     const auto& geometries = layer->get(Layer::sGeometriesKey);
     const auto& parts = layer->get(Layer::sPartsKey);
@@ -653,20 +778,24 @@ AsciiWriter::writeLayer(std::ostream& out, const Layer* layer) const
     // Write out each assignment in the layer.
     for (std::size_t i = 0; i < order.size(); ++i) {
         std::size_t index = order[i];
-        out << mIndent << '{' << sceneObjectRef(geometries[index]) << ", \"" <<
-                parts[index] << "\", " <<
-                sceneObjectRef(surfaceShaders[index]) << ", " <<
-                sceneObjectRef(lightSets[index]) << ", " <<
-                sceneObjectRef(displacements[index]) << ", " <<
-                sceneObjectRef(volumeShaders[index]) << ", " <<
-                sceneObjectRef(lightFilterSets[index]) << ", " <<
-                sceneObjectRef(shadowSets[index]) << ", " <<
-                sceneObjectRef(shadowReceiverSets[index]) << "},\n";
+        out += mIndent;
+        out += '{';
+        writeSceneObjectRef(out, geometries[index]);
+        out += ", ";
+        appendString(out, parts[index]);
+        for (const SceneObject* assignment : { surfaceShaders[index], lightSets[index],
+                                               displacements[index], volumeShaders[index],
+                                               lightFilterSets[index], shadowSets[index],
+                                               shadowReceiverSets[index] }) {
+            out += ", ";
+            writeSceneObjectRef(out, assignment);
+        }
+        out += "},\n";
     }
 }
 
 void
-AsciiWriter::writeMetadata(std::ostream& out, const Metadata* metadata) const
+AsciiWriter::writeMetadata(std::string& out, const Metadata* metadata) const
 {
     const auto& names = metadata->get(Metadata::sNameKey);
     const auto& types = metadata->get(Metadata::sTypeKey);
@@ -682,15 +811,50 @@ AsciiWriter::writeMetadata(std::ostream& out, const Metadata* metadata) const
     // Write out data elements.
     for (std::size_t i = 0; i < order.size(); ++i) {
         std::size_t index = order[i];
-        out << mIndent << "{\"" << names[index] << "\", \"" <<
-                types[index] << "\", \"" <<
-                values[index] << "\"},\n";
+        out += mIndent;
+        out += '{';
+        appendString(out, names[index]);
+        out += ", ";
+        appendString(out, types[index]);
+        out += ", ";
+        appendString(out, values[index]);
+        out += "},\n";
+    }
+}
+
+void
+AsciiWriter::writeObjectsParallel(std::ostream& output,
+                                  const std::vector<const SceneObject*>& writeOrder) const
+{
+    // Objects are formatted in batches, each object into its own buffer, and
+    // the buffers are written in order once the whole batch is done. Batching
+    // bounds the memory held by formatted text which hasn't been written yet.
+    const std::size_t batchSize = OBJECTS_PER_THREAD_BATCH *
+        static_cast<std::size_t>(tbb::this_task_arena::max_concurrency());
+    std::vector<std::string> buffers(std::min(batchSize, writeOrder.size()));
+
+    for (std::size_t batchBegin = 0; batchBegin < writeOrder.size(); batchBegin += batchSize) {
+        const std::size_t batchEnd = std::min(batchBegin + batchSize, writeOrder.size());
+        tbb::parallel_for(batchBegin, batchEnd, [&](std::size_t i) {
+            std::string& buffer = buffers[i - batchBegin];
+            buffer.clear();
+            if (i > 0) {
+                buffer += '\n';
+            }
+            writeObjectBlock(buffer, writeOrder[i]);
+        });
+        for (std::size_t i = batchBegin; i < batchEnd; ++i) {
+            const std::string& buffer = buffers[i - batchBegin];
+            output.write(buffer.data(), buffer.size());
+        }
     }
 }
 
 AsciiWriter::AsciiWriter(const SceneContext& context) :
     mContext(context),
     mDeltaEncoding(false),
+    mDirtyOnly(false),
+    mParallelEncoding(false),
     mIndent("    "),
     mElemsPerLine(0),
     mSkipDefaults(false)
@@ -713,53 +877,32 @@ AsciiWriter::toFile(const std::string& filename) const
 void
 AsciiWriter::toStream(std::ostream& output) const
 {
+    std::string buffer;
+
     // Write the SceneVariables first.
     const SceneObject* sceneVars = mContext.getSceneObject("__SceneVariables__");
     if (!skipSceneObject(sceneVars)) {
-        output << "SceneVariables {\n";
-        writeSceneObject(output, sceneVars);
-        output << "}\n\n";
+        buffer += "SceneVariables {\n";
+        writeSceneObject(buffer, sceneVars);
+        buffer += "}\n\n";
+        output.write(buffer.data(), buffer.size());
     }
 
     // Order the SceneObjects by the order we intend to write them.
     auto writeOrder = generateWriteOrder();
 
     // Write out each object.
-    bool first = true;
-    for (auto iter = writeOrder.begin(); iter != writeOrder.end(); ++iter) {
-        const SceneObject* so = *iter;
-
-        // Write the object header.
-        if (!first) {
-            output << "\n";
-        } else {
-            first = false;
-        }
-        output << sceneObjectRef(so) << " {\n";
-
-        // Write the attributes block, with special cases for sets and layers.
-        if (so->isA<GeometrySet>()) {
-            writeSet(output, so->asA<GeometrySet>()->getGeometries());
-        } else if (so->isA<LightFilterSet>()) {
-            writeSet(output, so->asA<LightFilterSet>()->getLightFilters());
-        } else if (so->isA<ShadowSet>()) {
-            writeSet(output, so->asA<ShadowSet>()->getLights());
-        } else if (so->isA<ShadowReceiverSet>()) {
-            writeSet(output, so->asA<ShadowReceiverSet>()->getGeometries());
-        } else if (so->isA<LightSet>()) {
-            writeSet(output, so->asA<LightSet>()->getLights());
-        } else if (so->isA<Layer>()) {
-            writeLayer(output, so->asA<Layer>());
-        } else if (so->isA<TraceSet>()) {
-            writeTraceSet(output, so->asA<TraceSet>());
-        } else if (so->isA<Metadata>()) {
-            writeMetadata(output, so->asA<Metadata>());
-        } else {
-            writeSceneObject(output, so);
+    if (mParallelEncoding) {
+        writeObjectsParallel(output, writeOrder);
+        return;
+    }
+    for (std::size_t i = 0; i < writeOrder.size(); ++i) {
+        buffer.clear();
+        if (i > 0) {
+            buffer += '\n';
         }
-
-        // Write the object footer.
-        output << "}\n";
+        writeObjectBlock(buffer, writeOrder[i]);
+        output.write(buffer.data(), buffer.size());
     }
 }
 
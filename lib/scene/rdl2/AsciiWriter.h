@@ -20,6 +20,28 @@ public:
 
     finline void setDeltaEncoding(bool deltaEncoding);
 
+    /**
+     * Writes only the SceneObjects which are dirty (created, or with an
+     * attribute or binding changed, since the last commitAllChanges()), but
+     * unlike delta encoding writes all of their attribute values. Like delta
+     * encoding, only the objects in the SceneContext's dirty object journal
+     * are visited rather than the whole context.
+     *
+     * @param   dirtyOnly   True to skip objects which aren't dirty.
+     *                      (Disabled by default)
+     */
+    finline void setDirtyOnly(bool dirtyOnly);
+
+    /**
+     * Formats the SceneObjects in parallel. Each object is formatted into its
+     * own buffer by a TBB task and the buffers are written in the usual
+     * order, so the output is byte-identical to the serial formatting.
+     *
+     * @param   parallelEncoding    True to format objects in parallel.
+     *                              (Disabled by default)
+     */
+    finline void setParallelEncoding(bool parallelEncoding);
+
     finline void setIndent(const char* indent);
 
     finline void setElementsPerLine(size_t elemsPerLine);
@@ -42,24 +64,32 @@ private:
     bool skipSceneObject(const SceneObject* so) const;
     bool skipAttributeValue(const SceneObject* so, const Attribute* attr) const;
     std::vector<const SceneObject*> generateWriteOrder() const;
-    std::string sceneObjectRef(const SceneObject* so) const;
-    std::string blurredValueToString(const SceneObject* so, const Attribute* attr) const;
-    std::string boundValueToString(const SceneObject* so, const Attribute* attr) const;
-    std::string valueToString(const SceneObject* so, const Attribute* attr,
-                              AttributeTimestep timestep) const;
+    void writeSceneObjectRef(std::string& out, const SceneObject* so) const;
+    void writeBlurredValue(std::string& out, const SceneObject* so, const Attribute* attr) const;
+    void writeBoundValue(std::string& out, const SceneObject* so, const Attribute* attr) const;
+    void writeValue(std::string& out, const SceneObject* so, const Attribute* attr,
+                    AttributeTimestep timestep) const;
     template <typename T, typename F>
-    std::string vectorToString(const SceneObject* so, const Attribute* attr,
-                               AttributeTimestep timestep, F predicate) const;
-    void writeSceneObject(std::ostream& out, const SceneObject* so) const;
+    void writeVector(std::string& out, const SceneObject* so, const Attribute* attr,
+                     AttributeTimestep timestep, F append) const;
+    void writeObjectBlock(std::string& out, const SceneObject* so) const;
+    void writeSceneObject(std::string& out, const SceneObject* so) const;
     template <typename Container>
-    void writeSet(std::ostream& out, const Container& members) const;
-    void writeTraceSet(std::ostream& out, const TraceSet* layer) const;
-    void writeLayer(std::ostream& out, const Layer* layer) const;
-    void writeMetadata(std::ostream& out, const Metadata* metadata) const;
+    void writeSet(std::string& out, const Container& members) const;
+    void writeTraceSet(std::string& out, const TraceSet* layer) const;
+    void writeLayer(std::string& out, const Layer* layer) const;
+    void writeMetadata(std::string& out, const Metadata* metadata) const;
+    void writeObjectsParallel(std::ostream& output,
+                              const std::vector<const SceneObject*>& writeOrder) const;
 
     // True if we should encode only deltas rather than the whole context.
     bool mDeltaEncoding;
 
+    // True if we should write only dirty objects, with all their values.
+    bool mDirtyOnly;
+
+    bool mParallelEncoding;
+
     const char* mIndent;
 
     size_t mElemsPerLine;
@@ -75,6 +105,18 @@ AsciiWriter::setDeltaEncoding(bool deltaEncoding)
     mDeltaEncoding = deltaEncoding;
 }
 
+void
+AsciiWriter::setDirtyOnly(bool dirtyOnly)
+{
+    mDirtyOnly = dirtyOnly;
+}
+
+void
+AsciiWriter::setParallelEncoding(bool parallelEncoding)
+{
+    mParallelEncoding = parallelEncoding;
+}
+
 void
 AsciiWriter::setIndent(const char* indent)
 {
@@ -110,7 +152,7 @@ AsciiWriter::clearMaxVectorSize()
 
 template <typename Container>
 void
-AsciiWriter::writeSet(std::ostream& out, const Container& members) const
+AsciiWriter::writeSet(std::string& out, const Container& members) const
 {
     // Sort the elements of the set by name.
     std::vector<const SceneObject*> order(members.begin(), members.end());
@@ -121,7 +163,9 @@ AsciiWriter::writeSet(std::ostream& out, const Container& members) const
     // Write out each member in the set, in order.
     for (auto iter = order.begin(); iter != order.end(); ++iter) {
         // TODO: don't use a full object reference?
-        out << mIndent << sceneObjectRef(*iter) << ",\n";
+        out += mIndent;
+        writeSceneObjectRef(out, *iter);
+        out += ",\n";
     }
 }
 
@@ -0,0 +1,154 @@
+// Copyright 2023-2024 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+
+#pragma once
+
+// Include this before any other includes!
+#include <scene_rdl2/common/platform/Platform.h>
+
+#include "AttributeKey.h"
+#include "SceneClass.h"
+#include "SceneObject.h"
+#include "Types.h"
+
+#include <scene_rdl2/render/util/AlignedAllocator.h>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+#include <stdint.h>
+
+namespace scene_rdl2 {
+namespace rdl2 {
+
+/**
+ * An AttributeColumn is a structure-of-arrays copy of one attribute across all
+ * SceneObjects of a SceneClass: row i holds the value of the attribute on the
+ * i-th object created from that class. The values sit in one contiguous,
+ * SIMD aligned array, so sweeping them (in C++ or from ISPC through data())
+ * streams through memory instead of chasing a pointer per object.
+ *
+ * The column is a cache. refresh() brings it up to date incrementally: it
+ * adds rows for objects created since the last refresh, and only recopies
+ * rows whose object changed. Changes are detected through the object's change
+ * count, which every set() that flags the attribute in the update mask also
+ * bumps. Unlike the update mask it is never cleared, so a column doesn't
+ * have to be refreshed in step with the update cycle.
+ *
+ *      AttributeColumn<Float> intensities(lightClass, intensityKey);
+ *      ...
+ *      intensities.refresh();  // cheap if little changed
+ *      sweep(intensities.data(), intensities.size());
+ *
+ * Bool columns hold one byte per value, since std::vector<bool> has no
+ * contiguous storage.
+ *
+ * Thread Safety:
+ *  - refresh() reads the SceneClass's objects, so it must not run at the same
+ *      time as objects of that class are created or updated. Reading a column
+ *      from many threads is fine.
+ *  - Only SceneObjects created through a SceneContext appear in a column.
+ */
+template <typename T>
+class AttributeColumn
+{
+public:
+    typedef typename std::conditional<std::is_same<T, Bool>::value, uint8_t, T>::type ValueType;
+
+    /**
+     * Creates an empty column for the given attribute. Call refresh() to
+     * fill it.
+     *
+     * @param   sceneClass  The SceneClass whose objects make up the rows.
+     * @param   key         The attribute to copy. It must belong to sceneClass.
+     * @param   timestep    Which timestep of blurrable attributes to copy.
+     */
+    AttributeColumn(const SceneClass& sceneClass, AttributeKey<T> key,
+                    AttributeTimestep timestep = TIMESTEP_BEGIN);
+
+    /**
+     * Brings the column up to date with the SceneClass's objects.
+     *
+     * @return  The number of rows that were added or recopied.
+     */
+    std::size_t refresh();
+
+    /// The number of rows.
+    std::size_t size() const { return mValues.size(); }
+
+    /// The contiguous, SIMD aligned values of all rows.
+    const ValueType* data() const { return mValues.data(); }
+
+    /// The value in the given row.
+    const ValueType& operator[](std::size_t row) const { return mValues[row]; }
+
+    /// The SceneObject the given row was copied from.
+    const SceneObject* getObject(std::size_t row) const { return mObjects[row]; }
+
+private:
+    // Rows are refreshed in parallel in chunks of this many.
+    static constexpr std::size_t GRAIN_SIZE = 1024;
+
+    const SceneClass& mSceneClass;
+    AttributeKey<T> mKey;
+    AttributeTimestep mTimestep;
+
+    std::vector<ValueType, alloc::AlignedAllocator<ValueType, SIMD_MEMORY_ALIGNMENT>> mValues;
+    std::vector<const SceneObject*> mObjects;
+
+    // The change count of each row's object when the row was last copied.
+    std::vector<uint64_t> mChangeCounts;
+};
+
+template <typename T>
+AttributeColumn<T>::AttributeColumn(const SceneClass& sceneClass, AttributeKey<T> key,
+                                    AttributeTimestep timestep) :
+    mSceneClass(sceneClass),
+    mKey(key),
+    mTimestep(timestep)
+{
+}
+
+template <typename T>
+std::size_t
+AttributeColumn<T>::refresh()
+{
+    // Append rows for new objects. Their change counts can't match, so the
+    // sweep below copies them.
+    const std::size_t oldSize = mObjects.size();
+    const std::size_t newSize = mSceneClass.mObjects.size();
+    if (newSize > oldSize) {
+        mObjects.reserve(newSize);
+        for (std::size_t i = oldSize; i < newSize; ++i) {
+            mObjects.push_back(mSceneClass.mObjects[i]);
+        }
+        mValues.resize(newSize);
+        mChangeCounts.resize(newSize, ~uint64_t(0));
+    }
+
+    std::atomic<std::size_t> copied(0);
+    tbb::parallel_for(tbb::blocked_range<std::size_t>(0, newSize, GRAIN_SIZE),
+                      [&](const tbb::blocked_range<std::size_t>& range) {
+        std::size_t count = 0;
+        for (std::size_t row = range.begin(); row < range.end(); ++row) {
+            const SceneObject* obj = mObjects[row];
+            if (mChangeCounts[row] != obj->mChangeCount) {
+                mValues[row] = obj->get(mKey, mTimestep);
+                mChangeCounts[row] = obj->mChangeCount;
+                ++count;
+            }
+        }
+        copied += count;
+    });
+
+    return copied;
+}
+
+} // namespace rdl2
+} // namespace scene_rdl2
+
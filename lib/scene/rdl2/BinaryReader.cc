@@ -10,6 +10,7 @@
 #include "Layer.h"
 #include "LightFilterSet.h"
 #include "LightSet.h"
+#include "LzBlockCodec.h"
 #include "Material.h"
 #include "SceneClass.h"
 #include "SceneContext.h"
@@ -25,11 +26,18 @@
 #include <scene_rdl2/common/except/exceptions.h>
 #include <scene_rdl2/render/util/Strings.h>
 
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
 #include <algorithm>
+#include <cstring>
 #include <fstream>
+#include <functional>
 #include <istream>
+#include <memory>
 #include <sstream>
 #include <string>
+#include <unordered_map>
 #include <stdint.h>
 
 #ifdef __APPLE__
@@ -39,6 +47,11 @@
 #include <endian.h>
 #endif
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 namespace scene_rdl2 {
 using logging::Logger;
 
@@ -46,7 +59,9 @@ namespace rdl2 {
 
 BinaryReader::BinaryReader(SceneContext& context) :
     mContext(context),
-    mWarningsAsErrors(false)
+    mWarningsAsErrors(false),
+    mParallelDecode(false),
+    mPrefetchSceneClasses(false)
 {
 }
 
@@ -68,6 +83,114 @@ BinaryReader::fromFile(const std::string& filename)
     fromStream(in);
 }
 
+namespace {
+
+typedef std::unique_ptr<void, std::function<void(void*)>> FileMapping;
+
+// Memory maps the whole file read-only, for reading RDL binary straight out
+// of the mapping. The mapping goes away with the returned pointer.
+FileMapping
+mapFile(const std::string& filename, std::size_t& fileSize)
+{
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::stringstream errMsg;
+        errMsg << "Could not open file '" << filename << "' for reading with"
+            " an RDL2 binary reader.";
+        throw except::IoError(errMsg.str());
+    }
+
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) != 0 || fileStat.st_size < static_cast<off_t>(2 * sizeof(uint64_t))) {
+        close(fd);
+        std::stringstream errMsg;
+        errMsg << "File '" << filename << "' is too small to be RDL2 binary.";
+        throw except::IoError(errMsg.str());
+    }
+    fileSize = static_cast<std::size_t>(fileStat.st_size);
+
+    void* addr = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // The mapping stays valid after the descriptor is closed.
+    if (addr == MAP_FAILED) {
+        std::stringstream errMsg;
+        errMsg << "Could not memory map file '" << filename << "' for reading with"
+            " an RDL2 binary reader.";
+        throw except::IoError(errMsg.str());
+    }
+    const std::size_t mappedSize = fileSize;
+    FileMapping mapping(addr, [mappedSize](void* ptr) { munmap(ptr, mappedSize); });
+    madvise(addr, fileSize, MADV_WILLNEED);
+    return mapping;
+}
+
+} // namespace
+
+void
+BinaryReader::fromMappedFile(const std::string& filename)
+{
+    std::size_t fileSize = 0;
+    FileMapping mapping = mapFile(filename, fileSize);
+
+    // Read the frame (or chunked stream of frames) straight out of the mapping.
+    Slice fileBytes(mapping.get(), fileSize);
+    std::size_t pos = 0;
+    if (readMappedLength(fileBytes, pos, filename) != CHUNKED_FRAME_MARKER) {
+        pos = 0;
+        readMappedFrame(fileBytes, pos, filename);
+        return;
+    }
+    while (readMappedFrame(fileBytes, pos, filename)) {}
+}
+
+uint64_t
+BinaryReader::readMappedLength(Slice fileBytes, std::size_t& pos, const std::string& filename)
+{
+    if (fileBytes.getLength() - pos < sizeof(uint64_t)) {
+        std::stringstream errMsg;
+        errMsg << "File '" << filename << "' is truncated: expected a frame length.";
+        throw except::IoError(errMsg.str());
+    }
+    uint64_t len;
+    std::memcpy(&len, static_cast<const char*>(fileBytes.getData()) + pos, sizeof(uint64_t));
+    pos += sizeof(uint64_t);
+    return be64toh(len);
+}
+
+bool
+BinaryReader::findMappedFrame(Slice fileBytes, std::size_t& pos, const std::string& filename,
+                              uint64_t& manifestLen, uint64_t& payloadLen)
+{
+    manifestLen = readMappedLength(fileBytes, pos, filename);
+    payloadLen = readMappedLength(fileBytes, pos, filename);
+    if (manifestLen == 0 && payloadLen == 0) {
+        return false;
+    }
+
+    const std::size_t remaining = fileBytes.getLength() - pos;
+    if (manifestLen > remaining || payloadLen > remaining - manifestLen) {
+        std::stringstream errMsg;
+        errMsg << "File '" << filename << "' is truncated: manifest and payload"
+            " lengths exceed the file size.";
+        throw except::IoError(errMsg.str());
+    }
+    return true;
+}
+
+bool
+BinaryReader::readMappedFrame(Slice fileBytes, std::size_t& pos, const std::string& filename)
+{
+    uint64_t manifestLen, payloadLen;
+    if (!findMappedFrame(fileBytes, pos, filename, manifestLen, payloadLen)) {
+        return false;
+    }
+
+    Slice manifestBytes(fileBytes, pos, manifestLen);
+    Slice payloadBytes(fileBytes, pos + manifestLen, payloadLen);
+    pos += manifestLen + payloadLen;
+    fromSlices(manifestBytes, payloadBytes);
+    return true;
+}
+
 void
 BinaryReader::fromStream(std::istream& input)
 {
@@ -76,11 +199,35 @@ BinaryReader::fromStream(std::istream& input)
     input.read(reinterpret_cast<char*>(&manifestLen), sizeof(uint64_t));
     manifestLen = be64toh(manifestLen);
 
+    if (manifestLen != CHUNKED_FRAME_MARKER) {
+        readFrame(input, manifestLen);
+        return;
+    }
+
+    // Chunked stream: decode and apply each frame as soon as it has been
+    // read, until the terminating empty frame.
+    while (true) {
+        input.read(reinterpret_cast<char*>(&manifestLen), sizeof(uint64_t));
+        if (!input) {
+            throw except::IoError("Chunked RDL2 binary stream ended before its terminating frame.");
+        }
+        manifestLen = be64toh(manifestLen);
+        if (!readFrame(input, manifestLen)) break;
+    }
+}
+
+bool
+BinaryReader::readFrame(std::istream& input, uint64_t manifestLen)
+{
     // Read the payload length from the stream and convert to native byte order.
     uint64_t payloadLen;
     input.read(reinterpret_cast<char*>(&payloadLen), sizeof(uint64_t));
     payloadLen = be64toh(payloadLen);
 
+    if (manifestLen == 0 && payloadLen == 0) {
+        return false;
+    }
+
     // Read the manifest.
     std::string manifest(manifestLen, '\0');
     input.read(&(manifest[0]), manifestLen);
@@ -90,22 +237,128 @@ BinaryReader::fromStream(std::istream& input)
     input.read(&(payload[0]), payloadLen);
 
     fromBytes(manifest, payload);
+    return true;
 }
 
 void
 BinaryReader::fromBytes(const std::string& manifest, const std::string& payload)
 {
-    Slice manifestBytes(manifest);
-    Slice payloadBytes(payload);
+    fromSlices(Slice(manifest), Slice(payload));
+}
+
+// static function
+void
+BinaryReader::stageFile(const std::string& filename, Staged& staged)
+{
+    // Expand each frame the way fromMappedFile() reads them. Records which
+    // weren't compressed are left in the mapping, which the staged file
+    // keeps until it is destroyed.
+    std::size_t fileSize = 0;
+    staged.mFileMapping = mapFile(filename, fileSize);
+    const Slice fileBytes(staged.mFileMapping.get(), fileSize);
+    std::size_t pos = 0;
+    const bool chunked = readMappedLength(fileBytes, pos, filename) == CHUNKED_FRAME_MARKER;
+    if (!chunked) {
+        pos = 0;
+    }
+    uint64_t manifestLen, payloadLen;
+    while (findMappedFrame(fileBytes, pos, filename, manifestLen, payloadLen)) {
+        RecordInfoVector records;
+        readManifest(Slice(fileBytes, pos, manifestLen), records);
+
+        staged.mFrames.emplace_back();
+        Staged::Frame& frame = staged.mFrames.back();
+        expandRecords(records, Slice(fileBytes, pos + manifestLen, payloadLen),
+                      frame.mBlockBytes, frame.mObjectRecords);
+        collectClassNames(frame.mObjectRecords, staged.mClassNames);
+        pos += manifestLen + payloadLen;
+
+        if (!chunked) break;
+    }
+}
+
+void
+BinaryReader::fromStaged(const Staged& staged)
+{
+    for (const Staged::Frame& frame : staged.mFrames) {
+        readObjectRecords(frame.mObjectRecords);
+    }
+}
 
+void
+BinaryReader::fromSlices(Slice manifestBytes, Slice payloadBytes)
+{
     // Read the manifest.
     RecordInfoVector records;
     readManifest(manifestBytes, records);
 
-    // Loop over records in the manifest and read each out of the payload.
-    // (This could be parallelized fairly easily if it's a bottleneck.)
-    for (RecordInfoVector::const_iterator iter = records.begin(); iter != records.end(); ++iter) {
-        switch (iter->mType) {
+    std::vector<std::string> blockBytes;
+    std::vector<Slice> objectRecords;
+    expandRecords(records, payloadBytes, blockBytes, objectRecords);
+    readObjectRecords(objectRecords);
+}
+
+// static function
+void
+BinaryReader::collectClassNames(const std::vector<Slice>& objectRecords,
+                                std::vector<std::string>& classNames)
+{
+    // Every record starts with its class name.
+    std::string className;
+    for (const Slice& bytes : objectRecords) {
+        ValueContainerDeq vContainerDeq(static_cast<const char *>(bytes.getData()), bytes.getLength());
+        vContainerDeq.deqString(className);
+        if (classNames.empty() || classNames.back() != className) {
+            classNames.push_back(className);
+        }
+    }
+}
+
+void
+BinaryReader::readObjectRecords(const std::vector<Slice>& objectRecords)
+{
+    if (!mPrefetchSceneClasses) {
+        readSceneObjects(objectRecords);
+        return;
+    }
+
+    // Get the DSOs of the record classes loading while we read the records.
+    // Nothing may be left loading once we return, the caller is free to
+    // change the DSO settings of the context.
+    std::vector<std::string> classNames;
+    collectClassNames(objectRecords, classNames);
+    mContext.prefetchSceneClasses(classNames);
+    try {
+        readSceneObjects(objectRecords);
+    } catch (...) {
+        mContext.waitForSceneClassPrefetch();
+        throw;
+    }
+    mContext.waitForSceneClassPrefetch();
+}
+
+void
+BinaryReader::readSceneObjects(const std::vector<Slice>& objectRecords)
+{
+    if (mParallelDecode) {
+        readSceneObjectsParallel(objectRecords);
+        return;
+    }
+
+    // Loop over the SceneObject records and read each one.
+    for (const Slice& bytes : objectRecords) {
+        readSceneObject(bytes);
+    }
+}
+
+// static function
+void
+BinaryReader::expandRecords(const RecordInfoVector& records, Slice payloadBytes,
+                            std::vector<std::string>& blockBytes, std::vector<Slice>& objectRecords)
+{
+    std::vector<Slice> blocks;
+    for (const RecordInfo& record : records) {
+        switch (record.mType) {
         case SCENE_OBJECT :
             {
                 std::stringstream errMsg;
@@ -115,19 +368,75 @@ BinaryReader::fromBytes(const std::string& manifest, const std::string& payload)
             break;
 
         case SCENE_OBJECT_2 :
-            readSceneObject(Slice(payloadBytes, iter->mOffset, iter->mSize));
+            break;
+
+        case SCENE_OBJECT_2_LZ_BLOCK :
+            if (record.mSize < sizeof(uint64_t)) {
+                throw except::IoError("Truncated compressed block in RDL2 binary payload.");
+            }
+            blocks.emplace_back(payloadBytes, record.mOffset, record.mSize);
+            {
+                // The size header comes straight from the file, so bound it
+                // before it's used for an allocation.
+                uint64_t rawSize;
+                std::memcpy(&rawSize, blocks.back().getData(), sizeof(uint64_t));
+                if (rawSize > LzBlockCodec::maxDecompressedSize(record.mSize - sizeof(uint64_t))) {
+                    std::stringstream errMsg;
+                    errMsg << "Compressed block in RDL2 binary payload claims " << rawSize <<
+                        " uncompressed bytes from " << record.mSize << " bytes of data.";
+                    throw except::RuntimeError(errMsg.str());
+                }
+            }
             break;
 
         default:
             {
                 std::stringstream errMsg;
-                errMsg << "Encountered unknown payload type '" << iter->mType <<
+                errMsg << "Encountered unknown payload type '" << record.mType <<
                     "' in manifest while parsing RDL2 binary file.";
                 throw except::TypeError(errMsg.str());
             }
             break;
         }
     }
+
+    // Decompress the blocks concurrently.
+    blockBytes.resize(blocks.size());
+    tbb::parallel_for(std::size_t(0), blocks.size(), [&](std::size_t blockId) {
+        const char* data = static_cast<const char*>(blocks[blockId].getData());
+        uint64_t rawSize;
+        std::memcpy(&rawSize, data, sizeof(uint64_t));
+        std::string& bytes = blockBytes[blockId];
+        bytes.resize(rawSize);
+        LzBlockCodec::decompress(data + sizeof(uint64_t), blocks[blockId].getLength() - sizeof(uint64_t),
+                                 &bytes[0], rawSize);
+    });
+
+    // Gather the SceneObject records in manifest order, splitting each
+    // block at the size header leading every record.
+    objectRecords.reserve(records.size());
+    std::size_t blockId = 0;
+    for (const RecordInfo& record : records) {
+        if (record.mType == SCENE_OBJECT_2) {
+            objectRecords.emplace_back(payloadBytes, record.mOffset, record.mSize);
+            continue;
+        }
+
+        const Slice block(blockBytes[blockId++]);
+        std::size_t pos = 0;
+        while (pos < block.getLength()) {
+            std::size_t size;
+            if (block.getLength() - pos < sizeof(size_t)) {
+                throw except::IoError("Corrupt record in compressed RDL2 binary block.");
+            }
+            std::memcpy(&size, static_cast<const char*>(block.getData()) + pos, sizeof(size_t));
+            if (size < sizeof(size_t) || size > block.getLength() - pos) {
+                throw except::IoError("Corrupt record in compressed RDL2 binary block.");
+            }
+            objectRecords.emplace_back(block, pos, size);
+            pos += size;
+        }
+    }
 }
 
 // static function    
@@ -159,6 +468,7 @@ BinaryReader::showManifest(const std::string& manifest)
     return ostr.str();
 }
 
+// static function
 void
 BinaryReader::readManifest(Slice bytes, RecordInfoVector& info)
 {
@@ -184,6 +494,75 @@ BinaryReader::readSceneObject(Slice bytes)
     const char *ptr = static_cast<const char *>(bytes.getData());
     ValueContainerDeq vContainerDeq(ptr, bytes.getLength());
 
+    SceneObject* sceneObject = createRecordSceneObject(vContainerDeq);
+    if (!sceneObject) return;
+
+    // Unpack the data into the object.
+    unpackSceneObject(vContainerDeq, *sceneObject);
+}
+
+void
+BinaryReader::readSceneObjectsParallel(const std::vector<Slice>& records)
+{
+    struct ObjectRecord
+    {
+        ObjectRecord(SceneObject* sceneObject, const ValueContainerDeq& vContainerDeq) :
+            mSceneObject(sceneObject), mVContainerDeq(vContainerDeq) {}
+
+        SceneObject* mSceneObject;
+        ValueContainerDeq mVContainerDeq; // positioned just after the class and object names
+    };
+
+    // Create every SceneObject up front. Object creation is threadsafe, but
+    // doing it here serially keeps the creation order of the recorded objects
+    // (which matters for things like the primary camera) deterministic.
+    std::vector<ObjectRecord> objectRecords;
+    objectRecords.reserve(records.size());
+    std::unordered_map<const SceneObject*, std::size_t> recordCount;
+    recordCount.reserve(records.size());
+    for (const Slice& bytes : records) {
+        ValueContainerDeq vContainerDeq(static_cast<const char *>(bytes.getData()), bytes.getLength());
+        SceneObject* sceneObject = createRecordSceneObject(vContainerDeq);
+        if (!sceneObject) continue;
+
+        objectRecords.emplace_back(sceneObject, vContainerDeq);
+        ++recordCount[sceneObject];
+    }
+
+    // Split the records into those we can decode concurrently and those which
+    // update the same SceneObject more than once. The latter keep their
+    // manifest order.
+    std::vector<ObjectRecord*> parallelRecords;
+    std::vector<ObjectRecord*> serialRecords;
+    parallelRecords.reserve(objectRecords.size());
+    for (ObjectRecord& objectRecord : objectRecords) {
+        if (recordCount[objectRecord.mSceneObject] > 1) {
+            serialRecords.push_back(&objectRecord);
+        } else {
+            parallelRecords.push_back(&objectRecord);
+        }
+    }
+    if (!serialRecords.empty()) {
+        Logger::info("BinaryReader: ", serialRecords.size(),
+                     " records target duplicated SceneObjects, decoding them serially.");
+    }
+
+    tbb::parallel_for(tbb::blocked_range<std::size_t>(0, parallelRecords.size()),
+                      [&](const tbb::blocked_range<std::size_t>& range) {
+        for (std::size_t i = range.begin(); i != range.end(); ++i) {
+            ObjectRecord* objectRecord = parallelRecords[i];
+            unpackSceneObject(objectRecord->mVContainerDeq, *(objectRecord->mSceneObject));
+        }
+    });
+
+    for (ObjectRecord* objectRecord : serialRecords) {
+        unpackSceneObject(objectRecord->mVContainerDeq, *(objectRecord->mSceneObject));
+    }
+}
+
+SceneObject*
+BinaryReader::createRecordSceneObject(ValueContainerDeq &vContainerDeq)
+{
     std::string klassName;
     std::string objName;
     vContainerDeq.deqString(klassName);
@@ -201,11 +580,9 @@ BinaryReader::readSceneObject(Slice bytes)
         } else {
             logging::Logger::warn(msg);
         }
-        return;
+        return nullptr;
     }
-
-    // Unpack the data into the object.
-    unpackSceneObject(vContainerDeq, *sceneObject);
+    return sceneObject;
 }
 
 void
@@ -408,7 +785,7 @@ BinaryReader::unpackSceneObject(ValueContainerDeq &vContainerDeq, SceneObject& s
                 sceneObject.mBindings[index] = targetObject;
                 sceneObject.mBindingSetMask.set(index, true);
                 sceneObject.mBindingUpdateMask.set(index, true);
-                sceneObject.mDirty = true;
+                sceneObject.markDirty();
             }
 
         } catch (except::KeyError& e) {
@@ -533,19 +910,23 @@ BinaryReader::unpackValue(ValueContainerDeq &vContainerDeq,
     } break;
     case ValueContainerUtil::ValueType::INT_VECTOR : {
         IntVector vec; vContainerDeq.deqVLIntVector(vec); // We are using VariableLength version
-        sceneObject.set(keyGen<IntVector>(transientEncoding, attributeId, attributeName, sceneClass), vec, timestep);
+        sceneObject.set(keyGen<IntVector>(transientEncoding, attributeId, attributeName, sceneClass),
+                        std::move(vec), timestep);
     } break;
     case ValueContainerUtil::ValueType::LONG_VECTOR : {
         LongVector vec; vContainerDeq.deqVLLongVector(vec); // We are using VariableLength version
-        sceneObject.set(keyGen<LongVector>(transientEncoding, attributeId, attributeName, sceneClass), vec, timestep);
+        sceneObject.set(keyGen<LongVector>(transientEncoding, attributeId, attributeName, sceneClass),
+                        std::move(vec), timestep);
     } break;
     case ValueContainerUtil::ValueType::FLOAT_VECTOR : {
         FloatVector vec; vContainerDeq.deqFloatVector(vec);
-        sceneObject.set(keyGen<FloatVector>(transientEncoding, attributeId, attributeName, sceneClass), vec, timestep);
+        sceneObject.set(keyGen<FloatVector>(transientEncoding, attributeId, attributeName, sceneClass),
+                        std::move(vec), timestep);
     } break;
     case ValueContainerUtil::ValueType::DOUBLE_VECTOR : {
         DoubleVector vec; vContainerDeq.deqDoubleVector(vec);
-        sceneObject.set(keyGen<DoubleVector>(transientEncoding, attributeId, attributeName, sceneClass), vec, timestep);
+        sceneObject.set(keyGen<DoubleVector>(transientEncoding, attributeId, attributeName, sceneClass),
+                        std::move(vec), timestep);
     } break;
     case ValueContainerUtil::ValueType::STRING_VECTOR : {
         StringVector vec; vContainerDeq.deqStringVector(vec);
@@ -553,43 +934,53 @@ BinaryReader::unpackValue(ValueContainerDeq &vContainerDeq,
     } break;
     case ValueContainerUtil::ValueType::RGB_VECTOR : {
         RgbVector vec; vContainerDeq.deqRgbVector(vec);
-        sceneObject.set(keyGen<RgbVector>(transientEncoding, attributeId, attributeName, sceneClass), vec, timestep);
+        sceneObject.set(keyGen<RgbVector>(transientEncoding, attributeId, attributeName, sceneClass),
+                        std::move(vec), timestep);
     } break;
     case ValueContainerUtil::ValueType::RGBA_VECTOR : {
         RgbaVector vec; vContainerDeq.deqRgbaVector(vec);
-        sceneObject.set(keyGen<RgbaVector>(transientEncoding, attributeId, attributeName, sceneClass), vec, timestep);
+        sceneObject.set(keyGen<RgbaVector>(transientEncoding, attributeId, attributeName, sceneClass),
+                        std::move(vec), timestep);
     } break;
     case ValueContainerUtil::ValueType::VEC2F_VECTOR : {
         Vec2fVector vec; vContainerDeq.deqVec2fVector(vec);
-        sceneObject.set(keyGen<Vec2fVector>(transientEncoding, attributeId, attributeName, sceneClass), vec, timestep);
+        sceneObject.set(keyGen<Vec2fVector>(transientEncoding, attributeId, attributeName, sceneClass),
+                        std::move(vec), timestep);
     } break;
     case ValueContainerUtil::ValueType::VEC2D_VECTOR : {
         Vec2dVector vec; vContainerDeq.deqVec2dVector(vec);
-        sceneObject.set(keyGen<Vec2dVector>(transientEncoding, attributeId, attributeName, sceneClass), vec, timestep);
+        sceneObject.set(keyGen<Vec2dVector>(transientEncoding, attributeId, attributeName, sceneClass),
+                        std::move(vec), timestep);
     } break;
     case ValueContainerUtil::ValueType::VEC3F_VECTOR : {
         Vec3fVector vec; vContainerDeq.deqVec3fVector(vec);
-        sceneObject.set(keyGen<Vec3fVector>(transientEncoding, attributeId, attributeName, sceneClass), vec, timestep);
+        sceneObject.set(keyGen<Vec3fVector>(transientEncoding, attributeId, attributeName, sceneClass),
+                        std::move(vec), timestep);
     } break;
     case ValueContainerUtil::ValueType::VEC3D_VECTOR : {
         Vec3dVector vec; vContainerDeq.deqVec3dVector(vec);
-        sceneObject.set(keyGen<Vec3dVector>(transientEncoding, attributeId, attributeName, sceneClass), vec, timestep);
+        sceneObject.set(keyGen<Vec3dVector>(transientEncoding, attributeId, attributeName, sceneClass),
+                        std::move(vec), timestep);
     } break;
     case ValueContainerUtil::ValueType::VEC4F_VECTOR : {
         Vec4fVector vec; vContainerDeq.deqVec4fVector(vec);
-        sceneObject.set(keyGen<Vec4fVector>(transientEncoding, attributeId, attributeName, sceneClass), vec, timestep);
+        sceneObject.set(keyGen<Vec4fVector>(transientEncoding, attributeId, attributeName, sceneClass),
+                        std::move(vec), timestep);
     } break;
     case ValueContainerUtil::ValueType::VEC4D_VECTOR : {
         Vec4dVector vec; vContainerDeq.deqVec4dVector(vec);
-        sceneObject.set(keyGen<Vec4dVector>(transientEncoding, attributeId, attributeName, sceneClass), vec, timestep);
+        sceneObject.set(keyGen<Vec4dVector>(transientEncoding, attributeId, attributeName, sceneClass),
+                        std::move(vec), timestep);
     } break;
     case ValueContainerUtil::ValueType::MAT4F_VECTOR : {
         Mat4fVector vec; vContainerDeq.deqMat4fVector(vec);
-        sceneObject.set(keyGen<Mat4fVector>(transientEncoding, attributeId, attributeName, sceneClass), vec, timestep);
+        sceneObject.set(keyGen<Mat4fVector>(transientEncoding, attributeId, attributeName, sceneClass),
+                        std::move(vec), timestep);
     } break;
     case ValueContainerUtil::ValueType::MAT4D_VECTOR : {
         Mat4dVector vec; vContainerDeq.deqMat4dVector(vec);
-        sceneObject.set(keyGen<Mat4dVector>(transientEncoding, attributeId, attributeName, sceneClass), vec, timestep);
+        sceneObject.set(keyGen<Mat4dVector>(transientEncoding, attributeId, attributeName, sceneClass),
+                        std::move(vec), timestep);
     } break;
 
     case ValueContainerUtil::ValueType::SCENE_OBJECT_VECTOR : {
@@ -11,6 +11,8 @@
 #include "SceneClass.h"
 
 #include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <istream>
 #include <string>
 #include <vector>
@@ -75,6 +77,12 @@ public:
  * NOTE: Both mlen and plen are 64-bit unsigned integers, in network byte
  *       order (big endian).
  *
+ * A stream may also be chunked (see BinaryWriter::setChunkedFraming()): an
+ * 8 byte CHUNKED_FRAME_MARKER in place of mlen, followed by any number of
+ * frames as above and a terminating frame with mlen and plen both 0.
+ * fromStream(), fromFile() and fromMappedFile() detect this automatically and
+ * decode each chunk as soon as it has been read.
+ *
  * This encoding allows us to easily read the manifest and payload into
  * separate buffers. The manifest must be decoded serially, but once decoded,
  * we have offsets into each message in the payload, so we can decode it in
@@ -83,11 +91,12 @@ public:
  * Thread Safety:
  *  - The SceneContext guarantees that operations that the BinaryReader takes
  *      (such as creating new SceneObjects) happens in a threadsafe way.
- *  - Manipulating the same SceneObject in multiple threads is not safe. As
- *      such, a binary RDL file with multiple copies of the same SceneObject
- *      may cause thread unsafety in the BinaryReader if those updates are
- *      decoded in parallel. The BinaryWriter will never produce such files,
- *      but it's something to keep in mind.
+ *  - Manipulating the same SceneObject in multiple threads is not safe. When
+ *      parallel decode is enabled, records which target a SceneObject that
+ *      appears more than once in the manifest are detected up front and
+ *      decoded serially in manifest order after the parallel pass, so the
+ *      result matches a serial decode. The BinaryWriter will never produce
+ *      such files, but merged or hand-built streams may.
  *  - Since the BinaryReader writes into SceneContext data (in particular,
  *      SceneObjects), it is not safe to be mucking about with that data in
  *      another thread while the BinaryReader is working.
@@ -99,9 +108,13 @@ public:
     {
         UNKNOWN = 0,
         SCENE_OBJECT = 1,
-        SCENE_OBJECT_2 = 2
+        SCENE_OBJECT_2 = 2,
+        SCENE_OBJECT_2_LZ_BLOCK = 3
     };
 
+    // Found in place of mlen at the start of a chunked stream.
+    static constexpr uint64_t CHUNKED_FRAME_MARKER = ~uint64_t(0);
+
     /**
      * Constructs a BinaryReader that will decode RDL binary into the given
      * SceneContext.
@@ -123,10 +136,23 @@ public:
      */
     void fromFile(const std::string& filename);
 
+    /**
+     * Memory maps the file with the given filename and decodes its contents
+     * as a stream of RDL binary. Unlike fromFile(), the manifest and payload
+     * are decoded directly from the mapping, so no intermediate copies of
+     * them are built and the peak memory footprint stays close to the size
+     * of the decoded scene data.
+     *
+     * @param   filename    The path to the RDL binary file on the filesystem.
+     */
+    void fromMappedFile(const std::string& filename);
+
     /**
      * Reads framed RDL binary from the given input stream. After reading both
      * mlen and plen, this will only read the manifest and payload from the
-     * stream and leave anything else in it untouched.
+     * stream and leave anything else in it untouched. For a chunked stream,
+     * every chunk up to and including the terminating frame is read, and each
+     * chunk is applied to the context as soon as it arrives.
      *
      * @param   input   The generic input stream to read framed RDL binary from.
      */
@@ -143,6 +169,57 @@ public:
      */
     void fromBytes(const std::string& manifest, const std::string& payload);
 
+    /**
+     * RDL binary which has been read from a file and expanded, but not yet
+     * applied to a SceneContext: the manifests are decoded, compressed blocks
+     * are decompressed and the SceneObject records are located. Staging
+     * doesn't touch any SceneContext, so several files can be staged
+     * concurrently and then applied in order with fromStaged().
+     */
+    class Staged
+    {
+    public:
+        Staged() = default;
+        Staged(const Staged&) = delete;
+        Staged& operator=(const Staged&) = delete;
+
+        /// The SceneClass names of the staged records, in record order with
+        /// repeats of the same name collapsed.
+        finline const std::vector<std::string>& getClassNames() const;
+
+    private:
+        friend class BinaryReader;
+
+        struct Frame
+        {
+            std::vector<std::string> mBlockBytes;   // decompressed blocks
+            std::vector<Slice> mObjectRecords;      // into mFileMapping or mBlockBytes
+        };
+
+        std::unique_ptr<void, std::function<void(void*)>> mFileMapping;
+        std::vector<Frame> mFrames;
+        std::vector<std::string> mClassNames;
+    };
+
+    /**
+     * Memory maps an RDL binary file and expands it, without applying it to
+     * a SceneContext. Like fromMappedFile(), only the compressed blocks are
+     * copied out of the mapping. This is safe to call concurrently.
+     *
+     * @param   filename    The path to the RDL binary file on the filesystem.
+     * @param   staged      Receives the expanded file. It must be empty.
+     * @throw   except::IoError     If the file can't be read or is corrupt.
+     */
+    static void stageFile(const std::string& filename, Staged& staged);
+
+    /**
+     * Applies a file staged with stageFile() to the SceneContext, with the
+     * same results as calling fromFile() on that file.
+     *
+     * @param   staged  The staged file.
+     */
+    void fromStaged(const Staged& staged);
+
     /**
      * When enabled, questionable actions which may be mistakes (such as trying
      * to set an attribute which doesn't exist) will cause an error rather than
@@ -153,6 +230,31 @@ public:
      */
     finline void setWarningsAsErrors(bool warningsAsErrors);
 
+    /**
+     * When enabled, fromBytes() creates every SceneObject named in the payload
+     * first and then unpacks the SCENE_OBJECT_2 records concurrently using
+     * TBB. Records targeting the same SceneObject more than once are decoded
+     * serially in manifest order. Disabled by default.
+     *
+     * Compressed payload blocks are always decompressed concurrently, whether
+     * this is enabled or not.
+     *
+     * @param   parallelDecode  Decode payload records in parallel.
+     */
+    finline void setParallelDecode(bool parallelDecode);
+
+    /**
+     * When enabled, fromBytes() collects the SceneClass names of all the
+     * records before reading them and has the SceneContext open the DSOs of
+     * those classes in the background (see
+     * SceneContext::prefetchSceneClasses()), so they load while the records
+     * are read. Every read waits for the prefetch before it returns or
+     * throws. Disabled by default.
+     *
+     * @param   prefetch    Prefetch the SceneClasses named in the payload.
+     */
+    finline void setPrefetchSceneClasses(bool prefetch);
+
     // for debug 
     static std::string showManifest(const std::string& manifest);
 
@@ -170,12 +272,62 @@ private:
     };
     typedef std::vector<RecordInfo> RecordInfoVector;
 
+    // Reads the rest of one frame whose mlen has already been read, and
+    // decodes it. Returns false for the empty frame terminating a chunked
+    // stream.
+    bool readFrame(std::istream& input, uint64_t manifestLen);
+
+    // Memory mapped equivalents of reading a frame length and a frame,
+    // advancing pos through the mapped file bytes.
+    static uint64_t readMappedLength(Slice fileBytes, std::size_t& pos, const std::string& filename);
+    bool readMappedFrame(Slice fileBytes, std::size_t& pos, const std::string& filename);
+
+    // Reads the lengths of the next frame of the file bytes, leaving pos at
+    // the start of its manifest. Returns false for the empty frame
+    // terminating a chunked stream.
+    static bool findMappedFrame(Slice fileBytes, std::size_t& pos, const std::string& filename,
+                                uint64_t& manifestLen, uint64_t& payloadLen);
+
+    // Decodes the manifest and payload from the given byte ranges. Both
+    // fromBytes() and fromMappedFile() end up here.
+    void fromSlices(Slice manifestBytes, Slice payloadBytes);
+
     // Helper function to decode the manifest and compute message offsets.
-    void readManifest(Slice bytes, RecordInfoVector& info);
+    static void readManifest(Slice bytes, RecordInfoVector& info);
 
     // Helper function for reading SceneObject messages out of the payload.
     void readSceneObject(Slice bytes);
 
+    // Helper function for validating the record types and locating every
+    // SceneObject record in manifest order. Compressed blocks are
+    // decompressed concurrently into blockBytes, which must outlive the
+    // returned slices.
+    static void expandRecords(const RecordInfoVector& records, Slice payloadBytes,
+                              std::vector<std::string>& blockBytes, std::vector<Slice>& objectRecords);
+
+    // Appends the class name of each record to classNames, skipping repeats
+    // of the previous name.
+    static void collectClassNames(const std::vector<Slice>& objectRecords,
+                                  std::vector<std::string>& classNames);
+
+    // Reads the located SceneObject records into the context, prefetching
+    // their SceneClasses if enabled.
+    void readObjectRecords(const std::vector<Slice>& objectRecords);
+
+    // Reads the located SceneObject records into the context, serially or in
+    // parallel.
+    void readSceneObjects(const std::vector<Slice>& objectRecords);
+
+    // Helper function for reading the payload records in parallel. All the
+    // SceneObjects are created serially first, then the records are unpacked
+    // concurrently. Duplicated SceneObjects fall back to the serial decode.
+    void readSceneObjectsParallel(const std::vector<Slice>& records);
+
+    // Helper function for dequeueing the class and object name of a SceneObject
+    // message and creating the SceneObject. Returns nullptr if the DSO could
+    // not be loaded and warnings are not treated as errors.
+    SceneObject* createRecordSceneObject(ValueContainerDeq &vContainerDeq);
+
     // Helper function for unpacking a Layer object one assignment
     // at a time
     void unpackLayer(BinaryReaderLayerUnpackStrings &layerStrVectors, Layer &layer) const;
@@ -202,14 +354,36 @@ private:
     SceneContext& mContext;
 
     bool mWarningsAsErrors;
+
+    bool mParallelDecode;
+
+    bool mPrefetchSceneClasses;
 };
 
+const std::vector<std::string>&
+BinaryReader::Staged::getClassNames() const
+{
+    return mClassNames;
+}
+
 void
 BinaryReader::setWarningsAsErrors(bool warningsAsErrors)
 {
     mWarningsAsErrors = warningsAsErrors;
 }
 
+void
+BinaryReader::setParallelDecode(bool parallelDecode)
+{
+    mParallelDecode = parallelDecode;
+}
+
+void
+BinaryReader::setPrefetchSceneClasses(bool prefetch)
+{
+    mPrefetchSceneClasses = prefetch;
+}
+
 } // namespace rdl2
 } // namespace scene_rdl2
 
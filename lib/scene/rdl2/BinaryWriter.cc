@@ -5,6 +5,7 @@
 #include "BinaryWriter.h"
 
 #include "Attribute.h"
+#include "LzBlockCodec.h"
 #include "SceneClass.h"
 #include "SceneContext.h"
 #include "SceneObject.h"
@@ -14,6 +15,10 @@
 
 #include <scene_rdl2/common/except/exceptions.h>
 
+#include <tbb/parallel_for.h>
+#include <tbb/task_arena.h>
+
+#include <algorithm>
 #include <cstddef>
 #include <fstream>
 #include <ostream>
@@ -53,7 +58,11 @@ BinaryWriter::BinaryWriter(const SceneContext& context) :
     mDeltaEncoding(false),
     mSkipDefaults(false),
     mLargeVectorsOnly(false),
-    mMinVectorSize(0)
+    mMinVectorSize(0),
+    mParallelEncoding(false),
+    mRecordsPerChunk(0),
+    mCompression(Compression::NONE),
+    mCompressionBlockSize(DEFAULT_COMPRESSION_BLOCK_SIZE)
 {
 }
 
@@ -74,9 +83,42 @@ BinaryWriter::toFile(const std::string& filename) const
 void
 BinaryWriter::toStream(std::ostream& output) const
 {
-    std::string manifest, payload;
-    toBytes(manifest, payload);
+    if (mRecordsPerChunk == 0) {
+        std::string manifest, payload;
+        toBytes(manifest, payload);
+        writeFrame(output, manifest, payload);
+        return;
+    }
+
+    // Write the chunked stream marker (in network byte order) in place of mlen.
+    uint64_t marker = htobe64(CHUNKED_FRAME_MARKER);
+    output.write(reinterpret_cast<char*>(&marker), sizeof(uint64_t));
+
+    // Encode and send one chunk at a time so the receiver can start decoding
+    // while the rest of the scene is still being encoded.
+    std::vector<const SceneObject*> sceneObjects;
+    collectSceneObjects(sceneObjects);
+    std::vector<const SceneObject*> chunkObjects;
+    for (std::size_t begin = 0; begin < sceneObjects.size(); begin += mRecordsPerChunk) {
+        const std::size_t end = std::min(begin + mRecordsPerChunk, sceneObjects.size());
+        chunkObjects.assign(sceneObjects.begin() + begin, sceneObjects.begin() + end);
+
+        std::string manifest, payload;
+        toBytes(chunkObjects, manifest, payload);
+        writeFrame(output, manifest, payload);
+        output.flush();
+    }
+
+    // An empty frame terminates the chunked stream.
+    uint64_t zero = 0;
+    output.write(reinterpret_cast<char*>(&zero), sizeof(uint64_t));
+    output.write(reinterpret_cast<char*>(&zero), sizeof(uint64_t));
+    output.flush();
+}
 
+void
+BinaryWriter::writeFrame(std::ostream& output, const std::string& manifest, const std::string& payload)
+{
     // Write the manifest length (in network byte order) to the stream.
     uint64_t manifestLen = htobe64(manifest.size());
     output.write(reinterpret_cast<char*>(&manifestLen), sizeof(uint64_t));
@@ -86,29 +128,62 @@ BinaryWriter::toStream(std::ostream& output) const
     output.write(reinterpret_cast<char*>(&payloadLen), sizeof(uint64_t));
 
     // Write the manifest.
-    output.write(&(manifest[0]), manifest.size());
+    output.write(manifest.data(), manifest.size());
 
     // Write the payload.
-    output.write(&(payload[0]), payload.size());
+    output.write(payload.data(), payload.size());
 }
 
 void
 BinaryWriter::toBytes(std::string& manifest, std::string& payload) const
+{
+    std::vector<const SceneObject*> sceneObjects;
+    collectSceneObjects(sceneObjects);
+    toBytes(sceneObjects, manifest, payload);
+}
+
+void
+BinaryWriter::collectSceneObjects(std::vector<const SceneObject*>& sceneObjects) const
+{
+    // If delta encoding, only visit the objects dirtied since the last
+    // commitAllChanges() instead of the whole context.
+    if (mDeltaEncoding) {
+        const SceneContext::DirtyObjectJournal& journal = mContext.getDirtyObjectJournal();
+        sceneObjects.reserve(journal.size());
+        for (const SceneObject* sceneObject : journal) {
+            // Skip objects committed individually since they were journaled.
+            if (sceneObject->mDirty) {
+                sceneObjects.push_back(sceneObject);
+            }
+        }
+    } else {
+        for (SceneContext::SceneObjectConstIterator iter = mContext.beginSceneObject();
+                iter != mContext.endSceneObject(); ++iter) {
+            sceneObjects.push_back(iter->second);
+        }
+    }
+}
+
+void
+BinaryWriter::toBytes(const std::vector<const SceneObject*>& sceneObjects,
+                      std::string& manifest, std::string& payload) const
 {
     RecordInfoVector records;
 
-    // Step over each SceneObject.
-    std::ptrdiff_t offset = 0;
-    for (SceneContext::SceneObjectConstIterator iter = mContext.beginSceneObject();
-            iter != mContext.endSceneObject(); ++iter) {
-        if (mDeltaEncoding && !iter->second->mDirty) {
-            // If delta encoding, skip objects that aren't dirty.
-            continue;
+    if (mParallelEncoding) {
+        writeSceneObjectsParallel(sceneObjects, records, payload);
+    } else {
+        // Step over each SceneObject.
+        std::ptrdiff_t offset = 0;
+        for (const SceneObject* sceneObject : sceneObjects) {
+            std::size_t size = writeSceneObject(*sceneObject, payload);
+            records.emplace_back(SCENE_OBJECT_2, offset, size);
+            offset += size;
         }
+    }
 
-        std::size_t size = writeSceneObject(*(iter->second), payload);
-        records.emplace_back(SCENE_OBJECT_2, offset, size);
-        offset += size;
+    if (mCompression != Compression::NONE) {
+        compressRecords(records, payload);
     }
 
     // Write the manifest once the payload is finished.
@@ -168,6 +243,95 @@ BinaryWriter::writeSceneObject(const SceneObject& sceneObject, std::string& byte
     return vContainerEnq.finalize();
 }
 
+void
+BinaryWriter::writeSceneObjectsParallel(const std::vector<const SceneObject*>& sceneObjects,
+                                        RecordInfoVector& records, std::string& payload) const
+{
+    // Objects are split into fixed ranges independent of scheduling, each
+    // encoded into its own buffer. Records are position independent, so
+    // joining the buffers in range order gives the serial byte stream.
+    const std::size_t numObjects = sceneObjects.size();
+    const std::size_t numRanges =
+        std::min(numObjects, static_cast<std::size_t>(tbb::this_task_arena::max_concurrency()) * 4);
+    if (numRanges == 0) return;
+    const std::size_t rangeSize = (numObjects + numRanges - 1) / numRanges;
+
+    std::vector<std::string> rangePayloads(numRanges);
+    std::vector<std::size_t> sizes(numObjects);
+    tbb::parallel_for(std::size_t(0), numRanges, [&](std::size_t rangeId) {
+        const std::size_t begin = rangeId * rangeSize;
+        const std::size_t end = std::min(begin + rangeSize, numObjects);
+        for (std::size_t i = begin; i < end; ++i) {
+            sizes[i] = writeSceneObject(*sceneObjects[i], rangePayloads[rangeId]);
+        }
+    });
+
+    // Precompute the record offsets and join the buffers.
+    std::ptrdiff_t offset = 0;
+    records.reserve(records.size() + numObjects);
+    for (std::size_t i = 0; i < numObjects; ++i) {
+        records.emplace_back(SCENE_OBJECT_2, offset, sizes[i]);
+        offset += sizes[i];
+    }
+    payload.reserve(payload.size() + offset);
+    for (const std::string& rangePayload : rangePayloads) {
+        payload.append(rangePayload);
+    }
+}
+
+void
+BinaryWriter::compressRecords(RecordInfoVector& records, std::string& payload) const
+{
+    // Group consecutive records into blocks of at least mCompressionBlockSize
+    // bytes (the last block may be smaller).
+    struct Block
+    {
+        std::size_t mFirstRecord;
+        std::size_t mEndRecord;
+        std::ptrdiff_t mOffset;
+        std::size_t mRawSize;
+    };
+    std::vector<Block> blocks;
+    for (std::size_t i = 0; i < records.size(); ++i) {
+        if (blocks.empty() || blocks.back().mRawSize >= mCompressionBlockSize) {
+            blocks.push_back(Block{i, i, records[i].mOffset, 0});
+        }
+        blocks.back().mEndRecord = i + 1;
+        blocks.back().mRawSize += records[i].mSize;
+    }
+
+    std::vector<std::string> compressed(blocks.size());
+    tbb::parallel_for(std::size_t(0), blocks.size(), [&](std::size_t blockId) {
+        const Block& block = blocks[blockId];
+        std::string& bytes = compressed[blockId];
+        const uint64_t rawSize = block.mRawSize;
+        bytes.append(reinterpret_cast<const char*>(&rawSize), sizeof(uint64_t));
+        LzBlockCodec::compress(payload.data() + block.mOffset, block.mRawSize, bytes);
+    });
+
+    // Rebuild the payload and records, keeping any block which didn't shrink
+    // as its original records.
+    RecordInfoVector blockRecords;
+    std::string blockPayload;
+    std::ptrdiff_t offset = 0;
+    for (std::size_t blockId = 0; blockId < blocks.size(); ++blockId) {
+        const Block& block = blocks[blockId];
+        if (compressed[blockId].size() < block.mRawSize) {
+            blockRecords.emplace_back(SCENE_OBJECT_2_LZ_BLOCK, offset, compressed[blockId].size());
+            blockPayload.append(compressed[blockId]);
+            offset += compressed[blockId].size();
+        } else {
+            for (std::size_t i = block.mFirstRecord; i < block.mEndRecord; ++i) {
+                blockRecords.emplace_back(records[i].mType, offset, records[i].mSize);
+                offset += records[i].mSize;
+            }
+            blockPayload.append(payload, block.mOffset, block.mRawSize);
+        }
+    }
+    records.swap(blockRecords);
+    payload.swap(blockPayload);
+}
+
 void
 BinaryWriter::packSceneObject(const SceneObject& sceneObject, ValueContainerEnq &vContainerEnq) const
 {
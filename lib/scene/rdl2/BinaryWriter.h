@@ -11,6 +11,7 @@
 #include "Types.h"
 
 #include <cstddef>
+#include <cstdint>
 #include <ostream>
 #include <string>
 #include <vector>
@@ -50,6 +51,27 @@ class ValueContainerEnq;
  * NOTE: Both mlen and plen are 64-bit unsigned integers, in network byte
  *       order (big endian).
  *
+ * When chunked framing is enabled with setChunkedFraming(N), toStream() and
+ * toFile() instead write a marker followed by a sequence of ordinary frames,
+ * each holding at most N records, and a terminating empty frame:
+ *
+ * +---------+---------+---------+-----+---------+---------+
+ * | marker  | frame 0 | frame 1 | ... |    0    |    0    |
+ * +---------+---------+---------+-----+---------+---------+
+ * | 8 bytes |         |         |     | 8 bytes | 8 bytes |
+ * +---------+---------+---------+-----+---------+---------+
+ *
+ * The marker is CHUNKED_FRAME_MARKER (all bits set), which can never be a
+ * valid mlen. Each frame is self-describing, so the BinaryReader decodes and
+ * applies a chunk as soon as it has arrived, while later chunks are still
+ * being sent.
+ *
+ * With setCompression(), consecutive SCENE_OBJECT_2 records are grouped into
+ * blocks of roughly the requested size and each block is compressed into a
+ * single SCENE_OBJECT_2_LZ_BLOCK record: the uncompressed size as a native
+ * uint64 followed by the LzBlockCodec stream. Blocks that don't shrink are
+ * left as plain records, so a compressed payload may mix both record types.
+ *
  * Thread Safety:
  *  - Since the BinaryWriter reads SceneContext data (in particular,
  *      SceneObjects), it is not safe to be writing to SceneObjects in another
@@ -67,9 +89,22 @@ public:
     {
         UNKNOWN = 0,
         SCENE_OBJECT = 1,       // protbuf version
-        SCENE_OBJECT_2 = 2      // value container version
+        SCENE_OBJECT_2 = 2,     // value container version
+        SCENE_OBJECT_2_LZ_BLOCK = 3 // LzBlockCodec compressed run of SCENE_OBJECT_2 records
     };
 
+    enum class Compression
+    {
+        NONE = 0,
+        LZ_BLOCK = 1            // LzBlockCodec, fast block compression
+    };
+
+    // Default amount of uncompressed record data per compressed block.
+    static constexpr size_t DEFAULT_COMPRESSION_BLOCK_SIZE = 1 << 20;
+
+    // Written in place of mlen at the start of a chunked stream.
+    static constexpr uint64_t CHUNKED_FRAME_MARKER = ~uint64_t(0);
+
     /**
      * Constructs a BinaryWriter that will encode the given SceneContext into
      * RDL binary.
@@ -129,6 +164,40 @@ public:
     finline void setSplitMode(size_t minVectorSize);
     finline void clearSplitMode();
 
+    /**
+     * Encodes the SceneObjects in parallel. Each TBB task encodes a contiguous
+     * range of objects into its own buffer and the buffers are then joined in
+     * order, so the output is byte-identical to the serial encoding.
+     *
+     * @param   parallelEncoding    True to encode objects in parallel.
+     *                              (Disabled by default)
+     */
+    finline void setParallelEncoding(bool parallelEncoding);
+
+    /**
+     * Makes toStream() and toFile() write a chunked stream of frames holding
+     * at most recordsPerChunk records each, flushing the stream after every
+     * chunk. Passing 0 restores the single monolithic frame. toBytes() is not
+     * affected.
+     *
+     * @param   recordsPerChunk     Maximum number of records per chunk, or 0
+     *                              for a single frame. (0 by default)
+     */
+    finline void setChunkedFraming(size_t recordsPerChunk);
+
+    /**
+     * Compresses the payload records in blocks of about blockSize
+     * uncompressed bytes. Blocks are compressed concurrently and decompressed
+     * concurrently by the BinaryReader. Larger blocks compress better, while
+     * smaller blocks give the reader more parallelism.
+     *
+     * @param   compression     The codec to use, or Compression::NONE.
+     *                          (NONE by default)
+     * @param   blockSize       Target uncompressed size of each block.
+     */
+    finline void setCompression(Compression compression,
+                                size_t blockSize = DEFAULT_COMPRESSION_BLOCK_SIZE);
+
     /**
      * Opens the file with the given filename and attempts to write the RDL
      * binary to it. You can use the BinaryReader's fromFile() method to read
@@ -180,12 +249,31 @@ private:
     };
     typedef std::vector<RecordInfo> RecordInfoVector;
 
+    // Collects the SceneObjects to encode, in encoding order.
+    void collectSceneObjects(std::vector<const SceneObject*>& sceneObjects) const;
+
+    // Encodes the given SceneObjects into a manifest and payload.
+    void toBytes(const std::vector<const SceneObject*>& sceneObjects,
+                 std::string& manifest, std::string& payload) const;
+
+    // Writes one mlen|plen|manifest|payload frame to the stream.
+    static void writeFrame(std::ostream& output, const std::string& manifest, const std::string& payload);
+
     // Helper function to encode the manifest.
     void writeManifest(const RecordInfoVector& info, std::string& bytes) const;
 
     // Helper function for writing SceneObject messages out to the payload.
     std::size_t writeSceneObject(const SceneObject& sceneObject, std::string& bytes) const;
 
+    // Helper function for writing a list of SceneObjects out to the payload
+    // concurrently, appending one record per object to the records.
+    void writeSceneObjectsParallel(const std::vector<const SceneObject*>& sceneObjects,
+                                   RecordInfoVector& records, std::string& payload) const;
+
+    // Helper function for replacing runs of records in the payload with
+    // compressed blocks, compressing the blocks concurrently.
+    void compressRecords(RecordInfoVector& records, std::string& payload) const;
+
     // Helper function for packing an RDL SceneObject into a SceneObject ValueContainer.
     void packSceneObject(const SceneObject& sceneObject, ValueContainerEnq &vContainer) const;
 
@@ -232,6 +320,16 @@ private:
     // Enables writing for "split mode", where only large vectors are written
     bool mLargeVectorsOnly;
     size_t mMinVectorSize;
+
+    // True if SceneObjects are encoded concurrently.
+    bool mParallelEncoding;
+
+    // Maximum number of records per chunk for chunked framing, 0 if disabled.
+    size_t mRecordsPerChunk;
+
+    // Payload compression codec and target uncompressed block size.
+    Compression mCompression;
+    size_t mCompressionBlockSize;
 };
 
 void
@@ -259,6 +357,25 @@ BinaryWriter::setSplitMode(size_t minVectorSize)
     mMinVectorSize = minVectorSize;
 }
 
+void
+BinaryWriter::setParallelEncoding(bool parallelEncoding)
+{
+    mParallelEncoding = parallelEncoding;
+}
+
+void
+BinaryWriter::setChunkedFraming(size_t recordsPerChunk)
+{
+    mRecordsPerChunk = recordsPerChunk;
+}
+
+void
+BinaryWriter::setCompression(Compression compression, size_t blockSize)
+{
+    mCompression = compression;
+    mCompressionBlockSize = blockSize;
+}
+
 void
 BinaryWriter::clearSplitMode()
 {
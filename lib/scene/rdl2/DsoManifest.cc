@@ -0,0 +1,678 @@
+// Copyright 2023-2024 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+
+#include "DsoManifest.h"
+
+#include "Attribute.h"
+#include "SceneClass.h"
+#include "Types.h"
+#include "ValueContainerDeq.h"
+#include "ValueContainerEnq.h"
+#include "ValueContainerUtil.h"
+
+#include <scene_rdl2/common/except/exceptions.h>
+#include <scene_rdl2/render/util/Strings.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace scene_rdl2 {
+namespace rdl2 {
+
+namespace {
+
+// Bump the version whenever the layout of the manifest or of the recorded
+// declarations changes. Manifests of any other version are ignored.
+const char* const MANIFEST_MAGIC = "RDL2_DSO_MANIFEST";
+const unsigned int MANIFEST_VERSION = 1;
+
+std::string
+absolutePath(const std::string& filePath)
+{
+    std::error_code ec;
+    std::filesystem::path p = std::filesystem::absolute(filePath, ec);
+    return (ec) ? filePath : p.lexically_normal().string();
+}
+
+bool
+statFile(const std::string& filePath, int64_t& modifyTime, uint64_t& fileSize)
+{
+    struct stat st;
+    if (::stat(filePath.c_str(), &st) != 0) {
+        return false;
+    }
+    modifyTime = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+    fileSize = static_cast<uint64_t>(st.st_size);
+    return true;
+}
+
+void
+recordDefault(ValueContainerEnq& enq, const Attribute& attr)
+{
+    switch (attr.getType()) {
+    case TYPE_BOOL:
+        enq.enqBool(attr.getDefaultValue<Bool>());
+        break;
+    case TYPE_INT:
+        enq.enqInt(attr.getDefaultValue<Int>());
+        break;
+    case TYPE_LONG:
+        enq.enqLong(attr.getDefaultValue<Long>());
+        break;
+    case TYPE_FLOAT:
+        enq.enqFloat(attr.getDefaultValue<Float>());
+        break;
+    case TYPE_DOUBLE:
+        enq.enqDouble(attr.getDefaultValue<Double>());
+        break;
+    case TYPE_STRING:
+        enq.enqString(attr.getDefaultValue<String>());
+        break;
+    case TYPE_RGB:
+        enq.enqRgb(attr.getDefaultValue<Rgb>());
+        break;
+    case TYPE_RGBA:
+        enq.enqRgba(attr.getDefaultValue<Rgba>());
+        break;
+    case TYPE_VEC2F:
+        enq.enqVec2f(attr.getDefaultValue<Vec2f>());
+        break;
+    case TYPE_VEC2D:
+        enq.enqVec2d(attr.getDefaultValue<Vec2d>());
+        break;
+    case TYPE_VEC3F:
+        enq.enqVec3f(attr.getDefaultValue<Vec3f>());
+        break;
+    case TYPE_VEC3D:
+        enq.enqVec3d(attr.getDefaultValue<Vec3d>());
+        break;
+    case TYPE_VEC4F:
+        enq.enqVec4f(attr.getDefaultValue<Vec4f>());
+        break;
+    case TYPE_VEC4D:
+        enq.enqVec4d(attr.getDefaultValue<Vec4d>());
+        break;
+    case TYPE_MAT4F:
+        enq.enqMat4f(attr.getDefaultValue<Mat4f>());
+        break;
+    case TYPE_MAT4D:
+        enq.enqMat4d(attr.getDefaultValue<Mat4d>());
+        break;
+    case TYPE_BOOL_VECTOR:
+        enq.enqBoolVector(attr.getDefaultValue<BoolVector>());
+        break;
+    case TYPE_INT_VECTOR:
+        enq.enqIntVector(attr.getDefaultValue<IntVector>());
+        break;
+    case TYPE_LONG_VECTOR:
+        enq.enqLongVector(attr.getDefaultValue<LongVector>());
+        break;
+    case TYPE_FLOAT_VECTOR:
+        enq.enqFloatVector(attr.getDefaultValue<FloatVector>());
+        break;
+    case TYPE_DOUBLE_VECTOR:
+        enq.enqDoubleVector(attr.getDefaultValue<DoubleVector>());
+        break;
+    case TYPE_STRING_VECTOR:
+        enq.enqStringVector(attr.getDefaultValue<StringVector>());
+        break;
+    case TYPE_RGB_VECTOR:
+        enq.enqRgbVector(attr.getDefaultValue<RgbVector>());
+        break;
+    case TYPE_RGBA_VECTOR:
+        enq.enqRgbaVector(attr.getDefaultValue<RgbaVector>());
+        break;
+    case TYPE_VEC2F_VECTOR:
+        enq.enqVec2fVector(attr.getDefaultValue<Vec2fVector>());
+        break;
+    case TYPE_VEC2D_VECTOR:
+        enq.enqVec2dVector(attr.getDefaultValue<Vec2dVector>());
+        break;
+    case TYPE_VEC3F_VECTOR:
+        enq.enqVec3fVector(attr.getDefaultValue<Vec3fVector>());
+        break;
+    case TYPE_VEC3D_VECTOR:
+        enq.enqVec3dVector(attr.getDefaultValue<Vec3dVector>());
+        break;
+    case TYPE_VEC4F_VECTOR:
+        enq.enqVec4fVector(attr.getDefaultValue<Vec4fVector>());
+        break;
+    case TYPE_VEC4D_VECTOR:
+        enq.enqVec4dVector(attr.getDefaultValue<Vec4dVector>());
+        break;
+    case TYPE_MAT4F_VECTOR:
+        enq.enqMat4fVector(attr.getDefaultValue<Mat4fVector>());
+        break;
+    case TYPE_MAT4D_VECTOR:
+        enq.enqMat4dVector(attr.getDefaultValue<Mat4dVector>());
+        break;
+
+    case TYPE_SCENE_OBJECT:
+    case TYPE_SCENE_OBJECT_VECTOR:
+    case TYPE_SCENE_OBJECT_INDEXABLE:
+        // Object references always default to null / empty.
+        break;
+
+    default:
+        throw except::TypeError(util::buildString("Attribute '", attr.getName(),
+                "' has a type which can't be recorded in a DSO manifest."));
+    }
+}
+
+// Dequeues ValueContainerEnq data from a manifest, checking every value,
+// count and length against the bytes left first. ValueContainerDeq trusts
+// its input, which a cache file on disk can't be. Throws
+// except::RuntimeError on anything which doesn't fit.
+class ManifestDeq
+{
+public:
+    explicit ManifestDeq(const std::string& bytes) :
+        // The padding lets a variable length value at the very end decode
+        // without reading past the buffer, it is checked afterwards.
+        mBytes(bytes + std::string(VL_PADDING, '\0')),
+        mEnd(mBytes.data() + bytes.size()),
+        mDeq(mBytes.data(), bytes.size())
+    {
+    }
+
+    bool deqBool() { need(sizeof(char)); return mDeq.deqBool(); }
+    Int deqInt() { Int i; mDeq.deqInt(i); checkEnd(); return i; }
+    Long deqLong() { long l; mDeq.deqLong(l); checkEnd(); return l; }
+    uint64_t deqULong() { unsigned long ul; mDeq.deqULong(ul); checkEnd(); return ul; }
+    unsigned int deqVLUInt() { unsigned int ui; mDeq.deqVLUInt(ui); checkEnd(); return ui; }
+
+    // A count of items which take at least one byte each.
+    std::size_t deqCount()
+    {
+        const std::size_t count = mDeq.deqVLSizeT();
+        checkEnd();
+        if (count > rest()) {
+            corrupt();
+        }
+        return count;
+    }
+
+    // A count followed by that many deqVLUInt() values. They are batch
+    // decoded in runs whose worst case size fits the bytes left, so a
+    // corrupt manifest can't make the decoder read past the buffer.
+    std::vector<unsigned int> deqVLUIntVector()
+    {
+        std::vector<unsigned int> vec(deqCount());
+        std::size_t i = 0;
+        while (i < vec.size()) {
+            const std::size_t run = std::min(vec.size() - i,
+                    rest() / ValueContainerUtil::variableLengthIntMaxSize);
+            if (run == 0) {
+                vec[i++] = deqVLUInt();
+                continue;
+            }
+            mDeq.deqVLUIntArray(vec.data() + i, run);
+            i += run;
+        }
+        return vec;
+    }
+
+    // Fixed size values (float, double and the math types).
+    template <typename T>
+    T deqRaw()
+    {
+        need(sizeof(T));
+        T t;
+        mDeq.deq(t);
+        return t;
+    }
+
+    std::string deqString()
+    {
+        peekLength(sizeof(char));
+        return mDeq.deqString();
+    }
+
+    StringVector deqStringVector()
+    {
+        StringVector vec(deqCount());
+        for (std::string& str : vec) {
+            str = deqString();
+        }
+        return vec;
+    }
+
+    BoolVector deqBoolVector()
+    {
+        peekLength(sizeof(char));
+        return mDeq.deqBoolVector();
+    }
+
+    template <typename T>
+    T deqVector()
+    {
+        peekLength(sizeof(typename T::value_type));
+        T vec;
+        mDeq.deqVector(vec);
+        return vec;
+    }
+
+private:
+    static constexpr std::size_t VL_PADDING = 16; // > longest variable length value
+
+    const char* current() const
+    {
+        return reinterpret_cast<const char*>(mDeq.getCurrDataAddress());
+    }
+    std::size_t rest() const { return mEnd - current(); }
+
+    [[noreturn]] static void corrupt()
+    {
+        throw except::RuntimeError("Corrupt DSO manifest.");
+    }
+    void checkEnd() const
+    {
+        if (current() > mEnd) {
+            corrupt();
+        }
+    }
+    void need(std::size_t size) const
+    {
+        if (size > rest()) {
+            corrupt();
+        }
+    }
+
+    // Checks the length prefix of a string or vector of elementSize items
+    // against the bytes left, without consuming it.
+    void peekLength(std::size_t elementSize) const
+    {
+        unsigned long length;
+        const std::size_t size = ValueContainerUtil::variableLengthDecoding(current(), length);
+        need(size);
+        if (length > (rest() - size) / elementSize) {
+            corrupt();
+        }
+    }
+
+    const std::string mBytes;
+    const char* const mEnd;
+    ValueContainerDeq mDeq;
+};
+
+template <typename T>
+Attribute*
+declareRecorded(SceneClass& sceneClass, const std::string& name, const T& defaultValue,
+                AttributeFlags flags, SceneObjectInterface objectType,
+                const std::vector<std::string>& aliases)
+{
+    sceneClass.declareAttribute<T>(name, defaultValue, flags, objectType, aliases);
+    return sceneClass.getAttribute(name);
+}
+
+template <typename T>
+Attribute*
+declareRecorded(SceneClass& sceneClass, const std::string& name,
+                AttributeFlags flags, SceneObjectInterface objectType,
+                const std::vector<std::string>& aliases)
+{
+    sceneClass.declareAttribute<T>(name, flags, objectType, aliases);
+    return sceneClass.getAttribute(name);
+}
+
+Attribute*
+replayAttribute(ManifestDeq& deq, SceneClass& sceneClass)
+{
+    const std::string name = deq.deqString();
+    const std::vector<std::string> aliases = deq.deqStringVector();
+    const AttributeType type = static_cast<AttributeType>(deq.deqVLUInt());
+    const AttributeFlags flags = static_cast<AttributeFlags>(deq.deqVLUInt());
+    const SceneObjectInterface objectType = static_cast<SceneObjectInterface>(deq.deqVLUInt());
+
+    switch (type) {
+    case TYPE_BOOL:
+        return declareRecorded<Bool>(sceneClass, name, deq.deqBool(), flags, objectType, aliases);
+    case TYPE_INT:
+        return declareRecorded<Int>(sceneClass, name, deq.deqInt(), flags, objectType, aliases);
+    case TYPE_LONG:
+        return declareRecorded<Long>(sceneClass, name, deq.deqLong(), flags, objectType, aliases);
+    case TYPE_FLOAT:
+        return declareRecorded<Float>(sceneClass, name, deq.deqRaw<Float>(), flags, objectType, aliases);
+    case TYPE_DOUBLE:
+        return declareRecorded<Double>(sceneClass, name, deq.deqRaw<Double>(), flags, objectType, aliases);
+    case TYPE_STRING:
+        return declareRecorded<String>(sceneClass, name, deq.deqString(), flags, objectType, aliases);
+    case TYPE_RGB:
+        return declareRecorded<Rgb>(sceneClass, name, deq.deqRaw<Rgb>(), flags, objectType, aliases);
+    case TYPE_RGBA:
+        return declareRecorded<Rgba>(sceneClass, name, deq.deqRaw<Rgba>(), flags, objectType, aliases);
+    case TYPE_VEC2F:
+        return declareRecorded<Vec2f>(sceneClass, name, deq.deqRaw<Vec2f>(), flags, objectType, aliases);
+    case TYPE_VEC2D:
+        return declareRecorded<Vec2d>(sceneClass, name, deq.deqRaw<Vec2d>(), flags, objectType, aliases);
+    case TYPE_VEC3F:
+        return declareRecorded<Vec3f>(sceneClass, name, deq.deqRaw<Vec3f>(), flags, objectType, aliases);
+    case TYPE_VEC3D:
+        return declareRecorded<Vec3d>(sceneClass, name, deq.deqRaw<Vec3d>(), flags, objectType, aliases);
+    case TYPE_VEC4F:
+        return declareRecorded<Vec4f>(sceneClass, name, deq.deqRaw<Vec4f>(), flags, objectType, aliases);
+    case TYPE_VEC4D:
+        return declareRecorded<Vec4d>(sceneClass, name, deq.deqRaw<Vec4d>(), flags, objectType, aliases);
+    case TYPE_MAT4F:
+        return declareRecorded<Mat4f>(sceneClass, name, deq.deqRaw<Mat4f>(), flags, objectType, aliases);
+    case TYPE_MAT4D:
+        return declareRecorded<Mat4d>(sceneClass, name, deq.deqRaw<Mat4d>(), flags, objectType, aliases);
+    case TYPE_SCENE_OBJECT:
+        return declareRecorded<SceneObject*>(sceneClass, name, flags, objectType, aliases);
+    case TYPE_BOOL_VECTOR:
+        return declareRecorded<BoolVector>(sceneClass, name, deq.deqBoolVector(), flags, objectType, aliases);
+    case TYPE_INT_VECTOR:
+        return declareRecorded<IntVector>(sceneClass, name, deq.deqVector<IntVector>(), flags, objectType, aliases);
+    case TYPE_LONG_VECTOR:
+        return declareRecorded<LongVector>(sceneClass, name, deq.deqVector<LongVector>(), flags, objectType, aliases);
+    case TYPE_FLOAT_VECTOR:
+        return declareRecorded<FloatVector>(sceneClass, name, deq.deqVector<FloatVector>(), flags, objectType, aliases);
+    case TYPE_DOUBLE_VECTOR:
+        return declareRecorded<DoubleVector>(sceneClass, name, deq.deqVector<DoubleVector>(), flags, objectType, aliases);
+    case TYPE_STRING_VECTOR:
+        return declareRecorded<StringVector>(sceneClass, name, deq.deqStringVector(), flags, objectType, aliases);
+    case TYPE_RGB_VECTOR:
+        return declareRecorded<RgbVector>(sceneClass, name, deq.deqVector<RgbVector>(), flags, objectType, aliases);
+    case TYPE_RGBA_VECTOR:
+        return declareRecorded<RgbaVector>(sceneClass, name, deq.deqVector<RgbaVector>(), flags, objectType, aliases);
+    case TYPE_VEC2F_VECTOR:
+        return declareRecorded<Vec2fVector>(sceneClass, name, deq.deqVector<Vec2fVector>(), flags, objectType, aliases);
+    case TYPE_VEC2D_VECTOR:
+        return declareRecorded<Vec2dVector>(sceneClass, name, deq.deqVector<Vec2dVector>(), flags, objectType, aliases);
+    case TYPE_VEC3F_VECTOR:
+        return declareRecorded<Vec3fVector>(sceneClass, name, deq.deqVector<Vec3fVector>(), flags, objectType, aliases);
+    case TYPE_VEC3D_VECTOR:
+        return declareRecorded<Vec3dVector>(sceneClass, name, deq.deqVector<Vec3dVector>(), flags, objectType, aliases);
+    case TYPE_VEC4F_VECTOR:
+        return declareRecorded<Vec4fVector>(sceneClass, name, deq.deqVector<Vec4fVector>(), flags, objectType, aliases);
+    case TYPE_VEC4D_VECTOR:
+        return declareRecorded<Vec4dVector>(sceneClass, name, deq.deqVector<Vec4dVector>(), flags, objectType, aliases);
+    case TYPE_MAT4F_VECTOR:
+        return declareRecorded<Mat4fVector>(sceneClass, name, deq.deqVector<Mat4fVector>(), flags, objectType, aliases);
+    case TYPE_MAT4D_VECTOR:
+        return declareRecorded<Mat4dVector>(sceneClass, name, deq.deqVector<Mat4dVector>(), flags, objectType, aliases);
+    case TYPE_SCENE_OBJECT_VECTOR:
+        return declareRecorded<SceneObjectVector>(sceneClass, name, flags, objectType, aliases);
+    case TYPE_SCENE_OBJECT_INDEXABLE:
+        return declareRecorded<SceneObjectIndexable>(sceneClass, name, flags, objectType, aliases);
+    default:
+        throw except::RuntimeError(util::buildString("Corrupt DSO manifest declaration of"
+                " attribute '", name, "' in SceneClass '", sceneClass.getName(), "'."));
+    }
+}
+
+} // namespace
+
+DsoManifest::DsoManifest(const std::string& filePath) :
+    mFilePath(filePath),
+    mDirty(false)
+{
+    load();
+}
+
+void
+DsoManifest::load()
+{
+    std::ifstream in(mFilePath.c_str(), std::ios::binary);
+    if (!in) {
+        return;
+    }
+    const std::string bytes((std::istreambuf_iterator<char>(in)),
+                            std::istreambuf_iterator<char>());
+    if (bytes.size() < sizeof(std::size_t)) {
+        return;
+    }
+
+    // A manifest is only a cache, so anything we can't make sense of is
+    // simply ignored and rebuilt.
+    EntryMap entries;
+    try {
+        ManifestDeq deq(bytes);
+        if (deq.deqString() != MANIFEST_MAGIC || deq.deqVLUInt() != MANIFEST_VERSION) {
+            return;
+        }
+        const std::size_t count = deq.deqCount();
+        for (std::size_t i = 0; i < count; ++i) {
+            std::string dsoFilePath = deq.deqString();
+            Entry entry;
+            entry.mModifyTime = deq.deqLong();
+            entry.mFileSize = deq.deqULong();
+            entry.mValid = deq.deqBool();
+            entry.mClassName = deq.deqString();
+            entry.mDeclaration = deq.deqString();
+            entries.emplace(std::move(dsoFilePath), std::move(entry));
+        }
+    } catch (...) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    mEntries = std::move(entries);
+}
+
+bool
+DsoManifest::find(const std::string& dsoFilePath, Entry& entry) const
+{
+    int64_t modifyTime;
+    uint64_t fileSize;
+    if (!statFile(dsoFilePath, modifyTime, fileSize)) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto iter = mEntries.find(absolutePath(dsoFilePath));
+    if (iter == mEntries.end() ||
+            iter->second.mModifyTime != modifyTime ||
+            iter->second.mFileSize != fileSize) {
+        return false;
+    }
+    entry = iter->second;
+    return true;
+}
+
+void
+DsoManifest::insert(const std::string& dsoFilePath, const std::string& className,
+                    bool valid, const std::string& declaration)
+{
+    Entry entry;
+    if (!statFile(dsoFilePath, entry.mModifyTime, entry.mFileSize)) {
+        return;
+    }
+    entry.mValid = valid;
+    entry.mClassName = className;
+    entry.mDeclaration = declaration;
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    mEntries[absolutePath(dsoFilePath)] = std::move(entry);
+    mDirty = true;
+}
+
+std::size_t
+DsoManifest::size() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mEntries.size();
+}
+
+bool
+DsoManifest::isDirty() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mDirty;
+}
+
+void
+DsoManifest::save()
+{
+    std::string bytes;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        ValueContainerEnq enq(&bytes);
+        enq.enqString(MANIFEST_MAGIC);
+        enq.enqVLUInt(MANIFEST_VERSION);
+        enq.enqVLSizeT(mEntries.size());
+        for (const auto& item : mEntries) {
+            enq.enqString(item.first);
+            enq.enqLong(item.second.mModifyTime);
+            enq.enqULong(item.second.mFileSize);
+            enq.enqBool(item.second.mValid);
+            enq.enqString(item.second.mClassName);
+            enq.enqString(item.second.mDeclaration);
+        }
+        enq.finalize();
+        mDirty = false;
+    }
+
+    std::filesystem::path p(mFilePath);
+    std::error_code ec;
+    if (p.has_parent_path()) {
+        std::filesystem::create_directories(p.parent_path(), ec);
+    }
+
+    // Write a private temporary file and rename it over the manifest, so
+    // other processes never read a partially written manifest.
+    const std::string tmpPath = util::buildString(mFilePath, ".", ::getpid(), ".tmp");
+    {
+        std::ofstream out(tmpPath.c_str(), std::ios::trunc | std::ios::binary);
+        out.write(bytes.data(), bytes.size());
+        if (!out) {
+            std::remove(tmpPath.c_str());
+            throw except::IoError(util::buildString("Could not write DSO manifest '",
+                    mFilePath, "'."));
+        }
+    }
+    if (std::rename(tmpPath.c_str(), mFilePath.c_str()) != 0) {
+        std::remove(tmpPath.c_str());
+        throw except::IoError(util::buildString("Could not write DSO manifest '",
+                mFilePath, "'."));
+    }
+}
+
+std::string
+DsoManifest::record(const SceneClass& sceneClass)
+{
+    std::string bytes;
+    ValueContainerEnq enq(&bytes);
+
+    enq.enqVLUInt(static_cast<unsigned int>(sceneClass.getDeclaredInterface()));
+
+    // Attributes, in declaration order so replay() reproduces their indices
+    // and offsets.
+    std::unordered_map<const Attribute*, unsigned int> indices;
+    enq.enqVLSizeT(std::distance(sceneClass.beginAttributes(), sceneClass.endAttributes()));
+    for (auto iter = sceneClass.beginAttributes(); iter != sceneClass.endAttributes(); ++iter) {
+        const Attribute& attr = **iter;
+        indices.emplace(&attr, static_cast<unsigned int>(indices.size()));
+
+        enq.enqString(attr.getName());
+        enq.enqStringVector(attr.getAliases());
+        enq.enqVLUInt(static_cast<unsigned int>(attr.getType()));
+        enq.enqVLUInt(static_cast<unsigned int>(attr.getFlags()));
+        enq.enqVLUInt(static_cast<unsigned int>(attr.getObjectType()));
+        recordDefault(enq, attr);
+
+        enq.enqVLSizeT(std::distance(attr.beginMetadata(), attr.endMetadata()));
+        for (auto md = attr.beginMetadata(); md != attr.endMetadata(); ++md) {
+            enq.enqString(md->first);
+            enq.enqString(md->second);
+        }
+        enq.enqVLSizeT(std::distance(attr.beginEnumValues(), attr.endEnumValues()));
+        for (auto ev = attr.beginEnumValues(); ev != attr.endEnumValues(); ++ev) {
+            enq.enqInt(ev->first);
+            enq.enqString(ev->second);
+        }
+    }
+
+    // Groups, by attribute index.
+    enq.enqVLSizeT(std::distance(sceneClass.beginGroups(), sceneClass.endGroups()));
+    for (auto group = sceneClass.beginGroups(); group != sceneClass.endGroups(); ++group) {
+        const std::vector<const Attribute*> members = sceneClass.getAttributeGroup(*group);
+        std::vector<unsigned int> memberIndices;
+        memberIndices.reserve(members.size());
+        for (const Attribute* attr : members) {
+            memberIndices.push_back(indices.at(attr));
+        }
+        enq.enqString(*group);
+        enq.enqVLSizeT(memberIndices.size());
+        enq.enqVLUIntArray(memberIndices.data(), memberIndices.size());
+    }
+
+    enq.finalize();
+    return bytes;
+}
+
+SceneObjectInterface
+DsoManifest::replay(const std::string& declaration, SceneClass& sceneClass)
+{
+    ManifestDeq deq(declaration);
+
+    const SceneObjectInterface interface = static_cast<SceneObjectInterface>(deq.deqVLUInt());
+
+    const std::size_t attributeCount = deq.deqCount();
+    for (std::size_t i = 0; i < attributeCount; ++i) {
+        Attribute* attr = replayAttribute(deq, sceneClass);
+
+        const std::size_t metadataCount = deq.deqCount();
+        for (std::size_t m = 0; m < metadataCount; ++m) {
+            const std::string key = deq.deqString();
+            attr->setMetadata(key, deq.deqString());
+        }
+        const std::size_t enumCount = deq.deqCount();
+        for (std::size_t e = 0; e < enumCount; ++e) {
+            const Int value = deq.deqInt();
+            attr->setEnumValue(value, deq.deqString());
+        }
+    }
+
+    const std::size_t groupCount = deq.deqCount();
+    for (std::size_t g = 0; g < groupCount; ++g) {
+        sceneClass.mGroupNames.push_back(deq.deqString());
+        for (const unsigned int index : deq.deqVLUIntVector()) {
+            if (index >= sceneClass.mAttributes.size()) {
+                throw except::RuntimeError(util::buildString("Corrupt DSO manifest"
+                        " declaration of groups in SceneClass '", sceneClass.getName(), "'."));
+            }
+            sceneClass.mGroupMap.insert(std::make_pair(g, sceneClass.mAttributes[index]));
+        }
+    }
+
+    return interface;
+}
+
+std::string
+DsoManifest::defaultFilePath()
+{
+    const char* manifest = std::getenv("RDL2_DSO_MANIFEST");
+    if (manifest) {
+        return manifest;
+    }
+
+    std::string cacheDir;
+    const char* xdgCacheHome = std::getenv("XDG_CACHE_HOME");
+    const char* home = std::getenv("HOME");
+    if (xdgCacheHome && *xdgCacheHome) {
+        cacheDir = xdgCacheHome;
+    } else if (home && *home) {
+        cacheDir = util::buildString(home, "/.cache");
+    } else {
+        return std::string();
+    }
+    return util::buildString(cacheDir, "/scene_rdl2/dso_manifest");
+}
+
+} // namespace rdl2
+} // namespace scene_rdl2
+
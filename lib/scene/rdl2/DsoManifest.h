@@ -0,0 +1,146 @@
+// Copyright 2023-2024 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+// Include this before any other includes!
+#include <scene_rdl2/common/platform/Platform.h>
+
+#include "Types.h"
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace scene_rdl2 {
+namespace rdl2 {
+
+/**
+ * A DsoManifest is a persistent, on-disk cache of what RDL DSOs declare. For
+ * each DSO file it remembers the file's modification time and size, whether
+ * the file is a valid RDL DSO at all, and a serialized copy of the
+ * declarations its rdl2_declare() function makes: the declared interface,
+ * every attribute (name, aliases, type, flags, object type, default value,
+ * metadata and enum values) and the attribute groups.
+ *
+ * When a SceneContext has a manifest, SceneClasses whose DSO has a fresh
+ * entry are declared by replaying that entry instead of dlopen()'ing the
+ * DSO. In proxy mode the DSO is then never opened; otherwise it is opened
+ * when the first object of the class is created. Entries are considered
+ * stale as soon as the DSO's modification time or size changes.
+ *
+ * All member functions are thread safe.
+ */
+class DsoManifest
+{
+public:
+    struct Entry
+    {
+        Entry() : mModifyTime(0), mFileSize(0), mValid(false) {}
+
+        int64_t mModifyTime;  // nanoseconds since the epoch
+        uint64_t mFileSize;
+        bool mValid;          // false if the file isn't a usable RDL DSO
+        std::string mClassName;
+        std::string mDeclaration; // from record(), empty if !mValid
+    };
+
+    /**
+     * Creates a manifest backed by the given file and loads the entries it
+     * holds. A missing, unreadable or corrupt file yields an empty manifest.
+     *
+     * @param   filePath    The manifest file.
+     */
+    explicit DsoManifest(const std::string& filePath);
+
+    /// The file this manifest is loaded from and saved to.
+    finline const std::string& getFilePath() const;
+
+    /**
+     * Looks up the entry for a DSO file, if it is still fresh.
+     *
+     * @param   dsoFilePath     Path to the DSO (relative paths are fine).
+     * @param   entry           Filled in if a fresh entry exists.
+     * @return  True if the DSO has an entry matching its current
+     *          modification time and size.
+     */
+    bool find(const std::string& dsoFilePath, Entry& entry) const;
+
+    /**
+     * Adds or replaces the entry for a DSO file, stamped with the file's
+     * current modification time and size. Does nothing if the file can't be
+     * stat()'d.
+     *
+     * @param   dsoFilePath     Path to the DSO (relative paths are fine).
+     * @param   className       The SceneClass the DSO declares.
+     * @param   valid           True if the file is a usable RDL DSO.
+     * @param   declaration     The declarations from record().
+     */
+    void insert(const std::string& dsoFilePath, const std::string& className,
+                bool valid, const std::string& declaration);
+
+    /// Number of entries in the manifest.
+    std::size_t size() const;
+
+    /// True if entries were inserted since the manifest was loaded or saved.
+    bool isDirty() const;
+
+    /**
+     * Writes the manifest to its file. The file is replaced atomically, so
+     * concurrent readers always see a complete manifest.
+     *
+     * @throw   except::IoError     If the file could not be written.
+     */
+    void save();
+
+    /**
+     * Serializes the declarations of a complete SceneClass.
+     *
+     * @param   sceneClass  The SceneClass to record.
+     * @return  The declarations, suitable for replay().
+     */
+    static std::string record(const SceneClass& sceneClass);
+
+    /**
+     * Declares the attributes and groups from record() on a SceneClass which
+     * hasn't been declared yet.
+     *
+     * @param   declaration     Declarations from record().
+     * @param   sceneClass      The SceneClass to declare them on.
+     * @return  The interface of the recorded SceneClass.
+     * @throw   except::RuntimeError    If the declarations are corrupt.
+     */
+    static SceneObjectInterface replay(const std::string& declaration,
+                                       SceneClass& sceneClass);
+
+    /**
+     * The manifest file used by the command line tools: $RDL2_DSO_MANIFEST
+     * if it is set (an empty value disables the manifest), otherwise
+     * scene_rdl2/dso_manifest under $XDG_CACHE_HOME or ~/.cache.
+     *
+     * @return  The manifest file path, or an empty string if there is none.
+     */
+    static std::string defaultFilePath();
+
+private:
+    typedef std::unordered_map<std::string, Entry> EntryMap;
+
+    void load();
+
+    const std::string mFilePath;
+
+    mutable std::mutex mMutex;
+    EntryMap mEntries;   // keyed by absolute DSO path
+    bool mDirty;
+};
+
+const std::string&
+DsoManifest::getFilePath() const
+{
+    return mFilePath;
+}
+
+} // namespace rdl2
+} // namespace scene_rdl2
+
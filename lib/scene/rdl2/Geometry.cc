@@ -246,7 +246,10 @@ Geometry::requiresGeometryUpdate(UpdateHelper& sceneObjects, int depth)
                         !object->asA<Geometry>()->requiresGeometryUpdate(sceneObjects, depth + 1)) {
                         continue;
                     }
-                    updateRequired |= object->updatePrep(sceneObjects, depth + 1);
+                    if (object->updatePrep(sceneObjects, depth + 1)) {
+                        updateRequired = true;
+                        sceneObjects.addDependency(this, object);
+                    }
                 }
             }
             break;
@@ -270,8 +273,9 @@ Geometry::requiresGeometryUpdate(UpdateHelper& sceneObjects, int depth)
         }
     }
     // This geometry does not have an attribute change that requires an update.
-    // Change the flag to false.
-    mAttributeTreeChanged = false;
+    // mAttributeTreeChanged stays raised for concurrent updatePrep() walks,
+    // geometryUpdateRequired() ignores it from now on.
+    mGeometryUpdateSkipped = true;
     return false;
 }
 
@@ -119,6 +119,15 @@ public:
     /// update that requires geometry to regenerate/tessellate/construct accelerator
     bool requiresGeometryUpdate(UpdateHelper& sceneObjects, int depth);
 
+    /// Like updateRequired(), but ignores attribute changes once
+    /// requiresGeometryUpdate() found that none of them require a geometry
+    /// update. Can be called after updatePrep() and before resetUpdate().
+    bool geometryUpdateRequired() const
+    {
+        return (attributeTreeChanged() && !mGeometryUpdateSkipped) ||
+               bindingTreeChanged() || mUpdateRequested;
+    }
+
     // Attributes common to all Geometries.
     static AttributeKey<String> sLabel;
     static AttributeKey<SceneObjectVector> sReferenceGeometries;
@@ -177,10 +186,15 @@ protected:
                     requiresGeometryUpdate(sceneObjects, depth + 1)) {
                     continue;
                 }
-                updateRequired |= object->updatePrep(sceneObjects, depth);
+                if (object->updatePrep(sceneObjects, depth)) {
+                    updateRequired = true;
+                    sceneObjects.addDependency(this, object);
+                }
             }
         }
-        mAttributeTreeChanged |= updateRequired;
+        if (updateRequired) {
+            mAttributeTreeChanged = true;
+        }
         return updateRequired;
     }
 
@@ -76,7 +76,7 @@ GeometrySet::add(Geometry* geometry)
     // the set() method.
     mAttributeUpdateMask.set(sGeometriesKey.mIndex, true);
     mAttributeSetMask.set(sGeometriesKey.mIndex, true);
-    mDirty = true;
+    markDirty();
 }
 
 void
@@ -104,7 +104,7 @@ GeometrySet::remove(Geometry* geometry)
         // through the set() method.
         mAttributeUpdateMask.set(sGeometriesKey.mIndex, true);
         mAttributeSetMask.set(sGeometriesKey.mIndex, true);
-        mDirty = true;
+        markDirty();
     }
 }
 
@@ -137,7 +137,7 @@ GeometrySet::clear()
     // through the set() method.
     mAttributeUpdateMask.set(sGeometriesKey.mIndex, true);
     mAttributeSetMask.set(sGeometriesKey.mIndex, true);
-    mDirty = true;
+    markDirty();
 }
 
 bool
@@ -160,16 +160,15 @@ GeometrySet::updatePrepFast(UpdateHelper& sceneObjects, int depth)
 {
     MNRY_ASSERT_REQUIRE(!mUpdateActive);
 
-    if (mUpdatePrepApplied &&
-            (sceneObjects.getDepth(this) >=depth || sceneObjects.isLeaf(this))) {
+    if (!beginUpdatePrep(sceneObjects, depth)) {
         return updateRequired();
     }
-    mUpdatePrepApplied = true;
 
     const SceneObjectIndexable& geometries = get(sGeometriesKey);
     bool attributeTreeChanged = false;
     bool bindingTreeChanged = false;
-    // check for any geometry in this set has been updated.
+    // check for any geometry in this set has been updated. Every changed
+    // geometry is recorded as a dependency, so no early termination here.
     for (auto iter = geometries.begin(); iter != geometries.end(); ++iter) {
         Geometry* geom = (*iter)->asA<Geometry>();
         if (geom->attributeTreeChanged()) {
@@ -178,17 +177,22 @@ GeometrySet::updatePrepFast(UpdateHelper& sceneObjects, int depth)
         if (geom->bindingTreeChanged()) {
             bindingTreeChanged = true;
         }
-        // terminate early if both are true
-        if (attributeTreeChanged && bindingTreeChanged) {
-            break;
+        if (geom->attributeTreeChanged() || geom->bindingTreeChanged()) {
+            sceneObjects.addDependency(this, geom);
         }
     }
-    mAttributeTreeChanged = attributeTreeChanged || mAttributeUpdateMask.any();
-    mBindingTreeChanged = bindingTreeChanged || mBindingUpdateMask.any();
+    // only raised, see SceneObject::updatePrep()
+    if (attributeTreeChanged || mAttributeUpdateMask.any()) {
+        mAttributeTreeChanged = true;
+    }
+    if (bindingTreeChanged || mBindingUpdateMask.any()) {
+        mBindingTreeChanged = true;
+    }
 
     if (updateRequired()) {
         sceneObjects.insert(this, depth);
     }
+    endUpdatePrep();
     return updateRequired();
 }
 
@@ -19,10 +19,14 @@
 #include <scene_rdl2/common/except/exceptions.h>
 #include <scene_rdl2/render/util/Strings.h>
 
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
 #include <cstddef>
 #include <sstream>
 #include <string>
 #include <utility>
+#include <vector>
 #include <stdint.h>
 
 namespace {
@@ -184,7 +188,7 @@ Layer::dirtyAssignments() {
     mAttributeSetMask.set(sVolumeShadersKey.mIndex, true);
     mAttributeSetMask.set(sShadowSetsKey.mIndex, true);
     mAttributeSetMask.set(sShadowReceiverSetsKey.mIndex, true);
-    mDirty = true;
+    markDirty();
 }
 
 int32_t
@@ -295,6 +299,9 @@ Layer::assign(Geometry* geometry, const String& partName, const LayerAssignment&
         MNRY_ASSERT(surfaceShaders.size() == idx + 1);
     }
 
+    // Only the per assignment attributes changed since TraceSet::assign().
+    restampAssignmentIndex();
+
     return idx;
 }
 
@@ -476,8 +483,58 @@ Layer::updatePrepAssignments(UpdateHelper& sceneObjects, int depth, Camera* came
     const auto& geometries = get(sGeometriesKey);
     const auto& displacements = get(sDisplacementsKey);
     const auto& volumeShaders = get(sVolumeShadersKey);
+
+    // The updatePrep() walks of the assignments are independent of each other
+    // (updatePrep() is threadsafe), so they run in parallel. Everything else
+    // touches shared state and is done in assignment order afterwards.
+    // Whether a geometry changed is read back in that second pass instead of
+    // being recorded here: a displacement of an earlier assignment may request
+    // an update of a geometry shared with later assignments, which these see
+    // just like the serial loop did.
+    enum : uint8_t {
+        MATERIAL_CHANGED     = 1 << 0,
+        VOLUME_CHANGED       = 1 << 1,
+        GEOMETRY_DEFORMED    = 1 << 2,
+        DISPLACEMENT_CHANGED = 1 << 3
+    };
+    std::vector<uint8_t> assignmentChanges(surfaceShaders.size(), 0);
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, surfaceShaders.size()),
+            [&](const tbb::blocked_range<size_t>& range)
+    {
+        for (size_t i = range.begin(); i != range.end(); ++i) {
+            uint8_t& flags = assignmentChanges[i];
+            Geometry * const geometry = geometries[i]->asA<Geometry>();
+            if (surfaceShaders[i] != nullptr) {
+                Material * const material = surfaceShaders[i]->asA<Material>();
+                if (material && material->updatePrep(sceneObjects, depth + 1)) { // true if object is in update graph
+                    flags |= MATERIAL_CHANGED;
+                }
+            }
+            if (volumeShaders[i] != nullptr) {
+                VolumeShader * const volumeShader = volumeShaders[i]->asA<VolumeShader>();
+                if (volumeShader && volumeShader->updatePrep(sceneObjects, depth + 1)) { // true if object is in update graph
+                    flags |= VOLUME_CHANGED;
+                }
+            }
+            if (geometry) {
+                if (isDeformed(geometry)) {
+                    flags |= GEOMETRY_DEFORMED;
+                } else {
+                    geometry->updatePrep(sceneObjects, depth + 1);
+                }
+            }
+            if (displacements[i] != nullptr) {
+                Displacement * const displacement = displacements[i]->asA<Displacement>();
+                if (displacement && displacement->updatePrep(sceneObjects, depth + 1)) { // true if object is in update graph
+                    flags |= DISPLACEMENT_CHANGED;
+                }
+            }
+        }
+    });
+
     for (size_t i = 0; i < surfaceShaders.size(); ++i) {
         Geometry * const geometry = geometries[i]->asA<Geometry>();
+        const uint8_t flags = assignmentChanges[i];
 
         // For IOR tracking purposes -- check if the geometry matches the geometry attached to the camera. If so, flag 
         // it so that (in updatePriorityAssignments) we can check for intersection with the geometry and set the 
@@ -490,51 +547,47 @@ Layer::updatePrepAssignments(UpdateHelper& sceneObjects, int depth, Camera* came
             }
         }
 
-        if (surfaceShaders[i] != nullptr) {
+        if (flags & MATERIAL_CHANGED) {
             Material * const material = surfaceShaders[i]->asA<Material>();
-            if (material && material->updatePrep(sceneObjects, depth + 1)) { // true if object is in update graph
-                mChangedRootShaders.insert(material);
-                // Geometries depend on materials because material request primitive
-                // attributes from the geometry. That means if a material changes
-                // it might request a new primitive attribute from the geometry
-                // and so the geometry would need to be reloaded and retessellated.
-                // At this point we do not know which primitive attributes the material
-                // requests, that occurs during the update calls, so we add this
-                // geometry to the list of changed or deformed geometries just in case.
-                mChangedOrDeformedGeometries[geometry] = i;
-                changed = true;
-            }
+            sceneObjects.addDependency(this, material);
+            mChangedRootShaders.insert(material);
+            // Geometries depend on materials because material request primitive
+            // attributes from the geometry. That means if a material changes
+            // it might request a new primitive attribute from the geometry
+            // and so the geometry would need to be reloaded and retessellated.
+            // At this point we do not know which primitive attributes the material
+            // requests, that occurs during the update calls, so we add this
+            // geometry to the list of changed or deformed geometries just in case.
+            mChangedOrDeformedGeometries[geometry] = i;
+            changed = true;
         }
-        if (volumeShaders[i] != nullptr) {
+        if (flags & VOLUME_CHANGED) {
             VolumeShader * const volumeShader = volumeShaders[i]->asA<VolumeShader>();
-            if (volumeShader && volumeShader->updatePrep(sceneObjects, depth + 1)) { // true if object is in update graph
-                mChangedRootShaders.insert(volumeShader);
-                // Geometries depend on volumeShaders because we bake the maps into the geometry itself
-                mChangedOrDeformedGeometries[geometry] = i;
-                changed = true;
-            }
+            sceneObjects.addDependency(this, volumeShader);
+            mChangedRootShaders.insert(volumeShader);
+            // Geometries depend on volumeShaders because we bake the maps into the geometry itself
+            mChangedOrDeformedGeometries[geometry] = i;
+            changed = true;
         }
-        if (geometry) {
-            if (isDeformed(geometry)) {
+        if (flags & GEOMETRY_DEFORMED) {
+            mChangedOrDeformedGeometries[geometry] = i;
+            changed = true;
+        } else if (geometry && geometry->geometryUpdateRequired()) { // also sees requestUpdate() of earlier assignments
+            sceneObjects.addDependency(this, geometry);
+            // true if the dirtied attributes involve geometry change
+            if (geometry->requiresGeometryUpdate(sceneObjects, depth + 1)) {
                 mChangedOrDeformedGeometries[geometry] = i;
-                changed = true;
-            } else if (geometry->updatePrep(sceneObjects, depth + 1)) {
-                // true if the dirtied attributes involve geometry change
-                if (geometry->requiresGeometryUpdate(sceneObjects, depth + 1)) {
-                    mChangedOrDeformedGeometries[geometry] = i;
-                }
-                changed = true;
             }
+            changed = true;
         }
-        if (displacements[i] != nullptr) {
+        if (flags & DISPLACEMENT_CHANGED) {
             Displacement * const displacement = displacements[i]->asA<Displacement>();
-            if (displacement && displacement->updatePrep(sceneObjects, depth + 1)) { // true if object is in update graph
-                mChangedRootShaders.insert(displacement);
-                mChangedOrDeformedGeometries[geometry] = i;
-                // geometry must re-tessellate even though no attrs or bindings have changed
-                geometry->requestUpdate();
-                changed = true;
-            }
+            sceneObjects.addDependency(this, displacement);
+            mChangedRootShaders.insert(displacement);
+            mChangedOrDeformedGeometries[geometry] = i;
+            // geometry must re-tessellate even though no attrs or bindings have changed
+            geometry->requestUpdate();
+            changed = true;
         }
     }
     // Flag LightSets, LightFilterSets, ShadowSets, and ShadowReceiverSets that need to be updated in preFrame()
@@ -542,6 +595,7 @@ Layer::updatePrepAssignments(UpdateHelper& sceneObjects, int depth, Camera* came
         if (lightSetObj) {
             LightSet * lightSet = lightSetObj->asA<LightSet>();
             if (lightSet->updatePrepLight(sceneObjects, depth  + 1)) {
+                sceneObjects.addDependency(this, lightSet);
                 mLightSetsChanged = true;
                 changed = true;
             }
@@ -559,6 +613,7 @@ Layer::updatePrepAssignments(UpdateHelper& sceneObjects, int depth, Camera* came
         for (SceneObject * const lightFilterSet : get(sLightFilterSetsKey)) {
             if (lightFilterSet && lightFilterSet->asA<LightFilterSet>()->
                 updatePrepLightFilter(sceneObjects, depth  + 1)) {
+                sceneObjects.addDependency(this, lightFilterSet);
                 mLightFilterSetsChanged = true;
                 changed = true;
             }
@@ -611,18 +666,22 @@ Layer::updatePrepFast(bool attributeTreeChanged,
 {
     MNRY_ASSERT_REQUIRE(!mUpdateActive);
     // early out
-    if (mUpdatePrepApplied &&
-            (sceneObjects.getDepth(this) >= depth || sceneObjects.isLeaf(this))) {
+    if (!beginUpdatePrep(sceneObjects, depth)) {
         return updateRequired();
     }
-    mUpdatePrepApplied = true;
 
-    mAttributeTreeChanged = attributeTreeChanged || mAttributeUpdateMask.any();
-    mBindingTreeChanged = bindingTreeChanged || mBindingUpdateMask.any();
+    // only raised, see SceneObject::updatePrep()
+    if (attributeTreeChanged || mAttributeUpdateMask.any()) {
+        mAttributeTreeChanged = true;
+    }
+    if (bindingTreeChanged || mBindingUpdateMask.any()) {
+        mBindingTreeChanged = true;
+    }
 
     if (mAttributeTreeChanged || mBindingTreeChanged) {
         sceneObjects.insert(this, depth);
     }
+    endUpdatePrep();
     return updateRequired();
 }
 
@@ -765,14 +824,14 @@ Layer::getChangedGeometryToRootShaders(GeometryToRootShadersMap & g2s)
         // not need to be updated. The three reasons why a geometry needs to be updated is if
         // 1) An attribute that requires a geometry update changes. Note that if an attribute
         //    changes that does not require a geometry update, special care is taken to
-        //    set the mAttributeTreeChanged flag to false.
+        //    ignore it (see Geometry::geometryUpdateRequired()).
         // 2) An attribute binding changes
         // 3) A shader requests that the geometry is updated.
         // 3 is a special case. If any change is made to a geometry's assigned material,
         // that geometry is added to mChangedOrDeformedGeometries. After this happens,
         // we check if the material requests the geometry update. See SceneContext::applyUpdates
         // and Layer::updatePrepAssignment for more details.
-        if (geom->updateRequired()) {
+        if (geom->geometryUpdateRequired()) {
             if (surfaceShaders[index]) {
                 RootShader * const rootShader = surfaceShaders[index]->asA<RootShader>();
                 g2s[geom].insert(rootShader);
@@ -843,7 +902,7 @@ Layer::clear()
     mAttributeSetMask.set(sLightFilterSetsKey.mIndex, true);
     mAttributeSetMask.set(sShadowSetsKey.mIndex, true);
     mAttributeSetMask.set(sShadowReceiverSetsKey.mIndex, true);
-    mDirty = true;
+    markDirty();
     
     mLightSetsChanged = true;
     mChangedRootShaders.clear();
@@ -73,7 +73,7 @@ LightSet::add(Light* light)
     // the set() method.
     mAttributeUpdateMask.set(sLightsKey.mIndex, true);
     mAttributeSetMask.set(sLightsKey.mIndex, true);
-    mDirty = true;
+    markDirty();
 }
 
 void
@@ -102,7 +102,7 @@ LightSet::remove(Light* light)
         // through the set() method.
         mAttributeUpdateMask.set(sLightsKey.mIndex, true);
         mAttributeSetMask.set(sLightsKey.mIndex, true);
-        mDirty = true;
+        markDirty();
     }
 }
 
@@ -157,7 +157,7 @@ LightSet::clear()
     // through the set() method.
     mAttributeUpdateMask.set(sLightsKey.mIndex, true);
     mAttributeSetMask.set(sLightsKey.mIndex, true);
-    mDirty = true;
+    markDirty();
 }
 
 } // namespace rdl2
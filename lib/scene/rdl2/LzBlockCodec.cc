@@ -0,0 +1,197 @@
+// Copyright 2023-2024 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+#include "LzBlockCodec.h"
+
+#include <scene_rdl2/common/except/exceptions.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+namespace scene_rdl2 {
+namespace rdl2 {
+
+namespace {
+
+constexpr std::size_t MIN_MATCH = 4;
+constexpr std::size_t MAX_OFFSET = 65535;
+constexpr std::size_t LAST_LITERALS = 5;     // the last bytes are always literals
+constexpr std::size_t MATCH_FIND_LIMIT = 12; // no match starts this close to the end
+constexpr unsigned HASH_BITS = 16;
+
+inline uint32_t
+read32(const unsigned char* p)
+{
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(uint32_t));
+    return v;
+}
+
+inline uint32_t
+hash32(uint32_t v)
+{
+    return (v * 2654435761u) >> (32 - HASH_BITS);
+}
+
+inline void
+writeLength(std::size_t len, std::string& dst)
+{
+    while (len >= 255) {
+        dst.push_back(static_cast<char>(255));
+        len -= 255;
+    }
+    dst.push_back(static_cast<char>(len));
+}
+
+void
+writeSequence(const unsigned char* literals, std::size_t literalLen,
+              std::size_t offset, std::size_t matchLen, std::string& dst)
+{
+    const std::size_t tokenPos = dst.size();
+    unsigned char token = static_cast<unsigned char>(std::min<std::size_t>(literalLen, 15) << 4);
+    dst.push_back(0);
+    if (literalLen >= 15) writeLength(literalLen - 15, dst);
+    dst.append(reinterpret_cast<const char*>(literals), literalLen);
+
+    if (matchLen) {
+        dst.push_back(static_cast<char>(offset & 0xff));
+        dst.push_back(static_cast<char>(offset >> 8));
+        const std::size_t len = matchLen - MIN_MATCH;
+        token |= static_cast<unsigned char>(std::min<std::size_t>(len, 15));
+        if (len >= 15) writeLength(len - 15, dst);
+    }
+    dst[tokenPos] = static_cast<char>(token);
+}
+
+[[noreturn]] void
+corrupt()
+{
+    throw except::IoError("Corrupt compressed block in RDL2 binary.");
+}
+
+inline std::size_t
+readLength(const unsigned char*& ip, const unsigned char* end)
+{
+    std::size_t len = 0;
+    unsigned char b;
+    do {
+        if (ip == end) corrupt();
+        b = *ip++;
+        len += b;
+    } while (b == 255);
+    return len;
+}
+
+} // namespace
+
+// static function
+void
+LzBlockCodec::compress(const void* src, std::size_t size, std::string& dst)
+{
+    const unsigned char* const base = static_cast<const unsigned char*>(src);
+    const unsigned char* const end = base + size;
+    const unsigned char* anchor = base;
+
+    dst.reserve(dst.size() + size + size / 255 + 16);
+
+    if (size > MATCH_FIND_LIMIT) {
+        const unsigned char* const matchLimit = end - LAST_LITERALS;
+        const unsigned char* const findLimit = end - MATCH_FIND_LIMIT;
+        std::vector<uint32_t> table(std::size_t(1) << HASH_BITS, 0);
+
+        const unsigned char* ip = base + 1;
+        while (ip < findLimit) {
+            const uint32_t seq = read32(ip);
+            uint32_t& entry = table[hash32(seq)];
+            const unsigned char* match = base + entry;
+            entry = static_cast<uint32_t>(ip - base);
+
+            if (match >= ip || static_cast<std::size_t>(ip - match) > MAX_OFFSET || read32(match) != seq) {
+                // Step faster through data that isn't matching.
+                ip += 1 + ((ip - anchor) >> 6);
+                continue;
+            }
+
+            // Extend the match backwards into the pending literals, then forwards.
+            while (ip > anchor && match > base && ip[-1] == match[-1]) {
+                --ip;
+                --match;
+            }
+            std::size_t matchLen = MIN_MATCH;
+            while (ip + matchLen < matchLimit && ip[matchLen] == match[matchLen]) {
+                ++matchLen;
+            }
+
+            writeSequence(anchor, ip - anchor, ip - match, matchLen, dst);
+            ip += matchLen;
+            anchor = ip;
+        }
+    }
+
+    writeSequence(anchor, end - anchor, 0, 0, dst);
+}
+
+// static function
+void
+LzBlockCodec::decompress(const void* src, std::size_t size, void* dst, std::size_t rawSize)
+{
+    const unsigned char* ip = static_cast<const unsigned char*>(src);
+    const unsigned char* const ipEnd = ip + size;
+    unsigned char* const opBase = static_cast<unsigned char*>(dst);
+    unsigned char* op = opBase;
+    unsigned char* const opEnd = opBase + rawSize;
+
+    while (ip < ipEnd) {
+        const unsigned char token = *ip++;
+
+        std::size_t literalLen = token >> 4;
+        if (literalLen == 15) literalLen += readLength(ip, ipEnd);
+        if (literalLen > static_cast<std::size_t>(ipEnd - ip) ||
+            literalLen > static_cast<std::size_t>(opEnd - op)) {
+            corrupt();
+        }
+        std::memcpy(op, ip, literalLen);
+        ip += literalLen;
+        op += literalLen;
+        if (ip == ipEnd) break; // the last sequence has no match
+
+        if (ipEnd - ip < 2) corrupt();
+        const std::size_t offset = ip[0] | (static_cast<std::size_t>(ip[1]) << 8);
+        ip += 2;
+        if (offset == 0 || offset > static_cast<std::size_t>(op - opBase)) corrupt();
+
+        std::size_t matchLen = token & 15;
+        if (matchLen == 15) matchLen += readLength(ip, ipEnd);
+        matchLen += MIN_MATCH;
+        if (matchLen > static_cast<std::size_t>(opEnd - op)) corrupt();
+
+        const unsigned char* match = op - offset;
+        if (offset >= matchLen) {
+            std::memcpy(op, match, matchLen);
+            op += matchLen;
+        } else {
+            // Overlapping copy repeats the last offset bytes.
+            for (std::size_t i = 0; i < matchLen; ++i) *op++ = *match++;
+        }
+    }
+
+    if (op != opEnd) corrupt();
+}
+
+// static function
+std::size_t
+LzBlockCodec::maxDecompressedSize(std::size_t size)
+{
+    constexpr std::size_t MAX_RATIO = 255;
+    if (size > std::numeric_limits<std::size_t>::max() / MAX_RATIO) {
+        return std::numeric_limits<std::size_t>::max();
+    }
+    return size * MAX_RATIO;
+}
+
+} // namespace rdl2
+} // namespace scene_rdl2
+
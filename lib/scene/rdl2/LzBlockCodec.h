@@ -0,0 +1,42 @@
+// Copyright 2023-2024 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace scene_rdl2 {
+namespace rdl2 {
+
+/**
+ * LzBlockCodec is a small, dependency free LZ77 byte codec used to compress
+ * blocks of records in RDL binary. It favours speed over ratio: matches are
+ * found through a single hash probe and encoded as LZ4 style sequences
+ *
+ *  token | literal length ext | literals | offset (2 bytes) | match length ext
+ *
+ * where the token holds 4 bits of literal length and 4 bits of match length.
+ * The last sequence of a block only holds literals. Decompression needs the
+ * uncompressed size up front, which callers store next to the block.
+ */
+class LzBlockCodec
+{
+public:
+    // Appends the compressed form of the size bytes at src to dst.
+    static void compress(const void* src, std::size_t size, std::string& dst);
+
+    // Decompresses the block at src into exactly rawSize bytes at dst.
+    // Throws except::IoError if the block is corrupt or does not decompress
+    // to rawSize bytes.
+    static void decompress(const void* src, std::size_t size, void* dst, std::size_t rawSize);
+
+    // Upper bound of the decompressed size of a valid size byte block. Every
+    // input byte expands to at most 255 output bytes (a length extension byte).
+    // Used to reject corrupt size headers before allocating the output.
+    static std::size_t maxDecompressedSize(std::size_t size);
+};
+
+} // namespace rdl2
+} // namespace scene_rdl2
+
@@ -26,7 +26,9 @@
 #include <scene_rdl2/common/except/exceptions.h>
 #include <scene_rdl2/common/platform/Platform.h>
 
+#include <filesystem>
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <string>
 #include <utility>
@@ -117,17 +119,54 @@ ObjectFactory::ObjectFactory(ClassDeclareFunc declareFunc, ObjectCreateFunc crea
     mDso(std::move(dso)),
     mDeclareFunc(declareFunc),
     mCreateFunc(createFunc),
-    mDestroyFunc(destroyFunc)
+    mDestroyFunc(destroyFunc),
+    mDeferred(false)
 {
     MNRY_ASSERT(mDeclareFunc, "ObjectFactory must have a declare function pointer!");
     MNRY_ASSERT(mCreateFunc, "ObjectFactory must have a create function pointer!");
     MNRY_ASSERT(mDestroyFunc, "ObjectFactory must have a destroy function pointer!");
 }
 
+ObjectFactory::ObjectFactory(const std::string& className, const std::string& dsoFilePath,
+                             const std::string& declaration, bool proxyModeEnabled) :
+    mDeclareFunc(nullptr),
+    mCreateFunc(proxyModeEnabled ? proxyCreate : nullptr),
+    mDestroyFunc(proxyModeEnabled ? proxyDestroy : nullptr),
+    mClassName(className),
+    mDsoFilePath(dsoFilePath),
+    mDeclaration(declaration),
+    mDeferred(!proxyModeEnabled)
+{
+    MNRY_ASSERT(!mDeclaration.empty(), "ObjectFactory must have a manifest declaration!");
+}
+
 std::string
 ObjectFactory::getSourcePath() const
 {
-    return (mDso) ? mDso->getFilePath() : std::string();
+    return (mDso) ? mDso->getFilePath() : mDsoFilePath;
+}
+
+void
+ObjectFactory::loadDso(SceneClass& sceneClass)
+{
+    std::call_once(mLoadFlag, [this, &sceneClass]() {
+        // Open the DSO the manifest entry was recorded from.
+        std::string directory = std::filesystem::path(mDsoFilePath).parent_path().string();
+        std::unique_ptr<Dso> dso(new Dso(mClassName, directory.empty() ? "." : directory, false));
+
+        // Extract the declare, create, and destroy function pointers.
+        ClassDeclareFunc declarer = dso->getDeclare();
+        ObjectCreateFunc creator = dso->getCreate();
+        ObjectDestroyFunc destroyer = dso->getDestroy();
+
+        // The DSO's objects rely on state its declare function sets up.
+        sceneClass.adoptDsoDeclaration(declarer);
+
+        mDeclareFunc = declarer;
+        mCreateFunc = creator;
+        mDestroyFunc = destroyer;
+        mDso = std::move(dso);
+    });
 }
 
 template <typename T>
@@ -184,6 +223,16 @@ ObjectFactory::createProxyFactory(const std::string& className, const std::strin
         new ObjectFactory(declarer, proxyCreate, proxyDestroy, std::move(dso)));
 }
 
+std::unique_ptr<ObjectFactory>
+ObjectFactory::createManifestFactory(const std::string& className,
+                                     const std::string& dsoFilePath,
+                                     const std::string& declaration,
+                                     bool proxyModeEnabled)
+{
+    return std::unique_ptr<ObjectFactory>(
+        new ObjectFactory(className, dsoFilePath, declaration, proxyModeEnabled));
+}
+
 } // namespace rdl2
 } // namespace scene_rdl2
 
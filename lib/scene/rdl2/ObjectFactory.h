@@ -5,9 +5,11 @@
 #pragma once
 
 #include "Dso.h"
+#include "DsoManifest.h"
 #include "Types.h"
 
 #include <memory>
+#include <mutex>
 #include <string>
 
 namespace scene_rdl2 {
@@ -25,6 +27,10 @@ namespace rdl2 {
  * The ObjectFactory also takes ownership of a Dso object, if loading symbols
  * from any DSO is required.
  *
+ * Factories created from a DsoManifest entry declare their SceneClass by
+ * replaying the recorded declarations. They only open the DSO once load() is
+ * called before the first object is created, and never in proxy mode.
+ *
  * Thread Safety:
  *  - Creating ObjectFactories for the same SceneClass from different threads
  *      simultaneously is not thread safe, because we don't enforce thread
@@ -66,6 +72,19 @@ public:
      */
     finline void destroy(SceneObject* sceneObject);
 
+    /**
+     * Opens the DSO of a factory created by createManifestFactory(), if it
+     * hasn't been opened yet, and gives the SceneClass the blind data the
+     * DSO's declare function provides. Does nothing for other factories.
+     * Must be called before create(). Thread safe.
+     *
+     * @param   sceneClass  The SceneClass declared through this factory.
+     * @throw   except::IoError         If the DSO could not be opened.
+     * @throw   except::RuntimeError    If the DSO's declarations no longer
+     *                                  match the manifest.
+     */
+    finline void load(SceneClass& sceneClass);
+
     /**
      * Returns the path to where this SceneClass came from. If the factory is a
      * DsoFactory or a ProxyFactory, it returns the file system path of the DSO
@@ -111,19 +130,52 @@ public:
      */
     static std::unique_ptr<ObjectFactory> createProxyFactory(const std::string& className, const std::string& dsoPath);
 
+    /**
+     * Create an ObjectFactory that declares from a DsoManifest entry instead
+     * of the DSO's declare function. In proxy mode objects are built in proxy
+     * objects and the DSO is never opened, otherwise the DSO is opened by
+     * load().
+     *
+     * @param   className       The SceneClass name.
+     * @param   dsoFilePath     The DSO the manifest entry was recorded from.
+     * @param   declaration     The recorded declarations (see DsoManifest).
+     * @param   proxyModeEnabled    True to create proxy objects.
+     * @return  An ObjectFactory that can declare, create, and destroy these
+     *          DSO objects.
+     */
+    static std::unique_ptr<ObjectFactory> createManifestFactory(const std::string& className,
+                                                                const std::string& dsoFilePath,
+                                                                const std::string& declaration,
+                                                                bool proxyModeEnabled);
+
 private:
     ObjectFactory(ClassDeclareFunc declareFunc, ObjectCreateFunc createFunc,
                   ObjectDestroyFunc destroyFunc, std::unique_ptr<Dso> dso = nullptr);
 
+    ObjectFactory(const std::string& className, const std::string& dsoFilePath,
+                  const std::string& declaration, bool proxyModeEnabled);
+
+    void loadDso(SceneClass& sceneClass);
+
     std::unique_ptr<Dso> mDso;
     ClassDeclareFunc mDeclareFunc;
     ObjectCreateFunc mCreateFunc;
     ObjectDestroyFunc mDestroyFunc;
+
+    // Manifest factories only.
+    std::string mClassName;
+    std::string mDsoFilePath;
+    std::string mDeclaration;
+    bool mDeferred;             // true if load() has to open the DSO
+    std::once_flag mLoadFlag;
 };
 
 SceneObjectInterface
 ObjectFactory::declare(SceneClass& sceneClass)
 {
+    if (!mDeclaration.empty()) {
+        return DsoManifest::replay(mDeclaration, sceneClass);
+    }
     return mDeclareFunc(sceneClass);
 }
 
@@ -139,6 +191,14 @@ ObjectFactory::destroy(SceneObject* sceneObject)
     mDestroyFunc(sceneObject);
 }
 
+void
+ObjectFactory::load(SceneClass& sceneClass)
+{
+    if (mDeferred) {
+        loadDso(sceneClass);
+    }
+}
+
 } // namespace rdl2
 } // namespace scene_rdl2
 
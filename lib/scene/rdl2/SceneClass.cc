@@ -7,11 +7,16 @@
 
 #include "Attribute.h"
 #include "ObjectFactory.h"
+#include "SceneContext.h"
 #include "Types.h"
 
 #include <scene_rdl2/common/except/exceptions.h>
+#include <scene_rdl2/render/util/Arena.h>
+#include <scene_rdl2/render/util/BitUtils.h>
 #include <scene_rdl2/render/util/StrUtil.h>
 
+#include <tbb/spin_mutex.h>
+
 #include <cstdlib>
 #include <memory>
 #include <sstream>
@@ -24,6 +29,84 @@ namespace rdl2 {
 /// Comment for an attribute.
 const std::string SceneClass::sComment("comment");
 
+thread_local SceneClass::StorageBatch* SceneClass::sStorageBatch = nullptr;
+
+namespace {
+
+// Storage chunks are aligned to cache lines, which are 64 bytes on all modern
+// processors.
+constexpr std::size_t STORAGE_ALIGNMENT = 64;
+
+// Storage blocks hold at least this many chunks and are at least this big.
+constexpr std::size_t STORAGE_CHUNKS_PER_BLOCK = 256;
+constexpr std::size_t STORAGE_MIN_BLOCK_SIZE = 64 * 1024;
+
+} // namespace
+
+class SceneClass::StorageAllocator
+{
+public:
+    StorageAllocator(std::size_t storageSize, const SceneContext* context) :
+        mStride(util::alignUp(std::max<std::size_t>(storageSize, 1), STORAGE_ALIGNMENT)),
+        mPool(util::alignedMallocCtorArgs<alloc::ArenaBlockPool>(CACHE_LINE_SIZE,
+              blockSize(mStride))),
+        mNext(nullptr),
+        mEnd(nullptr)
+    {
+        if (context && context->mStorageNumaNodeId != ~0u) {
+            mPool->setupNumaInfo(context->mStorageNumaNodeId,
+                                 context->mStorageAllocCallBack,
+                                 context->mStorageFreeCallBack);
+        }
+    }
+
+    ~StorageAllocator()
+    {
+        // Hand every block back, so the pool can release them all.
+        for (alloc::ArenaBlock* block : mBlocks) {
+            mPool->freeBlock(block);
+        }
+    }
+
+    // Returns a run of between 1 and count contiguous chunks, and the number
+    // of chunks in the run.
+    char* allocate(std::size_t count, std::size_t& granted)
+    {
+        MNRY_ASSERT(count > 0);
+        tbb::spin_mutex::scoped_lock lock(mMutex);
+        if (mNext == mEnd) {
+            alloc::ArenaBlock* block = mPool->allocateBlock();
+            mBlocks.push_back(block);
+            mNext = reinterpret_cast<char*>(block->mMemory);
+            mEnd = mNext + (block->mSize / mStride) * mStride;
+        }
+        granted = std::min(count, static_cast<std::size_t>(mEnd - mNext) / mStride);
+        char* run = mNext;
+        mNext += granted * mStride;
+        return run;
+    }
+
+    std::size_t getStride() const { return mStride; }
+
+private:
+    static unsigned blockSize(std::size_t stride)
+    {
+        // Large chunks get fewer per block, but every block fits one chunk.
+        std::size_t size = std::min<std::size_t>(stride * STORAGE_CHUNKS_PER_BLOCK,
+                                                 DEFAULT_ARENA_BLOCK_SIZE);
+        size = std::max(std::max(size, stride), STORAGE_MIN_BLOCK_SIZE);
+        return util::roundUpToPowerOfTwo(static_cast<uint32_t>(size));
+    }
+
+    const std::size_t mStride;
+    util::Ref<alloc::ArenaBlockPool> mPool;
+
+    tbb::spin_mutex mMutex;
+    char* mNext;
+    char* mEnd;
+    std::vector<alloc::ArenaBlock*> mBlocks;
+};
+
 SceneClass::SceneClass(SceneContext* context, const std::string& name,
                        std::unique_ptr<ObjectFactory> objectFactory) :
     mContext(context),
@@ -41,6 +124,10 @@ SceneClass::~SceneClass()
             iter != mAttributes.end(); ++iter) {
         delete *iter;
     }
+
+    // The SceneContext destroys all objects before their classes, so no
+    // object still points into the storage blocks released here.
+    mStorageAllocator.reset();
 }
 
 bool
@@ -108,13 +195,18 @@ SceneClass::computeOffsetAndSize(AttributeFlags flags)
 void*
 SceneClass::createStorage() const
 {
-    // Cache lines on all modern processors are 64 bytes.
-    const std::size_t cacheLineSize = 64;
-
-    // Allocate a chunk of memory for the attribute values. We spent the time
-    // laying out attributes nicely with respect to cache lines, so make sure
-    // to allocate this chunk with proper alignment!
-    void* storage = util::alignedMalloc(mAttributeStorageSize, cacheLineSize);
+    // Take a chunk of memory for the attribute values from the current batch
+    // if there is one for this class, otherwise straight from the allocator.
+    // Either way it is cache line aligned, which the attribute layout of
+    // computeOffsetAndSize() relies on.
+    void* storage = nullptr;
+    if (sStorageBatch) {
+        storage = sStorageBatch->next(*this);
+    }
+    if (!storage) {
+        std::size_t granted = 0;
+        storage = getStorageAllocator().allocate(1, granted);
+    }
 
     // Initialize each attribute with its default value at every timestep.
     for (AttributeConstIterator iter = mAttributes.begin();
@@ -336,8 +428,55 @@ SceneClass::destroyStorage(void* storage) const
         destroyValue(storage, attribute);
     }
 
-    // Release the memory.
-    util::alignedFree(storage);
+    // The memory itself is released in bulk with the SceneClass.
+}
+
+SceneClass::StorageAllocator&
+SceneClass::getStorageAllocator() const
+{
+    std::call_once(mStorageAllocatorOnce, [this]() {
+        MNRY_ASSERT(mComplete);
+        mStorageAllocator.reset(new StorageAllocator(mAttributeStorageSize, mContext));
+    });
+    return *mStorageAllocator;
+}
+
+SceneClass::StorageBatch::StorageBatch(const SceneClass& sceneClass, std::size_t count) :
+    mSceneClass(sceneClass),
+    mNext(nullptr),
+    mEnd(nullptr),
+    mRemaining(count),
+    mPrevious(sStorageBatch)
+{
+    sStorageBatch = this;
+}
+
+SceneClass::StorageBatch::~StorageBatch()
+{
+    MNRY_ASSERT(sStorageBatch == this);
+    sStorageBatch = mPrevious;
+}
+
+void*
+SceneClass::StorageBatch::next(const SceneClass& sceneClass)
+{
+    if (&sceneClass != &mSceneClass) {
+        return nullptr;
+    }
+
+    StorageAllocator& allocator = mSceneClass.getStorageAllocator();
+    if (mNext == mEnd) {
+        if (mRemaining == 0) {
+            return nullptr;
+        }
+        std::size_t granted = 0;
+        mNext = allocator.allocate(mRemaining, granted);
+        mEnd = mNext + granted * allocator.getStride();
+        mRemaining -= granted;
+    }
+    void* storage = mNext;
+    mNext += allocator.getStride();
+    return storage;
 }
 
 void
@@ -635,6 +774,35 @@ SceneClass::getSourcePath() const
     return mObjectFactory->getSourcePath();
 }
 
+void
+SceneClass::adoptDsoDeclaration(ClassDeclareFunc declareFunc)
+{
+    SceneClass scratch(mContext, mName, nullptr);
+    const SceneObjectInterface interface = declareFunc(scratch);
+
+    // The DSO's objects address their attributes through the keys its
+    // declare function just created, so the layout must be identical.
+    bool matches = interface == mDeclaredInterface &&
+                   scratch.mAttributes.size() == mAttributes.size() &&
+                   scratch.mAttributeStorageSize == mAttributeStorageSize;
+    for (std::size_t i = 0; matches && i < mAttributes.size(); ++i) {
+        const Attribute* declared = scratch.mAttributes[i];
+        const Attribute* recorded = mAttributes[i];
+        matches = declared->mName == recorded->mName &&
+                  declared->mType == recorded->mType &&
+                  declared->mFlags == recorded->mFlags &&
+                  declared->mOffset == recorded->mOffset;
+    }
+    if (!matches) {
+        std::stringstream errMsg;
+        errMsg << "The declarations of SceneClass '" << mName << "' in '" <<
+            getSourcePath() << "' don't match its DSO manifest entry.";
+        throw except::RuntimeError(errMsg.str());
+    }
+
+    mData = scratch.mData;
+}
+
 // Explicit instantiations of templated functions for all attribute types.
 template std::pair<uint32_t, std::size_t> SceneClass::computeOffsetAndSize<Bool>(AttributeFlags);
 template std::pair<uint32_t, std::size_t> SceneClass::computeOffsetAndSize<Int>(AttributeFlags);
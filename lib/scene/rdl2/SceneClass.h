@@ -10,11 +10,13 @@
 #include "Attribute.h"
 #include "AttributeKey.h"
 #include "ObjectFactory.h"
+#include "Symbol.h"
 #include "Types.h"
 
 #include <scene_rdl2/common/except/exceptions.h>
 
 #include <boost/type_traits/alignment_of.hpp>
+#include <tbb/concurrent_vector.h>
 
 #include <algorithm>
 #include <cstddef>
@@ -22,6 +24,7 @@
 #include <unordered_map>
 #include <unordered_set>
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <string>
 #include <utility>
@@ -251,6 +254,29 @@ public:
      */
     finline Attribute* getAttribute(const std::string& name);
 
+    /**
+     * Retrieves the full Attribute object for the attribute whose name (or
+     * alias) interns to the given Symbol. This skips hashing the name, which
+     * makes it the cheaper lookup when the same name is used over and over.
+     * The string overloads still hash the full name, only callers holding
+     * on to a Symbol get the integer lookup.
+     *
+     * @param   name    The interned name of the attribute you want.
+     * @return  A const (read-only) version of the Attribute object.
+     * @throw   except::KeyError    If there is no attribute with that name.
+     */
+    finline const Attribute* getAttribute(Symbol name) const;
+
+    /**
+     * Retrieves the full Attribute object for the attribute whose name (or
+     * alias) interns to the given Symbol.
+     *
+     * @param   name    The interned name of the attribute you want.
+     * @return  The Attribute object.
+     * @throw   except::KeyError    If there is no attribute with that name.
+     */
+    finline Attribute* getAttribute(Symbol name);
+
     /**
      * Tests whether the class has an attribute with the given
      * name.
@@ -273,6 +299,18 @@ public:
     template <typename T>
     finline AttributeKey<T> getAttributeKey(const std::string& name) const;
 
+    /**
+     * Retrieves a typed AttributeKey for the attribute whose name interns to
+     * the given Symbol. Same as the string version, minus the name hashing.
+     *
+     * @param   name    The interned name of the attribute you want.
+     * @return  A typed AttributeKey to access the value of that attribute.
+     * @throw   except::TypeError   If the templated type of the AttributeKey
+     *                              does not match the type of the attribute.
+     */
+    template <typename T>
+    finline AttributeKey<T> getAttributeKey(Symbol name) const;
+
     /**
      * Retrieves a begin iterator to the list of attributes in this SceneClass.
      * An unfortunate artifact of the implemenation is that dereferencing the
@@ -443,6 +481,7 @@ private:
     typedef std::unordered_map<std::string, Attribute*> AttributeMap;
     typedef AttributeMap::value_type AttributeMapItem;
     typedef AttributeMap::const_iterator AttributeMapConstIterator;
+    typedef std::unordered_map<Symbol, Attribute*> AttributeSymbolMap;
 
     SceneClass(SceneContext* context, const std::string& name,
                std::unique_ptr<ObjectFactory> objectFactory);
@@ -463,6 +502,46 @@ private:
     // Helper function to validate attribute name
     static bool validName(const std::string& name);
 
+    // Hands out the attribute storage chunks of all objects of this
+    // SceneClass from large blocks of an alloc::ArenaBlockPool, so the storage
+    // of same-class objects is contiguous. Chunks are never freed one by one;
+    // the blocks are released together with the SceneClass.
+    class StorageAllocator;
+
+    // Returns the storage allocator, creating it on first use. The chunk size
+    // is only known once all attributes are declared. The SceneContext's
+    // storage NUMA settings are copied at that point too.
+    StorageAllocator& getStorageAllocator() const;
+
+    // Reserves contiguous storage for a batch of new objects of this
+    // SceneClass. While it is alive, createStorage() calls on the constructing
+    // thread hand out chunks from runs of up to count chunks, instead of
+    // taking the allocator lock for each one. Batches nest; the innermost one
+    // is used.
+    class StorageBatch
+    {
+    public:
+        StorageBatch(const SceneClass& sceneClass, std::size_t count);
+        ~StorageBatch();
+
+        // Returns the next chunk, or nullptr when count chunks were handed out
+        // or the batch was reserved for another SceneClass.
+        void* next(const SceneClass& sceneClass);
+
+    private:
+        StorageBatch(const StorageBatch&) = delete;
+        StorageBatch& operator=(const StorageBatch&) = delete;
+
+        const SceneClass& mSceneClass;
+        char* mNext;
+        char* mEnd;
+        std::size_t mRemaining;
+        StorageBatch* mPrevious;
+    };
+
+    // The StorageBatch (if any) active on the calling thread.
+    static thread_local StorageBatch* sStorageBatch;
+
     // Helper function to create an attribute. All attribute declaration
     // functions end up here. The template parameter F is a callable
     // that will construct the new Attribute appropriately. It's used to curry
@@ -485,7 +564,9 @@ private:
     // to their default value.
     void* createStorage() const;
 
-    // Internal API function to destroy a storage chunk for storing attributes.
+    // Internal API function to destroy the attribute values in a storage
+    // chunk. It doesn't free the chunk itself; storage memory is only
+    // released together with the SceneClass.
     void destroyStorage(void* storage) const;
 
     // Internal API function to get an attribute value in the given storage
@@ -510,6 +591,12 @@ private:
     static finline bool setValue(const void* storage, AttributeKey<T> key,
                                  AttributeTimestep timestep, const T& value);
 
+    // Same as setValue(), but moves the value into the storage chunk instead
+    // of copying it. The value is left untouched if nothing changed.
+    template <typename T>
+    static finline bool moveValue(const void* storage, AttributeKey<T> key,
+                                  AttributeTimestep timestep, T&& value);
+
     // Helper function to compare an attribute value at a specific memory
     // location with a given value. The function returns true if equal and
     // false otherwise
@@ -534,6 +621,12 @@ private:
     // their declaration.
     void destroyValue(void* storage, const Attribute* attribute) const;
 
+    // Runs the DSO's declare function on a scratch SceneClass when a class
+    // declared from a DsoManifest opens its DSO. This sets up the DSO's own
+    // attribute keys, and the blind data it declares is copied over. Throws
+    // except::RuntimeError if the declarations differ from the manifest.
+    void adoptDsoDeclaration(ClassDeclareFunc declareFunc);
+
     // Helper function to copy an attribute value
     // dest and source are storage pointers, as for create and destroyValue
     // sourceAttr and destAttr must hold the same type.
@@ -574,6 +667,17 @@ private:
     // A lookup table for finding an attribute by name.
     AttributeMap mNameMap;
 
+    // The same lookup table keyed by interned name.
+    AttributeSymbolMap mSymbolMap;
+
+    // Every SceneObject created from this class through the SceneContext, in
+    // creation order.
+    tbb::concurrent_vector<SceneObject*> mObjects;
+
+    // The allocator for attribute storage chunks, created on first use.
+    mutable std::unique_ptr<StorageAllocator> mStorageAllocator;
+    mutable std::once_flag mStorageAllocatorOnce;
+
     // A list of group names which attributes can be grouped into. This is
     // purely for UI inspection purposes.
     GroupNamesVector mGroupNames;
@@ -597,9 +701,16 @@ private:
     friend class SceneVariables;
     friend class Camera;
 
+    // AttributeColumn walks the objects of the class.
+    template <typename T> friend class AttributeColumn;
+
     // Classes requiring access for serialization.
     friend class BinaryWriter;
     friend class BinaryReader;
+    friend class DsoManifest;
+
+    // ObjectFactory adopts the declarations of deferred DSOs.
+    friend class ObjectFactory;
 
     // Classes that need access for testing purposes.
     friend class unittest::TestSceneClass;
@@ -702,9 +813,11 @@ SceneClass::createAttribute(const std::string& name, AttributeFlags flags,
     // Add the attribute to the list of attributes and lookup map.
     mAttributes.push_back(attribute);
     mNameMap.insert(AttributeMapItem(name, attribute));
+    mSymbolMap.emplace(Symbol(name), attribute);
     // Aliases
     for (const auto &a : aliases) {
         mNameMap.insert(AttributeMapItem(a, attribute));
+        mSymbolMap.emplace(Symbol(a), attribute);
     }
 
     // Track the amount of space used to store the attribute's value. (We don't
@@ -734,6 +847,9 @@ SceneClass::createObject(const std::string& name)
         throw except::RuntimeError(errMsg.str());
     }
 
+    // Classes declared from a DsoManifest open their DSO on first use.
+    mObjectFactory->load(*this);
+
     // Delegate to the ObjectFactory.
     return mObjectFactory->create(*this, name);
 }
@@ -799,6 +915,34 @@ SceneClass::getAttribute(const std::string& name)
     return iter->second;
 }
 
+const Attribute*
+SceneClass::getAttribute(Symbol name) const
+{
+    AttributeSymbolMap::const_iterator iter = mSymbolMap.find(name);
+    if (iter == mSymbolMap.end()) {
+        std::stringstream errMsg;
+        errMsg << "No Attribute named '" <<
+            (name.isValid() ? name.str() : std::string()) <<
+            "' on SceneClass '" << mName << "'.";
+        throw except::KeyError(errMsg.str());
+    }
+    return iter->second;
+}
+
+Attribute*
+SceneClass::getAttribute(Symbol name)
+{
+    AttributeSymbolMap::const_iterator iter = mSymbolMap.find(name);
+    if (iter == mSymbolMap.end()) {
+        std::stringstream errMsg;
+        errMsg << "No Attribute named '" <<
+            (name.isValid() ? name.str() : std::string()) <<
+            "' on SceneClass '" << mName << "'.";
+        throw except::KeyError(errMsg.str());
+    }
+    return iter->second;
+}
+
 bool
 SceneClass::hasAttribute(const std::string& name)
 {
@@ -876,6 +1020,13 @@ AttributeKey<T> SceneClass::getAttributeKey(const std::string& name) const
     return AttributeKey<T>(*getAttribute(name));
 }
 
+template <typename T>
+AttributeKey<T> SceneClass::getAttributeKey(Symbol name) const
+{
+    // The AttributeKey constructor does the type check.
+    return AttributeKey<T>(*getAttribute(name));
+}
+
 template <typename T>
 const T&
 SceneClass::getValue(const void* storage, AttributeKey<T> key,
@@ -908,6 +1059,19 @@ SceneClass::setValue(const void* storage, AttributeKey<T> key,
     return true;
 }
 
+template <typename T>
+bool
+SceneClass::moveValue(const void* storage, AttributeKey<T> key,
+                      AttributeTimestep timestep, T&& value)
+{
+    T* base = reinterpret_cast<T*>((uintptr_t)storage + key.mOffset);
+    if (isEqualToValue(&(base[timestep]), value)) {
+        return false;
+    }
+    base[timestep] = std::move(value);
+    return true;
+}
+
 template <typename T>
 bool
 SceneClass::isEqualToValue(T* address, const T& value)
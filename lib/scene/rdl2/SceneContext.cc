@@ -7,6 +7,7 @@
 #include "Camera.h"
 #include "Dso.h"
 #include "DsoFinder.h"
+#include "DsoManifest.h"
 #include "Geometry.h"
 #include "GeometrySet.h"
 #include "UpdateHelper.h"
@@ -27,11 +28,12 @@
 
 #include <scene_rdl2/common/platform/Platform.h>
 #include <scene_rdl2/common/except/exceptions.h>
+#include <scene_rdl2/render/util/Files.h>
 #include <scene_rdl2/render/util/Strings.h>
 #include <scene_rdl2/render/logging/logging.h>
 
 #include <tbb/concurrent_hash_map.h>
-#include <tbb/parallel_for_each.h>
+#include <tbb/parallel_for.h>
 
 #include <algorithm>
 #include <cstddef>
@@ -40,11 +42,13 @@
 #include <mutex>
 #include <sstream>
 #include <string>
+#include <unordered_set>
 #include <vector>
 
 #include <dirent.h>
 #include <errno.h>
 #include <libgen.h>
+#include <strings.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
@@ -89,6 +93,7 @@ SceneContext::createBuiltInSceneClass(const std::string& className)
 
 SceneContext::SceneContext() :
     mProxyModeEnabled(false),
+    mStorageNumaNodeId(~0u),
     mSceneVariables(nullptr),
     mRender2World(nullptr),
     mDsoPath(DsoFinder::find())
@@ -120,6 +125,9 @@ SceneContext::SceneContext() :
 
 SceneContext::~SceneContext()
 {
+    // Background DSO opening needs the context.
+    discardSceneClassPrefetch();
+
     // Delete all scene objects.
     for (SceneObjectMap::iterator objIter = mSceneObjects.begin();
             objIter != mSceneObjects.end(); ++objIter) {
@@ -183,6 +191,61 @@ SceneContext::getSceneObject(const std::string& name)
     return reader->second;
 }
 
+const SceneObject*
+SceneContext::getSceneObject(Symbol name) const
+{
+    const SceneObject* obj = findSceneObject(name);
+    if (!obj) {
+        std::stringstream errMsg;
+        errMsg << "No SceneObject named '" <<
+            (name.isValid() ? name.str() : std::string()) <<
+            "' in the SceneContext.";
+        throw except::KeyError(errMsg.str());
+    }
+
+    return obj;
+}
+
+SceneObject*
+SceneContext::getSceneObject(Symbol name)
+{
+    SceneObject* obj = findSceneObject(name);
+    if (!obj) {
+        std::stringstream errMsg;
+        errMsg << "No SceneObject named '" <<
+            (name.isValid() ? name.str() : std::string()) <<
+            "' in the SceneContext.";
+        throw except::KeyError(errMsg.str());
+    }
+
+    return obj;
+}
+
+SceneObject*
+SceneContext::findSceneObject(Symbol name) const
+{
+    if (!name.isValid()) {
+        return nullptr;
+    }
+
+    {
+        SceneObjectSymbolMap::const_accessor reader;
+        if (mSceneObjectSymbols.find(reader, name)) {
+            return reader->second;
+        }
+    }
+
+    // First lookup of this name by Symbol. SceneObjects are never removed
+    // from the context, so the index entry never goes stale. Misses aren't
+    // recorded, the object may still be created later.
+    SceneObjectMap::const_accessor reader;
+    if (!mSceneObjects.find(reader, name.str())) {
+        return nullptr;
+    }
+    mSceneObjectSymbols.insert(SceneObjectSymbolMap::value_type(name, reader->second));
+    return reader->second;
+}
+
 const rdl2::Camera*
 SceneContext::getPrimaryCamera() const
 {
@@ -333,16 +396,26 @@ SceneContext::createSceneClass(const std::string& className)
 
         // It really does not exist yet. Let's try to create it.
         try {
-            std::string dsoPath = getDsoPath();
-            if (mProxyModeEnabled) {
-                sc.reset(new SceneClass(this, className,
-                    ObjectFactory::createProxyFactory(className, dsoPath)));
-            } else {
-                sc.reset(new SceneClass(this, className,
-                    ObjectFactory::createDsoFactory(className, dsoPath)));
+            std::string dsoFilePath;
+            bool fromManifest = false;
+            std::unique_ptr<ObjectFactory> factory =
+                takePrefetchedFactory(className, dsoFilePath, fromManifest);
+            if (!factory) {
+                factory = createDsoObjectFactory(className, dsoFilePath, fromManifest);
             }
+            sc.reset(new SceneClass(this, className, std::move(factory)));
             sc->declare();
             sc->setComplete();
+
+            // Remember what the DSO declared for the next SceneContext.
+            if (mDsoManifest && !fromManifest && !dsoFilePath.empty()) {
+                try {
+                    mDsoManifest->insert(dsoFilePath, className, true,
+                                         DsoManifest::record(*sc));
+                } catch (const except::TypeError&) {
+                    // Leave classes we can't record out of the manifest.
+                }
+            }
         } catch (...) {
             // Something went wrong when creating the SceneClass. Roll back
             // our insertion by erasing the key.
@@ -364,6 +437,146 @@ SceneContext::createSceneClass(const std::string& className)
     return writer->second;
 }
 
+std::unique_ptr<ObjectFactory>
+SceneContext::createDsoObjectFactory(const std::string& className,
+                                     std::string& dsoFilePath,
+                                     bool& fromManifest) const
+{
+    const std::string dsoPath = getDsoPath();
+
+    if (mDsoManifest) {
+        // Find the file Dso would open. This is a few stat() calls, which
+        // are much cheaper than a dlopen() on a network file system.
+        const std::string fileName = className + ((mProxyModeEnabled) ? ".so.proxy" : ".so");
+        dsoFilePath = util::findFile(fileName, (dsoPath.empty()) ? "." : dsoPath);
+
+        DsoManifest::Entry entry;
+        if (!dsoFilePath.empty() && mDsoManifest->find(dsoFilePath, entry) &&
+                entry.mValid && entry.mClassName == className) {
+            fromManifest = true;
+            return ObjectFactory::createManifestFactory(className, dsoFilePath,
+                                                        entry.mDeclaration,
+                                                        mProxyModeEnabled);
+        }
+    }
+
+    if (mProxyModeEnabled) {
+        return ObjectFactory::createProxyFactory(className, dsoPath);
+    }
+    return ObjectFactory::createDsoFactory(className, dsoPath);
+}
+
+void
+SceneContext::prefetchSceneClasses(const std::vector<std::string>& classNames)
+{
+    std::unordered_set<std::string> pending;
+    for (const std::string& className : classNames) {
+        if (className.empty() || pending.count(className)) {
+            continue;
+        }
+        SceneClassMap::const_accessor reader;
+        if (!mSceneClasses.find(reader, className)) {
+            pending.insert(className);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mPrefetchMutex);
+    for (const std::string& className : pending) {
+        {
+            std::lock_guard<std::mutex> prefetchedLock(mPrefetchedMutex);
+            if (!mPrefetchedFactories.emplace(className, PrefetchedFactory()).second) {
+                // Already opened or being opened.
+                continue;
+            }
+        }
+        mPrefetchTasks.run([this, className]() {
+            {
+                std::lock_guard<std::mutex> prefetchedLock(mPrefetchedMutex);
+                auto iter = mPrefetchedFactories.find(className);
+                if (iter == mPrefetchedFactories.end()) {
+                    // createSceneClass() got to it first.
+                    return;
+                }
+                iter->second.mState = PrefetchedFactory::OPENING;
+            }
+
+            // Only the DSO is opened here. Its declare() function runs when
+            // createSceneClass() takes it.
+            std::unique_ptr<ObjectFactory> factory;
+            std::string dsoFilePath;
+            bool fromManifest = false;
+            try {
+                factory = createDsoObjectFactory(className, dsoFilePath, fromManifest);
+            } catch (...) {
+                // Whoever actually needs the class will get the error.
+            }
+
+            std::lock_guard<std::mutex> prefetchedLock(mPrefetchedMutex);
+            auto iter = mPrefetchedFactories.find(className);
+            MNRY_ASSERT(iter != mPrefetchedFactories.end());
+            iter->second.mState = PrefetchedFactory::DONE;
+            iter->second.mFactory = std::move(factory);
+            iter->second.mDsoFilePath = std::move(dsoFilePath);
+            iter->second.mFromManifest = fromManifest;
+            mPrefetchedCondition.notify_all();
+        });
+    }
+}
+
+void
+SceneContext::waitForSceneClassPrefetch()
+{
+    std::lock_guard<std::mutex> lock(mPrefetchMutex);
+    mPrefetchTasks.wait();
+}
+
+std::unique_ptr<ObjectFactory>
+SceneContext::takePrefetchedFactory(const std::string& className,
+                                    std::string& dsoFilePath,
+                                    bool& fromManifest)
+{
+    std::unique_lock<std::mutex> lock(mPrefetchedMutex);
+    if (mPrefetchedFactories.empty()) {
+        return nullptr;
+    }
+
+    auto iter = mPrefetchedFactories.find(className);
+    if (iter == mPrefetchedFactories.end()) {
+        return nullptr;
+    }
+    if (iter->second.mState == PrefetchedFactory::PENDING) {
+        // The task may be queued behind threads which, like this one, would
+        // wait for it. Claim the entry so the task skips it.
+        mPrefetchedFactories.erase(iter);
+        return nullptr;
+    }
+
+    // Some thread is opening it. The map may rehash while we wait, so look
+    // the entry up again each time.
+    mPrefetchedCondition.wait(lock, [&]() {
+        iter = mPrefetchedFactories.find(className);
+        return iter == mPrefetchedFactories.end() ||
+               iter->second.mState == PrefetchedFactory::DONE;
+    });
+    if (iter == mPrefetchedFactories.end()) {
+        return nullptr;
+    }
+
+    std::unique_ptr<ObjectFactory> factory = std::move(iter->second.mFactory);
+    dsoFilePath = std::move(iter->second.mDsoFilePath);
+    fromManifest = iter->second.mFromManifest;
+    mPrefetchedFactories.erase(iter);
+    return factory;
+}
+
+void
+SceneContext::discardSceneClassPrefetch()
+{
+    waitForSceneClassPrefetch();
+    std::lock_guard<std::mutex> lock(mPrefetchedMutex);
+    mPrefetchedFactories.clear();
+}
+
 SceneObject*
 SceneContext::createSceneObject(const std::string& className,
                                 const std::string& objectName)
@@ -399,12 +612,12 @@ SceneContext::createSceneObject(const std::string& className,
     // if the object does not exist, multiple threads could make it here and
     // try to create the same object at the same time.
     //
-    // Acquiring a write lock here will give us exclusive access, which we can
-    // then use to check for existence again. We then have both exclusive
-    // access to the container AND we know whether it exists. If it does exist
-    // in our exclusive test, that means another thread beat us to the
-    // exclusive writer lock, created the SceneObject, and we should just return
-    // what we found.
+    // Acquiring a write lock in insertSceneObject() will give us exclusive
+    // access, which we can then use to check for existence again. We then
+    // have both exclusive access to the container AND we know whether it
+    // exists. If it does exist in our exclusive test, that means another
+    // thread beat us to the exclusive writer lock, created the SceneObject,
+    // and we should just return what we found.
     //
     // It's also important to remember that this exclusive lock is how we are
     // able to guarantee thread safety to DSO create() function. That is only
@@ -413,6 +626,113 @@ SceneContext::createSceneObject(const std::string& className,
     // Get (or create, if necessary) the SceneClass first.
     SceneClass* sc = createSceneClass(className);
 
+    return insertSceneObject(sc, className, objectName);
+}
+
+void
+SceneContext::setAttributeStorageNumaInfo(unsigned numaNodeId,
+                                          const StorageAllocCallBack& allocCallBack,
+                                          const StorageFreeCallBack& freeCallBack)
+{
+    // SceneClasses which already allocated storage would silently keep their
+    // old settings.
+    MNRY_ASSERT_REQUIRE(mSceneObjects.size() == 1,
+        "setAttributeStorageNumaInfo() must be called before creating any SceneObject");
+    mStorageNumaNodeId = numaNodeId;
+    mStorageAllocCallBack = allocCallBack;
+    mStorageFreeCallBack = freeCallBack;
+}
+
+std::string
+SceneContext::getDsoManifestPath() const
+{
+    return (mDsoManifest) ? mDsoManifest->getFilePath() : std::string();
+}
+
+void
+SceneContext::setDsoManifestPath(const std::string& filePath)
+{
+    discardSceneClassPrefetch();
+    if (filePath.empty()) {
+        mDsoManifest.reset();
+    } else {
+        mDsoManifest.reset(new DsoManifest(filePath));
+    }
+}
+
+void
+SceneContext::saveDsoManifest()
+{
+    if (!mDsoManifest || !mDsoManifest->isDirty()) {
+        return;
+    }
+    try {
+        mDsoManifest->save();
+    } catch (const except::IoError& e) {
+        Logger::warn(e.what());
+    }
+}
+
+std::vector<SceneObject*>
+SceneContext::createSceneObjects(const std::string& className,
+                                 const std::vector<std::string>& objectNames)
+{
+    if (className.empty()) {
+        throw except::ValueError("Cannot create a SceneObject with an empty class name.");
+    }
+    for (const std::string& objectName : objectNames) {
+        if (objectName.empty()) {
+            throw except::ValueError("Cannot create a SceneObject with an empty object name.");
+        }
+    }
+
+    std::vector<SceneObject*> objects(objectNames.size(), nullptr);
+    if (className == "SceneVariables") {
+        for (std::size_t i = 0; i < objectNames.size(); ++i) {
+            objects[i] = createSceneObject(className, objectNames[i]);
+        }
+        return objects;
+    }
+
+    // Reader pass: pick up the objects that already exist, so we only reserve
+    // storage for the ones we will most likely create.
+    std::vector<std::size_t> pending;
+    pending.reserve(objectNames.size());
+    for (std::size_t i = 0; i < objectNames.size(); ++i) {
+        SceneObjectMap::const_accessor reader;
+        if (mSceneObjects.find(reader, objectNames[i])) {
+            verifyMatchingSceneClass(className, reader->second);
+            objects[i] = reader->second;
+        } else {
+            pending.push_back(i);
+        }
+    }
+    if (pending.empty()) {
+        return objects;
+    }
+
+    SceneClass* sc = createSceneClass(className);
+
+    // mSceneObjects is not rehashed for the batch up front: rehash() is not
+    // safe while other threads insert, and this function may run concurrently.
+
+    // Every object created on this thread while the batch is alive takes its
+    // attribute storage from contiguous runs reserved up front. Chunks left
+    // over because another thread (or a duplicate name in the batch) won the
+    // insertion race simply go unused.
+    SceneClass::StorageBatch storageBatch(*sc, pending.size());
+
+    for (std::size_t i : pending) {
+        objects[i] = insertSceneObject(sc, className, objectNames[i]);
+    }
+
+    return objects;
+}
+
+SceneObject*
+SceneContext::insertSceneObject(SceneClass* sc, const std::string& className,
+                                const std::string& objectName)
+{
     // Writer lock in scope until the end of the function.
     SceneObjectMap::accessor writer;
 
@@ -437,6 +757,10 @@ SceneContext::createSceneObject(const std::string& className,
         // it should be safe to go ahead with the insert.
         MNRY_ASSERT(obj, "SceneObject should never be invalid prior to insertion.");
         writer->second = obj;
+        sc->mObjects.push_back(obj);
+
+        // New objects are dirty, so they go in the journal for delta encoding.
+        obj->markDirty();
 
         // The containers that are below are not thread safe versions and are not protected
         // by the mSceneObjects write lock since tbb locks per bucket and not per container.
@@ -541,40 +865,25 @@ SceneContext::applyUpdates(Layer * const layer)
         }
     }
 
-    // Update all leaves
-    int s = mSceneObjectUpdateGraph.size();
-    if (s == 0){
-        Logger::info("There is no leaf scene object need to be updated");
+    // Update all objects from the leaves up. Each object is updated as soon as
+    // the objects it depends on are done, independent of its depth.
+    const size_t s = mSceneObjectUpdateGraph.getObjectCount();
+    if (s == 0) {
+        Logger::info("There is no scene object need to be updated");
     } else if (s == 1) {
-        Logger::info("Updating 1 leaf scene object...");
+        Logger::info("Updating 1 scene object...");
     } else {
-        Logger::info("Updating ", s, " leaf scene objects...");
-    } 
+        Logger::info("Updating ", s, " scene objects...");
+    }
 
-    tbb::parallel_for_each(mSceneObjectUpdateGraph.cbegin(), mSceneObjectUpdateGraph.cend(),
-            [&] (SceneObject* const obj)
+    const size_t outOfOrder = mSceneObjectUpdateGraph.parallelForEach([&] (SceneObject* const obj)
     {
         obj->debug("Updating");
         obj->update();
     });
-
-    // Update the objects from bottom up
-    for (int i = mSceneObjectUpdateGraph.getMaxDepth()-1; i >= 0; --i) {
-        int s = mSceneObjectUpdateGraph.size(i);
-        if (s == 0){
-            Logger::info("There is no scene object need to be updated at level ", i);
-        } else if (s == 1) {
-            Logger::info("Updating 1 scene object at level ", i, "...");
-        } else {
-            Logger::info("Updating ", s, " scene objects at level ", i, "...");
-        }
-
-        tbb::parallel_for_each(mSceneObjectUpdateGraph.cbegin(i), mSceneObjectUpdateGraph.cend(i),
-                [&] (SceneObject* const obj)
-        {
-            obj->debug("Updating");
-            obj->update();
-        });
+    if (outOfOrder != 0) {
+        Logger::error("The scene object dependencies form a cycle, ", outOfOrder,
+                      " scene objects were updated in depth order instead");
     }
 
     // Changes in a shader's requested primitive attributes require updating
@@ -713,44 +1022,24 @@ SceneContext::getUpdatedOrDeformedGeometrySets(Layer * const layer,
 void
 SceneContext::commitAllChanges()
 {
-    std::for_each(mSceneObjects.begin(), mSceneObjects.end(),
-    [](const SceneObjectMapItem& item) {
-        item.second->commitChanges();
-    });
+    // Only objects in the journal can have uncommitted changes.
+    for (SceneObject* obj : mDirtyObjectJournal) {
+        obj->commitChanges();
+        obj->mInDirtyJournal = false;
+    }
+    mDirtyObjectJournal.clear();
 }
 
 void
 SceneContext::loadAllSceneClasses()
 {
+    // Split the DSO path into its directories.
+    std::vector<std::string> directories;
     std::string remaining(getDsoPath());
     while (!remaining.empty()) {
         // Grab the next path entry.
         std::size_t colonPos = remaining.find_first_of(':');
-        std::string directory = remaining.substr(0, colonPos);
-        std::filesystem::path p(directory);
-        if (std::filesystem::exists(p)) {
-            for (auto const& dirEntry : std::filesystem::directory_iterator(p)) {
-                // If the file is a valid DSO, then create a SceneClass from it.
-                if (Dso::isValidDso(dirEntry.path().string(), mProxyModeEnabled)) {
-                    // Class name is the file name without ".so" (or
-                    // ".so.proxy" in proxy mode).
-                    std::string className;
-                    if (mProxyModeEnabled) {
-                        className = dirEntry.path().stem().stem().string();
-                    } else {
-                        className = dirEntry.path().stem().string();
-                    }
-
-                    try {
-                        createSceneClass(className);
-                    } catch (...) {
-                        // Swallow exceptions here. If something was wrong with
-                        // the declare() function, just move on to the next
-                        // SceneClass.
-                    }
-                }
-            }
-        }
+        directories.push_back(remaining.substr(0, colonPos));
 
         // Move to the next path entry.
         if (colonPos != std::string::npos) {
@@ -759,6 +1048,83 @@ SceneContext::loadAllSceneClasses()
             remaining = "";
         }
     }
+
+    // List the directories in parallel. On network file systems each listing
+    // is a round trip to the server.
+    std::vector<std::vector<std::string>> listings(directories.size());
+    tbb::parallel_for(std::size_t(0), directories.size(), [&](std::size_t i) {
+        std::filesystem::path p(directories[i]);
+        if (std::filesystem::exists(p)) {
+            for (auto const& dirEntry : std::filesystem::directory_iterator(p)) {
+                listings[i].push_back(dirEntry.path().string());
+            }
+        }
+    });
+
+    // Only files with the DSO extension of the current mode can be RDL DSOs.
+    const std::string extension = (mProxyModeEnabled) ? ".so.proxy" : ".so";
+    std::vector<std::string> candidates;
+    for (const auto& listing : listings) {
+        for (const std::string& filePath : listing) {
+            if (filePath.size() > extension.size() &&
+                    strcasecmp(filePath.c_str() + filePath.size() - extension.size(),
+                               extension.c_str()) == 0) {
+                candidates.push_back(filePath);
+            }
+        }
+    }
+
+    // Ask the DSO manifest about the candidates in parallel, it only stat()s
+    // them, so files it knows about aren't dlopen()'d.
+    std::vector<char> known(candidates.size(), 0);
+    std::vector<char> valid(candidates.size(), 0);
+    if (mDsoManifest) {
+        tbb::parallel_for(std::size_t(0), candidates.size(), [&](std::size_t i) {
+            DsoManifest::Entry entry;
+            if (mDsoManifest->find(candidates[i], entry)) {
+                known[i] = 1;
+                valid[i] = entry.mValid;
+            }
+        });
+    }
+
+    // dlopen() the rest one at a time. It runs the static initializers of
+    // the DSO and its dependencies, which needn't be thread safe.
+    for (std::size_t i = 0; i < candidates.size(); ++i) {
+        if (known[i]) {
+            continue;
+        }
+        valid[i] = Dso::isValidDso(candidates[i], mProxyModeEnabled);
+        if (mDsoManifest && !valid[i]) {
+            mDsoManifest->insert(candidates[i], std::string(), false, std::string());
+        }
+    }
+
+    // Create the SceneClasses in path order, so the declare() functions run
+    // in the same order they always have.
+    for (std::size_t i = 0; i < candidates.size(); ++i) {
+        if (!valid[i]) {
+            continue;
+        }
+
+        // Class name is the file name without ".so" (or ".so.proxy" in proxy
+        // mode).
+        std::filesystem::path p(candidates[i]);
+        std::string className;
+        if (mProxyModeEnabled) {
+            className = p.stem().stem().string();
+        } else {
+            className = p.stem().string();
+        }
+
+        try {
+            createSceneClass(className);
+        } catch (...) {
+            // Swallow exceptions here. If something was wrong with
+            // the declare() function, just move on to the next
+            // SceneClass.
+        }
+    }
 }
 
 void
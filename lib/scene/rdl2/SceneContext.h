@@ -8,18 +8,31 @@
 #include "SceneObject.h"
 #include "SceneContext.h"
 #include "SceneVariables.h"
+#include "Symbol.h"
 #include "Types.h"
 
 #include <scene_rdl2/render/util/Alloc.h>
 #include <scene_rdl2/common/platform/Platform.h>
 #include <tbb/concurrent_hash_map.h>
+#include <tbb/concurrent_vector.h>
+#include <tbb/task_group.h>
 
+#include <condition_variable>
+#include <functional>
+#include <memory>
 #include <mutex>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace scene_rdl2 {
 namespace rdl2 {
 
+// Forward declarations necessary for unit tests.
+namespace unittest {
+    class TestSceneContext;
+}
+
 /**
  * The SceneContext represents all the data for a specific scene in RDL. This
  * includes all the objects in the scene (SceneObjects) as well as their types
@@ -60,6 +73,13 @@ private:
     typedef tbb::concurrent_hash_map<std::string, SceneObject*> SceneObjectMap;
     typedef SceneObjectMap::value_type SceneObjectMapItem;
 
+    struct SymbolHashCompare
+    {
+        static std::size_t hash(Symbol symbol) { return symbol.id(); }
+        static bool equal(Symbol a, Symbol b) { return a == b; }
+    };
+    typedef tbb::concurrent_hash_map<Symbol, SceneObject*, SymbolHashCompare> SceneObjectSymbolMap;
+
 public:
     // need access to underlaying container for random access to make
     // code parallel.
@@ -73,6 +93,7 @@ public:
     typedef std::function<void(SceneObject *)> SceneObjectCallback;
     typedef std::vector<const RenderOutput *> RenderOutputVector;
     typedef std::vector<Camera*>::const_iterator CameraConstIterator;
+    typedef tbb::concurrent_vector<SceneObject*> DirtyObjectJournal;
 
     /// Construct a new SceneContext.
     SceneContext();
@@ -96,6 +117,10 @@ public:
     /// Retrieves whether or not the SceneContext is currently in proxy mode.
     finline bool getProxyModeEnabled() const;
 
+    /// Retrieves the DSO manifest file, or an empty string if the
+    /// SceneContext doesn't use a DSO manifest.
+    std::string getDsoManifestPath() const;
+
     /// Retrieves the SceneVariables object.
     finline const SceneVariables& getSceneVariables() const;
 
@@ -114,15 +139,32 @@ public:
     /// Retrieves a SceneObject by its name.
     const SceneObject* getSceneObject(const std::string& name) const;
 
+    /// Retrieves a SceneObject by its interned name. After the first lookup
+    /// of a name this skips hashing it, which pays off when the same names are
+    /// looked up repeatedly. Lookups by string still hash the full name.
+    const SceneObject* getSceneObject(Symbol name) const;
+
     /// Checks for existence of a SceneObject with the given name.
     finline bool sceneObjectExists(const std::string& name) const;
 
+    /// Checks for existence of a SceneObject with the given interned name.
+    finline bool sceneObjectExists(Symbol name) const;
+
     /// Returns a begin iterator to the SceneObjects.
     finline SceneObjectConstIterator beginSceneObject() const;
 
     /// Returns an end iterator to the SceneObjects.
     finline SceneObjectConstIterator endSceneObject() const;
 
+    /**
+     * Returns the SceneObjects which became dirty (were created or had an
+     * attribute or binding changed) since the last commitAllChanges(), in the
+     * order they first became dirty. Each object appears at most once. An
+     * object whose changes were committed individually may still be listed,
+     * so check SceneObject::isDirty() if that matters.
+     */
+    finline const DirtyObjectJournal& getDirtyObjectJournal() const;
+
     finline GeometryConstIterator beginGeometry() const;
     finline GeometryConstIterator endGeometry() const;
     finline GeometrySetConstIterator beginGeometrySet() const;
@@ -187,12 +229,62 @@ public:
      */
     finline void setProxyModeEnabled(bool enabled);
 
+    /**
+     * Sets the DsoManifest file used to cache DSO declarations, and loads it.
+     * An empty path disables the manifest, which is the default.
+     *
+     * With a manifest, createSceneClass() declares a DSO SceneClass from the
+     * manifest entry of its DSO when the entry is fresh, and records the
+     * declarations of the DSOs it does open. In proxy mode such classes never
+     * open their DSO; otherwise it is opened when their first object is
+     * created, and until then getDataPtr() finds no blind data on them.
+     * loadAllSceneClasses() also skips dlopen() for files the manifest knows
+     * aren't RDL DSOs. What the manifest learns is only written back by
+     * saveDsoManifest(); anything unsaved is dropped when the path changes
+     * or the SceneContext is destroyed.
+     *
+     * @param   filePath    The manifest file, see DsoManifest::defaultFilePath().
+     */
+    void setDsoManifestPath(const std::string& filePath);
+
+    /**
+     * Saves the DSO manifest if it learned anything since it was loaded or
+     * last saved. Failures are only logged, as the manifest is just a cache.
+     */
+    void saveDsoManifest();
+
+    typedef std::function<void*(std::size_t size, std::size_t alignment)> StorageAllocCallBack;
+    typedef std::function<void(void* addr, std::size_t size)> StorageFreeCallBack;
+
+    /**
+     * Places SceneObject attribute storage on a NUMA node. Each SceneClass
+     * allocates the storage of its objects in large blocks, and those blocks
+     * will be allocated and freed through the given callbacks (see
+     * alloc::ArenaBlockPool::setupNumaInfo()).
+     *
+     * Each SceneClass copies these settings when it creates the storage of
+     * its first object, and ignores any later call. So call this right after
+     * constructing the context, before creating any SceneObject; it asserts
+     * that only the __SceneVariables__ object exists. That object is created
+     * by the constructor, so its storage never uses these callbacks.
+     *
+     * @param   numaNodeId      The NUMA node the callbacks allocate from.
+     * @param   allocCallBack   Allocates size bytes with the given alignment.
+     * @param   freeCallBack    Frees memory returned by allocCallBack.
+     */
+    void setAttributeStorageNumaInfo(unsigned numaNodeId,
+                                     const StorageAllocCallBack& allocCallBack,
+                                     const StorageFreeCallBack& freeCallBack);
+
     /// Retrieves a mutable reference to the SceneVariables object.
     finline SceneVariables& getSceneVariables();
 
     /// Retrieves a mutable SceneObject by its name.
     SceneObject* getSceneObject(const std::string& name);
 
+    /// Retrieves a mutable SceneObject by its interned name.
+    SceneObject* getSceneObject(Symbol name);
+
     /// Sets the render to world transform
     void setRender2World(const Mat4d *render2World);
 
@@ -214,6 +306,30 @@ public:
      */
     SceneClass* createSceneClass(const std::string& className);
 
+    /**
+     * Starts opening the DSOs of the named SceneClasses on the TBB thread
+     * pool and returns immediately, so they load while the caller carries on
+     * (for example parsing the scene file that named them). Names of classes
+     * which already exist are skipped.
+     *
+     * Nothing is added to the SceneContext here. createSceneClass() still
+     * creates the SceneClass and runs its declare() function on the calling
+     * thread, it just takes the DSO opened here (waiting for it if it is
+     * still being opened). So names which turn out not to be needed only
+     * cost opening their DSO. Failures are ignored here; createSceneClass()
+     * tries again and throws as usual.
+     *
+     * Changing the DSO path, proxy mode or DSO manifest waits for the
+     * prefetch and drops the DSOs it opened.
+     *
+     * @param   classNames  The SceneClasses likely to be needed soon.
+     */
+    void prefetchSceneClasses(const std::vector<std::string>& classNames);
+
+    /// Waits until the DSOs of all SceneClasses passed to
+    /// prefetchSceneClasses() have been opened or have failed to open.
+    void waitForSceneClassPrefetch();
+
     /**
      * Create a SceneObject from the given SceneClass name with the given
      * object name.
@@ -233,6 +349,22 @@ public:
      */
     SceneObject* createSceneObject(const std::string& className, const std::string& objectName);
 
+    /**
+     * Create many SceneObjects of the same SceneClass at once. This behaves
+     * like calling createSceneObject() for each name, but the attribute
+     * storage of all new objects comes from a single allocation, and the
+     * SceneClass is looked up only once. It is safe to call concurrently
+     * from several threads, with overlapping names or not.
+     *
+     * @param   className   The name of the SceneClass that the objects will
+     *                      be created from.
+     * @param   objectNames The names of the objects.
+     * @return  The new or existing SceneObject for each name, in the same
+     *          order as objectNames.
+     */
+    std::vector<SceneObject*> createSceneObjects(const std::string& className,
+                                                 const std::vector<std::string>& objectNames);
+
     /**
      * Calls update() on any of the following that are modified: SceneVariables,
      * the active Camera, the supplied Layer, and assigned SceneObjects and
@@ -294,7 +426,8 @@ public:
     /**
      * Clears all flags on all attributes of all objects that are tracking
      * what has changed. This effectively puts the SceneContext in its "base"
-     * state, where nothing has changed.
+     * state, where nothing has changed. Only the objects in the dirty object
+     * journal are visited, and the journal is emptied.
      */
     void commitAllChanges();
 
@@ -347,6 +480,34 @@ private:
     template <typename T>
     void createBuiltInSceneClass(const std::string& className);
 
+    // Creates the named SceneObject under the mSceneObjects writer lock if it
+    // doesn't exist yet, and returns the new or existing object.
+    SceneObject* insertSceneObject(SceneClass* sc, const std::string& className,
+                                   const std::string& objectName);
+
+    // Returns the SceneObject with the given interned name, or null if there
+    // is none. Adds the name to mSceneObjectSymbols on its first hit.
+    SceneObject* findSceneObject(Symbol name) const;
+
+    // Creates the ObjectFactory for a DSO SceneClass, from the DSO manifest
+    // if it has a fresh entry (fromManifest is then set). If there is a
+    // manifest, dsoFilePath is set to the DSO its entry belongs to.
+    std::unique_ptr<ObjectFactory> createDsoObjectFactory(const std::string& className,
+                                                          std::string& dsoFilePath,
+                                                          bool& fromManifest) const;
+
+    // Takes the ObjectFactory prefetchSceneClasses() opened for className,
+    // waiting for it if it is being opened. Returns null if there is none,
+    // opening it failed, or its task hasn't started yet (the caller then
+    // opens the DSO itself rather than wait behind other tasks).
+    std::unique_ptr<ObjectFactory> takePrefetchedFactory(const std::string& className,
+                                                         std::string& dsoFilePath,
+                                                         bool& fromManifest);
+
+    // Waits for the prefetch and drops the ObjectFactories nobody took, as
+    // they were opened with the DSO settings which are about to change.
+    void discardSceneClassPrefetch();
+
     // Computes the fast time rescaling coefficients for use by interpolated get().
     // No interpolated gets should be happening on other threads while these are updated.
     void computeTimeRescalingCoeffs(float shutterOpen, float shutterClose, const std::vector<float> &motionSteps);
@@ -360,6 +521,15 @@ private:
     // object factory instead of a DSO factory.
     bool mProxyModeEnabled;
 
+    // Cached DSO declarations, or null if the manifest is disabled.
+    std::unique_ptr<DsoManifest> mDsoManifest;
+
+    // NUMA placement of attribute storage blocks. ~0 means no NUMA node, in
+    // which case the callbacks are unused.
+    unsigned mStorageNumaNodeId;
+    StorageAllocCallBack mStorageAllocCallBack;
+    StorageFreeCallBack mStorageFreeCallBack;
+
     // The map of SceneClass names to SceneClasses. It owns all the SceneClass
     // pointers it contains and is responsible for destroying them.
     SceneClassMap mSceneClasses;
@@ -368,6 +538,16 @@ private:
     // pointers it contains and is responsible for destroying them.
     SceneObjectMap mSceneObjects;
 
+    // The same SceneObjects keyed by interned name. It's an observational
+    // index; mSceneObjects owns the objects. Names are only added on their
+    // first lookup by Symbol, so creating objects doesn't intern their names.
+    mutable SceneObjectSymbolMap mSceneObjectSymbols;
+
+    // SceneObjects dirtied since the last commitAllChanges(). SceneObjects
+    // append themselves the first time they become dirty, possibly from
+    // several threads at once when different objects are updated concurrently.
+    DirtyObjectJournal mDirtyObjectJournal;
+
     // Quick access to the SceneVariables singleton object. This is just an
     // observational pointer. The owner of the SceneVariables object is the
     // SceneObject map.
@@ -411,11 +591,34 @@ private:
     friend class SceneVariables;
     friend class Camera;
 
+    // SceneClass reads the attribute storage NUMA placement.
+    friend class SceneClass;
+
+    // Inspects the update graph recorded by applyUpdates().
+    friend class unittest::TestSceneContext;
+
     // Mutex to sync write access to thread unsafe vectors like mGeometries only in
     // conditioning time. Those vectors will remain lock free for reading and reading / writing
     // at the same time is not allowed or protected in any way
     mutable std::mutex mCreateSceneObjectMutex;
 
+    // DSOs being opened in the background by prefetchSceneClasses(). The
+    // task group is guarded by mPrefetchMutex, the factories by
+    // mPrefetchedMutex.
+    struct PrefetchedFactory
+    {
+        enum State { PENDING, OPENING, DONE };
+        State mState = PENDING;
+        std::unique_ptr<ObjectFactory> mFactory; // null if opening failed
+        std::string mDsoFilePath;
+        bool mFromManifest = false;
+    };
+    std::mutex mPrefetchMutex;
+    tbb::task_group mPrefetchTasks;
+    std::mutex mPrefetchedMutex;
+    std::condition_variable mPrefetchedCondition;
+    std::unordered_map<std::string, PrefetchedFactory> mPrefetchedFactories;
+
     RenderOutputVector mRenderOutputs;
     std::string mDsoPath;
 
@@ -434,6 +637,7 @@ SceneContext::getDsoPath() const
 void
 SceneContext::setDsoPath(const std::string& dsoPath)
 {
+    discardSceneClassPrefetch();
     mDsoPath = dsoPath;
 }
 
@@ -446,6 +650,7 @@ SceneContext::getProxyModeEnabled() const
 void
 SceneContext::setProxyModeEnabled(bool enabled)
 {
+    discardSceneClassPrefetch();
     mProxyModeEnabled = enabled;
 }
 
@@ -487,6 +692,12 @@ SceneContext::sceneObjectExists(const std::string& name) const
     return mSceneObjects.find(reader, name);
 }
 
+bool
+SceneContext::sceneObjectExists(Symbol name) const
+{
+    return findSceneObject(name) != nullptr;
+}
+
 SceneContext::SceneObjectConstIterator
 SceneContext::beginSceneObject() const
 {
@@ -499,6 +710,12 @@ SceneContext::endSceneObject() const
     return mSceneObjects.end();
 }
 
+const SceneContext::DirtyObjectJournal&
+SceneContext::getDirtyObjectJournal() const
+{
+    return mDirtyObjectJournal;
+}
+
 SceneContext::GeometryConstIterator
 SceneContext::beginGeometry() const
 {
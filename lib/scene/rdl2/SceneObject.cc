@@ -80,9 +80,12 @@ SceneObject::SceneObject(const SceneClass& sceneClass, const std::string& name)
     mBindingUpdateMask(sceneClass.mAttributes.size()),
     mUpdateActive(false),
     mDirty(true),
-    mUpdatePrepApplied(false),
+    mInDirtyJournal(false),
+    mChangeCount(0),
+    mUpdatePrepState(UPDATE_PREP_NONE),
     mAttributeTreeChanged(false),
     mBindingTreeChanged(false),
+    mGeometryUpdateSkipped(false),
     mUpdateRequested(false)
 {
     mAttributeStorage = mSceneClass.createStorage();
@@ -114,6 +117,19 @@ SceneObject::update()
 {
 }
 
+void
+SceneObject::journalDirty()
+{
+    // SceneClasses built without a SceneContext (unit tests, standalone
+    // tools) have no journal to record into.
+    SceneContext* context = mSceneClass.mContext;
+    if (!context) {
+        return;
+    }
+    mInDirtyJournal = true;
+    context->mDirtyObjectJournal.push_back(this);
+}
+
 template <typename T, typename SET>
 void
 getBindingTransitiveClosureImpl(T * parentObj, SET & result)
@@ -191,7 +207,36 @@ SceneObject::set(AttributeKey<T> key, const T& value)
     if (changed) {
         mAttributeSetMask.set(key.mIndex, true);
         mAttributeUpdateMask.set(key.mIndex, true);
-        mDirty = true;
+        markDirty();
+    }
+}
+
+template <typename T>
+void
+SceneObject::set(AttributeKey<T> key, T&& value)
+{
+    if (!mUpdateActive) {
+        std::stringstream errMsg;
+        errMsg << "Attribute '" << mSceneClass.getAttribute(key)->getName() <<
+            "' of SceneObject '" << mName << "' can only be set between"
+            " beginUpdate() and endUpdate() calls.";
+        throw except::RuntimeError(errMsg.str());
+    }
+
+    // Every timestep except the last one needs its own copy.
+    int timestep = TIMESTEP_BEGIN;
+    bool changed = false;
+    while (key.isBlurrable() && timestep < NUM_TIMESTEPS - 1) {
+        changed |= SceneClass::setValue(mAttributeStorage, key, static_cast<AttributeTimestep>(timestep), value);
+        ++timestep;
+    }
+    changed |= SceneClass::moveValue(mAttributeStorage, key, static_cast<AttributeTimestep>(timestep),
+                                     std::move(value));
+
+    if (changed) {
+        mAttributeSetMask.set(key.mIndex, true);
+        mAttributeUpdateMask.set(key.mIndex, true);
+        markDirty();
     }
 }
 
@@ -230,7 +275,7 @@ SceneObject::setSequenceContainer(AttributeKey<Container> key, const Container&
     if (changed) {
         mAttributeSetMask.set(key.mIndex, true);
         mAttributeUpdateMask.set(key.mIndex, true);
-        mDirty = true;
+        markDirty();
     }
 }
 
@@ -248,6 +293,20 @@ SceneObject::set(AttributeKey<SceneObjectIndexable> key, const SceneObjectIndexa
     setSequenceContainer(key, value);
 }
 
+template <>
+void
+SceneObject::set(AttributeKey<SceneObjectVector> key, SceneObjectVector&& value)
+{
+    setSequenceContainer(key, value);
+}
+
+template <>
+void
+SceneObject::set(AttributeKey<SceneObjectIndexable> key, SceneObjectIndexable&& value)
+{
+    setSequenceContainer(key, value);
+}
+
 void
 SceneObject::set(AttributeKey<SceneObject*> key, SceneObject* value)
 {
@@ -279,7 +338,7 @@ SceneObject::set(AttributeKey<SceneObject*> key, SceneObject* value)
     if (changed) {
         mAttributeSetMask.set(key.mIndex, true);
         mAttributeUpdateMask.set(key.mIndex, true);
-        mDirty = true;
+        markDirty();
     }
 }
 
@@ -303,7 +362,31 @@ SceneObject::set(AttributeKey<T> key, const T& value, AttributeTimestep timestep
     if (SceneClass::setValue(mAttributeStorage, key, timestep, value)) {
         mAttributeSetMask.set(key.mIndex, true);
         mAttributeUpdateMask.set(key.mIndex, true);
-        mDirty = true;
+        markDirty();
+    }
+}
+
+template <typename T>
+void
+SceneObject::set(AttributeKey<T> key, T&& value, AttributeTimestep timestep)
+{
+    if (!mUpdateActive) {
+        std::stringstream errMsg;
+        errMsg << "Attribute '" << mSceneClass.getAttribute(key)->getName() <<
+            "' of SceneObject '" << mName << "' can only be set between"
+            " beginUpdate() and endUpdate() calls.";
+        throw except::RuntimeError(errMsg.str());
+    }
+
+    // If the attribute isn't blurrable, it's constant at all timesteps.
+    if (!key.isBlurrable()) {
+        timestep = TIMESTEP_BEGIN;
+    }
+
+    if (SceneClass::moveValue(mAttributeStorage, key, timestep, std::move(value))) {
+        mAttributeSetMask.set(key.mIndex, true);
+        mAttributeUpdateMask.set(key.mIndex, true);
+        markDirty();
     }
 }
 
@@ -340,7 +423,7 @@ SceneObject::setSequenceContainer(AttributeKey<Container> key, const Container&
     if (SceneClass::setValue(mAttributeStorage, key, timestep, value)) {
         mAttributeSetMask.set(key.mIndex, true);
         mAttributeUpdateMask.set(key.mIndex, true);
-        mDirty = true;
+        markDirty();
     }
 }
 
@@ -358,6 +441,20 @@ SceneObject::set(AttributeKey<SceneObjectIndexable> key, const SceneObjectIndexa
     setSequenceContainer(key, value, timestep);
 }
 
+template <>
+void
+SceneObject::set(AttributeKey<SceneObjectVector> key, SceneObjectVector&& value, AttributeTimestep timestep)
+{
+    setSequenceContainer(key, value, timestep);
+}
+
+template <>
+void
+SceneObject::set(AttributeKey<SceneObjectIndexable> key, SceneObjectIndexable&& value, AttributeTimestep timestep)
+{
+    setSequenceContainer(key, value, timestep);
+}
+
 void
 SceneObject::set(AttributeKey<SceneObject*> key, SceneObject* value, AttributeTimestep timestep)
 {
@@ -387,7 +484,7 @@ SceneObject::set(AttributeKey<SceneObject*> key, SceneObject* value, AttributeTi
     if (SceneClass::setValue(mAttributeStorage, key, timestep, value)) {
         mAttributeSetMask.set(key.mIndex, true);
         mAttributeUpdateMask.set(key.mIndex, true);
-        mDirty = true;
+        markDirty();
     }
 }
 
@@ -581,7 +678,7 @@ SceneObject::setBinding(uint32_t index, bool bindable,
     mBindings[index] = sceneObject;
     mBindingSetMask.set(index, true);
     mBindingUpdateMask.set(index, true);
-    mDirty = true;
+    markDirty();
 }
 
 template <typename T>
@@ -627,7 +724,7 @@ SceneObject::copyValues(const Attribute& attr, const SceneObject& source)
     if (changed) {
         mAttributeSetMask.set(attr.mIndex, true);
         mAttributeUpdateMask.set(attr.mIndex, true);
-        mDirty = true;
+        markDirty();
     }
 }
 
@@ -736,6 +833,74 @@ template void SceneObject::set(AttributeKey<Mat4fVector>, const Mat4fVector&, At
 template void SceneObject::set(AttributeKey<Mat4dVector>, const Mat4dVector&, AttributeTimestep);
 // SceneObjectVector specialized above.
 
+template void SceneObject::set(AttributeKey<Bool>, Bool&&);
+template void SceneObject::set(AttributeKey<Int>, Int&&);
+template void SceneObject::set(AttributeKey<int64_t>, Long&&);
+template void SceneObject::set(AttributeKey<Float>, Float&&);
+template void SceneObject::set(AttributeKey<Double>, Double&&);
+template void SceneObject::set(AttributeKey<String>, String&&);
+template void SceneObject::set(AttributeKey<Rgb>, Rgb&&);
+template void SceneObject::set(AttributeKey<Rgba>, Rgba&&);
+template void SceneObject::set(AttributeKey<Vec2f>, Vec2f&&);
+template void SceneObject::set(AttributeKey<Vec2d>, Vec2d&&);
+template void SceneObject::set(AttributeKey<Vec3f>, Vec3f&&);
+template void SceneObject::set(AttributeKey<Vec3d>, Vec3d&&);
+template void SceneObject::set(AttributeKey<Vec4f>, Vec4f&&);
+template void SceneObject::set(AttributeKey<Vec4d>, Vec4d&&);
+template void SceneObject::set(AttributeKey<Mat4f>, Mat4f&&);
+template void SceneObject::set(AttributeKey<Mat4d>, Mat4d&&);
+template void SceneObject::set(AttributeKey<BoolVector>, BoolVector&&);
+template void SceneObject::set(AttributeKey<IntVector>, IntVector&&);
+template void SceneObject::set(AttributeKey<LongVector>, LongVector&&);
+template void SceneObject::set(AttributeKey<FloatVector>, FloatVector&&);
+template void SceneObject::set(AttributeKey<DoubleVector>, DoubleVector&&);
+template void SceneObject::set(AttributeKey<StringVector>, StringVector&&);
+template void SceneObject::set(AttributeKey<RgbVector>, RgbVector&&);
+template void SceneObject::set(AttributeKey<RgbaVector>, RgbaVector&&);
+template void SceneObject::set(AttributeKey<Vec2fVector>, Vec2fVector&&);
+template void SceneObject::set(AttributeKey<Vec2dVector>, Vec2dVector&&);
+template void SceneObject::set(AttributeKey<Vec3fVector>, Vec3fVector&&);
+template void SceneObject::set(AttributeKey<Vec3dVector>, Vec3dVector&&);
+template void SceneObject::set(AttributeKey<Vec4fVector>, Vec4fVector&&);
+template void SceneObject::set(AttributeKey<Vec4dVector>, Vec4dVector&&);
+template void SceneObject::set(AttributeKey<Mat4fVector>, Mat4fVector&&);
+template void SceneObject::set(AttributeKey<Mat4dVector>, Mat4dVector&&);
+// SceneObjectVector specialized above.
+
+template void SceneObject::set(AttributeKey<Bool>, Bool&&, AttributeTimestep);
+template void SceneObject::set(AttributeKey<Int>, Int&&, AttributeTimestep);
+template void SceneObject::set(AttributeKey<int64_t>, Long&&, AttributeTimestep);
+template void SceneObject::set(AttributeKey<Float>, Float&&, AttributeTimestep);
+template void SceneObject::set(AttributeKey<Double>, Double&&, AttributeTimestep);
+template void SceneObject::set(AttributeKey<String>, String&&, AttributeTimestep);
+template void SceneObject::set(AttributeKey<Rgb>, Rgb&&, AttributeTimestep);
+template void SceneObject::set(AttributeKey<Rgba>, Rgba&&, AttributeTimestep);
+template void SceneObject::set(AttributeKey<Vec2f>, Vec2f&&, AttributeTimestep);
+template void SceneObject::set(AttributeKey<Vec2d>, Vec2d&&, AttributeTimestep);
+template void SceneObject::set(AttributeKey<Vec3f>, Vec3f&&, AttributeTimestep);
+template void SceneObject::set(AttributeKey<Vec3d>, Vec3d&&, AttributeTimestep);
+template void SceneObject::set(AttributeKey<Vec4f>, Vec4f&&, AttributeTimestep);
+template void SceneObject::set(AttributeKey<Vec4d>, Vec4d&&, AttributeTimestep);
+template void SceneObject::set(AttributeKey<Mat4f>, Mat4f&&, AttributeTimestep);
+template void SceneObject::set(AttributeKey<Mat4d>, Mat4d&&, AttributeTimestep);
+template void SceneObject::set(AttributeKey<BoolVector>, BoolVector&&, AttributeTimestep);
+template void SceneObject::set(AttributeKey<IntVector>, IntVector&&, AttributeTimestep);
+template void SceneObject::set(AttributeKey<LongVector>, LongVector&&, AttributeTimestep);
+template void SceneObject::set(AttributeKey<FloatVector>, FloatVector&&, AttributeTimestep);
+template void SceneObject::set(AttributeKey<DoubleVector>, DoubleVector&&, AttributeTimestep);
+template void SceneObject::set(AttributeKey<StringVector>, StringVector&&, AttributeTimestep);
+template void SceneObject::set(AttributeKey<RgbVector>, RgbVector&&, AttributeTimestep);
+template void SceneObject::set(AttributeKey<RgbaVector>, RgbaVector&&, AttributeTimestep);
+template void SceneObject::set(AttributeKey<Vec2fVector>, Vec2fVector&&, AttributeTimestep);
+template void SceneObject::set(AttributeKey<Vec2dVector>, Vec2dVector&&, AttributeTimestep);
+template void SceneObject::set(AttributeKey<Vec3fVector>, Vec3fVector&&, AttributeTimestep);
+template void SceneObject::set(AttributeKey<Vec3dVector>, Vec3dVector&&, AttributeTimestep);
+template void SceneObject::set(AttributeKey<Vec4fVector>, Vec4fVector&&, AttributeTimestep);
+template void SceneObject::set(AttributeKey<Vec4dVector>, Vec4dVector&&, AttributeTimestep);
+template void SceneObject::set(AttributeKey<Mat4fVector>, Mat4fVector&&, AttributeTimestep);
+template void SceneObject::set(AttributeKey<Mat4dVector>, Mat4dVector&&, AttributeTimestep);
+// SceneObjectVector specialized above.
+
 template void SceneObject::set(const std::string&, const Bool&);
 template void SceneObject::set(const std::string&, const Int&);
 template void SceneObject::set(const std::string&, const Long&);
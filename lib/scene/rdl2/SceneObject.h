@@ -18,10 +18,12 @@
 #include <boost/dynamic_bitset.hpp>
 
 
+#include <atomic>
 #include <memory>
 #include <sstream>
 #include <string>
 #include <stdint.h>
+#include <thread>
 #include <utility>
 
 namespace llvm {
@@ -234,6 +236,17 @@ public:
     template <typename T>
     void set(AttributeKey<T> key, const T& value);
 
+    /**
+     * Same as set() above, but moves the value into the attribute storage
+     * instead of copying it. Useful for large vector values. If the attribute
+     * is blurrable, the earlier timesteps receive copies.
+     *
+     * @param   key     An AttributeKey for the value you want to set.
+     * @param   value   The value you want to set it to.
+     */
+    template <typename T>
+    void set(AttributeKey<T> key, T&& value);
+
     /**
      * An overload of the generic set() method specifically for SceneObject*s
      * which will check the value's object type against allowed object types
@@ -267,6 +280,17 @@ public:
      */
     void set(AttributeKey<SceneObject*> key, SceneObject* value, AttributeTimestep timestep);
 
+    /**
+     * Same as the timestep set() above, but moves the value into the
+     * attribute storage instead of copying it.
+     *
+     * @param   key         An AttributeKey for the value you want to set.
+     * @param   value       The value you want to set it to.
+     * @param   timestep    The timestep you want to set the value at.
+     */
+    template <typename T>
+    void set(AttributeKey<T> key, T&& value, AttributeTimestep timestep);
+
     /**
      * A template version of set that is called from sequence container
      * specializations.
@@ -520,6 +544,10 @@ public:
      * Otherwise update the depth of this object in UpdateHelper,  until after 
      * another resetUpdate(). Should only be called after all UpdateGuards.
      *
+     * Threadsafe: walks reaching this object from several threads are
+     * serialized, a walk that finds this object being walked by another
+     * thread waits for it to finish before it reads the result.
+     *
      * @return  True if this object or its dependencies has been changed and this
      * object needs update.
      */
@@ -527,14 +555,20 @@ public:
     {
         MNRY_ASSERT_REQUIRE(!mUpdateActive);
         
-        if (mUpdatePrepApplied && 
-            (sceneObjects.getDepth(this) >= depth || sceneObjects.isLeaf(this))) {
+        if (!beginUpdatePrep(sceneObjects, depth)) {
             return updateRequired();
         }
-        mUpdatePrepApplied = true;
         
-        mAttributeTreeChanged = mAttributeUpdateMask.any();
-        mBindingTreeChanged = mBindingUpdateMask.any();
+        // A deeper revisit walks the same dependencies again and can only
+        // confirm the result of the first walk, so the flags are only ever
+        // raised here. Threads taking the early-out above read them while a
+        // revisit is running.
+        if (mAttributeUpdateMask.any()) {
+            mAttributeTreeChanged = true;
+        }
+        if (mBindingUpdateMask.any()) {
+            mBindingTreeChanged = true;
+        }
 
         bool isLeaf = true;
         const size_t n = mSceneClass.mAttributes.size();
@@ -547,7 +581,10 @@ public:
                     SceneObject * const object = get(key);
                     if (object) {
                         isLeaf = false;
-                        mAttributeTreeChanged |= object->updatePrep(sceneObjects, depth + 1);
+                        if (object->updatePrep(sceneObjects, depth + 1)) {
+                            mAttributeTreeChanged = true;
+                            sceneObjects.addDependency(this, object);
+                        }
                     }
                 }
                 break;
@@ -567,7 +604,10 @@ public:
             }
             if (attribute->isBindable() && mBindings[i]) {
                 isLeaf = false;
-                mBindingTreeChanged |= mBindings[i]->updatePrep(sceneObjects, depth + 1);
+                if (mBindings[i]->updatePrep(sceneObjects, depth + 1)) {
+                    mBindingTreeChanged = true;
+                    sceneObjects.addDependency(this, mBindings[i]);
+                }
             }
         }
         
@@ -578,6 +618,7 @@ public:
                 sceneObjects.insert(this, depth);
             }
         }
+        endUpdatePrep();
         return updateRequired();
     }
 
@@ -592,18 +633,17 @@ public:
         UpdateHelper sceneObjects;
 
         this->updatePrep(sceneObjects, 0);
-        
-        // Update all leaves
 
-        size_t s = sceneObjects.size();
-        if (s == 0){
-            Logger::info("There is no leaf scene object need to be updated");
+        const size_t s = sceneObjects.getObjectCount();
+        if (s == 0) {
+            Logger::info("There is no scene object need to be updated");
         } else if (s == 1) {
-            Logger::info("Updating 1 leaf scene object...");
+            Logger::info("Updating 1 scene object...");
         } else {
-            Logger::info("Updating ", s, " leaf scene objects...");
-        } 
+            Logger::info("Updating ", s, " scene objects...");
+        }
 
+        // Update all leaves
         for (auto obj = sceneObjects.cbegin(); obj != sceneObjects.cend(); ++obj)
         {
             (*obj)->debug("Updating");
@@ -613,15 +653,6 @@ public:
         // Update the objects from bottom up
         for (int i = static_cast<int>(sceneObjects.getMaxDepth())-1; i >= 0;
              --i) {
-            size_t s = sceneObjects.size(i);
-            if (s == 0){
-                Logger::info("There is no scene object need to be updated at level ", i);
-            } else if (s == 1) {
-                Logger::info("Updating 1 scene object at level ", i, "...");
-            } else {
-                Logger::info("Updating ", s, " scene objects at level ", i, "...");
-            } 
-
             for (auto obj = sceneObjects.cbegin(i); obj != sceneObjects.cend(i); ++obj)
             {
                 (*obj)->debug("Updating");
@@ -638,10 +669,11 @@ public:
     void resetUpdate()
     {
         MNRY_ASSERT_REQUIRE(!mUpdateActive);
-        if (mUpdatePrepApplied) {
-            mUpdatePrepApplied = false;
+        if (updatePrepApplied()) {
+            mUpdatePrepState.store(UPDATE_PREP_NONE, std::memory_order_relaxed);
             mAttributeTreeChanged = false;
             mBindingTreeChanged = false;
+            mGeometryUpdateSkipped = false;
             mUpdateRequested = false;
             mAttributeUpdateMask.reset();
             mBindingUpdateMask.reset();
@@ -654,7 +686,7 @@ public:
      * @return  True if this object needs update
      */
     bool updateRequired() const {
-        MNRY_ASSERT(mUpdatePrepApplied, "updateRequired() need to be called when mUpdatePrepApplied is true");
+        MNRY_ASSERT(updatePrepApplied(), "updateRequired() need to be called when updatePrepApplied() is true");
         return (mAttributeTreeChanged || mBindingTreeChanged || mUpdateRequested);
     }
 
@@ -663,7 +695,10 @@ public:
      *
      * @return  True if updatePrep() has been called on this object
      */
-    bool updatePrepApplied() const { return mUpdatePrepApplied; }
+    bool updatePrepApplied() const
+    {
+        return mUpdatePrepState.load(std::memory_order_acquire) != UPDATE_PREP_NONE;
+    }
 
     /**
      * Can be called after updatePrep() and before resetUpdate().
@@ -923,6 +958,46 @@ protected:
     // use SceneContext::createSceneObject.
     SceneObject(const SceneClass& sceneClass, const std::string& name);
 
+    /**
+     * Starts the updatePrep() walk of this object at the given depth. Returns
+     * false if the walk is not needed because this object has already been
+     * walked at this depth or deeper (or as a leaf). If another thread is
+     * walking this object, waits for that walk to finish first. When this
+     * returns true the caller owns the walk and must call endUpdatePrep().
+     *
+     * The wait spins rather than blocks because it is bounded: the owner of
+     * an active walk only descends into this object's dependencies, and the
+     * objects reachable by updatePrep() form a DAG (a cycle already recurses
+     * forever in a serial walk), so the owner never waits on the waiter. The
+     * wait lasts one walk of the dependency sub-tree, which is also the work
+     * the waiter would otherwise do itself.
+     */
+    bool beginUpdatePrep(const UpdateHelper& sceneObjects, int depth)
+    {
+        int state = mUpdatePrepState.load(std::memory_order_acquire);
+        while (true) {
+            if (state == UPDATE_PREP_ACTIVE) {
+                std::this_thread::yield();
+                state = mUpdatePrepState.load(std::memory_order_acquire);
+                continue;
+            }
+            if (state == UPDATE_PREP_DONE &&
+                (sceneObjects.getDepth(this) >= depth || sceneObjects.isLeaf(this))) {
+                return false;
+            }
+            if (mUpdatePrepState.compare_exchange_weak(state, UPDATE_PREP_ACTIVE,
+                                                       std::memory_order_acquire)) {
+                return true;
+            }
+        }
+    }
+
+    // Publishes the result of the walk started by beginUpdatePrep().
+    void endUpdatePrep()
+    {
+        mUpdatePrepState.store(UPDATE_PREP_DONE, std::memory_order_release);
+    }
+
     template <typename Container>
     bool updatePrepSequenceContainer(const Attribute* attribute,
                                      UpdateHelper& sceneObjects,
@@ -932,11 +1007,14 @@ protected:
         const AttributeKey<Container> key(*attribute);
         const Container& objectVector = get(key);
         for (SceneObject * const object : objectVector) {
-            if (object) {
-                updateRequired |= object->updatePrep(sceneObjects, depth);
+            if (object && object->updatePrep(sceneObjects, depth)) {
+                updateRequired = true;
+                sceneObjects.addDependency(this, object);
             }
         }
-        mAttributeTreeChanged |= updateRequired;
+        if (updateRequired) {
+            mAttributeTreeChanged = true;
+        }
         return updateRequired;
     }
 
@@ -1005,6 +1083,15 @@ private:
                     SceneObjectInterface objectType, SceneObject* sceneObject,
                     F attributeNameFetcher);
 
+    // Marks the object as dirty. The first time the object becomes dirty
+    // after the last SceneContext::commitAllChanges() it is also recorded in
+    // the SceneContext's dirty object journal, which lets delta encoding visit
+    // only the objects that changed.
+    finline void markDirty();
+
+    // Appends this object to the SceneContext's dirty object journal.
+    void journalDirty();
+
     // Bitmask indicating which attributes have been set. Used for determining
     // which attribute values to pack during serialization.
     boost::dynamic_bitset<> mAttributeSetMask;
@@ -1035,6 +1122,14 @@ private:
     // This is used by the SceneObject writers to decide what objects to 
     // serialize, not by updatePrep().
     bool mDirty;
+
+    // Tracks whether this object is already in the SceneContext's dirty
+    // object journal, so it's only recorded once between commits.
+    bool mInDirtyJournal;
+
+    // Counts the calls to markDirty(), so derived classes can tell whether
+    // data they cache from attribute values is still current. Never reset.
+    uint64_t mChangeCount;
     
     // Tracks whether updatePrep() has been called on this object since the
     // last resetUpdate() call. Keeps the updatePrep() call tree from going
@@ -1043,17 +1138,29 @@ private:
     // the same branch to update the depths of its childrens. Also Notice this 
     // only means that updatePrep() has been called. It does not mean that update() 
     // has been called.
-    bool mUpdatePrepApplied;
+    // UPDATE_PREP_ACTIVE marks a walk in progress, which other threads reaching
+    // this object wait on.
+    enum UpdatePrepState { UPDATE_PREP_NONE, UPDATE_PREP_ACTIVE, UPDATE_PREP_DONE };
+    std::atomic<int> mUpdatePrepState;
 
     // Track whether any dependencies have been changed hence this object need 
-    // to be updated.
-    bool mAttributeTreeChanged;
-    bool mBindingTreeChanged;
+    // to be updated. Set during updatePrep() and read by concurrent walks
+    // reaching this object, cleared only by resetUpdate().
+    std::atomic<bool> mAttributeTreeChanged;
+    std::atomic<bool> mBindingTreeChanged;
+
+    // Set by Geometry::requiresGeometryUpdate() when none of the attribute
+    // changes of a Geometry require a geometry update. Kept apart from
+    // mAttributeTreeChanged, which is never lowered during updatePrep().
+    std::atomic<bool> mGeometryUpdateSkipped;
 
     // Sometimes a change external to the object can require that this object be
     //  updated.  (E.g. a displacement assignment in a layer.)
     bool mUpdateRequested;
 
+    // The SceneContext maintains the dirty object journal.
+    friend class SceneContext;
+
     // Classes requiring access for serialization.
     friend class AsciiWriter;
     friend class BinaryWriter;
@@ -1069,6 +1176,9 @@ private:
     friend class Metadata;
     friend class TraceSet;
 
+    // AttributeColumn uses the change count to refresh rows.
+    template <typename T> friend class AttributeColumn;
+
     // Classes requiring access for testing.
     friend class unittest::TestSceneObject;
 };
@@ -1236,12 +1346,22 @@ SceneObject::commitChanges()
     mDirty = false;
 }
 
+void
+SceneObject::markDirty()
+{
+    mDirty = true;
+    ++mChangeCount;
+    if (!mInDirtyJournal) {
+        journalDirty();
+    }
+}
+
 void
 SceneObject::markAttributeChanged(const Attribute* attribute)
 {
         mAttributeSetMask.set(attribute->mIndex, true);
         mAttributeUpdateMask.set(attribute->mIndex, true);
-        mDirty = true;
+        markDirty();
 }
 
 namespace {
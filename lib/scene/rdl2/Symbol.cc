@@ -0,0 +1,110 @@
+// Copyright 2023-2024 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+
+#include "Symbol.h"
+
+#include <scene_rdl2/common/except/exceptions.h>
+
+#include <tbb/concurrent_hash_map.h>
+#include <tbb/concurrent_vector.h>
+
+namespace scene_rdl2 {
+namespace rdl2 {
+
+namespace {
+
+class SymbolTable
+{
+public:
+    static SymbolTable& get()
+    {
+        // Never destroyed, so symbols stay valid during static destruction.
+        static SymbolTable* table = new SymbolTable;
+        return *table;
+    }
+
+    uint32_t intern(const std::string& str)
+    {
+        {
+            IdMap::const_accessor reader;
+            if (mIds.find(reader, str)) {
+                return reader->second;
+            }
+        }
+
+        // Check the limit before inserting, so no key is ever left without an
+        // id. Concurrent interns may pass the check together, MAX_COUNT leaves
+        // them plenty of room below INVALID_ID.
+        if (mStrings.size() >= MAX_COUNT) {
+            throw except::RuntimeError("Too many interned symbols.");
+        }
+
+        IdMap::accessor writer;
+        if (mIds.insert(writer, str)) {
+            writer->second = static_cast<uint32_t>(mStrings.push_back(str) - mStrings.begin());
+        }
+        return writer->second;
+    }
+
+    uint32_t find(const std::string& str) const
+    {
+        IdMap::const_accessor reader;
+        return mIds.find(reader, str) ? reader->second : Symbol::INVALID_ID;
+    }
+
+    const std::string& str(uint32_t id) const
+    {
+        MNRY_ASSERT(id < mStrings.size());
+        return mStrings[id];
+    }
+
+    std::size_t count() const
+    {
+        return mIds.size();
+    }
+
+private:
+    typedef tbb::concurrent_hash_map<std::string, uint32_t> IdMap;
+
+    static constexpr std::size_t MAX_COUNT = Symbol::INVALID_ID / 2;
+
+    IdMap mIds;
+
+    // Element addresses are stable, so str() references stay valid.
+    tbb::concurrent_vector<std::string> mStrings;
+};
+
+} // namespace
+
+Symbol::Symbol(const std::string& str) :
+    mId(SymbolTable::get().intern(str))
+{
+}
+
+// static function
+Symbol
+Symbol::find(const std::string& str)
+{
+    Symbol symbol;
+    symbol.mId = SymbolTable::get().find(str);
+    return symbol;
+}
+
+const std::string&
+Symbol::str() const
+{
+    MNRY_ASSERT(isValid());
+    return SymbolTable::get().str(mId);
+}
+
+// static function
+std::size_t
+Symbol::count()
+{
+    return SymbolTable::get().count();
+}
+
+} // namespace rdl2
+} // namespace scene_rdl2
+
@@ -0,0 +1,98 @@
+// Copyright 2023-2024 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+
+#pragma once
+
+// Include this before any other includes!
+#include <scene_rdl2/common/platform/Platform.h>
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <stdint.h>
+
+namespace scene_rdl2 {
+namespace rdl2 {
+
+/**
+ * A Symbol is an interned name: a stable 32-bit id for a string in a process
+ * wide symbol table. Interning a string hashes it once; after that, comparing
+ * and hashing symbols are integer operations, and the id stays valid for the
+ * life of the process.
+ *
+ * Attribute names (including aliases) are interned when the attributes are
+ * declared. SceneObject names are only interned by callers that build a Symbol
+ * for them. Hot lookups that hold on to a Symbol can use the Symbol overloads
+ * of SceneContext::getSceneObject() and SceneClass::getAttribute() and skip
+ * string hashing; the string overloads still hash the full name:
+ *
+ *      const Symbol colorName("color");           // hashes "color" once
+ *      for (SceneObject* so : objects) {
+ *          const Attribute* attr = so->getSceneClass().getAttribute(colorName);
+ *          ...
+ *      }
+ *
+ * The symbol table is threadsafe. Interned strings are never freed.
+ */
+class Symbol
+{
+public:
+    static constexpr uint32_t INVALID_ID = ~uint32_t(0);
+
+    /// The invalid symbol, which no string interns to.
+    Symbol() : mId(INVALID_ID) {}
+
+    /// Interns the string, adding it to the symbol table if it's new.
+    explicit Symbol(const std::string& str);
+    explicit Symbol(const char* str) : Symbol(std::string(str)) {}
+
+    /// Returns the symbol of an already interned string without adding it to
+    /// the symbol table. Returns the invalid symbol if the string was never
+    /// interned, so nothing can be named by it.
+    static Symbol find(const std::string& str);
+
+    /// Rebuilds a symbol from the id() of a valid symbol, e.g. one cached
+    /// outside of C++.
+    static Symbol fromId(uint32_t id)
+    {
+        Symbol symbol;
+        symbol.mId = id;
+        return symbol;
+    }
+
+    /// The interned string. Must not be called on the invalid symbol.
+    const std::string& str() const;
+
+    uint32_t id() const { return mId; }
+    bool isValid() const { return mId != INVALID_ID; }
+
+    bool operator==(Symbol other) const { return mId == other.mId; }
+    bool operator!=(Symbol other) const { return mId != other.mId; }
+
+    /// Orders by id, not alphabetically.
+    bool operator<(Symbol other) const { return mId < other.mId; }
+
+    /// Number of strings interned so far.
+    static std::size_t count();
+
+private:
+    uint32_t mId;
+};
+
+} // namespace rdl2
+} // namespace scene_rdl2
+
+namespace std {
+
+template <>
+struct hash<scene_rdl2::rdl2::Symbol>
+{
+    std::size_t operator()(scene_rdl2::rdl2::Symbol symbol) const
+    {
+        return std::hash<uint32_t>()(symbol.id());
+    }
+};
+
+} // namespace std
+
@@ -7,19 +7,102 @@
 
 #include <scene_rdl2/common/except/exceptions.h>
 
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
 namespace scene_rdl2 {
 namespace rdl2 {
 
 AttributeKey<SceneObjectIndexable> TraceSet::sGeometriesKey;
 AttributeKey<StringVector>         TraceSet::sPartsKey;
 
+/// Hashed (Geometry*, part name) -> assignment ID lookup table. Part names are
+/// interned to small ids, so geometries sharing part names (instanced crowds,
+/// fur grooms) share the strings.
+class TraceSet::AssignmentIndex
+{
+public:
+    AssignmentIndex() :
+        mChangeCount(~uint64_t(0)) // not built yet
+    {
+    }
+
+    void build(const SceneObjectIndexable& geometries, const StringVector& parts)
+    {
+        mPartIds.clear();
+        mIndex.clear();
+        const std::size_t count = std::min(geometries.size(), parts.size());
+        mIndex.reserve(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            insert(geometries[i], parts[i], static_cast<int32_t>(i));
+        }
+    }
+
+    // Keeps the first assignment ID of a (geometry, part) pair.
+    void insert(const SceneObject* geometry, const std::string& partName, int32_t assignmentId)
+    {
+        const auto part = mPartIds.emplace(partName, static_cast<uint32_t>(mPartIds.size())).first;
+        mIndex.emplace(Key{geometry, part->second}, assignmentId);
+    }
+
+    // Returns -1 if there is no such assignment.
+    int32_t find(const SceneObject* geometry, const std::string& partName) const
+    {
+        const auto part = mPartIds.find(partName);
+        if (part == mPartIds.end()) {
+            return -1;
+        }
+        const auto it = mIndex.find(Key{geometry, part->second});
+        return (it == mIndex.end()) ? -1 : it->second;
+    }
+
+    // The TraceSet's mChangeCount this index was built for.
+    std::atomic<uint64_t> mChangeCount;
+
+    // Serializes rebuilds from concurrent lookups.
+    std::mutex mMutex;
+
+private:
+    struct Key
+    {
+        const SceneObject* mGeometry;
+        uint32_t mPartId;
+
+        bool operator==(const Key& other) const
+        {
+            return mGeometry == other.mGeometry && mPartId == other.mPartId;
+        }
+    };
+
+    struct KeyHash
+    {
+        std::size_t operator()(const Key& key) const
+        {
+            return std::hash<const SceneObject*>()(key.mGeometry) ^
+                   (static_cast<std::size_t>(key.mPartId) * 0x9e3779b97f4a7c15ull);
+        }
+    };
+
+    std::unordered_map<std::string, uint32_t> mPartIds;
+    std::unordered_map<Key, int32_t, KeyHash> mIndex;
+};
+
 TraceSet::TraceSet(const SceneClass& sceneClass, const std::string& name) :
-    Parent(sceneClass, name)
+    Parent(sceneClass, name),
+    mAssignmentIndex(new AssignmentIndex)
 {
     // Add the TraceSet interface.
     mType |= INTERFACE_TRACESET;
 }
 
+TraceSet::~TraceSet()
+{
+}
+
 SceneObjectInterface
 TraceSet::declare(SceneClass& sceneClass)
 {
@@ -53,23 +136,16 @@ TraceSet::assign(Geometry* geometry, const String& partName)
         throw except::RuntimeError(errMsg.str());
     }
 
+    // If the assignment already exists, just return the existing assignment ID.
+    const int32_t existingId = getAssignmentIndex().find(geometry, partName);
+    if (existingId >= 0) {
+        return existingId;
+    }
+
     // Get mutable references to the attribute vectors.
     auto& geometries = getMutable(sGeometriesKey);
     auto& parts = getMutable(sPartsKey);
 
-    // We have to do a const cast here, because we have a container of
-    // SceneObject*, but equal_range takes a const T&. The compiler does not
-    // like us trying to take a const pointer reference. It's complicated and
-    // annoying.
-    const auto iters = geometries.equal_range(const_cast<Geometry*>(geometry));
-    // If the assignment already exists, just return the existing assignment ID.
-    for (auto it = iters.first; it != iters.second; ++it) {
-        const auto idx = *it;
-        if (parts[idx] == partName) {
-            return idx;
-        }
-    }
-
     // Assignment doesn't exist yet, so create it.
     geometries.push_back(geometry);
     parts.push_back(partName);
@@ -78,9 +154,15 @@ TraceSet::assign(Geometry* geometry, const String& partName)
     mAttributeUpdateMask.set(sPartsKey.mIndex, true);
     mAttributeSetMask.set(sGeometriesKey.mIndex, true);
     mAttributeSetMask.set(sPartsKey.mIndex, true);
-    mDirty = true;
+    markDirty();
+
+    // The index was current before this assignment, so adding it keeps the
+    // index current.
+    const int32_t assignmentId = static_cast<int32_t>(geometries.size() - 1);
+    mAssignmentIndex->insert(geometry, partName, assignmentId);
+    restampAssignmentIndex();
 
-    return geometries.size() - 1;
+    return assignmentId;
 }
 
 TraceSet::GeometryPartPair
@@ -105,32 +187,50 @@ TraceSet::lookupGeomAndPart(int32_t assignmentId) const
 int32_t
 TraceSet::getAssignmentId(const Geometry* geometry, const String& partName) const
 {
-    const auto& geometries = get(sGeometriesKey);
-    const auto& parts = get(sPartsKey);
+    // Pointer compare for geometry uniqueness is ok, since the SceneContext
+    // enforces that we can't create two SceneObjects with the same name.
+    const AssignmentIndex& index = getAssignmentIndex();
+    const int32_t assignmentId = index.find(geometry, partName);
+    if (assignmentId >= 0) {
+        return assignmentId;
+    }
+
+    // Return the default assignment (part name ""), -1 if there is none.
+    return index.find(geometry, "");
+}
 
-    // Save the default assignment (part name "") if we come across it during
-    // the search.
-    int32_t defaultAssignmentId = -1; // Not found.
+void
+TraceSet::lookupAll(const Geometry* geometry, const StringVector& partNames,
+                    std::vector<int32_t>& assignmentIds) const
+{
+    const AssignmentIndex& index = getAssignmentIndex();
+    const int32_t defaultAssignmentId = index.find(geometry, "");
 
-    // We have to do a const cast here, because we have a container of
-    // SceneObject*, but equal_range takes a const T&. The compiler does not
-    // like us trying to take a const pointer reference. It's complicated and
-    // annoying.
-    const auto iters = geometries.equal_range(const_cast<Geometry*>(geometry));
-    for (auto it = iters.first; it != iters.second; ++it) {
-        const auto idx = *it;
-        // Pointer compare for geometry uniqueness is ok, since the SceneContext
-        // enforces that we can't create two SceneObjects with the same name.
-        const std::string& part = parts[idx];
-        if (part == partName) {
-            return idx;
-        } else if (part == "") {
-            defaultAssignmentId = idx;
+    assignmentIds.resize(partNames.size());
+    for (std::size_t i = 0; i < partNames.size(); ++i) {
+        const int32_t assignmentId = index.find(geometry, partNames[i]);
+        assignmentIds[i] = (assignmentId >= 0) ? assignmentId : defaultAssignmentId;
+    }
+}
+
+const TraceSet::AssignmentIndex&
+TraceSet::getAssignmentIndex() const
+{
+    AssignmentIndex& index = *mAssignmentIndex;
+    if (index.mChangeCount.load(std::memory_order_acquire) != mChangeCount) {
+        std::lock_guard<std::mutex> lock(index.mMutex);
+        if (index.mChangeCount.load(std::memory_order_relaxed) != mChangeCount) {
+            index.build(get(sGeometriesKey), get(sPartsKey));
+            index.mChangeCount.store(mChangeCount, std::memory_order_release);
         }
     }
+    return index;
+}
 
-    // Return the default assignment.
-    return defaultAssignmentId;
+void
+TraceSet::restampAssignmentIndex()
+{
+    mAssignmentIndex->mChangeCount.store(mChangeCount, std::memory_order_release);
 }
 
 bool
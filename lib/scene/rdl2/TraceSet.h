@@ -13,6 +13,9 @@
 #include "SceneObject.h"
 #include "Types.h"
 
+#include <memory>
+#include <vector>
+
 namespace scene_rdl2 {
 namespace rdl2 {
     class AscIIWriter;
@@ -72,8 +75,10 @@ ContainerWrapper<Container> makeContainerWrapper(const Container& c)
  * It can be used to quickly and efficiently look up which object has been
  * intersected.
  *
- * You can also get the assignment ID from the Geometry / Part pair, but this
- * is a slow operation.
+ * You can also get the assignment ID from the Geometry / Part pair. This goes
+ * through a hashed index keyed by (Geometry*, part name id), where part names
+ * are interned to ids. The index is kept up to date by assign() and rebuilt
+ * on the next lookup after the assignments are changed any other way.
  *
  * Calling the assign() method again with an existing Geometry/Part pair will
  * return the same assignment ID that was there before.
@@ -91,6 +96,7 @@ public:
         GeometryIterator;
 
     TraceSet(const SceneClass& sceneClass, const std::string& name);
+    ~TraceSet();
     static SceneObjectInterface declare(SceneClass& sceneClass);
 
     /**
@@ -131,6 +137,19 @@ public:
      */
     int32_t getAssignmentId(const Geometry* geometry, const String& partName) const;
 
+    /**
+     * Batch version of getAssignmentId(). Resolves the assignment ID of every
+     * part in partNames on the given Geometry in one call, falling back to
+     * the default assignment (part name "") or -1 like getAssignmentId().
+     *
+     * @param   geometry        The Geometry on which the parts live.
+     * @param   partNames       The names of the parts to look up.
+     * @param   assignmentIds   Resized to partNames.size() and filled with
+     *                          the assignment ID of each part.
+     */
+    void lookupAll(const Geometry* geometry, const StringVector& partNames,
+                   std::vector<int32_t>& assignmentIds) const;
+
     /**
      * Given a Geometry, this will return whether or not the trace set contains
      * said geometry.
@@ -155,6 +174,20 @@ protected:
     friend AsciiWriter;
     static AttributeKey<SceneObjectIndexable> sGeometriesKey;
     static AttributeKey<StringVector> sPartsKey;
+
+    // Marks the assignment index as current again after changes to this
+    // object which did not touch the geometries or parts attributes. Only
+    // valid right after assign(), which leaves the index current.
+    void restampAssignmentIndex();
+
+private:
+    class AssignmentIndex;
+
+    // Returns the assignment index, rebuilding it first if the object has
+    // changed since it was built. Threadsafe with other lookups.
+    const AssignmentIndex& getAssignmentIndex() const;
+
+    std::unique_ptr<AssignmentIndex> mAssignmentIndex;
 };
 
 template <>
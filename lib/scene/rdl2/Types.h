@@ -60,6 +60,7 @@ struct DisplayFilterStatev; // displayfilter::DisplayFilterStatev;
 struct DisplayFilterInputBufferv; // displayfilter::InputBuffer;
 
 // Forward declaration of RDL classes.
+class AsciiNativeReader;
 class AsciiReader;
 class AsciiWriter;
 class Attribute;
@@ -70,6 +71,7 @@ class Camera;
 class Displacement;
 class DisplayFilter;
 class Dso;
+class DsoManifest;
 class EnvMap;
 class Geometry;
 class GeometrySet;
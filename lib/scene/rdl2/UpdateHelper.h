@@ -7,6 +7,14 @@
 
 #include <scene_rdl2/common/platform/Platform.h>
 
+#include <tbb/concurrent_hash_map.h>
+#include <tbb/parallel_for_each.h>
+#include <tbb/spin_mutex.h>
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <memory>
 #include <vector>
 #include <unordered_set>
 #include <unordered_map>
@@ -20,21 +28,28 @@ namespace rdl2 {
  * Updating of all the objects in the scene is a two-stage process starts
  * in applyUpdates() function in SceneContext.cc
  *
- * 1. Walk through the object directed acyclic graphs (DAG) serially in
- *    depth first order to decide which objects need to be updated and
- *    decide the order of the updates. The order of updates is maintained
- *    in a graph-depth-based data structure. If there are multiple paths
- *    reaching to the same object, the deepest level depth is recorded.
+ * 1. Walk through the object directed acyclic graphs (DAG) in depth first
+ *    order to decide which objects need to be updated and decide the order
+ *    of the updates. The order of updates is maintained in a
+ *    graph-depth-based data structure. If there are multiple paths reaching
+ *    to the same object, the deepest level depth is recorded.
  *
- *    Check updatePrep() function in SceneObject.h for more details
+ *    Several walks may run at the same time (Layer::updatePrepAssignments()
+ *    walks its assignments in parallel), so all the insert and lookup
+ *    functions below are threadsafe. A single object is only walked by one
+ *    thread at a time, check updatePrep() function in SceneObject.h for
+ *    more details
  *
- * 2. Call update() on all objects which need update level by level from
- *    the deepest level to shallow ones. For the objects which have the same
- *    depth, update() will be called in parallel.
+ *    While walking, every object also records an edge to each of its
+ *    dependencies which needs update (addDependency()).
+ *
+ * 2. Call update() on all objects which need update. parallelForEach() walks
+ *    the recorded edges: an object is updated as soon as all of its own
+ *    dependencies have been updated, so there is no barrier between levels
+ *    and a slow object only holds back the objects which depend on it.
  *
  * 3. Leaves in DAG are the nodes which do not have any dependencies. Leaves
- *    are treated seperately here. All leaves can be updated in parallel before
- *    other nodes in DAG.
+ *    are the starting points of the update.
  *
  * Definition of depth of a level
  * -2 : not found, hasn't been recorded
@@ -70,7 +85,9 @@ private:
     typedef std::unordered_set<SceneObject*> ObjectSet;
     typedef std::vector<ObjectSet> DagLevels;
     typedef std::vector<SceneObject*> DagLeaves;
-    typedef std::unordered_map<SceneObject*, int> DepthMap;
+    typedef tbb::concurrent_hash_map<SceneObject*, int> DepthMap;
+    typedef tbb::concurrent_hash_map<SceneObject*, ObjectSet> DependentMap;
+    typedef tbb::spin_mutex Mutex;
 
     // store all objects except the leaves
     DagLevels mDagLevels;
@@ -78,11 +95,17 @@ private:
     // store all leaves
     DagLeaves mDagLeaves;
 
+    // guards mDagLevels and mDagLeaves
+    Mutex mDagMutex;
+
     // lookup table for depth of certain object
     // all leaves have depth assigned to be -1
     // other objects have depth starting from 0
     DepthMap mDepthMap;
 
+    // lookup table from an object to the objects which depend on it
+    DependentMap mDependents;
+
 public:
     typedef typename ObjectSet::const_iterator const_iterator;
     typedef typename DagLeaves::const_iterator const_leaves_iterator;
@@ -98,6 +121,15 @@ public:
     // insert a leaf to mDagLeaves.
     finline void insertLeaf (SceneObject* const  &obj);
 
+    // record that obj has to be updated after dependency. recording the same
+    // edge more than once has no effect.
+    void addDependency (SceneObject* const &obj, SceneObject* const &dependency)
+    {
+        DependentMap::accessor acc;
+        mDependents.insert(acc, dependency);
+        acc->second.insert(obj);
+    }
+
     // get maximum depth of DAG except leaves
     size_t getMaxDepth() const { return mDagLevels.size(); };
 
@@ -106,9 +138,8 @@ public:
     // starting from 0
     int getDepth (SceneObject* const &obj) const
     {
-        auto it = mDepthMap.find(obj);
-        return (it == mDepthMap.end())?
-                -2 : (*it).second;
+        DepthMap::const_accessor acc;
+        return mDepthMap.find(acc, obj) ? acc->second : -2;
     };
 
     // return true if object is a leaf
@@ -122,8 +153,32 @@ public:
         mDagLevels.clear();
         mDagLeaves.clear();
         mDepthMap.clear();
+        mDependents.clear();
     }
 
+    // call func on every recorded object (leaves and levels) in parallel.
+    // func is called on an object only after it returned for all of the
+    // object's recorded dependencies. edges to objects which were not
+    // recorded (they do not need update) are ignored. not threadsafe with
+    // the insert functions.
+    // if the recorded edges form a cycle, the objects on the cycle (and the
+    // objects depending on them) can never become ready. they are updated
+    // serially afterwards in depth order instead (leaves first, then from
+    // the deepest level up). returns the number of objects updated this
+    // way, so the caller can report the cycle.
+    template <typename Func>
+    size_t parallelForEach(const Func& func) const;
+
+    // return true if obj has recorded an edge to dependency
+    bool hasDependency (SceneObject* const &obj, SceneObject* const &dependency) const
+    {
+        DependentMap::const_accessor acc;
+        return mDependents.find(acc, dependency) && acc->second.count(obj) != 0;
+    }
+
+    // return the number of recorded objects (leaves and levels)
+    size_t getObjectCount() const { return mDepthMap.size(); }
+
     //------------------iterators --------------------------------------------
 
     // constant begin iterator of a certain depth in DAG
@@ -165,12 +220,15 @@ private:
 void UpdateHelper::insert(SceneObject* const &obj, int depth) {
     MNRY_ASSERT(depth >= 0, "dag depth starts from 0");
 
-    int recordedDepth = getDepth(obj);
+    DepthMap::accessor acc;
+    const int recordedDepth = mDepthMap.insert(acc, obj) ? -2 : acc->second;
     MNRY_ASSERT(recordedDepth != -1, "this object has been inserted as a leaf");
 
     if (recordedDepth >= depth) {
         return;
     } else {
+        acc->second = depth;
+        Mutex::scoped_lock lock(mDagMutex);
         // this object has been recorded before
         if (recordedDepth >= 0) { // !=-2
             mDagLevels[recordedDepth].erase(obj);
@@ -179,12 +237,12 @@ void UpdateHelper::insert(SceneObject* const &obj, int depth) {
             mDagLevels.resize(depth+1);
         }
         mDagLevels[depth].insert(obj);
-        mDepthMap[obj] = depth;
     }
 }  
 
 void UpdateHelper::insertLeaf(SceneObject* const &obj) {
-    int recordedDepth = getDepth(obj);
+    DepthMap::accessor acc;
+    const int recordedDepth = mDepthMap.insert(acc, obj) ? -2 : acc->second;
     // a leaf needs to be either not recorded or recorded as leaf before
     MNRY_ASSERT(recordedDepth < 0, "conflict when inserting leaf");
 
@@ -192,11 +250,91 @@ void UpdateHelper::insertLeaf(SceneObject* const &obj) {
     if (recordedDepth == -1) {
         return;
     } else {
+        acc->second = -1;
+        Mutex::scoped_lock lock(mDagMutex);
         mDagLeaves.push_back(obj);
-        mDepthMap[obj] = -1;
     } 
 } 
 
+template <typename Func>
+size_t UpdateHelper::parallelForEach(const Func& func) const
+{
+    const size_t count = mDepthMap.size();
+    if (count == 0) {
+        return 0;
+    }
+
+    std::vector<SceneObject*> objects;
+    std::unordered_map<SceneObject*, size_t> index;
+    objects.reserve(count);
+    index.reserve(count);
+    for (const auto& entry : mDepthMap) {
+        index.emplace(entry.first, objects.size());
+        objects.push_back(entry.first);
+    }
+
+    // objects depending on each object, and the number of dependencies each
+    // object is still waiting for
+    std::vector<std::vector<size_t>> dependents(count);
+    std::unique_ptr<std::atomic<int>[]> pending(new std::atomic<int>[count]);
+    for (size_t i = 0; i < count; ++i) {
+        pending[i].store(0, std::memory_order_relaxed);
+    }
+    for (const auto& entry : mDependents) {
+        auto from = index.find(entry.first);
+        if (from == index.end()) {
+            continue;
+        }
+        for (SceneObject* const dependent : entry.second) {
+            auto to = index.find(dependent);
+            if (to != index.end()) {
+                dependents[from->second].push_back(to->second);
+                pending[to->second].fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    std::vector<size_t> ready;
+    for (size_t i = 0; i < count; ++i) {
+        if (pending[i].load(std::memory_order_relaxed) == 0) {
+            ready.push_back(i);
+        }
+    }
+
+    tbb::parallel_for_each(ready.begin(), ready.end(),
+            [&](size_t i, tbb::feeder<size_t>& feeder)
+    {
+        func(objects[i]);
+
+        for (size_t dependent : dependents[i]) {
+            if (pending[dependent].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                feeder.add(dependent);
+            }
+        }
+    });
+
+    // an object is fed exactly when its pending count drops to 0, so
+    // anything still waiting is on (or behind) a cycle
+    std::vector<std::pair<int, SceneObject*>> leftover;
+    for (size_t i = 0; i < count; ++i) {
+        if (pending[i].load(std::memory_order_relaxed) != 0) {
+            leftover.emplace_back(getDepth(objects[i]), objects[i]);
+        }
+    }
+    // leaves (-1) first, then the deepest level first
+    std::sort(leftover.begin(), leftover.end(),
+              [](const std::pair<int, SceneObject*>& a,
+                 const std::pair<int, SceneObject*>& b) {
+        const int da = a.first < 0 ? std::numeric_limits<int>::max() : a.first;
+        const int db = b.first < 0 ? std::numeric_limits<int>::max() : b.first;
+        return da > db;
+    });
+    for (const auto& entry : leftover) {
+        func(entry.second);
+    }
+    return leftover.size();
+}
+
 } // namespace rdl2
 } // namespace scene_rdl2
 
@@ -4,10 +4,12 @@
 
 #include "Utils.h"
 
+#include "AsciiNativeReader.h"
 #include "AsciiReader.h"
 #include "AsciiWriter.h"
 #include "BinaryReader.h"
 #include "BinaryWriter.h"
+#include "SceneContext.h"
 #include "SceneVariables.h"
 #include "Types.h"
 
@@ -16,8 +18,14 @@
 #include <scene_rdl2/render/util/Files.h>
 #include <scene_rdl2/render/util/Strings.h>
 
+#include <tbb/parallel_for.h>
+
 #include <algorithm>
 #include <cctype>
+#include <exception>
+#include <fstream>
+#include <iterator>
+#include <memory>
 #include <set>
 #include <string>
 
@@ -26,13 +34,19 @@ namespace {
 // maximum size of vector to write to rdla in "split rdla/rdlb mode"
 constexpr int SPLIT_VEC_SIZE = 12;
 
+// maximum number of files readScenesFromFiles() holds staged at once
+constexpr std::size_t STAGE_WINDOW = 8;
+
 }
 
 namespace scene_rdl2 {
 namespace rdl2 {
 
-void
-readSceneFromFile(const std::string& filePath, SceneContext& context)
+namespace {
+
+// Returns the lower case extension of a scene file, "rdla" or "rdlb".
+std::string
+sceneFileExtension(const std::string& filePath)
 {
     // Grab the file extension and convert it to lower case.
     auto ext = util::lowerCaseExtension(filePath);
@@ -41,20 +55,127 @@ readSceneFromFile(const std::string& filePath, SceneContext& context)
                 "File '", filePath, "' has no extension."
                 " Cannot determine file type."));
     }
+    if (ext != "rdla" && ext != "rdlb") {
+        throw except::RuntimeError(util::buildString(
+                "File '", filePath, "' has an unknown extension."
+                " Cannot determine file type."));
+    }
+    return ext;
+}
+
+// A scene file which readScenesFromFiles() has read and parsed or expanded,
+// but not yet applied to the SceneContext.
+struct StagedSceneFile
+{
+    std::exception_ptr mError;  // rethrown when the file's turn comes
+    bool mAscii = false;
+
+    // RDL text, and its native parse if it is in the declarative subset.
+    std::string mCode;
+    std::unique_ptr<AsciiNativeReader> mNative;
+
+    BinaryReader::Staged mBinary;
+};
+
+void
+stageSceneFile(const std::string& filePath, SceneContext& context, StagedSceneFile& staged)
+{
+    staged.mAscii = sceneFileExtension(filePath) == "rdla";
+    if (!staged.mAscii) {
+        BinaryReader::stageFile(filePath, staged.mBinary);
+        return;
+    }
 
-    if (ext == "rdla") {
+    std::ifstream in(filePath.c_str(), std::ios::binary);
+    if (!in) {
+        throw except::IoError("Could not open file for reading.");
+    }
+    staged.mCode.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+
+    // Parsing only builds the reader's own data, the context isn't touched.
+    staged.mNative.reset(new AsciiNativeReader(context));
+    if (!staged.mNative->parse(staged.mCode)) {
+        staged.mNative.reset();
+    }
+}
+
+} // namespace
+
+void
+readSceneFromFile(const std::string& filePath, SceneContext& context)
+{
+    if (sceneFileExtension(filePath) == "rdla") {
         AsciiReader reader(context);
         reader.fromFile(filePath);
-    } else if (ext == "rdlb") {
+    } else {
         BinaryReader reader(context);
         reader.fromFile(filePath);
-    } else {
-        throw except::RuntimeError(util::buildString(
-                "File '", filePath, "' has an unknown extension."
-                " Cannot determine file type."));
     }
 }
 
+void
+readScenesFromFiles(const std::vector<std::string>& filePaths, SceneContext& context)
+{
+    // Stage a window of files at once and apply it before staging the next,
+    // so only a few staged files are held in memory however many are given.
+    try {
+        for (std::size_t first = 0; first < filePaths.size(); first += STAGE_WINDOW) {
+            const std::size_t count = std::min(STAGE_WINDOW, filePaths.size() - first);
+
+            // Read and parse or expand the files of the window at once.
+            std::vector<std::unique_ptr<StagedSceneFile>> staged(count);
+            tbb::parallel_for(std::size_t(0), count, [&](std::size_t i) {
+                staged[i].reset(new StagedSceneFile);
+                try {
+                    stageSceneFile(filePaths[first + i], context, *staged[i]);
+                } catch (...) {
+                    staged[i]->mError = std::current_exception();
+                }
+            });
+
+            // Get the DSOs of the window loading while its first files are
+            // applied. (Text outside the native subset prefetches its own
+            // when it runs.)
+            std::vector<std::string> classNames;
+            for (const auto& file : staged) {
+                if (file->mError) break;
+                if (!file->mAscii) {
+                    const std::vector<std::string>& names = file->mBinary.getClassNames();
+                    classNames.insert(classNames.end(), names.begin(), names.end());
+                } else if (file->mNative) {
+                    const std::vector<std::string>& names = file->mNative->getClassNames();
+                    classNames.insert(classNames.end(), names.begin(), names.end());
+                }
+            }
+            context.prefetchSceneClasses(classNames);
+
+            // Apply them in order, each with a reader of its own like
+            // readSceneFromFile() does.
+            for (std::size_t i = 0; i < count; ++i) {
+                StagedSceneFile& file = *staged[i];
+                if (file.mError) {
+                    std::rethrow_exception(file.mError);
+                }
+
+                if (file.mAscii) {
+                    AsciiReader reader(context);
+                    reader.fromParsedString(file.mCode, file.mNative.get(),
+                                            '@' + filePaths[first + i]);
+                } else {
+                    BinaryReader reader(context);
+                    reader.fromStaged(file.mBinary);
+                }
+                staged[i].reset();
+            }
+        }
+    } catch (...) {
+        // Nothing may be left loading once we return.
+        context.waitForSceneClassPrefetch();
+        throw;
+    }
+    context.waitForSceneClassPrefetch();
+}
+
 void
 writeSceneToFile(const SceneContext& context, const std::string& filePath,
                  bool deltaEncoding, bool skipDefaults, size_t elemsPerLine)
@@ -72,6 +193,7 @@ writeSceneToFile(const SceneContext& context, const std::string& filePath,
         writer.setDeltaEncoding(deltaEncoding);
         writer.setSkipDefaults(skipDefaults);
         writer.setElementsPerLine(elemsPerLine);
+        writer.setParallelEncoding(true);
         writer.toFile(filePath);
     } else if (ext == "rdlb") {
         BinaryWriter writer(context);
@@ -85,6 +207,7 @@ writeSceneToFile(const SceneContext& context, const std::string& filePath,
         awriter.setDeltaEncoding(deltaEncoding);
         awriter.setElementsPerLine(elemsPerLine);
         awriter.setMaxVectorSize(SPLIT_VEC_SIZE);
+        awriter.setParallelEncoding(true);
         awriter.toFile(filePath + ".rdla");
         BinaryWriter bwriter(context);
         bwriter.setSkipDefaults(skipDefaults);
@@ -7,6 +7,7 @@
 #include "Types.h"
 
 #include <string>
+#include <vector>
 
 namespace scene_rdl2 {
 namespace rdl2 {
@@ -23,6 +24,27 @@ namespace rdl2 {
 void
 readSceneFromFile(const std::string& filePath, SceneContext& context);
 
+/**
+ * Loads several files into a SceneContext, with the same results as calling
+ * readSceneFromFile() on each of them in order: later files override what
+ * earlier files set.
+ *
+ * A few files at a time are read, parsed and decompressed concurrently
+ * without touching the SceneContext, and the DSOs of the SceneClasses they
+ * use are opened in the background, before the staged files are applied to
+ * the SceneContext one after the other. RDL binary files are memory mapped
+ * rather than read. An error in a file is thrown once the files before it
+ * have been applied. No DSO is still being opened when this returns.
+ *
+ * @param   filePaths   The paths to the .rdla and .rdlb files, in the order
+ *                      they should be applied.
+ * @param   context     The SceneContext to read into.
+ * @throw   except::RuntimeError    If a file type cannot be inferred from
+ *                                  the file extension.
+ */
+void
+readScenesFromFiles(const std::vector<std::string>& filePaths, SceneContext& context);
+
 /**
  * Convenience function for easily dumping a SceneContext to a file, with the
  * type of writer inferred from the file extension.
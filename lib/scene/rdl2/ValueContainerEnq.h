@@ -5,6 +5,9 @@
 
 #include "ValueContainerUtil.h"
 
+#include <cstring>
+#include <type_traits>
+
 // This is a directive for debug message dump. Use this directive, all enqueue operations
 // are displayed to std::cout
 //#define VALUE_CONTAINER_ENQ_DEBUG_MSG_ON
@@ -112,6 +115,7 @@ public:
     template <typename T> void
     enqVector(const T &vec)
     {
+        static_assert(std::is_trivially_copyable<typename T::value_type>::value, "Calling memcpy");
         void *ptr =
             getEnqDataAddr
             (ValueContainerUtil::variableLengthLongMaxSize + sizeof(vec[0]) * vec.size());
@@ -122,7 +126,7 @@ public:
         VALUE_CONTAINER_ENQ_DEBUG_MSG("enqVector(" << demangle(typeid(T).name()) << ").size():>"
                                        << vec.size() << "<\n");
         // all vec items are stored in contiguous address
-        memoryCopy(ptr, &vec[0], sizeof(vec[0]) * vec.size());
+        memoryCopy(ptr, vec.data(), sizeof(vec[0]) * vec.size());
         ptr = (void *)((uintptr_t)ptr + sizeof(vec[0]) * vec.size());
         updateId(ptr);
         VALUE_CONTAINER_ENQ_COUNTER(vec);
@@ -159,6 +163,7 @@ public:
     inline void enqVLLong(const long l);
     inline void enqVLULong(const unsigned long ul);
     inline void enqVLSizeT(const size_t t) { enqVLULong(static_cast<unsigned long>(t)); }
+    inline void enqVLUIntArray(const unsigned int *array, const size_t count); // same data as count x enqVLUInt()
     inline void enqVLIntVector(const IntVector &vec);   // all variable length encoding internally
     inline void enqVLLongVector(const LongVector &vec); // all variable length encoding internally
 
@@ -562,6 +567,14 @@ ValueContainerEnq::enqVLULong(const unsigned long ul)
     VALUE_CONTAINER_ENQ_COUNTERVL(ul);
 }
 
+inline void
+ValueContainerEnq::enqVLUIntArray(const unsigned int *array, const size_t count)
+{
+    void *ptr = getEnqDataAddr(ValueContainerUtil::variableLengthIntMaxSize * count);
+    mId += ValueContainerUtil::variableLengthEncodingArray(array, count, ptr);
+    VALUE_CONTAINER_ENQ_DEBUG_MSG("enqVLUIntArray() count:>" << count << "<\n");
+}
+
 inline void
 ValueContainerEnq::enqVLIntVector(const IntVector &vec)
 {
@@ -3,10 +3,16 @@
 
 #include "ValueContainerUtil.h"
 
+#include <algorithm>
+#include <cstring>
 #include <string>
 #include <iomanip>
 #include <sstream>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 namespace scene_rdl2 {
 namespace rdl2 {
 
@@ -57,6 +63,111 @@ ValueContainerUtil::valueType2Str(ValueType valueType)
     }
 }
 
+// static function
+size_t
+ValueContainerUtil::variableLengthEncodingArray(const unsigned int *in, size_t count, void *outPtr)
+{
+    unsigned char *out = static_cast<unsigned char *>(outPtr);
+    size_t i = 0;
+
+#if defined(__SSE2__)
+    // 16 values < 128 are narrowed to 16 bytes in one go.
+    const __m128i highBits = _mm_set1_epi32(~0x7f);
+    for (; count - i >= 16; ) {
+        const __m128i v0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+        const __m128i v1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i + 4));
+        const __m128i v2 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i + 8));
+        const __m128i v3 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i + 12));
+        const __m128i any = _mm_or_si128(_mm_or_si128(v0, v1), _mm_or_si128(v2, v3));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(any, highBits), _mm_setzero_si128())) != 0xffff) {
+            // Mixed sizes: encode the next 16 one by one.
+            for (const size_t end = i + 16; i < end; ++i) {
+                out += variableLengthEncoding(in[i], out);
+            }
+            continue;
+        }
+        const __m128i bytes = _mm_packus_epi16(_mm_packs_epi32(v0, v1), _mm_packs_epi32(v2, v3));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out), bytes);
+        out += 16;
+        i += 16;
+    }
+#endif // end __SSE2__
+
+    for (; i < count; ++i) {
+        out += variableLengthEncoding(in[i], out);
+    }
+    return out - static_cast<unsigned char *>(outPtr);
+}
+
+// static function
+size_t
+ValueContainerUtil::variableLengthDecodingArray(const void *inPtr, size_t count, unsigned int *out)
+{
+    const unsigned char *in = static_cast<const unsigned char *>(inPtr);
+    size_t i = 0;
+
+    // While at least 16 values remain, at least 16 encoded bytes remain too, so it is always
+    // safe to load 16 bytes here.
+#if defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    while (count - i >= 16) {
+        const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in));
+        const unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(bytes)); // continuation bits
+
+        if (mask == 0x0) {
+            // 16 x 1 byte values : zero extend to 32 bits.
+            const __m128i lo = _mm_unpacklo_epi8(bytes, zero);
+            const __m128i hi = _mm_unpackhi_epi8(bytes, zero);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i     ), _mm_unpacklo_epi16(lo, zero));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i +  4), _mm_unpackhi_epi16(lo, zero));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i +  8), _mm_unpacklo_epi16(hi, zero));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i + 12), _mm_unpackhi_epi16(hi, zero));
+            in += 16;
+            i += 16;
+        } else if (mask == 0x5555) {
+            // 8 x 2 byte values : each 16 bit lane holds (b0 & 0x7f) | (b1 << 8).
+            const __m128i lo = _mm_and_si128(bytes, _mm_set1_epi16(0x007f));
+            const __m128i hi = _mm_srli_epi16(_mm_and_si128(bytes, _mm_set1_epi16(0x7f00)), 1);
+            const __m128i v = _mm_or_si128(lo, hi);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i    ), _mm_unpacklo_epi16(v, zero));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i + 4), _mm_unpackhi_epi16(v, zero));
+            in += 16;
+            i += 8;
+        } else {
+            // Mixed sizes: decode the values ending inside these 16 bytes one by one. A broken
+            // stream may have no value ending here at all, still decode one to make progress.
+            const int n = std::max(__builtin_popcount(~mask & 0xffff), 1);
+            for (int k = 0; k < n; ++k, ++i) {
+                in += variableLengthDecoding(in, out[i]);
+            }
+        }
+    }
+#else
+    // Copy runs of 8 x 1 byte values found with a 64 bit word.
+    while (count - i >= 8) {
+        uint64_t word;
+        std::memcpy(&word, in, sizeof(uint64_t));
+        const uint64_t stopBits = ~word & 0x8080808080808080ULL; // one per value ending in the word
+        if (stopBits != 0x8080808080808080ULL) {
+            // Decode at least one value, a broken stream may have no value ending in the word.
+            const int n = std::max(__builtin_popcountll(stopBits), 1);
+            for (int k = 0; k < n; ++k, ++i) {
+                in += variableLengthDecoding(in, out[i]);
+            }
+            continue;
+        }
+        for (int n = 0; n < 8; ++n) out[i + n] = in[n];
+        in += 8;
+        i += 8;
+    }
+#endif // end !__SSE2__
+
+    for (; i < count; ++i) {
+        in += variableLengthDecoding(in, out[i]);
+    }
+    return in - static_cast<const unsigned char *>(inPtr);
+}
+
 // static function
 std::string
 ValueContainerUtil::hexDump(const std::string &titleMsg, const void *buff, const size_t size)
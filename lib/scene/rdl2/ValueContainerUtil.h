@@ -65,6 +65,14 @@ public:
     static inline size_t variableLengthDecoding(const void *in, unsigned int &ui);
     static inline size_t variableLengthEncodingSize(unsigned int ui); // return encoded data size only
 
+    // Batch versions of the above for count unsigned ints. The encoded bytes are identical to count
+    // calls of the single value functions. On x86 these use an SSE2 kernel which encodes/decodes runs
+    // of 1 byte values 16 at a time and runs of 2 byte values 8 at a time (like masked-vbyte, the
+    // continuation bits are collected with movemask), other platforms use a scalar path which skips
+    // over runs of 1 byte values 8 at a time. Both return the encoded data size.
+    static size_t variableLengthEncodingArray(const unsigned int *in, size_t count, void *out);
+    static size_t variableLengthDecodingArray(const void *in, size_t count, unsigned int *out);
+
     static inline size_t variableLengthEncoding(int i, void *out);
     static inline size_t variableLengthDecoding(const void *in, int &i);
     static inline size_t variableLengthEncodingSize(int i); // return encoded data size only
@@ -89,6 +89,7 @@
 #include "AsciiReader.h"
 #include "AsciiWriter.h"
 #include "Attribute.h"
+#include "AttributeColumn.h"
 #include "AttributeKey.h"
 #include "BinaryReader.h"
 #include "BinaryWriter.h"
@@ -98,6 +99,7 @@
 #include "DisplayFilter.h"
 #include "Dso.h"
 #include "DsoFinder.h"
+#include "DsoManifest.h"
 #include "EnvMap.h"
 #include "Geometry.h"
 #include "GeometrySet.h"
@@ -123,6 +125,7 @@
 #include "ShadowReceiverSet.h"
 #include "ShadowSet.h"
 #include "Slice.h"
+#include "Symbol.h"
 #include "TraceSet.h"
 #include "Types.h"
 #include "UserData.h"
@@ -41,6 +41,10 @@ end
 -- We track each global as it's assigned (through the __newindex() metamethod).
 mt.__declared = {}
 
+-- The constructor closures created by __index(), so the C side can tell them
+-- apart from globals assigned by the user.
+mt.__constructors = {}
+
 -- The __newindex() metamethod is invoked whenever a value is assigned to a
 -- global.
 mt.__newindex = function(globals, key, value)
@@ -97,6 +101,7 @@ mt.__index = function(globals, key)
             -- Creating the constructor on the fly succeeded. Save the closure
             -- in the global so we don't do it again.
             mt.__declared[key] = true
+            mt.__constructors[key] = ctor
             rawset(globals, key, ctor)
             return ctor
         end
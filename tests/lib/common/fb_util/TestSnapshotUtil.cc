@@ -318,6 +318,13 @@ TestSnapshotUtil::testWeightMask()
                  flag = false;
              }
              return flag;
+         },
+         [&](int offsetItem) { // snapshotTileFuncC
+            uint32_t* dstWPtr = reinterpret_cast<uint32_t*>(dstWAddr + offsetItem * sizeof(float));
+            uint32_t* srcWPtr = reinterpret_cast<uint32_t*>(srcWAddr + offsetItem * sizeof(float));
+            int tileId = offsetItem / (sTileReso * sTileReso);
+            return fb_util::SnapshotUtil::snapshotTileWeightBuffer_AVX512(dstWPtr, dstPixMaskBuff[tileId],
+                                                                          srcWPtr, srcPixMaskBuff[tileId]);
          });
 
     free(dstW);
@@ -337,6 +344,10 @@ TestSnapshotUtil::testFloatWeight()
                      [&](uint32_t* dstVPtr, uint32_t* dstWPtr, uint32_t* srcVPtr, uint32_t* srcWPtr) {
                          return fb_util::SnapshotUtil::snapshotTileFloatWeight_SISD
                              (dstVPtr, dstWPtr, srcVPtr, srcWPtr);
+                     },
+                     [&](uint32_t* dstVPtr, uint32_t* dstWPtr, uint32_t* srcVPtr, uint32_t* srcWPtr) {
+                         return fb_util::SnapshotUtil::snapshotTileFloatWeight_AVX512
+                             (dstVPtr, dstWPtr, srcVPtr, srcWPtr);
                      });
 }
 
@@ -353,6 +364,11 @@ TestSnapshotUtil::testFloatNumSample()
                             uint32_t* srcVPtr, uint32_t* srcNPtr, uint64_t srcPixMask) {
                             return fb_util::SnapshotUtil::snapshotTileFloatNumSample_SISD
                                 (dstVPtr, dstNPtr, dstPixMask, srcVPtr, srcNPtr, srcPixMask);
+                        },
+                        [&](uint32_t* dstVPtr, uint32_t* dstNPtr, uint64_t dstPixMask,
+                            uint32_t* srcVPtr, uint32_t* srcNPtr, uint64_t srcPixMask) {
+                            return fb_util::SnapshotUtil::snapshotTileFloatNumSample_AVX512
+                                (dstVPtr, dstNPtr, dstPixMask, srcVPtr, srcNPtr, srcPixMask);
                         });
 }
 
@@ -368,6 +384,10 @@ TestSnapshotUtil::testFloat2Weight()
                      [&](uint32_t* dstVPtr, uint32_t* dstWPtr, uint32_t* srcVPtr, uint32_t* srcWPtr) {
                          return fb_util::SnapshotUtil::snapshotTileFloat2Weight_SISD
                              (dstVPtr, dstWPtr, srcVPtr, srcWPtr);
+                     },
+                     [&](uint32_t* dstVPtr, uint32_t* dstWPtr, uint32_t* srcVPtr, uint32_t* srcWPtr) {
+                         return fb_util::SnapshotUtil::snapshotTileFloat2Weight_AVX512
+                             (dstVPtr, dstWPtr, srcVPtr, srcWPtr);
                      });
 }
 
@@ -384,6 +404,11 @@ TestSnapshotUtil::testFloat2NumSample()
                             uint32_t* srcVPtr, uint32_t* srcNPtr, uint64_t srcPixMask) {
                             return fb_util::SnapshotUtil::snapshotTileFloat2NumSample_SISD
                                 (dstVPtr, dstNPtr, dstPixMask, srcVPtr, srcNPtr, srcPixMask);
+                        },
+                        [&](uint32_t* dstVPtr, uint32_t* dstNPtr, uint64_t dstPixMask,
+                            uint32_t* srcVPtr, uint32_t* srcNPtr, uint64_t srcPixMask) {
+                            return fb_util::SnapshotUtil::snapshotTileFloat2NumSample_AVX512
+                                (dstVPtr, dstNPtr, dstPixMask, srcVPtr, srcNPtr, srcPixMask);
                         });
 }
     
@@ -399,6 +424,10 @@ TestSnapshotUtil::testFloat3Weight()
                      [&](uint32_t* dstVPtr, uint32_t* dstWPtr, uint32_t* srcVPtr, uint32_t* srcWPtr) {
                          return fb_util::SnapshotUtil::snapshotTileFloat3Weight_SISD
                              (dstVPtr, dstWPtr, srcVPtr, srcWPtr);
+                     },
+                     [&](uint32_t* dstVPtr, uint32_t* dstWPtr, uint32_t* srcVPtr, uint32_t* srcWPtr) {
+                         return fb_util::SnapshotUtil::snapshotTileFloat3Weight_AVX512
+                             (dstVPtr, dstWPtr, srcVPtr, srcWPtr);
                      });
 }
 
@@ -415,6 +444,11 @@ TestSnapshotUtil::testFloat3NumSample()
                             uint32_t* srcVPtr, uint32_t* srcNPtr, uint64_t srcPixMask) {
                             return fb_util::SnapshotUtil::snapshotTileFloat3NumSample_SISD
                                 (dstVPtr, dstNPtr, dstPixMask, srcVPtr, srcNPtr, srcPixMask);
+                        },
+                        [&](uint32_t* dstVPtr, uint32_t* dstNPtr, uint64_t dstPixMask,
+                            uint32_t* srcVPtr, uint32_t* srcNPtr, uint64_t srcPixMask) {
+                            return fb_util::SnapshotUtil::snapshotTileFloat3NumSample_AVX512
+                                (dstVPtr, dstNPtr, dstPixMask, srcVPtr, srcNPtr, srcPixMask);
                         });
 }
 
@@ -430,6 +464,10 @@ TestSnapshotUtil::testFloat4Weight()
                      [&](uint32_t* dstVPtr, uint32_t* dstWPtr, uint32_t* srcVPtr, uint32_t* srcWPtr) {
                          return fb_util::SnapshotUtil::snapshotTileFloat4Weight_SISD
                              (dstVPtr, dstWPtr, srcVPtr, srcWPtr);
+                     },
+                     [&](uint32_t* dstVPtr, uint32_t* dstWPtr, uint32_t* srcVPtr, uint32_t* srcWPtr) {
+                         return fb_util::SnapshotUtil::snapshotTileFloat4Weight_AVX512
+                             (dstVPtr, dstWPtr, srcVPtr, srcWPtr);
                      });
 }
 
@@ -446,6 +484,11 @@ TestSnapshotUtil::testFloat4NumSample()
                             uint32_t* srcVPtr, uint32_t* srcNPtr, uint64_t srcPixMask) {
                             return fb_util::SnapshotUtil::snapshotTileFloat4NumSample_SISD
                                 (dstVPtr, dstNPtr, dstPixMask, srcVPtr, srcNPtr, srcPixMask);
+                        },
+                        [&](uint32_t* dstVPtr, uint32_t* dstNPtr, uint64_t dstPixMask,
+                            uint32_t* srcVPtr, uint32_t* srcNPtr, uint64_t srcPixMask) {
+                            return fb_util::SnapshotUtil::snapshotTileFloat4NumSample_AVX512
+                                (dstVPtr, dstNPtr, dstPixMask, srcVPtr, srcNPtr, srcPixMask);
                         });
 }
     
@@ -455,7 +498,8 @@ void
 TestSnapshotUtil::testFloatNWeight(const std::string& testName,
                                    const int pixDim,
                                    const TestSnapshotTileFunc& snapshotTileFuncA,
-                                   const TestSnapshotTileFunc& snapshotTileFuncB)
+                                   const TestSnapshotTileFunc& snapshotTileFuncB,
+                                   const TestSnapshotTileFunc& snapshotTileFuncC)
 {
     int w = sTileReso * 240; // = 1920
     int h = sTileReso * 135; // = 1080
@@ -558,6 +602,13 @@ TestSnapshotUtil::testFloatNWeight(const std::string& testName,
              }
              */
              return flag;
+         },
+         [&](int offsetItem) { // snapshotTileFuncC
+             uint32_t* dstVPtr = reinterpret_cast<uint32_t*>(dstVAddr + offsetItem * sizeof(float) * pixDim);
+             uint32_t* dstWPtr = reinterpret_cast<uint32_t*>(dstWAddr + offsetItem * sizeof(float));
+             uint32_t* srcVPtr = reinterpret_cast<uint32_t*>(srcVAddr + offsetItem * sizeof(float) * pixDim);
+             uint32_t* srcWPtr = reinterpret_cast<uint32_t*>(srcWAddr + offsetItem * sizeof(float));
+             return snapshotTileFuncC(dstVPtr, dstWPtr, srcVPtr, srcWPtr);
          });
 
     free(dstV);
@@ -571,7 +622,8 @@ TestSnapshotUtil::testFloatNWeight(const std::string& testName,
 void
 TestSnapshotUtil::testFloatNNumSample(const int pixDim,
                                       const TestSnapshotTileFunc2& snapshotTileFuncA,
-                                      const TestSnapshotTileFunc2& snapshotTileFuncB)
+                                      const TestSnapshotTileFunc2& snapshotTileFuncB,
+                                      const TestSnapshotTileFunc2& snapshotTileFuncC)
 {
     int w = sTileReso * 240; // = 1920
     int h = sTileReso * 135; // = 1080
@@ -669,6 +721,15 @@ TestSnapshotUtil::testFloatNNumSample(const int pixDim,
                  flag = false;
              }
              return flag;
+         },
+         [&](int offsetItem) { // snapshotTileFuncC
+            uint32_t* dstVPtr = reinterpret_cast<uint32_t*>(dstVAddr + offsetItem * sizeof(float) * pixDim);
+            uint32_t* dstNPtr = reinterpret_cast<uint32_t*>(dstNAddr + offsetItem * sizeof(unsigned int));
+            uint32_t* srcVPtr = reinterpret_cast<uint32_t*>(srcVAddr + offsetItem * sizeof(float) * pixDim);
+            uint32_t* srcNPtr = reinterpret_cast<uint32_t*>(srcNAddr + offsetItem * sizeof(unsigned int));
+            int tileId = offsetItem / (sTileReso * sTileReso);
+            return snapshotTileFuncC(dstVPtr, dstNPtr, dstPixMaskBuff[tileId],
+                                     srcVPtr, srcNPtr, srcPixMaskBuff[tileId]);
          });
 
     free(dstV);
@@ -1271,7 +1332,8 @@ TestSnapshotUtil::snapshotTimingCompare(const int w, // should be tile aligned r
                                         const std::function<uint64_t(int offsetItem)>& snapshotTileFuncA,
                                         const std::function<uint64_t(int offsetItem)>& snapshotTileFuncB,
                                         const std::function<bool(const std::string& msg,
-                                                                 std::vector<uint64_t> &)>& verifyFunc) const
+                                                                 std::vector<uint64_t> &)>& verifyFunc,
+                                        const std::function<uint64_t(int offsetItem)>& snapshotTileFuncC) const
 {
 #ifdef TIMING_TEST
     int timingTestLoopMax = 128; // for performance test
@@ -1311,9 +1373,31 @@ TestSnapshotUtil::snapshotTimingCompare(const int w, // should be tile aligned r
     timeB /= static_cast<float>(timingTestLoopMax);
     CPPUNIT_ASSERT(verifyFunc("testFuncB", pixMaskBuff));
 
+    // funcC is the AVX512 version and only runs on the CPU which supports AVX512
+    bool testC = snapshotTileFuncC && SnapshotUtil::isAVX512Available();
+    float timeC = 0.0f;
+    if (testC) {
+        pixMaskBuff.clear();
+        pixMaskBuff.resize(tileTotal, static_cast<uint64_t>(0x0));
+        for (int i = 0; i < timingTestLoopMax; ++i) {
+            resetDataFunc();
+            recTime.start();
+            {
+                snapshotTileLoop(w, h, pixMaskBuff, snapshotTileFuncC);
+            }
+            timeC += recTime.end();
+        }
+        timeC /= static_cast<float>(timingTestLoopMax);
+        CPPUNIT_ASSERT(verifyFunc("testFuncC", pixMaskBuff));
+    }
+
 #ifdef TIMING_TEST  
     std::cerr << "timeA:" << timeA * 1000.0f << "ms (" << timeB / timeA << "x) "
-              << "timeB:" << timeB * 1000.0f << "ms (" << timeA / timeB << "x)" << std::endl;
+              << "timeB:" << timeB * 1000.0f << "ms (" << timeA / timeB << "x)";
+    if (testC) {
+        std::cerr << " timeC:" << timeC * 1000.0f << "ms (" << timeB / timeC << "x of timeB)";
+    }
+    std::cerr << std::endl;
 #endif // end TIMING_TEST
 }
 
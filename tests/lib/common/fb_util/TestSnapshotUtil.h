@@ -55,10 +55,12 @@ private:
     void testFloatNWeight(const std::string& testName,
                           const int pixDim,
                           const TestSnapshotTileFunc& snapshotTileFuncA,
-                          const TestSnapshotTileFunc& snapshotTileFuncB);
+                          const TestSnapshotTileFunc& snapshotTileFuncB,
+                          const TestSnapshotTileFunc& snapshotTileFuncC);
     void testFloatNNumSample(const int pixDim,
                              const TestSnapshotTileFunc2& snapshotTileFuncA,
-                             const TestSnapshotTileFunc2& snapshotTileFuncB);
+                             const TestSnapshotTileFunc2& snapshotTileFuncB,
+                             const TestSnapshotTileFunc2& snapshotTileFuncC);
 
     template <typename T> void setupBuffRandom(std::vector<T>& buff) const; // setup random val buffer
     template <typename T> void setupBuffZero(std::vector<T>& buff,
@@ -131,7 +133,9 @@ private:
                                const std::function<uint64_t(int offsetItem)>& snapshotTileFuncA,
                                const std::function<uint64_t(int offsetItem)>& snapshotTileFuncB,
                                const std::function<bool(const std::string& msg,
-                                                        std::vector<uint64_t>&)>& verifyFunc) const;
+                                                        std::vector<uint64_t>&)>& verifyFunc,
+                               // AVX512 version : skipped if empty or AVX512 is not available
+                               const std::function<uint64_t(int offsetItem)>& snapshotTileFuncC = nullptr) const;
     bool verifyPixMask(std::vector<int> &updatePixIdArray, std::vector<uint64_t> &pixMaskBuff) const;
 
     std::string showTile(int tileId, int offsetItem,
@@ -0,0 +1,178 @@
+// Copyright 2023-2024 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+#include "TestCrc32c.h"
+#include "TimeOutput.h"
+
+#include <scene_rdl2/common/fb_util/ActivePixels.h>
+#include <scene_rdl2/common/grid_util/PackActiveTiles.h>
+#include <scene_rdl2/common/grid_util/PackTiles.h>
+
+#include <cstring>
+#include <random>
+
+namespace scene_rdl2 {
+namespace grid_util {
+namespace unittest {
+
+void
+TestCrc32c::testHash()
+{
+    TIME_START;
+
+    // standard CRC32C check value
+    const std::string check("123456789");
+    CPPUNIT_ASSERT(~refCrc32c(~0u, reinterpret_cast<const unsigned char *>(check.data()),
+                              check.size()) == 0xe3069283);
+
+    // every tail length and lane split position
+    const std::string data = randomDataGen(200);
+    for (size_t size = 0; size <= data.size(); ++size) {
+        const std::string curr = data.substr(0, size);
+        CPPUNIT_ASSERT("testHash" && Crc32cUtil::hash(curr) == refHash(curr));
+    }
+
+    const std::string big = randomDataGen(123456);
+    CPPUNIT_ASSERT("testHash big" && Crc32cUtil::hash(big) == refHash(big));
+
+    // unaligned start address
+    CPPUNIT_ASSERT(Crc32cUtil::hash(big.data() + 3, 1000) == refHash(big.substr(3, 1000)));
+
+    // trailing zero bytes change the hash
+    CPPUNIT_ASSERT(Crc32cUtil::hash(std::string(64, 0x0)) != Crc32cUtil::hash(std::string(65, 0x0)));
+
+    TIME_END;
+}
+
+void
+TestCrc32c::testGen()
+{
+    TIME_START;
+
+    // every split position and split pattern gives the same hash as the whole data
+    const std::string data = randomDataGen(300);
+    Crc32cGen crc;
+    for (size_t size = 0; size <= data.size(); size += 7) {
+        const Crc32cUtil::Hash hash = Crc32cUtil::hash(data.data(), size);
+        for (size_t split = 0; split <= size; ++split) {
+            crc.init();
+            crc.updateByteData(data.data(), split);
+            crc.updateByteData(data.data() + split, size - split);
+            CPPUNIT_ASSERT("testGen split" && crc.finalize() == hash);
+        }
+
+        crc.init();
+        for (size_t i = 0; i < size; ++i) crc.updateByteData(data.data() + i, 1);
+        CPPUNIT_ASSERT("testGen byte" && crc.finalize() == hash);
+    }
+
+    TIME_END;
+}
+
+void
+TestCrc32c::testPackTilesHash()
+{
+    TIME_START;
+
+    fb_util::ActivePixels activePixels;
+    activePixels.init(160, 120);
+    PackActiveTiles::randomActivePixels(activePixels, 5000);
+
+    fb_util::RenderBuffer renderBufferTiled;
+    fb_util::FloatBuffer weightBufferTiled;
+    renderBufferTiled.init(activePixels.getAlignedWidth(), activePixels.getAlignedHeight());
+    weightBufferTiled.init(activePixels.getAlignedWidth(), activePixels.getAlignedHeight());
+    renderBufferTiled.clear(fb_util::RenderColor(0.25f, 0.5f, 0.75f, 1.0f));
+    weightBufferTiled.clear(2.0f);
+
+    auto encode = [&](const bool withHash, const PackTiles::HashType hashType) {
+        std::string data;
+        PackTiles::encode(false, // renderBufferOdd
+                          activePixels, renderBufferTiled, weightBufferTiled, data,
+                          PackTiles::PrecisionMode::F32,
+                          CoarsePassPrecision::F32,
+                          FinePassPrecision::F32,
+                          false, // noNumSampleMode
+                          withHash,
+                          PackTiles::EnqFormatVer::VER2,
+                          hashType);
+        return data;
+    };
+
+    const std::string noHash = encode(false, PackTiles::HashType::CRC32C);
+    const std::string sha1 = encode(true, PackTiles::HashType::SHA1);
+    const std::string crc = encode(true, PackTiles::HashType::CRC32C);
+
+    // SHA1 and no hash data keep the original format : only the hash region differs.
+    CPPUNIT_ASSERT(noHash.size() == sha1.size());
+    CPPUNIT_ASSERT(noHash.compare(PackTiles::HASH_SIZE, std::string::npos,
+                                  sha1, PackTiles::HASH_SIZE, std::string::npos) == 0);
+
+    CPPUNIT_ASSERT(!PackTiles::verifyDecodeHash(noHash.data(), noHash.size()));
+    for (const std::string *data : {&sha1, &crc}) {
+        CPPUNIT_ASSERT(PackTiles::verifyDecodeHash(data->data(), data->size()));
+        CPPUNIT_ASSERT(PackTiles::decodeDataType(data->data(), data->size()) ==
+                       PackTiles::DataType::BEAUTY_WITH_NUMSAMPLE);
+
+        std::string broken = *data;
+        broken[broken.size() - 1] ^= 0x10;
+        CPPUNIT_ASSERT(!PackTiles::verifyDecodeHash(broken.data(), broken.size()));
+    }
+
+    TIME_END;
+}
+
+// static function
+uint32_t
+TestCrc32c::refCrc32c(uint32_t crc, const unsigned char *data, size_t size)
+{
+    for (size_t i = 0; i < size; ++i) {
+        crc ^= data[i];
+        for (int k = 0; k < 8; ++k) {
+            crc = (crc & 1) ? ((crc >> 1) ^ 0x82f63b78) : (crc >> 1);
+        }
+    }
+    return crc;
+}
+
+// static function
+Crc32cUtil::Hash
+TestCrc32c::refHash(const std::string &data)
+{
+    const unsigned char *ptr = reinterpret_cast<const unsigned char *>(data.data());
+    const size_t size = data.size();
+    const size_t mainSize = size / 32 * 32;
+
+    uint32_t lane[4] = {~0u, ~0u, ~0u, ~0u};
+    for (size_t offset = 0; offset < mainSize; offset += 8) {
+        uint32_t &crc = lane[(offset / 8) % 4];
+        crc = refCrc32c(crc, ptr + offset, 8);
+    }
+    lane[0] = refCrc32c(lane[0], ptr + mainSize, size - mainSize);
+
+    Crc32cUtil::Hash hash;
+    for (unsigned laneId = 0; laneId < 4; ++laneId) {
+        const uint64_t sizeInfo = static_cast<uint64_t>(size) + laneId;
+        unsigned char sizeByte[8];
+        for (int i = 0; i < 8; ++i) sizeByte[i] = static_cast<unsigned char>(sizeInfo >> (i * 8));
+        const uint32_t v = ~refCrc32c(lane[laneId], sizeByte, 8);
+        for (int i = 0; i < 4; ++i) hash[laneId * 4 + i] = static_cast<unsigned char>(v >> (i * 8));
+    }
+    return hash;
+}
+
+std::string
+TestCrc32c::randomDataGen(size_t size) const
+{
+    std::mt19937 mt(size);
+    std::uniform_int_distribution<int> dist(0, 255);
+
+    std::string data(size, 0x0);
+    for (size_t i = 0; i < size; ++i) {
+        data[i] = static_cast<char>(dist(mt));
+    }
+    return data;
+}
+
+} // namespace unittest
+} // namespace grid_util
+} // namespace scene_rdl2
@@ -0,0 +1,42 @@
+// Copyright 2023-2024 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+#pragma once
+
+#include <scene_rdl2/common/grid_util/Crc32cUtil.h>
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/TestFixture.h>
+
+#include <cstdint>
+
+namespace scene_rdl2 {
+namespace grid_util {
+namespace unittest {
+
+class TestCrc32c : public CppUnit::TestFixture
+{
+public:
+    void setUp() {}
+    void tearDown() {}
+
+    void testHash();
+    void testGen();
+    void testPackTilesHash();
+
+    CPPUNIT_TEST_SUITE(TestCrc32c);
+    CPPUNIT_TEST(testHash);
+    CPPUNIT_TEST(testGen);
+    CPPUNIT_TEST(testPackTilesHash);
+    CPPUNIT_TEST_SUITE_END();
+
+protected:
+    // Straightforward bitwise reference implementation of Crc32cUtil::hash()
+    static uint32_t refCrc32c(uint32_t crc, const unsigned char *data, size_t size);
+    static Crc32cUtil::Hash refHash(const std::string &data);
+
+    std::string randomDataGen(size_t size) const;
+};
+
+} // namespace unittest
+} // namespace grid_util
+} // namespace scene_rdl2
@@ -0,0 +1,374 @@
+// Copyright 2023-2024 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+#include "TestPackTiles.h"
+#include "TimeOutput.h"
+
+#include <scene_rdl2/common/grid_util/PackActiveTiles.h>
+#include <scene_rdl2/common/grid_util/PackTiles.h>
+#include <scene_rdl2/common/grid_util/PackTilesBuffer.h>
+#include <scene_rdl2/common/grid_util/RansCodec.h>
+#include <scene_rdl2/scene/rdl2/ValueContainerUtil.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace scene_rdl2 {
+namespace grid_util {
+namespace unittest {
+
+namespace {
+
+std::string
+encodeBeauty(const fb_util::ActivePixels &activePixels,
+             const fb_util::RenderBuffer &renderBufferTiled,
+             const fb_util::FloatBuffer &weightBufferTiled,
+             const PackTiles::PrecisionMode precisionMode,
+             const PackTiles::EnqFormatVer enqFormatVer,
+             const unsigned bandTotal)
+{
+    std::string data;
+    PackTiles::encode(false, // renderBufferOdd
+                      activePixels, renderBufferTiled, weightBufferTiled, data,
+                      precisionMode,
+                      CoarsePassPrecision::F32,
+                      FinePassPrecision::F32,
+                      false, // noNumSampleMode
+                      true,  // withHash
+                      enqFormatVer,
+                      PackTiles::HashType::CRC32C,
+                      bandTotal);
+    return data;
+}
+
+size_t
+encodeBeauty(const fb_util::ActivePixels &activePixels,
+             const fb_util::RenderBuffer &renderBufferTiled,
+             const fb_util::FloatBuffer &weightBufferTiled,
+             const PackTiles::EnqFormatVer enqFormatVer,
+             const PackTiles::HashType hashType,
+             const unsigned bandTotal,
+             PackTilesBuffer &buffer)
+{
+    return PackTiles::encode(false, // renderBufferOdd
+                             activePixels, renderBufferTiled, weightBufferTiled, buffer,
+                             PackTiles::PrecisionMode::F32,
+                             CoarsePassPrecision::F32,
+                             FinePassPrecision::F32,
+                             false, // noNumSampleMode
+                             true,  // withHash
+                             enqFormatVer,
+                             hashType,
+                             bandTotal);
+}
+
+bool
+decodeBeauty(const std::string &data,
+             fb_util::ActivePixels &activePixels,
+             fb_util::RenderBuffer &normalizedRenderBufferTiled,
+             PackTiles::NumSampleBuffer &numSampleBufferTiled)
+{
+    CoarsePassPrecision coarsePassPrecision;
+    FinePassPrecision finePassPrecision;
+    bool activeDecodeAction;
+    return PackTiles::decode(false, // renderBufferOdd
+                             data.data(), data.size(),
+                             true, // storeNumSampleData
+                             activePixels,
+                             normalizedRenderBufferTiled,
+                             numSampleBufferTiled,
+                             coarsePassPrecision,
+                             finePassPrecision,
+                             activeDecodeAction);
+}
+
+// Replaces the numSample stream of a single band VER3 beauty packet by a stream of continuation
+// bytes only (no value ends in it) and patches the sizes around it. Returns false if the
+// numSample stream is not found. The VER3 pixel block is the tail of the packet :
+//   ... | withNumSample(1) | numSampleStreamSize | codedSize | byte plane blocks | numSample block
+bool
+breakNumSampleStream(std::string &data)
+{
+    using rdl2::ValueContainerUtil;
+    const unsigned char *ptr = reinterpret_cast<const unsigned char *>(data.data());
+    for (size_t codedSizePos = PackTiles::HASH_SIZE + sizeof(size_t); codedSizePos < data.size();
+         ++codedSizePos) {
+        unsigned long codedSize;
+        const size_t codedSizeLen = ValueContainerUtil::variableLengthDecoding(ptr + codedSizePos,
+                                                                               codedSize);
+        const size_t codedPos = codedSizePos + codedSizeLen;
+        if (codedPos + codedSize != data.size()) continue;
+
+        size_t streamSizePos = codedSizePos - 1;
+        while (streamSizePos > 0 && (ptr[streamSizePos - 1] & 0x80)) --streamSizePos;
+        if (streamSizePos == 0 || ptr[streamSizePos - 1] != 0x1) continue; // withNumSample
+        unsigned long streamSize;
+        ValueContainerUtil::variableLengthDecoding(ptr + streamSizePos, streamSize);
+
+        // The numSample block ends at the end of the packet and is preceded by the byte plane
+        // blocks, each of them holds one byte per record (= value in the numSample stream).
+        const unsigned char *coded = ptr + codedPos;
+        std::string stream(streamSize, '\0');
+        for (size_t blockPos = 0; blockPos < codedSize; ++blockPos) {
+            if (RansCodec::decode(coded + blockPos, codedSize - blockPos,
+                                  &stream[0], streamSize) != codedSize - blockPos) {
+                continue;
+            }
+            const size_t recTotal = std::count_if(stream.begin(), stream.end(),
+                                                  [](const char c) { return !(c & 0x80); });
+            std::string plane(recTotal, '\0');
+            size_t planePos = 0;
+            while (planePos < blockPos) {
+                const size_t size = RansCodec::decode(coded + planePos, blockPos - planePos,
+                                                      &plane[0], recTotal);
+                if (!size) break;
+                planePos += size;
+            }
+            if (planePos != blockPos) continue;
+
+            std::string broken;
+            RansCodec::encode(std::string(streamSize, '\x80').data(), streamSize, broken);
+
+            unsigned char vl[ValueContainerUtil::variableLengthLongMaxSize];
+            const size_t vlSize = ValueContainerUtil::variableLengthEncoding(blockPos + broken.size(), vl);
+            data = data.substr(0, codedSizePos) +
+                std::string(reinterpret_cast<const char *>(vl), vlSize) +
+                data.substr(codedPos, blockPos) + broken;
+            const size_t dataSize = data.size() - PackTiles::HASH_SIZE;
+            std::memcpy(&data[PackTiles::HASH_SIZE], &dataSize, sizeof(size_t));
+            return true;
+        }
+    }
+    return false;
+}
+
+template <typename T>
+bool
+sameBuffer(const fb_util::PixelBuffer<T> &a, const fb_util::PixelBuffer<T> &b)
+{
+    if (a.getWidth() != b.getWidth() || a.getHeight() != b.getHeight()) return false;
+    return std::memcmp(a.getData(), b.getData(), a.getWidth() * a.getHeight() * sizeof(T)) == 0;
+}
+
+} // namespace
+
+void
+TestPackTiles::setUp()
+{
+    mActivePixels.init(203, 117);
+    PackActiveTiles::randomActivePixels(mActivePixels, 6000);
+
+    const unsigned alignedWidth = mActivePixels.getAlignedWidth();
+    const unsigned alignedHeight = mActivePixels.getAlignedHeight();
+    mRenderBufferTiled.init(alignedWidth, alignedHeight);
+    mWeightBufferTiled.init(alignedWidth, alignedHeight);
+    for (unsigned y = 0; y < alignedHeight; ++y) {
+        for (unsigned x = 0; x < alignedWidth; ++x) {
+            mRenderBufferTiled.setPixel(x, y, fb_util::RenderColor(static_cast<float>(x) * 0.01f,
+                                                                   static_cast<float>(y) * 0.02f,
+                                                                   0.5f, 1.0f));
+            mWeightBufferTiled.setPixel(x, y, static_cast<float>(1 + (x + y) % 7));
+        }
+    }
+}
+
+void
+TestPackTiles::testBandFormat()
+{
+    TIME_START;
+
+    for (PackTiles::EnqFormatVer ver : {PackTiles::EnqFormatVer::VER2, PackTiles::EnqFormatVer::VER3}) {
+        const std::string single =
+            encodeBeauty(mActivePixels, mRenderBufferTiled, mWeightBufferTiled,
+                         PackTiles::PrecisionMode::F32, ver, 1);
+        const std::string banded =
+            encodeBeauty(mActivePixels, mRenderBufferTiled, mWeightBufferTiled,
+                         PackTiles::PrecisionMode::F32, ver, 4);
+
+        // bandTotal = 1 (and 0) keeps the original format
+        CPPUNIT_ASSERT(single == encodeBeauty(mActivePixels, mRenderBufferTiled, mWeightBufferTiled,
+                                              PackTiles::PrecisionMode::F32, ver, 0));
+        CPPUNIT_ASSERT(single != banded);
+
+        CPPUNIT_ASSERT(PackTiles::verifyDecodeHash(banded.data(), banded.size()));
+        CPPUNIT_ASSERT(PackTiles::decodeDataType(banded.data(), banded.size()) ==
+                       PackTiles::DataType::BEAUTY_WITH_NUMSAMPLE);
+    }
+
+    // VER1 has no banded format and silently falls back to a single band.
+    CPPUNIT_ASSERT(encodeBeauty(mActivePixels, mRenderBufferTiled, mWeightBufferTiled,
+                                PackTiles::PrecisionMode::F32, PackTiles::EnqFormatVer::VER1, 4) ==
+                   encodeBeauty(mActivePixels, mRenderBufferTiled, mWeightBufferTiled,
+                                PackTiles::PrecisionMode::F32, PackTiles::EnqFormatVer::VER1, 1));
+
+    TIME_END;
+}
+
+void
+TestPackTiles::testBandDecode()
+{
+    TIME_START;
+
+    for (PackTiles::EnqFormatVer ver : {PackTiles::EnqFormatVer::VER2, PackTiles::EnqFormatVer::VER3}) {
+        for (PackTiles::PrecisionMode precisionMode : {PackTiles::PrecisionMode::F32,
+                                                       PackTiles::PrecisionMode::H16,
+                                                       PackTiles::PrecisionMode::UC8}) {
+            fb_util::ActivePixels refActivePixels;
+            fb_util::RenderBuffer refRenderBufferTiled;
+            PackTiles::NumSampleBuffer refNumSampleBufferTiled;
+            CPPUNIT_ASSERT(decodeBeauty(encodeBeauty(mActivePixels, mRenderBufferTiled, mWeightBufferTiled,
+                                                     precisionMode, ver, 1),
+                                        refActivePixels, refRenderBufferTiled, refNumSampleBufferTiled));
+
+            // more bands than active tiles is clamped internally
+            for (unsigned bandTotal : {2u, 5u, 64u, 100000u}) {
+                fb_util::ActivePixels activePixels;
+                fb_util::RenderBuffer renderBufferTiled;
+                PackTiles::NumSampleBuffer numSampleBufferTiled;
+                CPPUNIT_ASSERT(decodeBeauty(encodeBeauty(mActivePixels, mRenderBufferTiled,
+                                                         mWeightBufferTiled,
+                                                         precisionMode, ver, bandTotal),
+                                            activePixels, renderBufferTiled, numSampleBufferTiled));
+                CPPUNIT_ASSERT(activePixels.compare(refActivePixels));
+                CPPUNIT_ASSERT(sameBuffer(renderBufferTiled, refRenderBufferTiled));
+                CPPUNIT_ASSERT(sameBuffer(numSampleBufferTiled, refNumSampleBufferTiled));
+            }
+        }
+    }
+
+    TIME_END;
+}
+
+void
+TestPackTiles::testBuffer()
+{
+    TIME_START;
+
+    PackTilesBuffer buffer;
+    size_t capacity = 0;
+    for (int frame = 0; frame < 3; ++frame) {
+        for (PackTiles::EnqFormatVer ver : {PackTiles::EnqFormatVer::VER2, PackTiles::EnqFormatVer::VER3}) {
+            for (PackTiles::HashType hashType : {PackTiles::HashType::SHA1, PackTiles::HashType::CRC32C}) {
+                for (unsigned bandTotal : {1u, 4u}) {
+                    std::string ref;
+                    PackTiles::encode(false, // renderBufferOdd
+                                      mActivePixels, mRenderBufferTiled, mWeightBufferTiled, ref,
+                                      PackTiles::PrecisionMode::F32,
+                                      CoarsePassPrecision::F32,
+                                      FinePassPrecision::F32,
+                                      false, // noNumSampleMode
+                                      true,  // withHash
+                                      ver, hashType, bandTotal);
+
+                    buffer.clear();
+                    const size_t size = encodeBeauty(mActivePixels, mRenderBufferTiled, mWeightBufferTiled,
+                                                     ver, hashType, bandTotal, buffer);
+                    CPPUNIT_ASSERT(size == ref.size());
+                    CPPUNIT_ASSERT(buffer.getDataSize() == ref.size());
+
+                    // banded pixel blocks are not copied into the main data
+                    std::vector<struct iovec> iov;
+                    buffer.getIovec(iov);
+                    CPPUNIT_ASSERT(iov.size() == buffer.getSegmentTotal());
+                    CPPUNIT_ASSERT((bandTotal == 1) ? iov.size() == 1 : iov.size() > 1);
+
+                    std::string flat;
+                    buffer.flatten(flat);
+                    CPPUNIT_ASSERT(flat == ref);
+                    CPPUNIT_ASSERT(PackTiles::verifyDecodeHash(flat.data(), flat.size()));
+                }
+            }
+        }
+
+        // the next frame reuses the memory
+        if (frame > 0) CPPUNIT_ASSERT(buffer.getCapacity() == capacity);
+        capacity = buffer.getCapacity();
+    }
+
+    // several encodes are appended to the same buffer
+    buffer.clear();
+    encodeBeauty(mActivePixels, mRenderBufferTiled, mWeightBufferTiled,
+                 PackTiles::EnqFormatVer::VER2, PackTiles::HashType::CRC32C, 4, buffer);
+    const size_t firstSize = buffer.getDataSize();
+    encodeBeauty(mActivePixels, mRenderBufferTiled, mWeightBufferTiled,
+                 PackTiles::EnqFormatVer::VER3, PackTiles::HashType::CRC32C, 4, buffer);
+    std::string flat;
+    buffer.flatten(flat);
+    CPPUNIT_ASSERT(flat.size() == buffer.getDataSize());
+    CPPUNIT_ASSERT(PackTiles::verifyDecodeHash(flat.data(), firstSize));
+    CPPUNIT_ASSERT(PackTiles::verifyDecodeHash(flat.data() + firstSize, flat.size() - firstSize));
+
+    // flat mode appends into the caller's string
+    std::string output("abc");
+    PackTilesBuffer flatBuffer(output);
+    encodeBeauty(mActivePixels, mRenderBufferTiled, mWeightBufferTiled,
+                 PackTiles::EnqFormatVer::VER2, PackTiles::HashType::CRC32C, 4, flatBuffer);
+    CPPUNIT_ASSERT(flatBuffer.isFlat() && flatBuffer.getSegmentTotal() == 1);
+    CPPUNIT_ASSERT(output.compare(3, std::string::npos, flat, 0, firstSize) == 0);
+
+    TIME_END;
+}
+
+void
+TestPackTiles::testVer3()
+{
+    TIME_START;
+
+    // VER3 is lossless on top of VER2 : both decode to the same buffers.
+    for (PackTiles::PrecisionMode precisionMode : {PackTiles::PrecisionMode::F32,
+                                                   PackTiles::PrecisionMode::H16,
+                                                   PackTiles::PrecisionMode::UC8}) {
+        const std::string ver2 = encodeBeauty(mActivePixels, mRenderBufferTiled, mWeightBufferTiled,
+                                              precisionMode, PackTiles::EnqFormatVer::VER2, 1);
+        const std::string ver3 = encodeBeauty(mActivePixels, mRenderBufferTiled, mWeightBufferTiled,
+                                              precisionMode, PackTiles::EnqFormatVer::VER3, 1);
+        CPPUNIT_ASSERT(ver3.size() < ver2.size());
+        CPPUNIT_ASSERT(PackTiles::verifyDecodeHash(ver3.data(), ver3.size()));
+
+        fb_util::ActivePixels ver2ActivePixels, ver3ActivePixels;
+        fb_util::RenderBuffer ver2RenderBufferTiled, ver3RenderBufferTiled;
+        PackTiles::NumSampleBuffer ver2NumSampleBufferTiled, ver3NumSampleBufferTiled;
+        CPPUNIT_ASSERT(decodeBeauty(ver2, ver2ActivePixels, ver2RenderBufferTiled,
+                                    ver2NumSampleBufferTiled));
+        CPPUNIT_ASSERT(decodeBeauty(ver3, ver3ActivePixels, ver3RenderBufferTiled,
+                                    ver3NumSampleBufferTiled));
+        CPPUNIT_ASSERT(ver3ActivePixels.compare(ver2ActivePixels));
+        CPPUNIT_ASSERT(sameBuffer(ver3RenderBufferTiled, ver2RenderBufferTiled));
+        CPPUNIT_ASSERT(sameBuffer(ver3NumSampleBufferTiled, ver2NumSampleBufferTiled));
+    }
+
+    // A truncated VER3 pixel block is rejected. The container size field right after the hash
+    // is patched to match, so the cut reaches the pixel block decoder.
+    const std::string ver3 = encodeBeauty(mActivePixels, mRenderBufferTiled, mWeightBufferTiled,
+                                          PackTiles::PrecisionMode::F32,
+                                          PackTiles::EnqFormatVer::VER3, 1);
+    for (size_t cut = 1; cut <= 64; ++cut) {
+        std::string truncated = ver3.substr(0, ver3.size() - cut);
+        const size_t dataSize = truncated.size() - PackTiles::HASH_SIZE;
+        std::memcpy(&truncated[PackTiles::HASH_SIZE], &dataSize, sizeof(size_t));
+
+        fb_util::ActivePixels activePixels;
+        fb_util::RenderBuffer renderBufferTiled;
+        PackTiles::NumSampleBuffer numSampleBufferTiled;
+        CPPUNIT_ASSERT("testVer3 truncated" &&
+                       !decodeBeauty(truncated, activePixels, renderBufferTiled, numSampleBufferTiled));
+    }
+
+    // A numSample stream in which no value ends (every byte has the continuation bit) is rejected
+    // instead of hanging the decoder.
+    {
+        std::string broken = ver3;
+        CPPUNIT_ASSERT(breakNumSampleStream(broken));
+
+        fb_util::ActivePixels activePixels;
+        fb_util::RenderBuffer renderBufferTiled;
+        PackTiles::NumSampleBuffer numSampleBufferTiled;
+        CPPUNIT_ASSERT("testVer3 broken numSample" &&
+                       !decodeBeauty(broken, activePixels, renderBufferTiled, numSampleBufferTiled));
+    }
+
+    TIME_END;
+}
+
+} // namespace unittest
+} // namespace grid_util
+} // namespace scene_rdl2
@@ -0,0 +1,41 @@
+// Copyright 2023-2024 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+#pragma once
+
+#include <scene_rdl2/common/fb_util/ActivePixels.h>
+#include <scene_rdl2/common/fb_util/FbTypes.h>
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/TestFixture.h>
+
+namespace scene_rdl2 {
+namespace grid_util {
+namespace unittest {
+
+class TestPackTiles : public CppUnit::TestFixture
+{
+public:
+    void setUp();
+    void tearDown() {}
+
+    void testBandFormat();
+    void testBandDecode();
+    void testBuffer();
+    void testVer3();
+
+    CPPUNIT_TEST_SUITE(TestPackTiles);
+    CPPUNIT_TEST(testBandFormat);
+    CPPUNIT_TEST(testBandDecode);
+    CPPUNIT_TEST(testBuffer);
+    CPPUNIT_TEST(testVer3);
+    CPPUNIT_TEST_SUITE_END();
+
+protected:
+    fb_util::ActivePixels mActivePixels;
+    fb_util::RenderBuffer mRenderBufferTiled;
+    fb_util::FloatBuffer mWeightBufferTiled;
+};
+
+} // namespace unittest
+} // namespace grid_util
+} // namespace scene_rdl2
@@ -0,0 +1,156 @@
+// Copyright 2023-2024 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+#include "TestRansCodec.h"
+#include "TimeOutput.h"
+
+#include <scene_rdl2/common/grid_util/RansCodec.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace scene_rdl2 {
+namespace grid_util {
+namespace unittest {
+
+namespace {
+
+// Decodes the whole block and returns the consumed size, or 0 if the block is rejected.
+size_t
+decodeBlock(const std::string &coded, const size_t rawSize, std::string &raw)
+{
+    raw.assign(rawSize, 0x0);
+    return RansCodec::decode(coded.data(), coded.size(), &raw[0], rawSize);
+}
+
+} // namespace
+
+void
+TestRansCodec::testRoundtrip()
+{
+    TIME_START;
+
+    std::vector<std::string> inputs = {
+        std::string(),                  // RAW, empty
+        std::string("short"),           // RAW, too small for a frequency table
+        std::string(1000, 'x'),         // CONST
+        randomDataGen(5000),            // RAW, entropy coding does not pay off
+        skewedDataGen(63),
+        skewedDataGen(64),
+        skewedDataGen(65),
+        skewedDataGen(100003),          // RANS, tail not a multiple of the state count
+    };
+    std::string twoSymbols(4096, 'a');
+    twoSymbols[1234] = 'b';             // RANS, one symbol with the minimum frequency
+    inputs.push_back(twoSymbols);
+
+    for (const std::string &input : inputs) {
+        std::string coded;
+        RansCodec::encode(input.data(), input.size(), coded);
+        CPPUNIT_ASSERT("testRoundtrip overhead" && coded.size() <= input.size() + 1);
+
+        std::string raw;
+        CPPUNIT_ASSERT(decodeBlock(coded, input.size(), raw) == coded.size());
+        CPPUNIT_ASSERT(raw == input);
+
+        // Blocks are appended to a stream, the decoder stops at the end of the block.
+        std::string stream("head");
+        RansCodec::encode(input.data(), input.size(), stream);
+        stream += "tail";
+        raw.assign(input.size(), 0x0);
+        CPPUNIT_ASSERT(RansCodec::decode(stream.data() + 4, stream.size() - 4,
+                                         &raw[0], input.size()) == coded.size());
+        CPPUNIT_ASSERT(raw == input);
+    }
+
+    // Skewed data has to compress.
+    const std::string skewed = skewedDataGen(100003);
+    std::string coded;
+    RansCodec::encode(skewed.data(), skewed.size(), coded);
+    CPPUNIT_ASSERT(coded.size() < skewed.size() / 2);
+
+    TIME_END;
+}
+
+void
+TestRansCodec::testTruncated()
+{
+    TIME_START;
+
+    for (const std::string &input : {std::string(1000, 'x'), randomDataGen(3000), skewedDataGen(3001)}) {
+        std::string coded;
+        RansCodec::encode(input.data(), input.size(), coded);
+
+        // Every cut is rejected without reading past the end.
+        std::string raw;
+        for (size_t size = 0; size < coded.size(); ++size) {
+            const std::string cut = coded.substr(0, size);
+            CPPUNIT_ASSERT("testTruncated" && decodeBlock(cut, input.size(), raw) == 0);
+        }
+    }
+
+    TIME_END;
+}
+
+void
+TestRansCodec::testCorrupted()
+{
+    TIME_START;
+
+    const std::string input = skewedDataGen(3001);
+    std::string coded;
+    RansCodec::encode(input.data(), input.size(), coded);
+    CPPUNIT_ASSERT(coded[0] == 2); // RANS mode
+    std::string raw;
+
+    // unknown mode
+    std::string broken = coded;
+    broken[0] = 7;
+    CPPUNIT_ASSERT(decodeBlock(broken, input.size(), raw) == 0);
+
+    // a symbol missing from the bitmap leaves the frequencies short of the total
+    broken = coded;
+    for (size_t i = 1; i < 33; ++i) {
+        if (broken[i]) {
+            broken[i] = static_cast<char>(broken[i] & (broken[i] - 1)); // drop the lowest symbol
+            break;
+        }
+    }
+    CPPUNIT_ASSERT(decodeBlock(broken, input.size(), raw) == 0);
+
+    // the wrong raw size does not end with the initial states
+    CPPUNIT_ASSERT(decodeBlock(coded, input.size() - 1, raw) == 0);
+    CPPUNIT_ASSERT(decodeBlock(coded, input.size() + 1, raw) == 0);
+
+    TIME_END;
+}
+
+std::string
+TestRansCodec::skewedDataGen(size_t size) const
+{
+    std::mt19937 mt(size);
+    std::geometric_distribution<int> dist(0.3);
+
+    std::string data(size, 0x0);
+    for (size_t i = 0; i < size; ++i) {
+        data[i] = static_cast<char>(std::min(dist(mt), 255));
+    }
+    return data;
+}
+
+std::string
+TestRansCodec::randomDataGen(size_t size) const
+{
+    std::mt19937 mt(size);
+    std::uniform_int_distribution<int> dist(0, 255);
+
+    std::string data(size, 0x0);
+    for (size_t i = 0; i < size; ++i) {
+        data[i] = static_cast<char>(dist(mt));
+    }
+    return data;
+}
+
+} // namespace unittest
+} // namespace grid_util
+} // namespace scene_rdl2
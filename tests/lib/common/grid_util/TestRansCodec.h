@@ -0,0 +1,38 @@
+// Copyright 2023-2024 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+#pragma once
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/TestFixture.h>
+
+#include <string>
+
+namespace scene_rdl2 {
+namespace grid_util {
+namespace unittest {
+
+class TestRansCodec : public CppUnit::TestFixture
+{
+public:
+    void setUp() {}
+    void tearDown() {}
+
+    void testRoundtrip();
+    void testTruncated();
+    void testCorrupted();
+
+    CPPUNIT_TEST_SUITE(TestRansCodec);
+    CPPUNIT_TEST(testRoundtrip);
+    CPPUNIT_TEST(testTruncated);
+    CPPUNIT_TEST(testCorrupted);
+    CPPUNIT_TEST_SUITE_END();
+
+protected:
+    // Bytes with a skewed distribution, like VER3 prediction residuals.
+    std::string skewedDataGen(size_t size) const;
+    std::string randomDataGen(size_t size) const;
+};
+
+} // namespace unittest
+} // namespace grid_util
+} // namespace scene_rdl2
@@ -5,9 +5,12 @@
 #include "TestArg.h"
 #include "TestBinPacketDictionary.h"
 #include "TestCpuSocketUtil.h"
+#include "TestCrc32c.h"
 #include "TestFbUtils.h"
+#include "TestPackTiles.h"
 #include "TestParser.h"
 #include "TestPixelBufferSha1.h"
+#include "TestRansCodec.h"
 #include "TestSha1.h"
 #include "TestShmFb.h"
 #include "TestShmAffInfo.h"
@@ -26,9 +29,12 @@ main(int ac, char** av)
     CPPUNIT_TEST_SUITE_REGISTRATION(TestArg);
     CPPUNIT_TEST_SUITE_REGISTRATION(TestBinPacketDictionary);
     CPPUNIT_TEST_SUITE_REGISTRATION(TestCpuSocketUtil);
+    CPPUNIT_TEST_SUITE_REGISTRATION(TestCrc32c);
     CPPUNIT_TEST_SUITE_REGISTRATION(TestFbUtils);
+    CPPUNIT_TEST_SUITE_REGISTRATION(TestPackTiles);
     CPPUNIT_TEST_SUITE_REGISTRATION(TestParser);
     CPPUNIT_TEST_SUITE_REGISTRATION(TestPixelBufferSha1);
+    CPPUNIT_TEST_SUITE_REGISTRATION(TestRansCodec);
     CPPUNIT_TEST_SUITE_REGISTRATION(TestSha1);
     CPPUNIT_TEST_SUITE_REGISTRATION(TestShmAffInfo);
     CPPUNIT_TEST_SUITE_REGISTRATION(TestShmFb);
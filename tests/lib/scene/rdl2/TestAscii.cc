@@ -12,6 +12,7 @@
 #include <scene_rdl2/scene/rdl2/SceneObject.h>
 
 #include <scene_rdl2/common/except/exceptions.h>
+#include <scene_rdl2/common/rec_time/RecTime.h>
 
 #include <cppunit/extensions/HelperMacros.h>
 
@@ -636,6 +637,284 @@ TestAscii::testDenormals()
     }
 }
 
+void
+TestAscii::testFindSceneClassNames()
+{
+    const std::string code =
+        "-- Geometry(\"/commented\")\n"
+        "--[[ Material(\"/also/commented\") ]]\n"
+        "local name = \"Fake(\\\"/in/a/string\\\")\"\n"
+        "mtl = BaseMaterial(\"/mtl\") {}\n"
+        "geo = TeapotGeometry \"/teapot\" { [\"material\"] = mtl }\n"
+        "Camera(\"/cam\") { [\"fov\"] = 45.0 }\n"
+        "print(geo:get(\"material\"), string.format(\"%d\", 1))\n"
+        "local value = nil or \"default\"\n"
+        "BaseMaterial(\"/mtl2\") {}\n"
+        "Light2 [[/light]] {}\n";
+
+    const std::vector<std::string> names = AsciiReader::findSceneClassNames(code);
+    CPPUNIT_ASSERT_EQUAL(std::size_t(4), names.size());
+    CPPUNIT_ASSERT_EQUAL(std::string("BaseMaterial"), names[0]);
+    CPPUNIT_ASSERT_EQUAL(std::string("TeapotGeometry"), names[1]);
+    CPPUNIT_ASSERT_EQUAL(std::string("PerspectiveCamera"), names[2]);
+    CPPUNIT_ASSERT_EQUAL(std::string("Light2"), names[3]);
+}
+
+void
+TestAscii::testPrefetchSceneClasses()
+{
+    // Prefetching must not change what the reader produces, through the
+    // native parser or through Lua. FakeTeapot is named but never
+    // constructed, so it must not become a SceneClass.
+    const std::string native = "ExampleObject(\"/a\") {}\nExtensiveObject(\"/b\") {}\n";
+    const std::string lua = "if false then FakeTeapot(\"/never\") end\n"
+                            "ExampleObject(\"/c\") {}\n";
+    for (const std::string& code : { native, lua }) {
+        SceneContext context;
+        AsciiReader reader(context);
+        reader.setPrefetchSceneClasses(true);
+        reader.fromString(code);
+        CPPUNIT_ASSERT(!context.sceneClassExists("FakeTeapot"));
+
+        // The DSOs opened for the old path are dropped with it.
+        context.setDsoPath("/nonexistent/rdl2dso");
+        CPPUNIT_ASSERT_THROW(context.createSceneClass("FakeTeapot"), except::IoError);
+        CPPUNIT_ASSERT(context.sceneClassExists("ExampleObject"));
+    }
+
+    // Same when the read fails part way through.
+    SceneContext context;
+    AsciiReader reader(context);
+    reader.setPrefetchSceneClasses(true);
+    CPPUNIT_ASSERT_THROW(reader.fromString("FakeTeapot(\"/t\") {}\nerror(\"stop\")\n"),
+                         except::RuntimeError);
+    context.setDsoPath("/nonexistent/rdl2dso");
+    CPPUNIT_ASSERT(context.sceneClassExists("FakeTeapot"));
+    CPPUNIT_ASSERT_THROW(context.createSceneClass("ExampleObject"), except::IoError);
+}
+
+void
+TestAscii::testNativeParser()
+{
+    // Build a scene with every kind of block AsciiWriter produces.
+    SceneContext context;
+    const SceneClass* sc = context.createSceneClass("ExtensiveObject");
+    SceneObject* pizza = context.createSceneObject("ExtensiveObject", "/seq/shot/pizza");
+    SceneObject* cookie = context.createSceneObject("ExtensiveObject", "/seq/shot/cookie");
+    Geometry* teapot = context.createSceneObject("FakeTeapot", "/seq/shot/teapot")->asA<Geometry>();
+    Light* light = context.createSceneObject("FakeLight", "/seq/shot/light")->asA<Light>();
+    Material* material = context.createSceneObject("FakeMaterial", "/seq/shot/material")->asA<Material>();
+
+    pizza->beginUpdate();
+    pizza->set(sc->getAttributeKey<Bool>("bool"), true);
+    pizza->set(sc->getAttributeKey<Int>("int"), Int(100), TIMESTEP_BEGIN);
+    pizza->set(sc->getAttributeKey<Int>("int"), Int(-200), TIMESTEP_END);
+    pizza->set(sc->getAttributeKey<Float>("float"), 0.1f);
+    pizza->set(sc->getAttributeKey<String>("string"), String("it's a \"pizza\"\n"));
+    pizza->set(sc->getAttributeKey<Rgb>("rgb"), Rgb(0.1f, 0.2f, 0.3f));
+    pizza->set(sc->getAttributeKey<Vec3d>("vec3d"), Vec3d(1.0, -2.5, 1e-300));
+    pizza->set(sc->getAttributeKey<Mat4f>("mat4f"), mMat4fVec2[0]);
+    pizza->set(sc->getAttributeKey<SceneObject*>("scene object"), cookie);
+    pizza->setBinding(sc->getAttributeKey<String>("string"), cookie);
+    pizza->set(sc->getAttributeKey<FloatVector>("float vector"), FloatVector{ 0x1.0p-140f, -3.0f });
+    pizza->set(sc->getAttributeKey<StringVector>("string vector"), mStringVec2);
+    pizza->set(sc->getAttributeKey<RgbaVector>("rgba vector"), mRgbaVec2);
+    pizza->set(sc->getAttributeKey<SceneObjectVector>("scene object vector"),
+               SceneObjectVector{ light, nullptr, material });
+    pizza->endUpdate();
+
+    LightSet* lightSet = context.createSceneObject("LightSet", "/seq/shot/lights")->asA<LightSet>();
+    lightSet->beginUpdate();
+    lightSet->add(light);
+    lightSet->endUpdate();
+
+    Layer* layer = context.createSceneObject("Layer", "/seq/shot/layer")->asA<Layer>();
+    layer->beginUpdate();
+    layer->assign(teapot, "lid", material, lightSet, nullptr, nullptr);
+    layer->endUpdate();
+
+    Metadata* metadata = context.createSceneObject("Metadata", "/seq/shot/metadata")->asA<Metadata>();
+    StringVector names{ "blah" };
+    StringVector types{ "int" };
+    StringVector values{ "2" };
+    metadata->beginUpdate();
+    metadata->setAttributes(names, types, values);
+    metadata->endUpdate();
+
+    const std::string code = AsciiWriter(context).toString();
+
+    // Read it natively and with Lua, the results must be identical.
+    SceneContext nativeContext;
+    AsciiReader nativeReader(nativeContext);
+    nativeReader.fromString(code);
+    CPPUNIT_ASSERT(nativeReader.getUsedNativeParser());
+
+    SceneContext luaContext;
+    AsciiReader luaReader(luaContext);
+    luaReader.setNativeParsing(false);
+    luaReader.fromString(code);
+    CPPUNIT_ASSERT(!luaReader.getUsedNativeParser());
+
+    CPPUNIT_ASSERT_EQUAL(code, AsciiWriter(nativeContext).toString());
+    CPPUNIT_ASSERT_EQUAL(AsciiWriter(luaContext).toString(), AsciiWriter(nativeContext).toString());
+
+    // Lua code falls back to Lua.
+    AttributeKey<Int> intKey = sc->getAttributeKey<Int>("int");
+    nativeReader.fromString("local x = 7\nExtensiveObject(\"/seq/shot/pizza\") { [\"int\"] = x }\n");
+    CPPUNIT_ASSERT(!nativeReader.getUsedNativeParser());
+    CPPUNIT_ASSERT(nativeContext.getSceneObject("/seq/shot/pizza")->get(intKey) == 7);
+
+    // So do unknown attributes, which Lua warns about.
+    nativeReader.fromString("ExtensiveObject(\"/seq/shot/pizza\") { [\"no such attribute\"] = 1 }\n");
+    CPPUNIT_ASSERT(!nativeReader.getUsedNativeParser());
+
+    // Plain data is read natively, also into existing objects.
+    nativeReader.fromString("ExtensiveObject(\"/seq/shot/pizza\") { [\"int\"] = 8 }\n");
+    CPPUNIT_ASSERT(nativeReader.getUsedNativeParser());
+    CPPUNIT_ASSERT(nativeContext.getSceneObject("/seq/shot/pizza")->get(intKey) == 8);
+
+    // Once a global the native parser relies on has been reassigned, text
+    // which uses it must go through Lua.
+    AttributeKey<Vec2f> vec2fKey = sc->getAttributeKey<Vec2f>("vec2f");
+    nativeReader.fromString("Vec3 = Vec2\n");
+    nativeReader.fromString("ExtensiveObject(\"/seq/shot/pizza\") { [\"vec2f\"] = Vec3(1, 2) }\n");
+    CPPUNIT_ASSERT(!nativeReader.getUsedNativeParser());
+    CPPUNIT_ASSERT(nativeContext.getSceneObject("/seq/shot/pizza")->get(vec2fKey) == Vec2f(1.0f, 2.0f));
+}
+
+void
+TestAscii::testNativeParserTiming()
+{
+#ifdef TIMING_TEST
+    constexpr int OBJECTS = 2000;
+#else
+    constexpr int OBJECTS = 100;
+#endif
+    SceneContext context;
+    const SceneClass* sc = context.createSceneClass("ExtensiveObject");
+    AttributeKey<Int> intKey = sc->getAttributeKey<Int>("int");
+    AttributeKey<Float> floatKey = sc->getAttributeKey<Float>("float");
+    AttributeKey<Vec3f> vec3fKey = sc->getAttributeKey<Vec3f>("vec3f");
+    AttributeKey<FloatVector> floatVecKey = sc->getAttributeKey<FloatVector>("float vector");
+    for (int i = 0; i < OBJECTS; ++i) {
+        SceneObject* so = context.createSceneObject("ExtensiveObject",
+                "/seq/shot/object" + std::to_string(i));
+        so->beginUpdate();
+        so->set(intKey, Int(i));
+        so->set(floatKey, i * 0.25f);
+        so->set(vec3fKey, Vec3f(i, i + 1, i + 2));
+        so->set(floatVecKey, FloatVector(64, i * 0.5f));
+        so->endUpdate();
+    }
+    const std::string code = AsciiWriter(context).toString();
+
+    // Both ways read back the scene that was written.
+    auto read = [&](bool native) {
+        SceneContext readContext;
+        AsciiReader reader(readContext);
+        reader.setNativeParsing(native);
+        rec_time::RecTime recTime;
+        recTime.start();
+        reader.fromString(code);
+        const float sec = recTime.end();
+        CPPUNIT_ASSERT(reader.getUsedNativeParser() == native);
+        CPPUNIT_ASSERT_EQUAL(code, AsciiWriter(readContext).toString());
+        return sec;
+    };
+
+    const float luaSec = read(false);
+    const float nativeSec = read(true);
+#ifdef TIMING_TEST
+    std::cerr << ">> TestAscii.cc testNativeParserTiming() size:" << code.size()
+              << " lua:" << luaSec << " sec native:" << nativeSec << " sec"
+              << " speedup:" << ((nativeSec > 0.0f) ? luaSec / nativeSec : 0.0f) << '\n';
+#endif
+}
+
+void
+TestAscii::testParallelWriter()
+{
+    SceneContext context;
+    const SceneClass* sc = context.createSceneClass("ExtensiveObject");
+    AttributeKey<Int> intKey = sc->getAttributeKey<Int>("int");
+    AttributeKey<Float> floatKey = sc->getAttributeKey<Float>("float");
+    AttributeKey<Double> doubleKey = sc->getAttributeKey<Double>("double");
+    AttributeKey<FloatVector> floatVecKey = sc->getAttributeKey<FloatVector>("float vector");
+    AttributeKey<SceneObject*> sceneObjectKey = sc->getAttributeKey<SceneObject*>("scene object");
+
+    std::vector<SceneObject*> objects;
+    for (int i = 0; i < 500; ++i) {
+        SceneObject* so = context.createSceneObject("ExtensiveObject",
+                "/seq/shot/object" + std::to_string(i));
+        so->beginUpdate();
+        so->set(intKey, Int(i));
+        so->set(floatKey, i * 0.1f);
+        so->set(doubleKey, i / 3.0);
+        so->set(floatVecKey, FloatVector{ i * 0.5f, -1e-42f, 3.0e38f });
+        if (!objects.empty()) {
+            so->set(sceneObjectKey, objects.back());
+        }
+        so->endUpdate();
+        objects.push_back(so);
+    }
+    Light* light = context.createSceneObject("FakeLight", "/seq/shot/light")->asA<Light>();
+    LightSet* lightSet = context.createSceneObject("LightSet", "/seq/shot/lights")->asA<LightSet>();
+    lightSet->beginUpdate();
+    lightSet->add(light);
+    lightSet->endUpdate();
+
+    // Parallel formatting must produce exactly the serial output.
+    auto write = [&context](bool parallel, bool dirtyOnly, bool deltaEncoding) {
+        AsciiWriter writer(context);
+        writer.setParallelEncoding(parallel);
+        writer.setDirtyOnly(dirtyOnly);
+        writer.setDeltaEncoding(deltaEncoding);
+        writer.setElementsPerLine(2);
+        return writer.toString();
+    };
+    const std::string serial = write(false, false, false);
+    CPPUNIT_ASSERT_EQUAL(serial, write(true, false, false));
+    CPPUNIT_ASSERT(serial.find("[\"float\"] = 0.100000001,\n") != std::string::npos);
+
+    // Everything is dirty before the first commit.
+    CPPUNIT_ASSERT_EQUAL(serial, write(false, true, false));
+
+    // After a commit, dirty-only mode writes just the changed objects, but
+    // with all of their values.
+    context.commitAllChanges();
+    CPPUNIT_ASSERT(write(true, true, false).empty());
+
+    objects[7]->beginUpdate();
+    objects[7]->set(intKey, Int(-7));
+    objects[7]->endUpdate();
+    objects[300]->beginUpdate();
+    objects[300]->set(floatKey, 2.5f);
+    objects[300]->endUpdate();
+
+    const std::string dirty = write(false, true, false);
+    CPPUNIT_ASSERT_EQUAL(dirty, write(true, true, false));
+    CPPUNIT_ASSERT(dirty.find("SceneVariables") == std::string::npos);
+    CPPUNIT_ASSERT(dirty.find("\"/seq/shot/object7\"") != std::string::npos);
+    CPPUNIT_ASSERT(dirty.find("\"/seq/shot/object300\"") != std::string::npos);
+    CPPUNIT_ASSERT(dirty.find("\"/seq/shot/object8\"") == std::string::npos);
+    CPPUNIT_ASSERT(dirty.find("[\"double\"] = ") != std::string::npos);
+
+    const std::string delta = write(true, false, true);
+    CPPUNIT_ASSERT_EQUAL(write(false, false, true), delta);
+    CPPUNIT_ASSERT(delta.find("\"/seq/shot/object300\"") != std::string::npos);
+    CPPUNIT_ASSERT(delta.find("[\"double\"] = ") == std::string::npos);
+
+    // The dirty objects read back with all their values.
+    SceneContext readContext;
+    AsciiReader reader(readContext);
+    reader.fromString(dirty);
+    const SceneObject* readObject = readContext.getSceneObject("/seq/shot/object7");
+    CPPUNIT_ASSERT(readObject->get(intKey) == -7);
+    CPPUNIT_ASSERT(readObject->get(doubleKey) == objects[7]->get(doubleKey));
+    CPPUNIT_ASSERT(readObject->get(floatVecKey) == objects[7]->get(floatVecKey));
+    CPPUNIT_ASSERT(readContext.getSceneObject("/seq/shot/object300")->get(floatKey) == 2.5f);
+}
+
 } // namespace unittest
 } // namespace rdl2
 } // namespace scene_rdl2
@@ -36,6 +36,25 @@ public:
     /// Test that attribute aliases work
     void testAttributeAlias();
 
+    /// Test scanning RDL text for SceneClass constructors.
+    void testFindSceneClassNames();
+
+    /// Test that a read with SceneClass prefetching leaves nothing loading
+    /// behind, so the DSO path can change right after it.
+    void testPrefetchSceneClasses();
+
+    /// Test that the native parser reads AsciiWriter output the same way
+    /// Lua does, and falls back to Lua for anything else.
+    void testNativeParser();
+
+    /// Check that the native parser and Lua read back the same scene, and
+    /// compare their read times when TIMING_TEST is defined.
+    void testNativeParserTiming();
+
+    /// Test that parallel formatting matches serial formatting, and that
+    /// dirty-only mode writes the dirty objects in full.
+    void testParallelWriter();
+
 #ifdef _TEST_ASCII_DO_TEST_MEMORY
     /// Test to ensure that no memory leaks for the AsciiReader/Writer
     void testMemory();
@@ -49,6 +68,11 @@ public:
     CPPUNIT_TEST(testDeltaEncoding);
     CPPUNIT_TEST(testNullReferences);
     CPPUNIT_TEST(testAttributeAlias);
+    CPPUNIT_TEST(testFindSceneClassNames);
+    CPPUNIT_TEST(testPrefetchSceneClasses);
+    CPPUNIT_TEST(testNativeParser);
+    CPPUNIT_TEST(testNativeParserTiming);
+    CPPUNIT_TEST(testParallelWriter);
 #ifdef _TEST_ASCII_DO_TEST_MEMORY
     CPPUNIT_TEST(testMemory);
 #endif
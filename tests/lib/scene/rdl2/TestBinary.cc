@@ -7,14 +7,22 @@
 #include <scene_rdl2/scene/rdl2/AttributeKey.h>
 #include <scene_rdl2/scene/rdl2/BinaryReader.h>
 #include <scene_rdl2/scene/rdl2/BinaryWriter.h>
+#include <scene_rdl2/scene/rdl2/LzBlockCodec.h>
 #include <scene_rdl2/scene/rdl2/SceneClass.h>
 #include <scene_rdl2/scene/rdl2/SceneContext.h>
 #include <scene_rdl2/scene/rdl2/SceneObject.h>
+#include <scene_rdl2/scene/rdl2/ValueContainerDeq.h>
+#include <scene_rdl2/scene/rdl2/ValueContainerEnq.h>
 
 #include <scene_rdl2/common/except/exceptions.h>
+#include <scene_rdl2/common/rec_time/RecTime.h>
 
 #include <cppunit/extensions/HelperMacros.h>
+#include <tbb/task_arena.h>
 
+#include <cstring>
+#include <iostream>
+#include <sstream>
 #include <string>
 
 namespace scene_rdl2 {
@@ -624,6 +632,477 @@ TestBinary::testNullReferences()
     CPPUNIT_ASSERT(pizza->getBinding(stringKey) == nullptr);
 }
 
+void
+TestBinary::testParallelDecode()
+{
+    SceneContext context;
+    std::string manifest, payload;
+    setupParallelDecodeScene(context, 500, 64, manifest, payload);
+
+    SceneContext serialContext;
+    BinaryReader serialReader(serialContext);
+    serialReader.fromBytes(manifest, payload);
+
+    SceneContext parallelContext;
+    BinaryReader parallelReader(parallelContext);
+    parallelReader.setParallelDecode(true);
+    parallelReader.fromBytes(manifest, payload);
+
+    const SceneClass* sc = context.getSceneClass("ExtensiveObject");
+    AttributeKey<Int> intKey = sc->getAttributeKey<Int>("int");
+    AttributeKey<FloatVector> floatVecKey = sc->getAttributeKey<FloatVector>("float vector");
+    AttributeKey<Vec3fVector> vec3fVecKey = sc->getAttributeKey<Vec3fVector>("vec3f vector");
+    AttributeKey<SceneObject*> sceneObjectKey = sc->getAttributeKey<SceneObject*>("scene object");
+    for (auto iter = context.beginSceneObject(); iter != context.endSceneObject(); ++iter) {
+        const SceneObject* src = iter->second;
+        if (!src->isA<SceneVariables>()) {
+            const SceneObject* serialObj = serialContext.getSceneObject(src->getName());
+            const SceneObject* parallelObj = parallelContext.getSceneObject(src->getName());
+            CPPUNIT_ASSERT(serialObj->get(intKey) == parallelObj->get(intKey));
+            CPPUNIT_ASSERT(serialObj->get(floatVecKey) == parallelObj->get(floatVecKey));
+            CPPUNIT_ASSERT(serialObj->get(vec3fVecKey) == parallelObj->get(vec3fVecKey));
+            const SceneObject* serialRef = serialObj->get(sceneObjectKey);
+            const SceneObject* parallelRef = parallelObj->get(sceneObjectKey);
+            CPPUNIT_ASSERT((serialRef == nullptr) == (parallelRef == nullptr));
+            if (serialRef) {
+                CPPUNIT_ASSERT(serialRef->getName() == parallelRef->getName());
+            }
+        }
+    }
+
+    // Build a stream with two records for the same object. The second record
+    // must win, exactly like the serial decode.
+    auto encodeIntValue = [&](int value, std::string& m, std::string& p) {
+        SceneContext ctx;
+        SceneObject* pizza = ctx.createSceneObject("ExtensiveObject", "/seq/shot/pizza");
+        SceneObject* cookie = ctx.createSceneObject("ExtensiveObject", "/seq/shot/cookie");
+        pizza->beginUpdate();
+        pizza->set(intKey, Int(value));
+        pizza->endUpdate();
+        cookie->beginUpdate();
+        cookie->set(intKey, Int(value + 1));
+        cookie->endUpdate();
+        BinaryWriter writer(ctx);
+        writer.toBytes(m, p);
+    };
+    std::string manifestA, payloadA, manifestB, payloadB;
+    encodeIntValue(10, manifestA, payloadA);
+    encodeIntValue(20, manifestB, payloadB);
+
+    std::string mergedManifest;
+    {
+        ValueContainerDeq deqA(manifestA.data(), manifestA.size());
+        ValueContainerDeq deqB(manifestB.data(), manifestB.size());
+        size_t sizeA = deqA.deqVLSizeT();
+        size_t sizeB = deqB.deqVLSizeT();
+        ValueContainerEnq enq(&mergedManifest);
+        enq.enqVLSizeT(sizeA + sizeB);
+        for (size_t i = 0; i < sizeA; ++i) {
+            enq.enqVLUInt(deqA.deqVLUInt());
+            enq.enqVLSizeT(deqA.deqVLSizeT());
+        }
+        for (size_t i = 0; i < sizeB; ++i) {
+            enq.enqVLUInt(deqB.deqVLUInt());
+            enq.enqVLSizeT(deqB.deqVLSizeT());
+        }
+        enq.finalize();
+    }
+    const std::string mergedPayload = payloadA + payloadB;
+
+    SceneContext dupContext;
+    BinaryReader dupReader(dupContext);
+    dupReader.setParallelDecode(true);
+    dupReader.fromBytes(mergedManifest, mergedPayload);
+    CPPUNIT_ASSERT(dupContext.getSceneObject("/seq/shot/pizza")->get(intKey) == 20);
+    CPPUNIT_ASSERT(dupContext.getSceneObject("/seq/shot/cookie")->get(intKey) == 21);
+}
+
+void
+TestBinary::testParallelDecodeTiming()
+{
+#ifdef TIMING_TEST
+    constexpr int OBJECTS = 5000;
+    constexpr int VECTOR_SIZE = 256;
+#else
+    constexpr int OBJECTS = 200;
+    constexpr int VECTOR_SIZE = 16;
+#endif
+    SceneContext context;
+    std::string manifest, payload;
+    setupParallelDecodeScene(context, OBJECTS, VECTOR_SIZE, manifest, payload);
+
+    const SceneClass* sc = context.getSceneClass("ExtensiveObject");
+    AttributeKey<Int> intKey = sc->getAttributeKey<Int>("int");
+    AttributeKey<FloatVector> floatVecKey = sc->getAttributeKey<FloatVector>("float vector");
+
+    // Every thread count decodes the same scene.
+    auto decode = [&](bool parallel) {
+        SceneContext readContext;
+        BinaryReader reader(readContext);
+        reader.setParallelDecode(parallel);
+        rec_time::RecTime recTime;
+        recTime.start();
+        reader.fromBytes(manifest, payload);
+        const float sec = recTime.end();
+
+        for (auto iter = context.beginSceneObject(); iter != context.endSceneObject(); ++iter) {
+            const SceneObject* src = iter->second;
+            if (!src->isA<SceneVariables>()) {
+                const SceneObject* obj = readContext.getSceneObject(src->getName());
+                CPPUNIT_ASSERT(obj->get(intKey) == src->get(intKey));
+                CPPUNIT_ASSERT(obj->get(floatVecKey) == src->get(floatVecKey));
+            }
+        }
+        return sec;
+    };
+
+    const float serialSec = decode(false);
+#ifdef TIMING_TEST
+    std::cerr << ">> TestBinary.cc testParallelDecodeTiming() serial:" << serialSec << " sec\n";
+#endif
+    for (int numThreads : {1, 8, 32, 64}) {
+        tbb::task_arena arena(numThreads);
+        float sec = 0.0f;
+        arena.execute([&] { sec = decode(true); });
+#ifdef TIMING_TEST
+        std::cerr << ">> TestBinary.cc testParallelDecodeTiming() threads:" << numThreads
+                  << " parallel:" << sec << " sec"
+                  << " speedup:" << ((sec > 0.0f) ? serialSec / sec : 0.0f) << '\n';
+#endif
+    }
+}
+
+void
+TestBinary::testMappedFile()
+{
+    SceneContext context;
+    std::string manifest, payload;
+    setupParallelDecodeScene(context, 100, 1000, manifest, payload);
+    BinaryWriter writer(context);
+    writer.toFile("mapped.rdlb");
+
+    SceneContext fileContext;
+    BinaryReader fileReader(fileContext);
+    fileReader.fromFile("mapped.rdlb");
+
+    SceneContext mappedContext;
+    BinaryReader mappedReader(mappedContext);
+    mappedReader.fromMappedFile("mapped.rdlb");
+
+    const SceneClass* sc = context.getSceneClass("ExtensiveObject");
+    AttributeKey<Int> intKey = sc->getAttributeKey<Int>("int");
+    AttributeKey<FloatVector> floatVecKey = sc->getAttributeKey<FloatVector>("float vector");
+    AttributeKey<Vec3fVector> vec3fVecKey = sc->getAttributeKey<Vec3fVector>("vec3f vector");
+    for (int i = 0; i < 100; ++i) {
+        const std::string name = "/seq/shot/obj" + std::to_string(i);
+        const SceneObject* fileObj = fileContext.getSceneObject(name);
+        const SceneObject* mappedObj = mappedContext.getSceneObject(name);
+        CPPUNIT_ASSERT(fileObj->get(intKey) == mappedObj->get(intKey));
+        CPPUNIT_ASSERT(fileObj->get(floatVecKey) == mappedObj->get(floatVecKey));
+        CPPUNIT_ASSERT(fileObj->get(vec3fVecKey) == mappedObj->get(vec3fVecKey));
+        CPPUNIT_ASSERT(mappedObj->get(vec3fVecKey).size() == 1000);
+    }
+
+    CPPUNIT_ASSERT_THROW(mappedReader.fromMappedFile("does_not_exist.rdlb"), except::IoError);
+}
+
+void
+TestBinary::testParallelEncoding()
+{
+    SceneContext context;
+    std::string manifest, payload;
+    setupParallelDecodeScene(context, 2000, 32, manifest, payload);
+
+    auto encode = [&](bool parallel, bool delta, std::string& m, std::string& p) {
+        BinaryWriter writer(context);
+        writer.setParallelEncoding(parallel);
+        writer.setDeltaEncoding(delta);
+        writer.toBytes(m, p);
+    };
+
+    std::string serialManifest, serialPayload, parallelManifest, parallelPayload;
+    encode(false, false, serialManifest, serialPayload);
+    encode(true, false, parallelManifest, parallelPayload);
+    CPPUNIT_ASSERT(serialManifest == parallelManifest);
+    CPPUNIT_ASSERT(serialPayload == parallelPayload);
+
+    // Delta encoding of a handful of changed objects.
+    context.commitAllChanges();
+    const SceneClass* sc = context.getSceneClass("ExtensiveObject");
+    AttributeKey<Int> intKey = sc->getAttributeKey<Int>("int");
+    for (int i = 0; i < 2000; i += 97) {
+        SceneObject* obj = context.getSceneObject("/seq/shot/obj" + std::to_string(i));
+        obj->beginUpdate();
+        obj->set(intKey, Int(-i));
+        obj->endUpdate();
+    }
+    std::string serialDeltaManifest, serialDeltaPayload, parallelDeltaManifest, parallelDeltaPayload;
+    encode(false, true, serialDeltaManifest, serialDeltaPayload);
+    encode(true, true, parallelDeltaManifest, parallelDeltaPayload);
+    CPPUNIT_ASSERT(serialDeltaManifest == parallelDeltaManifest);
+    CPPUNIT_ASSERT(serialDeltaPayload == parallelDeltaPayload);
+    CPPUNIT_ASSERT(serialDeltaPayload.size() < serialPayload.size());
+
+    // Empty delta.
+    context.commitAllChanges();
+    std::string emptyManifest, emptyPayload;
+    encode(true, true, emptyManifest, emptyPayload);
+    CPPUNIT_ASSERT(emptyPayload.empty());
+}
+
+void
+TestBinary::setupParallelDecodeScene(SceneContext& context, int numObjects, int vectorSize,
+                                     std::string& manifest, std::string& payload) const
+{
+    const SceneClass* sc = context.createSceneClass("ExtensiveObject");
+    AttributeKey<Int> intKey = sc->getAttributeKey<Int>("int");
+    AttributeKey<FloatVector> floatVecKey = sc->getAttributeKey<FloatVector>("float vector");
+    AttributeKey<Vec3fVector> vec3fVecKey = sc->getAttributeKey<Vec3fVector>("vec3f vector");
+    AttributeKey<SceneObject*> sceneObjectKey = sc->getAttributeKey<SceneObject*>("scene object");
+
+    SceneObject* prev = nullptr;
+    for (int i = 0; i < numObjects; ++i) {
+        SceneObject* obj = context.createSceneObject("ExtensiveObject", "/seq/shot/obj" + std::to_string(i));
+        FloatVector floatVec(vectorSize);
+        Vec3fVector vec3fVec(vectorSize);
+        for (int j = 0; j < vectorSize; ++j) {
+            floatVec[j] = static_cast<float>(i + j);
+            vec3fVec[j] = Vec3f(static_cast<float>(i), static_cast<float>(j), static_cast<float>(i * j));
+        }
+        obj->beginUpdate();
+        obj->set(intKey, Int(i));
+        obj->set(floatVecKey, floatVec);
+        obj->set(vec3fVecKey, vec3fVec);
+        obj->set(sceneObjectKey, prev); // reference an object which may be decoded concurrently
+        obj->endUpdate();
+        prev = obj;
+    }
+
+    BinaryWriter writer(context);
+    writer.toBytes(manifest, payload);
+}
+
+void
+TestBinary::testChunkedStream()
+{
+    SceneContext context;
+    std::string manifest, payload;
+    setupParallelDecodeScene(context, 250, 16, manifest, payload);
+
+    // 250 objects in chunks of 64 gives three full chunks and a partial one.
+    BinaryWriter writer(context);
+    writer.setChunkedFraming(64);
+    std::stringstream chunked;
+    writer.toStream(chunked);
+    writer.toFile("chunked.rdlb");
+
+    // A stream is only complete once the terminating frame has been written.
+    const std::string chunkedBytes = chunked.str();
+    std::stringstream truncated(chunkedBytes.substr(0, chunkedBytes.size() - 2 * sizeof(uint64_t)));
+
+    SceneContext streamContext;
+    BinaryReader streamReader(streamContext);
+    streamReader.fromStream(chunked);
+
+    SceneContext fileContext;
+    BinaryReader fileReader(fileContext);
+    fileReader.fromFile("chunked.rdlb");
+
+    SceneContext mappedContext;
+    BinaryReader mappedReader(mappedContext);
+    mappedReader.fromMappedFile("chunked.rdlb");
+
+    const SceneClass* sc = context.getSceneClass("ExtensiveObject");
+    AttributeKey<Int> intKey = sc->getAttributeKey<Int>("int");
+    AttributeKey<FloatVector> floatVecKey = sc->getAttributeKey<FloatVector>("float vector");
+    AttributeKey<SceneObject*> objKey = sc->getAttributeKey<SceneObject*>("scene object");
+    for (int i = 0; i < 250; ++i) {
+        const std::string name = "/seq/shot/obj" + std::to_string(i);
+        const SceneObject* obj = context.getSceneObject(name);
+        for (const SceneContext* ctx : { &streamContext, &fileContext, &mappedContext }) {
+            const SceneObject* readObj = ctx->getSceneObject(name);
+            CPPUNIT_ASSERT(readObj->get(intKey) == obj->get(intKey));
+            CPPUNIT_ASSERT(readObj->get(floatVecKey) == obj->get(floatVecKey));
+            if (i > 0) {
+                // References across chunk boundaries resolve to the same object.
+                CPPUNIT_ASSERT(readObj->get(objKey) ==
+                               ctx->getSceneObject("/seq/shot/obj" + std::to_string(i - 1)));
+            }
+        }
+    }
+
+    // Unchunked streams are still read as a single frame.
+    BinaryWriter legacyWriter(context);
+    std::stringstream legacy;
+    legacyWriter.toStream(legacy);
+    SceneContext legacyContext;
+    BinaryReader legacyReader(legacyContext);
+    legacyReader.fromStream(legacy);
+    CPPUNIT_ASSERT(legacyContext.getSceneObject("/seq/shot/obj249")->get(intKey) ==
+                   context.getSceneObject("/seq/shot/obj249")->get(intKey));
+
+    SceneContext truncatedContext;
+    BinaryReader truncatedReader(truncatedContext);
+    CPPUNIT_ASSERT_THROW(truncatedReader.fromStream(truncated), except::IoError);
+}
+
+void
+TestBinary::testCompression()
+{
+    // Codec round trips, including empty, tiny and overlapping-match input.
+    for (const std::string& raw : { std::string(), std::string("abc"), std::string(10000, 'x'),
+                                    std::string("abcdefgh abcdefgh abcdefgh abcdefgh tail") }) {
+        std::string compressed;
+        LzBlockCodec::compress(raw.data(), raw.size(), compressed);
+        std::string decompressed(raw.size(), '\0');
+        LzBlockCodec::decompress(compressed.data(), compressed.size(), &decompressed[0], raw.size());
+        CPPUNIT_ASSERT(decompressed == raw);
+
+        // Asking for the wrong size is detected.
+        std::string tooLong(raw.size() + 1, '\0');
+        CPPUNIT_ASSERT_THROW(LzBlockCodec::decompress(compressed.data(), compressed.size(),
+                                                      &tooLong[0], tooLong.size()), except::IoError);
+    }
+
+    SceneContext context;
+    std::string manifest, payload;
+    setupParallelDecodeScene(context, 300, 64, manifest, payload);
+
+    // Small blocks so the payload holds many of them.
+    BinaryWriter writer(context);
+    writer.setCompression(BinaryWriter::Compression::LZ_BLOCK, 16 * 1024);
+    std::string compressedManifest, compressedPayload;
+    writer.toBytes(compressedManifest, compressedPayload);
+    CPPUNIT_ASSERT(compressedPayload.size() < payload.size());
+
+    const SceneClass* sc = context.getSceneClass("ExtensiveObject");
+    AttributeKey<Int> intKey = sc->getAttributeKey<Int>("int");
+    AttributeKey<FloatVector> floatVecKey = sc->getAttributeKey<FloatVector>("float vector");
+    AttributeKey<Vec3fVector> vec3fVecKey = sc->getAttributeKey<Vec3fVector>("vec3f vector");
+    for (bool parallel : { false, true }) {
+        SceneContext readContext;
+        BinaryReader reader(readContext);
+        reader.setParallelDecode(parallel);
+        reader.fromBytes(compressedManifest, compressedPayload);
+        for (int i = 0; i < 300; ++i) {
+            const std::string name = "/seq/shot/obj" + std::to_string(i);
+            const SceneObject* obj = context.getSceneObject(name);
+            const SceneObject* readObj = readContext.getSceneObject(name);
+            CPPUNIT_ASSERT(readObj->get(intKey) == obj->get(intKey));
+            CPPUNIT_ASSERT(readObj->get(floatVecKey) == obj->get(floatVecKey));
+            CPPUNIT_ASSERT(readObj->get(vec3fVecKey) == obj->get(vec3fVecKey));
+        }
+    }
+
+    // Compression composes with chunked framing and the file readers.
+    writer.setChunkedFraming(100);
+    writer.toFile("compressed.rdlb");
+    SceneContext mappedContext;
+    BinaryReader mappedReader(mappedContext);
+    mappedReader.fromMappedFile("compressed.rdlb");
+    CPPUNIT_ASSERT(mappedContext.getSceneObject("/seq/shot/obj299")->get(vec3fVecKey) ==
+                   context.getSceneObject("/seq/shot/obj299")->get(vec3fVecKey));
+
+    // A damaged block is reported rather than decoded.
+    std::string damagedPayload = compressedPayload;
+    damagedPayload.resize(damagedPayload.size() - 16);
+    std::string damagedManifest;
+    {
+        ValueContainerDeq deq(compressedManifest.data(), compressedManifest.size());
+        ValueContainerEnq enq(&damagedManifest);
+        std::size_t numRecords = deq.deqVLSizeT();
+        enq.enqVLSizeT(numRecords);
+        for (std::size_t i = 0; i < numRecords; ++i) {
+            unsigned int type = deq.deqVLUInt();
+            std::size_t size = deq.deqVLSizeT();
+            enq.enqVLUInt(type);
+            enq.enqVLSizeT((i + 1 == numRecords) ? size - 16 : size);
+        }
+        enq.finalize();
+    }
+    SceneContext damagedContext;
+    BinaryReader damagedReader(damagedContext);
+    CPPUNIT_ASSERT_THROW(damagedReader.fromBytes(damagedManifest, damagedPayload), except::IoError);
+
+    // An absurd uncompressed size header is rejected before allocating.
+    {
+        ValueContainerDeq deq(compressedManifest.data(), compressedManifest.size());
+        CPPUNIT_ASSERT(deq.deqVLSizeT() > 0);
+        CPPUNIT_ASSERT(deq.deqVLUInt() == BinaryWriter::SCENE_OBJECT_2_LZ_BLOCK);
+    }
+    std::string hugePayload = compressedPayload;
+    const uint64_t hugeSize = uint64_t(1) << 60;
+    std::memcpy(&hugePayload[0], &hugeSize, sizeof(uint64_t)); // first block's size header
+    SceneContext hugeContext;
+    BinaryReader hugeReader(hugeContext);
+    CPPUNIT_ASSERT_THROW(hugeReader.fromBytes(compressedManifest, hugePayload), except::RuntimeError);
+}
+
+void
+TestBinary::testCompressionTiming()
+{
+#ifdef TIMING_TEST
+    constexpr int OBJECTS = 2000;
+    constexpr int VECTOR_SIZE = 1024;
+#else
+    constexpr int OBJECTS = 200;
+    constexpr int VECTOR_SIZE = 64;
+#endif
+    SceneContext context;
+    std::string manifest, payload;
+    setupParallelDecodeScene(context, OBJECTS, VECTOR_SIZE, manifest, payload);
+
+    const SceneClass* sc = context.getSceneClass("ExtensiveObject");
+    AttributeKey<Int> intKey = sc->getAttributeKey<Int>("int");
+    AttributeKey<Vec3fVector> vec3fVecKey = sc->getAttributeKey<Vec3fVector>("vec3f vector");
+
+    // Every block size loads the same scene.
+    auto load = [&](const std::string& m, const std::string& p) {
+        SceneContext readContext;
+        BinaryReader reader(readContext);
+        reader.setParallelDecode(true);
+        rec_time::RecTime recTime;
+        recTime.start();
+        reader.fromBytes(m, p);
+        const float sec = recTime.end();
+
+        for (auto iter = context.beginSceneObject(); iter != context.endSceneObject(); ++iter) {
+            const SceneObject* src = iter->second;
+            if (!src->isA<SceneVariables>()) {
+                const SceneObject* obj = readContext.getSceneObject(src->getName());
+                CPPUNIT_ASSERT(obj->get(intKey) == src->get(intKey));
+                CPPUNIT_ASSERT(obj->get(vec3fVecKey) == src->get(vec3fVecKey));
+            }
+        }
+        return sec;
+    };
+
+    const float plainSec = load(manifest, payload);
+#ifdef TIMING_TEST
+    std::cerr << ">> TestBinary.cc testCompressionTiming() none size:" << payload.size()
+              << " load:" << plainSec << " sec\n";
+#endif
+    for (std::size_t blockSize : { std::size_t(64 * 1024), std::size_t(1024 * 1024), std::size_t(16 * 1024 * 1024) }) {
+        BinaryWriter writer(context);
+        writer.setCompression(BinaryWriter::Compression::LZ_BLOCK, blockSize);
+        std::string m, p;
+        rec_time::RecTime recTime;
+        recTime.start();
+        writer.toBytes(m, p);
+        const float encodeSec = recTime.end();
+        CPPUNIT_ASSERT(p.size() < payload.size());
+
+        const float sec = load(m, p);
+#ifdef TIMING_TEST
+        std::cerr << ">> TestBinary.cc testCompressionTiming() block:" << blockSize
+                  << " size:" << p.size()
+                  << " ratio:" << static_cast<float>(payload.size()) / static_cast<float>(p.size())
+                  << " encode:" << encodeSec << " sec"
+                  << " load:" << sec << " sec\n";
+#endif
+    }
+}
+
 } // namespace unittest
 } // namespace rdl2
 } // namespace scene_rdl2
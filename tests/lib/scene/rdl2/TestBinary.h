@@ -32,14 +32,51 @@ public:
     /// and bindings.
     void testNullReferences();
 
+    /// Test that parallel decode matches serial decode, including streams
+    /// which contain more than one record for the same SceneObject.
+    void testParallelDecode();
+
+    /// Check the parallel decode at 1, 8, 32 and 64 threads, and time it
+    /// when TIMING_TEST is defined.
+    void testParallelDecodeTiming();
+
+    /// Test that decoding from a memory mapped file matches fromFile().
+    void testMappedFile();
+
+    /// Test that parallel encoding is byte-identical to serial encoding.
+    void testParallelEncoding();
+
+    /// Test that chunked streams round trip through every read path.
+    void testChunkedStream();
+
+    /// Test the block codec and compressed payload round trips.
+    void testCompression();
+
+    /// Check that compressed payloads are smaller and load the same scene at
+    /// several block sizes. Reports sizes and load times when TIMING_TEST is
+    /// defined.
+    void testCompressionTiming();
+
     CPPUNIT_TEST_SUITE(TestBinary);
     CPPUNIT_TEST(testRoundtrip);
     CPPUNIT_TEST(testTransientEncoding);
     CPPUNIT_TEST(testDeltaEncoding);
     CPPUNIT_TEST(testNullReferences);
+    CPPUNIT_TEST(testParallelDecode);
+    CPPUNIT_TEST(testParallelDecodeTiming);
+    CPPUNIT_TEST(testMappedFile);
+    CPPUNIT_TEST(testParallelEncoding);
+    CPPUNIT_TEST(testChunkedStream);
+    CPPUNIT_TEST(testCompression);
+    CPPUNIT_TEST(testCompressionTiming);
     CPPUNIT_TEST_SUITE_END();
 
 private:
+    // Fills the context with numObjects ExtensiveObjects carrying vectors of
+    // vectorSize elements, returning the encoded manifest and payload.
+    void setupParallelDecodeScene(SceneContext& context, int numObjects, int vectorSize,
+                                  std::string& manifest, std::string& payload) const;
+
     BoolVector mBoolVec2;
     IntVector mIntVec2;
     LongVector mLongVec2;
@@ -5,12 +5,21 @@
 #include "TestDso.h"
 
 #include <scene_rdl2/scene/rdl2/Dso.h>
+#include <scene_rdl2/scene/rdl2/DsoManifest.h>
+#include <scene_rdl2/scene/rdl2/SceneClass.h>
+#include <scene_rdl2/scene/rdl2/SceneContext.h>
+#include <scene_rdl2/scene/rdl2/SceneObject.h>
+#include <scene_rdl2/scene/rdl2/ValueContainerEnq.h>
 
 #include <scene_rdl2/common/except/exceptions.h>
 #include <scene_rdl2/render/util/Files.h>
 
 #include <cppunit/extensions/HelperMacros.h>
 
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
 #include <string>
 
 namespace scene_rdl2 {
@@ -124,6 +133,102 @@ TestDso::testMissingSymbols()
     }
 }
 
+void
+TestDso::testDsoManifest()
+{
+    const std::string manifestPath("TestDso.dso_manifest");
+    std::remove(manifestPath.c_str());
+
+    // Opening the DSO records its declarations, which are only written by
+    // an explicit save.
+    std::string recorded;
+    {
+        SceneContext context;
+        context.setDsoPath(".");
+        context.setDsoManifestPath(manifestPath);
+        recorded = DsoManifest::record(*context.createSceneClass("ExtensiveObject"));
+    }
+    CPPUNIT_ASSERT(!std::ifstream(manifestPath.c_str()));
+    {
+        SceneContext context;
+        context.setDsoPath(".");
+        context.setDsoManifestPath(manifestPath);
+        CPPUNIT_ASSERT(DsoManifest::record(*context.createSceneClass("ExtensiveObject")) == recorded);
+        context.saveDsoManifest();
+    }
+    {
+        DsoManifest manifest(manifestPath);
+        CPPUNIT_ASSERT(manifest.size() == 1);
+        CPPUNIT_ASSERT(!manifest.isDirty());
+
+        DsoManifest::Entry entry;
+        CPPUNIT_ASSERT(manifest.find("./ExtensiveObject.so", entry));
+        CPPUNIT_ASSERT(entry.mValid);
+        CPPUNIT_ASSERT(entry.mClassName == "ExtensiveObject");
+        CPPUNIT_ASSERT(entry.mDeclaration == recorded);
+        CPPUNIT_ASSERT(!manifest.find("./ExampleObject.so", entry));
+    }
+
+    // A second context declares the class from the manifest, with the same
+    // attributes, defaults, metadata, enums and groups.
+    {
+        SceneContext context;
+        context.setDsoPath(".");
+        context.setDsoManifestPath(manifestPath);
+        SceneClass* sc = context.createSceneClass("ExtensiveObject");
+        CPPUNIT_ASSERT(sc->getSourcePath() == "./ExtensiveObject.so");
+        CPPUNIT_ASSERT(DsoManifest::record(*sc) == recorded);
+
+        // Creating an object opens the DSO, whose declarations must agree.
+        SceneObject* obj = context.createSceneObject("ExtensiveObject", "/seq/shot/pizza");
+        CPPUNIT_ASSERT(obj->get<Int>("int") == 42);
+        CPPUNIT_ASSERT(obj->get<String>("string") == "pizza");
+        CPPUNIT_ASSERT(obj->get<Mat4d>("mat4d") == Mat4d(1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0, 8.0,
+                                                         9.0, 10.0, 11.0, 12.0, 13.0, 14.0, 15.0, 16.0));
+    }
+
+    // A corrupt manifest is ignored.
+    auto writeManifest = [&](const std::string& bytes) {
+        std::ofstream out(manifestPath.c_str(), std::ios::trunc | std::ios::binary);
+        out.write(bytes.data(), bytes.size());
+    };
+    writeManifest("not a manifest");
+    {
+        DsoManifest manifest(manifestPath);
+        CPPUNIT_ASSERT(manifest.size() == 0);
+    }
+
+    // So is every truncation of a valid one, with its data size header
+    // patched so only the length checks can catch it.
+    const std::string valid = [&]() {
+        std::ifstream in(manifestPath.c_str(), std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }();
+    for (std::size_t size = sizeof(std::size_t); size < valid.size(); ++size) {
+        std::string truncated = valid.substr(0, size);
+        std::memcpy(&truncated[0], &size, sizeof(size));
+        writeManifest(truncated);
+        DsoManifest manifest(manifestPath);
+        CPPUNIT_ASSERT(manifest.size() == 0);
+    }
+
+    // And one claiming more entries than it could hold.
+    {
+        std::string bytes;
+        ValueContainerEnq enq(&bytes);
+        enq.enqString("RDL2_DSO_MANIFEST");
+        enq.enqVLUInt(1);
+        enq.enqVLSizeT(std::size_t(1) << 40);
+        enq.enqString("/a.so");
+        enq.finalize();
+        writeManifest(bytes);
+        DsoManifest manifest(manifestPath);
+        CPPUNIT_ASSERT(manifest.size() == 0);
+    }
+
+    std::remove(manifestPath.c_str());
+}
+
 } // namespace unittest
 } // namespace rdl2
 } // namespace scene_rdl2
@@ -34,12 +34,16 @@ public:
     /// Test that missing symbols throw an exception when loaded.
     void testMissingSymbols();
 
+    /// Test declaring SceneClasses from a DSO manifest.
+    void testDsoManifest();
+
     CPPUNIT_TEST_SUITE(TestDso);
     CPPUNIT_TEST(testGetFilePath);
     CPPUNIT_TEST(testIsValidDso);
     CPPUNIT_TEST(testFindDso);
     CPPUNIT_TEST(testLazyLoading);
     CPPUNIT_TEST(testMissingSymbols);
+    CPPUNIT_TEST(testDsoManifest);
     CPPUNIT_TEST_SUITE_END();
 };
 
@@ -5,17 +5,23 @@
 #include "TestSceneClass.h"
 
 #include <scene_rdl2/scene/rdl2/Attribute.h>
+#include <scene_rdl2/scene/rdl2/AttributeColumn.h>
 #include <scene_rdl2/scene/rdl2/AttributeKey.h>
 #include <scene_rdl2/scene/rdl2/SceneClass.h>
+#include <scene_rdl2/scene/rdl2/SceneContext.h>
+#include <scene_rdl2/scene/rdl2/SceneObject.h>
 #include <scene_rdl2/scene/rdl2/Types.h>
 
 #include <scene_rdl2/common/except/exceptions.h>
+#include <scene_rdl2/common/rec_time/RecTime.h>
 
 #include <cppunit/extensions/HelperMacros.h>
 
 #include <cstddef>
 #include <cstdlib>
+#include <iostream>
 #include <string>
+#include <vector>
 #include <stdint.h>
 
 #if __INTEL_COMPILER < 1600
@@ -2556,6 +2562,128 @@ TestSceneClass::testAttributeStorage()
     }
 }
 
+void
+TestSceneClass::testAttributeColumn()
+{
+    constexpr int OBJECTS = 5000;
+
+    SceneContext context;
+    std::vector<std::string> names;
+    for (int i = 0; i < OBJECTS; ++i) {
+        names.push_back("/seq/shot/object_" + std::to_string(i));
+    }
+    std::vector<SceneObject*> objects = context.createSceneObjects("ExtensiveObject", names);
+    const SceneClass& sc = objects[0]->getSceneClass();
+    AttributeKey<Float> floatKey = sc.getAttributeKey<Float>("float");
+    AttributeKey<Bool> boolKey = sc.getAttributeKey<Bool>("bool");
+
+    AttributeColumn<Float> floats(sc, floatKey);
+    AttributeColumn<Float> floatsEnd(sc, floatKey, TIMESTEP_END);
+    AttributeColumn<Bool> bools(sc, boolKey);
+    CPPUNIT_ASSERT_EQUAL(std::size_t(0), floats.size());
+
+    CPPUNIT_ASSERT_EQUAL(std::size_t(OBJECTS), floats.refresh());
+    CPPUNIT_ASSERT_EQUAL(std::size_t(OBJECTS), floatsEnd.refresh());
+    CPPUNIT_ASSERT_EQUAL(std::size_t(OBJECTS), bools.refresh());
+    CPPUNIT_ASSERT(reinterpret_cast<uintptr_t>(floats.data()) % SIMD_MEMORY_ALIGNMENT == 0);
+    for (int i = 0; i < OBJECTS; ++i) {
+        CPPUNIT_ASSERT(floats.getObject(i) == objects[i]);
+        CPPUNIT_ASSERT_EQUAL(1.0f, floats[i]);
+        CPPUNIT_ASSERT(bools[i]);
+    }
+
+    // Nothing changed, nothing is copied.
+    CPPUNIT_ASSERT_EQUAL(std::size_t(0), floats.refresh());
+
+    // Only changed objects are recopied, and setting an attribute to its
+    // current value is not a change.
+    for (int i = 0; i < OBJECTS; i += 10) {
+        SceneObject::UpdateGuard guard(objects[i]);
+        objects[i]->set(floatKey, float(i), TIMESTEP_END);
+        objects[i]->set(boolKey, false);
+    }
+    {
+        SceneObject::UpdateGuard guard(objects[1]);
+        objects[1]->set(floatKey, 1.0f);
+    }
+    CPPUNIT_ASSERT_EQUAL(std::size_t(OBJECTS / 10), floats.refresh());
+    CPPUNIT_ASSERT_EQUAL(std::size_t(OBJECTS / 10), floatsEnd.refresh());
+    CPPUNIT_ASSERT_EQUAL(std::size_t(OBJECTS / 10), bools.refresh());
+    for (int i = 0; i < OBJECTS; ++i) {
+        CPPUNIT_ASSERT_EQUAL(1.0f, floats[i]);
+        CPPUNIT_ASSERT_EQUAL(i % 10 ? 1.0f : float(i), floatsEnd[i]);
+        CPPUNIT_ASSERT_EQUAL(i % 10 != 0, bool(bools[i]));
+    }
+
+    // New objects are appended.
+    SceneObject* extra = context.createSceneObject("ExtensiveObject", "/seq/shot/extra");
+    CPPUNIT_ASSERT_EQUAL(std::size_t(1), floats.refresh());
+    CPPUNIT_ASSERT_EQUAL(std::size_t(OBJECTS + 1), floats.size());
+    CPPUNIT_ASSERT(floats.getObject(OBJECTS) == extra);
+}
+
+void
+TestSceneClass::testAttributeColumnTiming()
+{
+#ifdef TIMING_TEST
+    constexpr int OBJECTS = 200000;
+    constexpr int SWEEPS = 20;
+#else
+    constexpr int OBJECTS = 2000;
+    constexpr int SWEEPS = 2;
+#endif
+
+    SceneContext context;
+    std::vector<std::string> names;
+    for (int i = 0; i < OBJECTS; ++i) {
+        names.push_back("/seq/shot/object_" + std::to_string(i));
+    }
+    std::vector<SceneObject*> objects = context.createSceneObjects("ExtensiveObject", names);
+    const SceneClass& sc = objects[0]->getSceneClass();
+    AttributeKey<Float> floatKey = sc.getAttributeKey<Float>("float");
+    for (int i = 0; i < OBJECTS; ++i) {
+        objects[i]->beginUpdate();
+        objects[i]->set(floatKey, static_cast<Float>(i % 1000) * 0.5f);
+        objects[i]->endUpdate();
+    }
+
+    rec_time::RecTime recTime;
+    double getSum = 0.0;
+    recTime.start();
+    for (int s = 0; s < SWEEPS; ++s) {
+        for (const SceneObject* obj : objects) {
+            getSum += obj->get(floatKey);
+        }
+    }
+    const float getSec = recTime.end();
+
+    AttributeColumn<Float> column(sc, floatKey);
+    double columnSum = 0.0;
+    recTime.start();
+    for (int s = 0; s < SWEEPS; ++s) {
+        column.refresh();
+        const Float* values = column.data();
+        for (std::size_t i = 0; i < column.size(); ++i) {
+            columnSum += values[i];
+        }
+    }
+    const float columnSec = recTime.end();
+
+    // Both sweeps see the same values.
+    CPPUNIT_ASSERT_EQUAL(std::size_t(OBJECTS), column.size());
+    for (std::size_t i = 0; i < column.size(); ++i) {
+        CPPUNIT_ASSERT(column[i] == column.getObject(i)->get(floatKey));
+    }
+    CPPUNIT_ASSERT_EQUAL(getSum, columnSum);
+
+#ifdef TIMING_TEST
+    std::cerr << ">> TestSceneClass.cc testAttributeColumnTiming()"
+              << " objects:" << OBJECTS << " sweeps:" << SWEEPS
+              << " get:" << getSec << " sec"
+              << " column (with refresh):" << columnSec << " sec\n";
+#endif
+}
+
 } // namespace unittest
 } // namespace rdl2
 } // namespace scene_rdl2
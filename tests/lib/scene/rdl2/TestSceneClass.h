@@ -62,6 +62,15 @@ public:
     /// and set values in it.
     void testAttributeStorage();
 
+    /// Test that an AttributeColumn holds the attribute values of all objects
+    /// of the class and refreshes only new and changed rows.
+    void testAttributeColumn();
+
+    /// Check that sweeping an attribute through SceneObject::get() and
+    /// through its AttributeColumn see the same values, and compare their
+    /// timings when TIMING_TEST is defined.
+    void testAttributeColumnTiming();
+
     CPPUNIT_TEST_SUITE(TestSceneClass);
     CPPUNIT_TEST(testGetName);
     CPPUNIT_TEST(testDeclareSimple);
@@ -77,6 +86,8 @@ public:
     CPPUNIT_TEST(testMemoryLayout);
     CPPUNIT_TEST(testCreateDestroyObject);
     CPPUNIT_TEST(testAttributeStorage);
+    CPPUNIT_TEST(testAttributeColumn);
+    CPPUNIT_TEST(testAttributeColumnTiming);
     CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -4,17 +4,34 @@
 
 #include "TestSceneContext.h"
 
+#include <scene_rdl2/scene/rdl2/AsciiReader.h>
 #include <scene_rdl2/scene/rdl2/AttributeKey.h>
 #include <scene_rdl2/scene/rdl2/SceneContext.h>
 #include <scene_rdl2/scene/rdl2/SceneClass.h>
 #include <scene_rdl2/scene/rdl2/SceneObject.h>
 #include <scene_rdl2/scene/rdl2/SceneVariables.h>
+#include <scene_rdl2/scene/rdl2/Symbol.h>
 #include <scene_rdl2/scene/rdl2/Types.h>
+#include <scene_rdl2/scene/rdl2/UpdateHelper.h>
 
 #include <scene_rdl2/common/except/exceptions.h>
 #include <scene_rdl2/common/math/Color.h>
+#include <scene_rdl2/common/rec_time/RecTime.h>
+#include <scene_rdl2/render/util/Memory.h>
 
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_for_each.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
 namespace scene_rdl2 {
 namespace rdl2 {
@@ -123,6 +140,176 @@ TestSceneContext::testCreateSceneObject()
     );
 }
 
+void
+TestSceneContext::testCreateSceneObjects()
+{
+    SceneContext context;
+    SceneObject* pizza = context.createSceneObject("ExampleObject", "/seq/shot/pizza");
+
+    const std::vector<std::string> names = {
+        "/seq/shot/cookie", "/seq/shot/pizza", "/seq/shot/cake", "/seq/shot/cookie"
+    };
+    std::vector<SceneObject*> objects = context.createSceneObjects("ExampleObject", names);
+    CPPUNIT_ASSERT_EQUAL(names.size(), objects.size());
+    CPPUNIT_ASSERT(objects[1] == pizza);
+    CPPUNIT_ASSERT(objects[0] == objects[3]);
+    for (std::size_t i = 0; i < names.size(); ++i) {
+        CPPUNIT_ASSERT(objects[i] == context.getSceneObject(names[i]));
+        CPPUNIT_ASSERT(objects[i]->getName() == names[i]);
+    }
+
+    // Slab storage holds defaults and independent values.
+    AttributeKey<Int> key =
+        pizza->getSceneClass().getAttributeKey<Int>("awesomeness");
+    CPPUNIT_ASSERT_EQUAL(Int(11), objects[2]->get(key));
+    objects[2]->beginUpdate();
+    objects[2]->set(key, Int(12));
+    objects[2]->endUpdate();
+    CPPUNIT_ASSERT_EQUAL(Int(12), objects[2]->get(key));
+    CPPUNIT_ASSERT_EQUAL(Int(11), objects[0]->get(key));
+
+    CPPUNIT_ASSERT_THROW(context.createSceneObjects("ExtensiveObject", names),
+                         except::TypeError);
+    CPPUNIT_ASSERT_THROW(context.createSceneObjects("ExampleObject", {"/seq/shot/a", ""}),
+                         except::ValueError);
+
+    // Overlapping batches from many threads agree on one object per name.
+    constexpr int THREADS = 8;
+    constexpr int OBJECTS = 2000;
+    std::vector<std::vector<SceneObject*>> results(THREADS);
+    tbb::parallel_for(0, THREADS, [&](int t) {
+        std::vector<std::string> batch;
+        for (int i = 0; i < OBJECTS; ++i) {
+            batch.push_back("/batch/object_" + std::to_string((i + t * 97) % OBJECTS));
+        }
+        results[t] = context.createSceneObjects("ExampleObject", batch);
+    });
+    for (int t = 0; t < THREADS; ++t) {
+        for (int i = 0; i < OBJECTS; ++i) {
+            const std::string name = "/batch/object_" + std::to_string((i + t * 97) % OBJECTS);
+            CPPUNIT_ASSERT(results[t][i] == context.getSceneObject(name));
+        }
+    }
+}
+
+void
+TestSceneContext::testCreateSceneObjectsTiming()
+{
+#ifdef TIMING_TEST
+    constexpr int OBJECTS = 1000000;
+#else
+    constexpr int OBJECTS = 1000;
+#endif
+
+    std::vector<std::string> names;
+    names.reserve(OBJECTS);
+    for (int i = 0; i < OBJECTS; ++i) {
+        names.push_back("/seq/shot/object_" + std::to_string(i));
+    }
+
+    // Both ways create the same objects.
+#ifdef TIMING_TEST
+    rec_time::RecTime recTime;
+    float singleSec = 0.0f;
+    float bulkSec = 0.0f;
+#endif
+    std::size_t singleCount = 0;
+    {
+        SceneContext context;
+        context.createSceneClass("ExampleObject");
+#ifdef TIMING_TEST
+        recTime.start();
+#endif
+        for (const std::string& name : names) {
+            context.createSceneObject("ExampleObject", name);
+        }
+#ifdef TIMING_TEST
+        singleSec = recTime.end();
+#endif
+        for (const std::string& name : names) {
+            singleCount += context.sceneObjectExists(name);
+        }
+    }
+    CPPUNIT_ASSERT_EQUAL(std::size_t(OBJECTS), singleCount);
+
+    {
+        SceneContext context;
+        context.createSceneClass("ExampleObject");
+#ifdef TIMING_TEST
+        recTime.start();
+#endif
+        std::vector<SceneObject*> objects = context.createSceneObjects("ExampleObject", names);
+#ifdef TIMING_TEST
+        bulkSec = recTime.end();
+#endif
+        CPPUNIT_ASSERT_EQUAL(std::size_t(OBJECTS), objects.size());
+        for (int i = 0; i < OBJECTS; ++i) {
+            CPPUNIT_ASSERT(objects[i]->getName() == names[i]);
+            CPPUNIT_ASSERT(context.getSceneObject(names[i]) == objects[i]);
+        }
+    }
+
+#ifdef TIMING_TEST
+    std::cerr << ">> TestSceneContext.cc testCreateSceneObjectsTiming()"
+              << " objects:" << OBJECTS
+              << " single:" << singleSec << " sec"
+              << " bulk:" << bulkSec << " sec\n";
+#endif
+}
+
+void
+TestSceneContext::testAttributeStorageSlabs()
+{
+    constexpr int OBJECTS = 1000;
+
+    std::vector<std::string> names;
+    for (int i = 0; i < OBJECTS; ++i) {
+        names.push_back("/seq/shot/object_" + std::to_string(i));
+    }
+
+    std::atomic<int> allocs(0);
+    std::atomic<int> frees(0);
+    {
+        SceneContext context;
+        context.setAttributeStorageNumaInfo(0,
+            [&](std::size_t size, std::size_t alignment) {
+                ++allocs;
+                return util::alignedMalloc(size, alignment);
+            },
+            [&](void* addr, std::size_t) {
+                ++frees;
+                util::alignedFree(addr);
+            });
+
+        std::vector<SceneObject*> objects = context.createSceneObjects("ExampleObject", names);
+        SceneObject* single = context.createSceneObject("ExampleObject", "/seq/shot/single");
+        AttributeKey<Int> key =
+            objects[0]->getSceneClass().getAttributeKey<Int>("awesomeness");
+
+        // A batch is laid out at a constant stride, block by block.
+        const char* first = reinterpret_cast<const char*>(&objects[0]->get(key));
+        const std::ptrdiff_t stride =
+            reinterpret_cast<const char*>(&objects[1]->get(key)) - first;
+        CPPUNIT_ASSERT(stride > 0 && stride % 64 == 0);
+        int contiguous = 0;
+        for (int i = 1; i < OBJECTS; ++i) {
+            const char* prev = reinterpret_cast<const char*>(&objects[i - 1]->get(key));
+            const char* curr = reinterpret_cast<const char*>(&objects[i]->get(key));
+            contiguous += (curr - prev == stride);
+        }
+        CPPUNIT_ASSERT(contiguous >= OBJECTS - 1 - OBJECTS * stride / (64 * 1024));
+
+        // Single creation continues in the same storage.
+        const char* last = reinterpret_cast<const char*>(&objects.back()->get(key));
+        CPPUNIT_ASSERT(reinterpret_cast<const char*>(&single->get(key)) - last == stride);
+        CPPUNIT_ASSERT_EQUAL(Int(11), single->get(key));
+
+        CPPUNIT_ASSERT(allocs > 0);
+        CPPUNIT_ASSERT_EQUAL(0, int(frees));
+    }
+    CPPUNIT_ASSERT_EQUAL(int(allocs), int(frees));
+}
+
 void
 TestSceneContext::testGetSceneObject()
 {
@@ -416,6 +603,556 @@ TestSceneContext::testCreateObjectFailure()
     CPPUNIT_ASSERT_EQUAL(numBefore, numAfter);
 }
 
+void
+TestSceneContext::testDirtyObjectJournal()
+{
+    SceneContext context;
+    const SceneClass* sc = context.createSceneClass("FakeTeapot");
+    AttributeKey<Float> fakenessKey = sc->getAttributeKey<Float>("fakeness");
+
+    // The SceneVariables and every newly created object are journaled.
+    SceneObject* teapot = context.createSceneObject("FakeTeapot", "/seq/shot/teapot");
+    context.createSceneObject("FakeTeapot", "/seq/shot/teapot2");
+    context.createSceneObject("FakeTeapot", "/seq/shot/teapot"); // existing, not journaled again
+    CPPUNIT_ASSERT_EQUAL(std::size_t(3), context.getDirtyObjectJournal().size());
+
+    context.commitAllChanges();
+    CPPUNIT_ASSERT(context.getDirtyObjectJournal().empty());
+    CPPUNIT_ASSERT(!teapot->isDirty());
+
+    // Setting an attribute twice only journals the object once.
+    teapot->beginUpdate();
+    teapot->set(fakenessKey, 1.0f);
+    teapot->set(fakenessKey, 2.0f);
+    teapot->endUpdate();
+    CPPUNIT_ASSERT_EQUAL(std::size_t(1), context.getDirtyObjectJournal().size());
+    CPPUNIT_ASSERT(context.getDirtyObjectJournal()[0] == teapot);
+    CPPUNIT_ASSERT(teapot->isDirty());
+
+    // Setting an attribute to its current value doesn't dirty the object.
+    context.commitAllChanges();
+    teapot->beginUpdate();
+    teapot->set(fakenessKey, 2.0f);
+    teapot->endUpdate();
+    CPPUNIT_ASSERT(context.getDirtyObjectJournal().empty());
+}
+
+void
+TestSceneContext::testUpdateDependencyOrder()
+{
+    SceneContext context;
+    context.createSceneClass("FakeTeapot");
+    auto create = [&](const char* name) {
+        return context.createSceneObject("FakeTeapot", name);
+    };
+
+    // The example DAG from UpdateHelper.h, recorded the way updatePrep()
+    // would record it.
+    SceneObject* a = create("A");
+    SceneObject* b = create("B");
+    SceneObject* c = create("C");
+    SceneObject* d = create("D");
+    SceneObject* e = create("E");
+    SceneObject* f = create("F");
+    SceneObject* g = create("G");
+    SceneObject* unchanged = create("unchanged");
+
+    UpdateHelper helper;
+    helper.insertLeaf(g);
+    helper.insertLeaf(f);
+    helper.insert(e, 3);
+    helper.insert(c, 2);
+    helper.insert(b, 1);
+    helper.insert(d, 1);
+    helper.insert(a, 0);
+    helper.addDependency(e, g);
+    helper.addDependency(c, e);
+    helper.addDependency(d, e);
+    helper.addDependency(d, f);
+    helper.addDependency(b, c);
+    helper.addDependency(a, b);
+    helper.addDependency(a, d);
+    helper.addDependency(a, d); // duplicate edges are ignored
+    helper.addDependency(unchanged, a); // not recorded, so never visited
+
+    std::atomic<int> counter(0);
+    std::unordered_map<SceneObject*, int> order;
+    for (SceneObject* obj : { a, b, c, d, e, f, g, unchanged }) {
+        order[obj] = -1;
+    }
+    helper.parallelForEach([&](SceneObject* const obj) {
+        // Each object is visited by exactly one task, so writing its own
+        // slot is race free.
+        order.at(obj) = counter++;
+    });
+
+    CPPUNIT_ASSERT_EQUAL(7, counter.load());
+    CPPUNIT_ASSERT_EQUAL(-1, order[unchanged]);
+    CPPUNIT_ASSERT(order[g] < order[e]);
+    CPPUNIT_ASSERT(order[e] < order[c]);
+    CPPUNIT_ASSERT(order[e] < order[d]);
+    CPPUNIT_ASSERT(order[f] < order[d]);
+    CPPUNIT_ASSERT(order[c] < order[b]);
+    CPPUNIT_ASSERT(order[b] < order[a]);
+    CPPUNIT_ASSERT(order[d] < order[a]);
+
+    helper.clear();
+    counter = 0;
+    CPPUNIT_ASSERT_EQUAL(size_t(0), helper.parallelForEach([&](SceneObject* const) { ++counter; }));
+    CPPUNIT_ASSERT_EQUAL(0, counter.load());
+
+    // A cycle can never become ready. Every object on it, and every object
+    // depending on it, is still updated once, in depth order.
+    helper.insertLeaf(g);
+    helper.insert(c, 2);
+    helper.insert(b, 1);
+    helper.insert(a, 0);
+    helper.addDependency(c, g);
+    helper.addDependency(b, c);
+    helper.addDependency(c, b);
+    helper.addDependency(a, b);
+    for (auto& entry : order) {
+        entry.second = -1;
+    }
+    const size_t outOfOrder = helper.parallelForEach([&](SceneObject* const obj) {
+        order.at(obj) = counter++;
+    });
+    CPPUNIT_ASSERT_EQUAL(size_t(3), outOfOrder);
+    CPPUNIT_ASSERT_EQUAL(4, counter.load());
+    CPPUNIT_ASSERT_EQUAL(0, order[g]);
+    CPPUNIT_ASSERT(order[c] < order[b]);
+    CPPUNIT_ASSERT(order[b] < order[a]);
+    CPPUNIT_ASSERT_EQUAL(-1, order[d]);
+}
+
+void
+TestSceneContext::testApplyUpdatesDependencies()
+{
+    SceneContext context;
+    Geometry* teapot = context.createSceneObject("FakeTeapot", "/teapot")->asA<Geometry>();
+    Geometry* unchanged = context.createSceneObject("FakeTeapot", "/unchanged")->asA<Geometry>();
+    Material* material = context.createSceneObject("FakeMaterial", "/material")->asA<Material>();
+    Layer* layer = context.createSceneObject("Layer", "/layer")->asA<Layer>();
+
+    layer->beginUpdate();
+    layer->assign(teapot, "lid", material, nullptr);
+    layer->assign(unchanged, "lid", material, nullptr);
+    layer->endUpdate();
+
+    teapot->requestUpdate();
+    material->requestUpdate();
+    context.applyUpdates(layer);
+
+    const UpdateHelper& graph = context.mSceneObjectUpdateGraph;
+    CPPUNIT_ASSERT(graph.isLeaf(teapot));
+    CPPUNIT_ASSERT(graph.isLeaf(material));
+    CPPUNIT_ASSERT_EQUAL(-2, graph.getDepth(unchanged));
+    CPPUNIT_ASSERT(graph.hasDependency(layer, teapot));
+    CPPUNIT_ASSERT(graph.hasDependency(layer, material));
+    CPPUNIT_ASSERT(!graph.hasDependency(layer, unchanged));
+    CPPUNIT_ASSERT(!graph.hasDependency(teapot, material));
+
+    // The recorded edges schedule the geometry and the material before the
+    // layer, without falling back to depth order.
+    std::mutex mutex;
+    std::vector<SceneObject*> updated;
+    CPPUNIT_ASSERT_EQUAL(size_t(0), graph.parallelForEach([&](SceneObject* const obj) {
+        std::lock_guard<std::mutex> lock(mutex);
+        updated.push_back(obj);
+    }));
+    CPPUNIT_ASSERT_EQUAL(graph.getObjectCount(), updated.size());
+    CPPUNIT_ASSERT(std::find(updated.begin(), updated.end(), layer) != updated.end());
+    CPPUNIT_ASSERT(std::find(updated.begin(), updated.end(), teapot) <
+                   std::find(updated.begin(), updated.end(), layer));
+    CPPUNIT_ASSERT(std::find(updated.begin(), updated.end(), material) <
+                   std::find(updated.begin(), updated.end(), layer));
+
+    context.resetUpdates(layer);
+    CPPUNIT_ASSERT_EQUAL(size_t(0), context.mSceneObjectUpdateGraph.getObjectCount());
+}
+
+void
+TestSceneContext::testApplyUpdatesSharedGeometry()
+{
+    SceneContext context;
+    Geometry* teapot = context.createSceneObject("FakeTeapot", "/teapot")->asA<Geometry>();
+    Material* material = context.createSceneObject("FakeMaterial", "/material")->asA<Material>();
+    Displacement* displacement =
+        context.createSceneObject("FakeDisplacement", "/displacement")->asA<Displacement>();
+    Layer* layer = context.createSceneObject("Layer", "/layer")->asA<Layer>();
+
+    layer->beginUpdate();
+    layer->assign(teapot, "lid", material, nullptr, displacement, nullptr);
+    layer->assign(teapot, "body", material, nullptr);
+    layer->endUpdate();
+
+    // Only the displacement of the first assignment changed. Its update
+    // request reaches the geometry before the second assignment looks at it.
+    displacement->requestUpdate();
+    context.applyUpdates(layer);
+
+    const UpdateHelper& graph = context.mSceneObjectUpdateGraph;
+    CPPUNIT_ASSERT(graph.hasDependency(layer, displacement));
+    CPPUNIT_ASSERT(graph.hasDependency(layer, teapot));
+}
+
+void
+TestSceneContext::testUpdateSchedulingTiming()
+{
+    // CHAINS independent shader chains of DEPTH objects each, all ending in
+    // one root. On every level one object, each time in another chain, is
+    // slow to update.
+#ifdef TIMING_TEST
+    constexpr int CHAINS = 32;
+    constexpr int DEPTH = 16;
+    const auto slowTime = std::chrono::milliseconds(2);
+#else
+    constexpr int CHAINS = 4;
+    constexpr int DEPTH = 6;
+    const auto slowTime = std::chrono::milliseconds(0);
+#endif
+
+    SceneContext context;
+    context.createSceneClass("FakeTeapot");
+    SceneObject* root = context.createSceneObject("FakeTeapot", "root");
+
+    UpdateHelper helper;
+    std::unordered_map<SceneObject*, bool> slow;
+    std::unordered_map<SceneObject*, int> index;
+    std::vector<std::pair<SceneObject*, SceneObject*>> edges; // (object, dependency)
+    helper.insert(root, 0);
+    slow[root] = false;
+    index[root] = 0;
+    for (int chain = 0; chain < CHAINS; ++chain) {
+        SceneObject* parent = root;
+        for (int level = 1; level <= DEPTH; ++level) {
+            SceneObject* obj = context.createSceneObject("FakeTeapot",
+                "chain" + std::to_string(chain) + "_" + std::to_string(level));
+            if (level == DEPTH) {
+                helper.insertLeaf(obj);
+            } else {
+                helper.insert(obj, level);
+            }
+            helper.addDependency(parent, obj);
+            edges.emplace_back(parent, obj);
+            slow[obj] = (level % CHAINS) == chain;
+            const int id = static_cast<int>(index.size());
+            index[obj] = id;
+            parent = obj;
+        }
+    }
+
+    // Stamps every object with the order in which its update finished.
+    std::vector<std::atomic<int>> finished(index.size());
+    std::atomic<int> finishedCount(0);
+    auto reset = [&]() {
+        for (std::atomic<int>& stamp : finished) {
+            stamp = 0;
+        }
+        finishedCount = 0;
+    };
+    auto update = [&](SceneObject* const obj) {
+        if (slow.at(obj)) {
+            std::this_thread::sleep_for(slowTime);
+        }
+        CPPUNIT_ASSERT(finished[index.at(obj)].exchange(++finishedCount) == 0);
+    };
+
+    // Both schedules update every object once, after the objects it
+    // depends on.
+    auto check = [&]() {
+        CPPUNIT_ASSERT_EQUAL(static_cast<int>(index.size()), finishedCount.load());
+        for (const auto& edge : edges) {
+            CPPUNIT_ASSERT(finished[index.at(edge.second)] < finished[index.at(edge.first)]);
+        }
+    };
+
+    rec_time::RecTime recTime;
+    reset();
+    recTime.start();
+    tbb::parallel_for_each(helper.cbegin(), helper.cend(), update);
+    for (int i = static_cast<int>(helper.getMaxDepth()) - 1; i >= 0; --i) {
+        tbb::parallel_for_each(helper.cbegin(i), helper.cend(i), update);
+    }
+    const float levelSec = recTime.end();
+    check();
+
+    reset();
+    recTime.start();
+    CPPUNIT_ASSERT_EQUAL(size_t(0), helper.parallelForEach(update));
+    const float graphSec = recTime.end();
+    check();
+
+#ifdef TIMING_TEST
+    std::cerr << ">> TestSceneContext.cc testUpdateSchedulingTiming()"
+              << " objects:" << CHAINS * DEPTH + 1
+              << " levels:" << levelSec << " sec"
+              << " graph:" << graphSec << " sec\n";
+#endif
+}
+
+void
+TestSceneContext::testConcurrentUpdatePrep()
+{
+    // ROOTS roots, each pointing to one of MIDDLES shared objects, which all
+    // point to one shared leaf. Every other middle object is also reached
+    // through an extra object, so it is reached at two different depths.
+    constexpr int ROOTS = 20000;
+    constexpr int MIDDLES = 8;
+
+    SceneContext context;
+    const SceneClass* sc = context.createSceneClass("ExtensiveObject");
+    AttributeKey<SceneObject*> objKey = sc->getAttributeKey<SceneObject*>("scene_object");
+
+    SceneObject* leaf = context.createSceneObject("ExtensiveObject", "leaf");
+    std::vector<SceneObject*> middles;
+    std::vector<SceneObject*> extras;
+    for (int i = 0; i < MIDDLES; ++i) {
+        SceneObject* middle = context.createSceneObject("ExtensiveObject", "middle" + std::to_string(i));
+        middle->beginUpdate();
+        middle->set(objKey, leaf);
+        middle->endUpdate();
+        if (i % 2) {
+            SceneObject* extra = context.createSceneObject("ExtensiveObject", "extra" + std::to_string(i));
+            extra->beginUpdate();
+            extra->set(objKey, middle);
+            extra->endUpdate();
+            extras.push_back(extra);
+        }
+        middles.push_back(middle);
+    }
+    std::vector<SceneObject*> roots;
+    for (int i = 0; i < ROOTS; ++i) {
+        SceneObject* root = context.createSceneObject("ExtensiveObject", "root" + std::to_string(i));
+        root->beginUpdate();
+        root->set(objKey, (i % 3 == 0 && !extras.empty()) ?
+                  extras[i % extras.size()] : middles[i % MIDDLES]);
+        root->endUpdate();
+        roots.push_back(root);
+    }
+
+    auto resetAll = [&]() {
+        for (auto iter = context.beginSceneObject(); iter != context.endSceneObject(); ++iter) {
+            iter->second->resetUpdate();
+        }
+    };
+
+    UpdateHelper serial;
+    for (int i = 0; i < ROOTS; ++i) {
+        roots[i]->updatePrep(serial, 0);
+    }
+    resetAll();
+
+    UpdateHelper concurrent;
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, roots.size(), 16),
+            [&](const tbb::blocked_range<size_t>& range)
+    {
+        for (size_t i = range.begin(); i != range.end(); ++i) {
+            CPPUNIT_ASSERT(roots[i]->updatePrep(concurrent, 0));
+        }
+    });
+
+    CPPUNIT_ASSERT_EQUAL(serial.size(), concurrent.size());
+    CPPUNIT_ASSERT_EQUAL(serial.getMaxDepth(), concurrent.getMaxDepth());
+    for (auto iter = context.beginSceneObject(); iter != context.endSceneObject(); ++iter) {
+        CPPUNIT_ASSERT_EQUAL(serial.getDepth(iter->second), concurrent.getDepth(iter->second));
+    }
+    CPPUNIT_ASSERT(concurrent.isLeaf(leaf));
+
+    // Every object is updated after the objects it points to.
+    std::atomic<int> counter(0);
+    std::unordered_map<SceneObject*, int> order;
+    for (auto iter = context.beginSceneObject(); iter != context.endSceneObject(); ++iter) {
+        order[iter->second] = -1;
+    }
+    concurrent.parallelForEach([&](SceneObject* const obj) {
+        order.at(obj) = counter++;
+    });
+    for (auto iter = context.beginSceneObject(); iter != context.endSceneObject(); ++iter) {
+        SceneObject* obj = iter->second;
+        if (obj->getSceneClass().getName() != "ExtensiveObject") {
+            continue;
+        }
+        CPPUNIT_ASSERT(order[obj] >= 0);
+        SceneObject* dependency = obj->get(objKey);
+        if (dependency) {
+            // Also holds for walks that reached the dependency while another
+            // thread was revisiting it at a deeper level.
+            CPPUNIT_ASSERT(concurrent.hasDependency(obj, dependency));
+            CPPUNIT_ASSERT(order[dependency] < order[obj]);
+        }
+    }
+    resetAll();
+}
+
+void
+TestSceneContext::testSymbolLookup()
+{
+    // Interning the same string from many threads gives one id.
+    const std::string name("/seq/shot/symbol_test");
+    std::vector<uint32_t> ids(64);
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, ids.size()),
+                      [&](const tbb::blocked_range<size_t>& range) {
+        for (size_t i = range.begin(); i < range.end(); ++i) {
+            ids[i] = Symbol(name).id();
+        }
+    });
+    for (uint32_t id : ids) {
+        CPPUNIT_ASSERT_EQUAL(ids[0], id);
+    }
+    CPPUNIT_ASSERT(Symbol(name).str() == name);
+    CPPUNIT_ASSERT(Symbol::find(name) == Symbol(name));
+    CPPUNIT_ASSERT(!Symbol::find("/seq/shot/never_interned").isValid());
+    CPPUNIT_ASSERT(Symbol("a") != Symbol("b"));
+
+    SceneContext context;
+    SceneObject* pizza = context.createSceneObject("ExampleObject", "/seq/shot/pizza");
+    const Symbol pizzaName("/seq/shot/pizza");
+
+    CPPUNIT_ASSERT(context.sceneObjectExists(pizzaName));
+    CPPUNIT_ASSERT(!context.sceneObjectExists(Symbol("/seq/shot/not_a_pizza")));
+    CPPUNIT_ASSERT(context.getSceneObject(pizzaName) == pizza);
+    CPPUNIT_ASSERT_THROW(context.getSceneObject(Symbol("/seq/shot/not_a_pizza")),
+                         except::KeyError);
+    CPPUNIT_ASSERT_THROW(context.getSceneObject(Symbol()), except::KeyError);
+
+    // Creating an object doesn't intern its name, the first lookup by Symbol
+    // still finds it.
+    SceneObject* pasta = context.createSceneObject("ExampleObject", "/seq/shot/pasta");
+    CPPUNIT_ASSERT(!Symbol::find("/seq/shot/pasta").isValid());
+    CPPUNIT_ASSERT(context.getSceneObject(Symbol("/seq/shot/pasta")) == pasta);
+    CPPUNIT_ASSERT(context.sceneObjectExists(Symbol::find("/seq/shot/pasta")));
+
+    const SceneClass& sc = pizza->getSceneClass();
+    const Symbol awesomeness("awesomeness");
+    CPPUNIT_ASSERT(sc.getAttribute(awesomeness) == sc.getAttribute("awesomeness"));
+    CPPUNIT_ASSERT_THROW(sc.getAttribute(Symbol("not_an_attribute")), except::KeyError);
+
+    AttributeKey<Int> key = sc.getAttributeKey<Int>(awesomeness);
+    CPPUNIT_ASSERT(key == sc.getAttributeKey<Int>("awesomeness"));
+    CPPUNIT_ASSERT_THROW(sc.getAttributeKey<Float>(awesomeness), except::TypeError);
+
+    // Reading names that aren't attributes must not grow the symbol table,
+    // it is never freed.
+    AsciiReader reader(context);
+    reader.fromString("ExampleObject(\"/seq/shot/pizza\")[\"awesomeness\"] = 7\n");
+    CPPUNIT_ASSERT_EQUAL(Int(7), pizza->get(sc.getAttributeKey<Int>("awesomeness")));
+    const std::size_t symbolCount = Symbol::count();
+    for (int i = 0; i < 100; ++i) {
+        const std::string suffix = std::to_string(i);
+        reader.fromString("local o = ExampleObject(\"/seq/shot/pizza\")\n"
+                          "o[\"unknown_set_" + suffix + "\"] = 1\n"
+                          "o { [\"unknown_mass_" + suffix + "\"] = 2, awesomeness = 3 }\n"
+                          "local ok = pcall(function() return o[\"unknown_get_" + suffix +
+                          "\"] end)\n"
+                          "assert(not ok)\n");
+    }
+    CPPUNIT_ASSERT_EQUAL(symbolCount, Symbol::count());
+    CPPUNIT_ASSERT_EQUAL(Int(3), pizza->get(sc.getAttributeKey<Int>("awesomeness")));
+    CPPUNIT_ASSERT(!Symbol::find("unknown_set_0").isValid());
+}
+
+void
+TestSceneContext::testSymbolLookupTiming()
+{
+#ifdef TIMING_TEST
+    constexpr int OBJECTS = 20000;
+    constexpr int LOOKUPS = 1000000;
+#else
+    constexpr int OBJECTS = 500;
+    constexpr int LOOKUPS = 10000;
+#endif
+
+    SceneContext context;
+    std::vector<std::string> names;
+    for (int i = 0; i < OBJECTS; ++i) {
+        names.push_back("/seq/shot/long/scene/object/path/object_" + std::to_string(i));
+        context.createSceneObject("ExtensiveObject", names.back());
+    }
+    std::vector<Symbol> symbols;
+    for (const std::string& name : names) {
+        symbols.push_back(Symbol(name));
+    }
+
+    const SceneClass* sc = context.getSceneClass("ExtensiveObject");
+    const std::string attrName("float");
+    const Symbol attrSymbol(attrName);
+
+    rec_time::RecTime recTime;
+    const Attribute* byString = nullptr;
+    recTime.start();
+    for (int i = 0; i < LOOKUPS; ++i) {
+        byString = sc->getAttribute(attrName);
+    }
+    const float attrStringSec = recTime.end();
+
+    const Attribute* bySymbol = nullptr;
+    recTime.start();
+    for (int i = 0; i < LOOKUPS; ++i) {
+        bySymbol = sc->getAttribute(attrSymbol);
+    }
+    const float attrSymbolSec = recTime.end();
+    CPPUNIT_ASSERT(byString == bySymbol);
+
+    size_t found = 0;
+    recTime.start();
+    for (const std::string& name : names) {
+        found += context.getSceneObject(name) != nullptr;
+    }
+    const float objStringSec = recTime.end();
+
+    recTime.start();
+    for (Symbol symbol : symbols) {
+        found += context.getSceneObject(symbol) != nullptr;
+    }
+    const float objSymbolSec = recTime.end();
+    CPPUNIT_ASSERT_EQUAL(size_t(2 * OBJECTS), found);
+    for (int i = 0; i < OBJECTS; ++i) {
+        CPPUNIT_ASSERT(context.getSceneObject(symbols[i]) == context.getSceneObject(names[i]));
+    }
+
+#ifdef TIMING_TEST
+    std::cerr << ">> TestSceneContext.cc testSymbolLookupTiming()"
+              << " attribute string:" << attrStringSec << " sec"
+              << " symbol:" << attrSymbolSec << " sec"
+              << " object string:" << objStringSec << " sec"
+              << " symbol:" << objSymbolSec << " sec\n";
+#endif
+}
+
+void
+TestSceneContext::testPrefetchSceneClasses()
+{
+    SceneContext context;
+    context.prefetchSceneClasses({ "ExampleObject", "ExtensiveObject", "ExampleObject",
+                                   "ThrowDuringDeclare", "Nonexistent", "" });
+
+    // Creating a class whose DSO is still loading takes it over.
+    SceneClass* extensive = context.createSceneClass("ExtensiveObject");
+    CPPUNIT_ASSERT(extensive != nullptr);
+
+    // Only the DSOs are opened, the classes are declared by createSceneClass().
+    context.waitForSceneClassPrefetch();
+    CPPUNIT_ASSERT(!context.sceneClassExists("ExampleObject"));
+    CPPUNIT_ASSERT(context.getSceneClass("ExtensiveObject") == extensive);
+
+    // Failures are left for whoever creates the class to see.
+    CPPUNIT_ASSERT(!context.sceneClassExists("ThrowDuringDeclare"));
+    CPPUNIT_ASSERT(!context.sceneClassExists("Nonexistent"));
+    CPPUNIT_ASSERT_THROW(context.createSceneClass("ThrowDuringDeclare"), std::runtime_error);
+    CPPUNIT_ASSERT_THROW(context.createSceneClass("Nonexistent"), except::IoError);
+
+    // Existing classes are skipped, and prefetching again is harmless.
+    context.prefetchSceneClasses({ "ExampleObject", "ExtensiveObject", "SceneVariables" });
+    context.waitForSceneClassPrefetch();
+    CPPUNIT_ASSERT(context.createSceneObject("ExampleObject", "/example") != nullptr);
+
+    // DSOs nobody took are dropped when the DSO path changes.
+    context.prefetchSceneClasses({ "FakeTeapot" });
+    context.setDsoPath("/nonexistent/rdl2dso");
+    CPPUNIT_ASSERT_THROW(context.createSceneClass("FakeTeapot"), except::IoError);
+}
+
 } // namespace unittest
 } // namespace rdl2
 } // namespace scene_rdl2
@@ -39,6 +39,18 @@ public:
     /// object again will return the existing object.
     void testCreateSceneObject();
 
+    /// Test that creating SceneObjects in bulk matches creating them one by
+    /// one, including existing and duplicate names and concurrent batches.
+    void testCreateSceneObjects();
+
+    /// Check that creating many SceneObjects one by one and in bulk gives the
+    /// same objects, and compare their timings when TIMING_TEST is defined.
+    void testCreateSceneObjectsTiming();
+
+    /// Test that the attribute storage of same-class objects is contiguous
+    /// and that NUMA allocation callbacks see every storage block.
+    void testAttributeStorageSlabs();
+
     /// Test that we can get a SceneObject by name.
     void testGetSceneObject();
 
@@ -65,6 +77,43 @@ public:
     /// creation fails.
     void testCreateObjectFailure();
 
+    /// Test that the dirty object journal tracks created and changed objects
+    /// exactly once and is emptied by commitAllChanges().
+    void testDirtyObjectJournal();
+
+    /// Test that UpdateHelper::parallelForEach() visits every recorded object
+    /// once and only after all of its recorded dependencies.
+    void testUpdateDependencyOrder();
+
+    // Verify applyUpdates() records the layer assignment edges and updates
+    // every recorded object.
+    void testApplyUpdatesDependencies();
+
+    // Verify a displacement change of one assignment makes the later
+    // assignments of the same geometry see the geometry as changed.
+    void testApplyUpdatesSharedGeometry();
+
+    /// Check that level by level and dependency driven updates both visit a
+    /// synthetic deep network in dependency order. Compares their timings on
+    /// a larger network with a few slow objects when TIMING_TEST is defined.
+    void testUpdateSchedulingTiming();
+
+    /// Test that walking a shared object graph with updatePrep() from many
+    /// threads records the same objects, depths and edges as a serial walk.
+    void testConcurrentUpdatePrep();
+
+    /// Test that interned names are stable across threads and find the same
+    /// SceneObjects and Attributes as their strings.
+    void testSymbolLookup();
+
+    /// Check that attribute and object lookups by string and by Symbol find
+    /// the same things, and compare their timings when TIMING_TEST is
+    /// defined.
+    void testSymbolLookupTiming();
+
+    /// Test creating SceneClasses in the background.
+    void testPrefetchSceneClasses();
+
     CPPUNIT_TEST_SUITE(TestSceneContext);
     CPPUNIT_TEST(testDsoPath);
     CPPUNIT_TEST(testCreateSceneClass);
@@ -72,6 +121,9 @@ public:
     CPPUNIT_TEST(testSceneClassExists);
     CPPUNIT_TEST(testIterateSceneClasses);
     CPPUNIT_TEST(testCreateSceneObject);
+    CPPUNIT_TEST(testCreateSceneObjects);
+    CPPUNIT_TEST(testCreateSceneObjectsTiming);
+    CPPUNIT_TEST(testAttributeStorageSlabs);
     CPPUNIT_TEST(testGetSceneObject);
     CPPUNIT_TEST(testSceneObjectExists);
     CPPUNIT_TEST(testIterateSceneObjects);
@@ -80,6 +132,15 @@ public:
     CPPUNIT_TEST(testSceneVariables);
     CPPUNIT_TEST(testCreateClassFailure);
     CPPUNIT_TEST(testCreateObjectFailure);
+    CPPUNIT_TEST(testDirtyObjectJournal);
+    CPPUNIT_TEST(testUpdateDependencyOrder);
+    CPPUNIT_TEST(testApplyUpdatesDependencies);
+    CPPUNIT_TEST(testApplyUpdatesSharedGeometry);
+    CPPUNIT_TEST(testUpdateSchedulingTiming);
+    CPPUNIT_TEST(testConcurrentUpdatePrep);
+    CPPUNIT_TEST(testSymbolLookup);
+    CPPUNIT_TEST(testSymbolLookupTiming);
+    CPPUNIT_TEST(testPrefetchSceneClasses);
     CPPUNIT_TEST_SUITE_END();
 };
 
@@ -617,6 +617,75 @@ TestSceneObject::testExtension()
     mDsoClass->destroyObject(obj);
 }
 
+void
+TestSceneObject::testSetWithoutContext()
+{
+    CPPUNIT_ASSERT(mDsoClass->getSceneContext() == nullptr);
+
+    SceneObject* obj = mDsoClass->createObject("/seq/shot/pizza");
+    obj->commitChanges();
+    CPPUNIT_ASSERT(!obj->isDirty());
+
+    obj->beginUpdate();
+    obj->set(mIntKey, Int(9001));
+    obj->set(mStringVectorKey, StringVector{"a", "b"});
+    obj->endUpdate();
+    CPPUNIT_ASSERT(obj->isDirty());
+    CPPUNIT_ASSERT(obj->get(mIntKey) == Int(9001));
+    CPPUNIT_ASSERT(obj->get(mStringVectorKey).size() == 2);
+
+    // no journal to record into, so the object is never marked as journaled
+    CPPUNIT_ASSERT(!obj->mInDirtyJournal);
+
+    obj->commitChanges();
+    obj->beginUpdate();
+    obj->set(mIntKey, Int(42));
+    obj->endUpdate();
+    CPPUNIT_ASSERT(obj->isDirty());
+    CPPUNIT_ASSERT(obj->get(mIntKey) == Int(42));
+
+    mDsoClass->destroyObject(obj);
+}
+
+void
+TestSceneObject::testMoveSet()
+{
+    SceneObject* obj = mDsoClass->createObject("/seq/shot/pizza");
+    obj->commitChanges();
+
+    // moves are rejected outside of an update, like copies
+    CPPUNIT_ASSERT_THROW(obj->set(mFloatVectorKey, FloatVector{1.0f}), except::RuntimeError);
+    CPPUNIT_ASSERT_THROW(obj->set(mFloatVectorKey, FloatVector{1.0f}, TIMESTEP_END), except::RuntimeError);
+
+    obj->beginUpdate();
+    FloatVector floats(1000, 0.5f);
+    obj->set(mFloatVectorKey, std::move(floats));
+    obj->set(mIntKey, Int(7)); // blurrable: both timesteps are set
+    obj->set(mDoubleKey, Double(3.0), TIMESTEP_END);
+    obj->endUpdate();
+
+    CPPUNIT_ASSERT(obj->get(mFloatVectorKey) == FloatVector(1000, 0.5f));
+    CPPUNIT_ASSERT(obj->get(mIntKey, TIMESTEP_BEGIN) == Int(7));
+    CPPUNIT_ASSERT(obj->get(mIntKey, TIMESTEP_END) == Int(7));
+    CPPUNIT_ASSERT(obj->get(mDoubleKey, TIMESTEP_BEGIN) == Double(2.0));
+    CPPUNIT_ASSERT(obj->get(mDoubleKey, TIMESTEP_END) == Double(3.0));
+    CPPUNIT_ASSERT(obj->mAttributeSetMask.test(mFloatVectorKey.mIndex));
+    CPPUNIT_ASSERT(obj->mAttributeSetMask.test(mIntKey.mIndex));
+    CPPUNIT_ASSERT(obj->isDirty());
+
+    // moving in the same value doesn't change anything
+    obj->commitChanges();
+    obj->beginUpdate();
+    obj->set(mFloatVectorKey, FloatVector(1000, 0.5f));
+    obj->set(mIntKey, Int(7));
+    obj->endUpdate();
+    CPPUNIT_ASSERT(!obj->mAttributeSetMask.test(mFloatVectorKey.mIndex));
+    CPPUNIT_ASSERT(!obj->mAttributeSetMask.test(mIntKey.mIndex));
+    CPPUNIT_ASSERT(!obj->isDirty());
+
+    mDsoClass->destroyObject(obj);
+}
+
 } // namespace unittest
 } // namespace rdl2
 } // namespace scene_rdl2
@@ -60,6 +60,13 @@ public:
     /// Mostly a compilation test.
     void testExtension();
 
+    /// Test that sets and markDirty work on an object whose SceneClass has no
+    /// SceneContext (no dirty object journal).
+    void testSetWithoutContext();
+
+    /// Test that setting rvalues (move-set) behaves like a copying set().
+    void testMoveSet();
+
     CPPUNIT_TEST_SUITE(TestSceneObject);
     CPPUNIT_TEST(testGetClass);
     CPPUNIT_TEST(testGetName);
@@ -72,6 +79,8 @@ public:
     CPPUNIT_TEST(testAttributeSetMask);
     CPPUNIT_TEST(testBindings);
     CPPUNIT_TEST(testExtension);
+    CPPUNIT_TEST(testSetWithoutContext);
+    CPPUNIT_TEST(testMoveSet);
     CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -5,6 +5,7 @@
 // Test split mode writing a context to both rdla and rdlb
 #include "TestSplit.h"
 
+#include <scene_rdl2/scene/rdl2/AsciiWriter.h>
 #include <scene_rdl2/scene/rdl2/AttributeKey.h>
 #include <scene_rdl2/scene/rdl2/Utils.h>
 #include <scene_rdl2/scene/rdl2/SceneClass.h>
@@ -120,6 +121,76 @@ TestSplit::testRoundtrip()
     CPPUNIT_ASSERT(geoms.empty());
 }
 
+void
+TestSplit::testReadScenesFromFiles()
+{
+    SceneContext context;
+    const SceneClass* sc = context.createSceneClass("ExtensiveObject");
+    SceneObject* apple = context.createSceneObject("ExtensiveObject", "/seq/shot/apple");
+    SceneObject* banana = context.createSceneObject("ExtensiveObject", "/seq/shot/banana");
+    AttributeKey<String> stringKey = sc->getAttributeKey<String>("string");
+    AttributeKey<Vec3fVector> vec3fVectorKey = sc->getAttributeKey<Vec3fVector>("vec3f_vector");
+
+    apple->beginUpdate();
+    apple->set(stringKey, std::string("apple"));
+    apple->set(vec3fVectorKey, mShortVec);
+    apple->endUpdate();
+    banana->beginUpdate();
+    banana->set(stringKey, std::string("banana"));
+    banana->set(vec3fVectorKey, mLongVec);
+    banana->endUpdate();
+
+    writeSceneToFile(context, "multi_split", false, true);
+
+    // A later layer overrides an earlier one, and one needs Lua.
+    {
+        std::ofstream out("multi_override.rdla");
+        out << "ExtensiveObject(\"/seq/shot/apple\") { [\"string\"] = \"pear\" }\n";
+    }
+    {
+        std::ofstream out("multi_lua.rdla");
+        out << "local name = \"/seq/shot/cherry\"\n"
+               "ExtensiveObject(name) { [\"string\"] = \"cherry\" }\n";
+    }
+
+    const std::vector<std::string> files = {
+        "multi_split.rdla", "multi_split.rdlb", "multi_override.rdla", "multi_lua.rdla"
+    };
+
+    SceneContext serialContext;
+    for (const std::string& file : files) {
+        readSceneFromFile(file, serialContext);
+    }
+
+    SceneContext parallelContext;
+    readScenesFromFiles(files, parallelContext);
+
+    CPPUNIT_ASSERT_EQUAL(AsciiWriter(serialContext).toString(),
+                         AsciiWriter(parallelContext).toString());
+    CPPUNIT_ASSERT(parallelContext.getSceneObject("/seq/shot/apple")->get(stringKey) == "pear");
+    CPPUNIT_ASSERT(parallelContext.getSceneObject("/seq/shot/banana")->get(vec3fVectorKey) == mLongVec);
+    CPPUNIT_ASSERT(parallelContext.getSceneObject("/seq/shot/cherry")->get(stringKey) == "cherry");
+
+    // Errors are thrown after the files before them are applied.
+    SceneContext errorContext;
+    CPPUNIT_ASSERT_THROW(readScenesFromFiles({ "multi_override.rdla", "multi.txt" }, errorContext),
+                         except::RuntimeError);
+    CPPUNIT_ASSERT(errorContext.getSceneObject("/seq/shot/apple")->get(stringKey) == "pear");
+
+    // More files than are staged at once still apply in order.
+    std::vector<std::string> layers;
+    for (int i = 0; i < 20; ++i) {
+        layers.push_back("multi_layer_" + std::to_string(i) + ".rdla");
+        std::ofstream out(layers.back());
+        out << "ExtensiveObject(\"/seq/shot/apple\") { [\"string\"] = \"layer "
+            << i << "\" }\n";
+    }
+    layers.insert(layers.begin() + 10, "multi_split.rdlb");
+    SceneContext layerContext;
+    readScenesFromFiles(layers, layerContext);
+    CPPUNIT_ASSERT(layerContext.getSceneObject("/seq/shot/apple")->get(stringKey) == "layer 19");
+    CPPUNIT_ASSERT(layerContext.getSceneObject("/seq/shot/banana")->get(vec3fVectorKey) == mLongVec);
+}
 
 } // namespace unittest
 } // namespace rdl2
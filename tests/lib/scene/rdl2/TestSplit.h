@@ -24,8 +24,13 @@ public:
     /// Test basic roundtrip functionality
     void testRoundtrip();
 
+    /// Test that loading several files concurrently matches loading them
+    /// one at a time.
+    void testReadScenesFromFiles();
+
     CPPUNIT_TEST_SUITE(TestSplit);
     CPPUNIT_TEST(testRoundtrip);
+    CPPUNIT_TEST(testReadScenesFromFiles);
     CPPUNIT_TEST_SUITE_END();
 
 private:
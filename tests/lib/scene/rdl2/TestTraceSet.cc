@@ -10,10 +10,14 @@
 #include <scene_rdl2/scene/rdl2/SceneContext.h>
 #include <scene_rdl2/scene/rdl2/SceneObject.h>
 
+#include <scene_rdl2/common/rec_time/RecTime.h>
+
 #include <cppunit/extensions/HelperMacros.h>
 
+#include <iostream>
 #include <string>
 #include <sstream>
+#include <vector>
 
 namespace scene_rdl2 {
 namespace rdl2 {
@@ -103,6 +107,97 @@ TestTraceSet::testSerialize()
     CPPUNIT_ASSERT(traceSetRead->lookupGeomAndPart(4).second == "base");
 }
 
+void
+TestTraceSet::testLookup()
+{
+    Geometry* teapot1 = mContext->createSceneObject("FakeTeapot", "/seq/shot/teapot1")->asA<Geometry>();
+    Geometry* teapot2 = mContext->createSceneObject("FakeTeapot", "/seq/shot/teapot2")->asA<Geometry>();
+    TraceSet* traceSet = mContext->createSceneObject("TraceSet", "/seq/shot/traceset")->asA<TraceSet>();
+
+    traceSet->beginUpdate();
+    CPPUNIT_ASSERT(traceSet->assign(teapot1, "lid") == 0);
+    CPPUNIT_ASSERT(traceSet->assign(teapot1, "") == 1);
+    CPPUNIT_ASSERT(traceSet->assign(teapot2, "lid") == 2);
+    CPPUNIT_ASSERT(traceSet->assign(teapot1, "lid") == 0); // existing
+    traceSet->endUpdate();
+
+    CPPUNIT_ASSERT(traceSet->getAssignmentId(teapot1, "lid") == 0);
+    CPPUNIT_ASSERT(traceSet->getAssignmentId(teapot1, "spout") == 1); // default
+    CPPUNIT_ASSERT(traceSet->getAssignmentId(teapot2, "lid") == 2);
+    CPPUNIT_ASSERT(traceSet->getAssignmentId(teapot2, "spout") == -1);
+
+    std::vector<int32_t> ids;
+    traceSet->lookupAll(teapot1, { "lid", "spout", "" }, ids);
+    CPPUNIT_ASSERT(ids == std::vector<int32_t>({ 0, 1, 1 }));
+    traceSet->lookupAll(teapot2, { "lid", "spout" }, ids);
+    CPPUNIT_ASSERT(ids == std::vector<int32_t>({ 2, -1 }));
+
+    // Rewriting the parts without assign() is picked up by the next lookup.
+    const AttributeKey<StringVector> partsKey =
+        traceSet->getSceneClass().getAttributeKey<StringVector>("parts");
+    traceSet->beginUpdate();
+    traceSet->set(partsKey, StringVector({ "spout", "", "body" }));
+    traceSet->endUpdate();
+    CPPUNIT_ASSERT(traceSet->getAssignmentId(teapot1, "spout") == 0);
+    CPPUNIT_ASSERT(traceSet->getAssignmentId(teapot1, "lid") == 1); // default
+    CPPUNIT_ASSERT(traceSet->getAssignmentId(teapot2, "lid") == -1);
+    CPPUNIT_ASSERT(traceSet->getAssignmentId(teapot2, "body") == 2);
+
+    traceSet->beginUpdate();
+    CPPUNIT_ASSERT(traceSet->assign(teapot2, "body") == 2);
+    CPPUNIT_ASSERT(traceSet->assign(teapot2, "lid") == 3);
+    traceSet->endUpdate();
+    CPPUNIT_ASSERT(traceSet->getAssignmentId(teapot2, "lid") == 3);
+}
+
+void
+TestTraceSet::testLookupTiming()
+{
+#ifdef TIMING_TEST
+    constexpr int PARTS = 20000;
+#else
+    constexpr int PARTS = 500;
+#endif
+
+    Geometry* teapot = mContext->createSceneObject("FakeTeapot", "/seq/shot/teapot")->asA<Geometry>();
+    Layer* layer = mContext->createSceneObject("Layer", "/seq/shot/layer")->asA<Layer>();
+
+    StringVector partNames;
+    for (int i = 0; i < PARTS; ++i) {
+        partNames.push_back("part" + std::to_string(i));
+    }
+
+    rec_time::RecTime recTime;
+    recTime.start();
+    layer->beginUpdate();
+    for (const std::string& partName : partNames) {
+        layer->assign(teapot, partName, nullptr, nullptr);
+    }
+    layer->endUpdate();
+    const float assignSec = recTime.end();
+
+    recTime.start();
+    for (int i = 0; i < PARTS; ++i) {
+        CPPUNIT_ASSERT(layer->getAssignmentId(teapot, partNames[i]) == i);
+    }
+    const float lookupSec = recTime.end();
+
+    std::vector<int32_t> ids;
+    recTime.start();
+    layer->lookupAll(teapot, partNames, ids);
+    const float lookupAllSec = recTime.end();
+    for (int i = 0; i < PARTS; ++i) {
+        CPPUNIT_ASSERT(ids[i] == i);
+    }
+
+#ifdef TIMING_TEST
+    std::cerr << ">> TestTraceSet.cc testLookupTiming() parts:" << PARTS
+              << " assign:" << assignSec << " sec"
+              << " lookup:" << lookupSec << " sec"
+              << " lookupAll:" << lookupAllSec << " sec\n";
+#endif
+}
+
 
 } // namespace unittest
 } // namespace rdl2
@@ -23,8 +23,18 @@ public:
 
     void testSerialize();
 
+    /// Test getAssignmentId() and lookupAll(), including the default part
+    /// fallback and changes made without assign().
+    void testLookup();
+
+    /// Check assigning and looking up the parts of a geometry with many parts,
+    /// and time it when TIMING_TEST is defined.
+    void testLookupTiming();
+
     CPPUNIT_TEST_SUITE(TestTraceSet);
     CPPUNIT_TEST(testSerialize);
+    CPPUNIT_TEST(testLookup);
+    CPPUNIT_TEST(testLookupTiming);
     CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -10,6 +10,7 @@
 
 #include <scene_rdl2/common/rec_time/RecTime.h>
 
+#include <algorithm>
 #include <vector>
 #include <float.h>
 #include <stdio.h> // rand()
@@ -1219,6 +1220,141 @@ TestValueContainer::testVLLongVector() // int64_t
              });
 }
 
+void
+TestValueContainer::testVLUIntArray()
+{
+    // Runs of 1 byte, 2 byte and mixed size values, plus a short tail.
+    std::vector<unsigned int> vec;
+    for (unsigned int i = 0; i < 100; ++i) vec.push_back(i);
+    for (unsigned int i = 0; i < 100; ++i) vec.push_back(128 + i * 100);
+    for (unsigned int i = 0; i < 100; ++i) vec.push_back((i % 3 == 0) ? 0xffffffff - i : i);
+    vec.push_back(7);
+
+    // Batch encoding must be byte-identical to enqVLUInt() one at a time.
+    std::string single, batch;
+    {
+        ValueContainerEnq vcEnq(&single);
+        for (unsigned int ui : vec) vcEnq.enqVLUInt(ui);
+        vcEnq.finalize();
+    }
+    {
+        ValueContainerEnq vcEnq(&batch);
+        vcEnq.enqVLUIntArray(vec.data(), vec.size());
+        vcEnq.finalize();
+    }
+    CPPUNIT_ASSERT(single == batch);
+
+    ValueContainerDeq vcDeq(batch.data(), batch.size());
+    std::vector<unsigned int> pVec(vec.size());
+    vcDeq.deqVLUIntArray(pVec.data(), pVec.size());
+    CPPUNIT_ASSERT(pVec == vec);
+    CPPUNIT_ASSERT(vcDeq.getRestSize() == 0);
+
+    // A broken stream with no value ending in a whole 16 byte window must still make progress
+    // and consume the same bytes as the single value decoder.
+    {
+        std::vector<unsigned char> corrupt(64, 0x0);
+        std::fill(corrupt.begin(), corrupt.begin() + 16, 0x80);
+        std::vector<unsigned int> out(16);
+        size_t singleSize = 0;
+        for (size_t i = 0; i < out.size(); ++i) {
+            singleSize += ValueContainerUtil::variableLengthDecoding(&corrupt[singleSize], out[i]);
+        }
+        CPPUNIT_ASSERT(ValueContainerUtil::variableLengthDecodingArray(corrupt.data(), out.size(),
+                                                                       out.data()) == singleSize);
+    }
+
+    // Decode a large array of small values (e.g. delta coded tile ids) both
+    // ways. Timed when TIMING_TEST is defined.
+#ifdef TIMING_TEST
+    constexpr size_t size = 10000000;
+#else
+    constexpr size_t size = 10001;
+#endif
+    std::vector<unsigned int> ids(size);
+    for (size_t i = 0; i < size; ++i) ids[i] = static_cast<unsigned int>((i * 7) % 300);
+    std::string buff;
+    {
+        ValueContainerEnq vcEnq(&buff);
+        vcEnq.enqVLUIntArray(ids.data(), ids.size());
+        vcEnq.finalize();
+    }
+
+    rec_time::RecTime recTime;
+    std::vector<unsigned int> singleIds(size), batchIds(size);
+    recTime.start();
+    {
+        ValueContainerDeq deq(buff.data(), buff.size());
+        for (size_t i = 0; i < size; ++i) deq.deqVLUInt(singleIds[i]);
+    }
+    const float singleSec = recTime.end();
+    recTime.start();
+    {
+        ValueContainerDeq deq(buff.data(), buff.size());
+        deq.deqVLUIntArray(batchIds.data(), size);
+    }
+    const float batchSec = recTime.end();
+#ifdef TIMING_TEST
+    std::cerr << "TestValueContainer testVLUIntArray() x " << size
+              << " single:" << singleSec << " sec"
+              << " batch:" << batchSec << " sec"
+              << " speedup:" << ((batchSec > 0.0f) ? singleSec / batchSec : 0.0f) << std::endl;
+#endif
+    CPPUNIT_ASSERT(singleIds == ids);
+    CPPUNIT_ASSERT(batchIds == ids);
+}
+
+void
+TestValueContainer::testBulkVectorTiming()
+{
+#ifdef TIMING_TEST
+    constexpr size_t size = 10000000;
+#else
+    constexpr size_t size = 10000;
+#endif
+    Vec3fVector vec(size);
+    for (size_t i = 0; i < size; ++i) {
+        vec[i] = Vec3f(static_cast<float>(i), static_cast<float>(i) * 0.5f, static_cast<float>(i) * 0.25f);
+    }
+
+    std::string buff;
+    ValueContainerEnq vcEnq(&buff);
+    vcEnq.enqVec3fVector(vec);
+    vcEnq.finalize();
+
+    rec_time::RecTime recTime;
+
+    // Element by element, as deqVector() used to do it.
+    Vec3fVector elemVec;
+    recTime.start();
+    {
+        ValueContainerDeq vcDeq(buff.data(), buff.size());
+        elemVec.resize(vcDeq.deqVLSizeT());
+        for (size_t i = 0; i < elemVec.size(); ++i) {
+            vcDeq.deqVec3f(elemVec[i]);
+        }
+    }
+    const float elemSec = recTime.end();
+
+    Vec3fVector bulkVec;
+    recTime.start();
+    {
+        ValueContainerDeq vcDeq(buff.data(), buff.size());
+        vcDeq.deqVec3fVector(bulkVec);
+    }
+    const float bulkSec = recTime.end();
+
+#ifdef TIMING_TEST
+    std::cerr << "TestValueContainer testBulkVectorTiming() Vec3f x " << size
+              << " element:" << elemSec << " sec"
+              << " bulk:" << bulkSec << " sec"
+              << " speedup:" << ((bulkSec > 0.0f) ? elemSec / bulkSec : 0.0f) << std::endl;
+#endif
+
+    CPPUNIT_ASSERT(bulkVec == vec);
+    CPPUNIT_ASSERT(elemVec == vec);
+}
+
 } // namespace unittest
 } // namespace rdl2
 } // namespace scene_rdl2
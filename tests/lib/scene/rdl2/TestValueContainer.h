@@ -76,6 +76,9 @@ public:
     void testSceneObjectIndexable();
     void testVLIntVector();
     void testVLLongVector();
+    void testVLUIntArray();
+
+    void testBulkVectorTiming(); // bulk deqVector() vs element by element dequeue, timed with TIMING_TEST
 
     CPPUNIT_TEST_SUITE(TestValueContainer);
     CPPUNIT_TEST(testBool);
@@ -131,6 +134,8 @@ public:
     CPPUNIT_TEST(testSceneObjectIndexable);
     CPPUNIT_TEST(testVLIntVector);
     CPPUNIT_TEST(testVLLongVector);
+    CPPUNIT_TEST(testVLUIntArray);
+    CPPUNIT_TEST(testBulkVectorTiming);
     CPPUNIT_TEST_SUITE_END();
 
 protected: